@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+"""Call throughput microbenchmark.
+
+Makes a large number of small Python-to-Python calls, both in a loop and
+recursively, so that the cost of setting up and tearing down frames dominates.
+When run directly under CinderX, it reports calls per second with the frame
+arena enabled and disabled. With the arena disabled, frames are reused through
+CPython's per-code zombie frames and its frame free list instead.
+"""
+
+
+def add(a, b):
+    return a + b
+
+
+def loop_calls(n):
+    total = 0
+    for i in range(n):
+        total = add(total, i)
+    return total
+
+
+def fib(n):
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+    def dot(self, other):
+        return self.x * other.x + self.y * other.y
+
+
+def method_calls(n):
+    p = Point(1, 2)
+    q = Point(3, 4)
+    total = 0
+    for _ in range(n):
+        total += p.dot(q)
+    return total
+
+
+# fib(FIB_ARG) makes FIB_CALLS calls in total.
+FIB_ARG = 20
+FIB_CALLS = 21891
+LOOP_CALLS = 200000
+
+
+def run_all():
+    loop_calls(LOOP_CALLS)
+    method_calls(LOOP_CALLS)
+    fib(FIB_ARG)
+    return 2 * LOOP_CALLS + FIB_CALLS
+
+
+def run():
+    run_all()
+
+
+def measure(num_iterations):
+    import time
+
+    calls = 0
+    start = time.perf_counter()
+    for _ in range(num_iterations):
+        calls += run_all()
+    return calls / (time.perf_counter() - start)
+
+
+if __name__ == "__main__":
+    import sys
+
+    num_iterations = 1
+    if len(sys.argv) > 1:
+        num_iterations = int(sys.argv[1])
+
+    try:
+        import cinder
+
+        set_frame_arena_enabled = cinder.set_frame_arena_enabled
+    except (ImportError, AttributeError):
+        set_frame_arena_enabled = None
+
+    if set_frame_arena_enabled is None:
+        print(f"{measure(num_iterations):.0f} calls/s")
+    else:
+        # Warm up, so that both runs see the same shadow code and JIT state.
+        measure(1)
+        for enabled in (False, True):
+            set_frame_arena_enabled(enabled)
+            rate = measure(num_iterations)
+            label = "frame arena" if enabled else "zombie frames and free list"
+            print(f"{label}: {rate:.0f} calls/s")
+        print(cinder.get_frame_arena_stats())
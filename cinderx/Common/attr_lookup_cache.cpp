@@ -0,0 +1,181 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Common/attr_lookup_cache.h"
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+// The result of looking up name on type, for instances of type.
+//
+// Whether descr is a data descriptor is checked on every access rather than
+// cached, since changes to the descriptor's type don't modify the owning type.
+// Entries hold raw references so that the table needs no destructor at exit.
+struct Entry {
+  // Borrowed; only trusted while its version tag matches version.
+  PyTypeObject* type{nullptr};
+  unsigned int version{0};
+  // Owned, so that a different name can't later show up at the same address.
+  PyObject* name{nullptr};
+  // What the MRO walk found on type, or nullptr. Borrowed: anything that
+  // could free it modifies type, changing its version tag.
+  PyObject* descr{nullptr};
+  // The type's shared split-dict keys and the index of name in them, for
+  // looking name up in instance dicts that still share those keys.
+  PyDictKeysObject* keys{nullptr};
+  Py_ssize_t split_index{-1};
+};
+
+constexpr size_t kNumEntries = 4096;
+
+std::array<Entry, kNumEntries> s_entries;
+Ci_AttrLookupCacheStats s_stats;
+
+Entry& slotFor(PyTypeObject* type, PyObject* name) {
+  size_t index =
+      (type->tp_version_tag ^ (reinterpret_cast<uintptr_t>(name) >> 4)) %
+      kNumEntries;
+  return s_entries[index];
+}
+
+void clearEntry(Entry& entry) {
+  entry.type = nullptr;
+  entry.version = 0;
+  entry.keys = nullptr;
+  entry.split_index = -1;
+  entry.descr = nullptr;
+  Py_CLEAR(entry.name);
+}
+
+Entry* findEntry(PyTypeObject* type, PyObject* name) {
+  if (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+    return nullptr;
+  }
+  Entry& entry = slotFor(type, name);
+  if (entry.type != type || entry.name != name ||
+      entry.version != type->tp_version_tag) {
+    return nullptr;
+  }
+  return &entry;
+}
+
+Entry* fillEntry(PyTypeObject* type, PyObject* name) {
+  if (type->tp_dict == nullptr) {
+    return nullptr;
+  }
+  PyObject* descr = _PyType_Lookup(type, name);
+  if (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+    return nullptr;
+  }
+
+  Entry& entry = slotFor(type, name);
+  clearEntry(entry);
+  entry.type = type;
+  entry.version = type->tp_version_tag;
+  Py_INCREF(name);
+  entry.name = name;
+  entry.descr = descr;
+  if (type->tp_dictoffset > 0 &&
+      PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)) {
+    auto ht = reinterpret_cast<PyHeapTypeObject*>(type);
+    if (ht->ht_cached_keys != nullptr) {
+      Py_ssize_t index = _PyDictKeys_GetSplitIndex(ht->ht_cached_keys, name);
+      if (index != -1) {
+        entry.keys = ht->ht_cached_keys;
+        entry.split_index = index;
+      }
+    }
+  }
+  return &entry;
+}
+
+// Mirrors _PyObject_GenericGetAttrWithDict. entry may be overwritten by any
+// code that runs from here, so everything needed is read out of it up front.
+PyObject* getAttr(const Entry& entry, PyObject* obj, PyObject* name) {
+  PyTypeObject* type = Py_TYPE(obj);
+  PyDictKeysObject* keys = entry.keys;
+  Py_ssize_t split_index = entry.split_index;
+  PyObject* descr = entry.descr;
+  descrgetfunc f = nullptr;
+  if (descr != nullptr) {
+    f = Py_TYPE(descr)->tp_descr_get;
+    if (f != nullptr && PyDescr_IsData(descr)) {
+      Py_INCREF(descr);
+      PyObject* res = f(descr, obj, reinterpret_cast<PyObject*>(type));
+      Py_DECREF(descr);
+      return res;
+    }
+  }
+
+  if (type->tp_dictoffset != 0) {
+    PyObject** dictptr = _PyObject_GetDictPtr(obj);
+    PyObject* dict = dictptr != nullptr ? *dictptr : nullptr;
+    if (dict != nullptr) {
+      auto dictobj = reinterpret_cast<PyDictObject*>(dict);
+      if (keys != nullptr && dictobj->ma_keys == keys) {
+        PyObject* res = dictobj->ma_values[split_index];
+        if (res != nullptr) {
+          Py_INCREF(res);
+          return res;
+        }
+      } else {
+        Py_INCREF(dict);
+        PyObject* res = PyDict_GetItemWithError(dict, name);
+        Py_XINCREF(res);
+        Py_DECREF(dict);
+        if (res != nullptr) {
+          return res;
+        }
+        if (PyErr_Occurred()) {
+          return nullptr;
+        }
+      }
+    }
+  }
+
+  if (f != nullptr) {
+    Py_INCREF(descr);
+    PyObject* res = f(descr, obj, reinterpret_cast<PyObject*>(type));
+    Py_DECREF(descr);
+    return res;
+  }
+  if (descr != nullptr) {
+    Py_INCREF(descr);
+    return descr;
+  }
+  // Let the generic implementation raise the AttributeError.
+  return PyObject_GenericGetAttr(obj, name);
+}
+
+} // namespace
+
+PyObject* Ci_AttrLookupCache_GetAttr(PyObject* obj, PyObject* name) {
+  PyTypeObject* type = Py_TYPE(obj);
+  if (type->tp_getattro != PyObject_GenericGetAttr ||
+      !PyUnicode_CheckExact(name) || !PyUnicode_CHECK_INTERNED(name)) {
+    return PyObject_GetAttr(obj, name);
+  }
+  Entry* entry = findEntry(type, name);
+  if (entry != nullptr) {
+    s_stats.hits++;
+  } else {
+    s_stats.misses++;
+    entry = fillEntry(type, name);
+    if (entry == nullptr) {
+      return PyObject_GetAttr(obj, name);
+    }
+  }
+  return getAttr(*entry, obj, name);
+}
+
+void Ci_AttrLookupCache_Clear() {
+  for (Entry& entry : s_entries) {
+    clearEntry(entry);
+  }
+  s_stats = {};
+}
+
+void Ci_AttrLookupCache_GetStats(Ci_AttrLookupCacheStats* stats) {
+  *stats = s_stats;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include <Python.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A process-wide cache of attribute lookups on types with generic attribute
+ * access, keyed on (type version tag, interned name).
+ *
+ * Attribute access sites that see too many receiver types to cache each of
+ * them locally, in both Shadowcode and JIT-compiled code, fall back to this
+ * cache instead of walking the MRO on every access. Modifying a type
+ * invalidates its version tag, and with it all of its entries.
+ */
+
+/*
+ * Equivalent to PyObject_GetAttr(obj, name). Returns a new reference, or NULL
+ * with an exception set.
+ */
+PyAPI_FUNC(PyObject*) Ci_AttrLookupCache_GetAttr(PyObject* obj, PyObject* name);
+
+/*
+ * Drop all entries.
+ */
+PyAPI_FUNC(void) Ci_AttrLookupCache_Clear(void);
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+} Ci_AttrLookupCacheStats;
+
+PyAPI_FUNC(void) Ci_AttrLookupCache_GetStats(Ci_AttrLookupCacheStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
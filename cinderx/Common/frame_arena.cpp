@@ -0,0 +1,251 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Common/frame_arena.h"
+
+#include "pycore_object.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The frames retained by one thread state, most recently released last.
+struct FrameArena {
+  std::vector<PyFrameObject*> frames;
+  size_t retained_bytes{0};
+  Ci_FrameArenaStats stats{};
+};
+
+// Bytes of frames each thread may retain.
+constexpr size_t kMaxRetainedBytes = 1 << 20;
+
+constexpr const char* kCapsuleName = "cinderx.frame_arena";
+
+bool s_enabled = true;
+
+// The arena of the thread state identified by t_tstate_id and t_interp. The
+// arena is owned by that thread state's dict; the ids are compared before the
+// pointer is used, since thread state ids are never reused.
+thread_local FrameArena* t_arena = nullptr;
+thread_local uint64_t t_tstate_id = 0;
+thread_local PyInterpreterState* t_interp = nullptr;
+
+size_t frameBytes(PyFrameObject* f) {
+  return _PyObject_VAR_SIZE(&PyFrame_Type, Py_SIZE(f));
+}
+
+Py_ssize_t frameSlots(PyCodeObject* code) {
+  return code->co_nlocals + PyTuple_GET_SIZE(code->co_cellvars) +
+      PyTuple_GET_SIZE(code->co_freevars);
+}
+
+// Retained frames no longer have a code object, so they can't go through
+// frame_dealloc(). They hold no references, so the memory is freed directly.
+void freeRetainedFrame(PyFrameObject* f) {
+#ifdef Py_REF_DEBUG
+  _Py_DEC_REFTOTAL;
+#endif
+#ifdef Py_TRACE_REFS
+  _Py_ForgetReference(reinterpret_cast<PyObject*>(f));
+#endif
+  PyObject_GC_Del(f);
+}
+
+void clearArena(FrameArena* arena) {
+  std::vector<PyFrameObject*> frames = std::move(arena->frames);
+  arena->frames.clear();
+  arena->retained_bytes = 0;
+  arena->stats.retained = 0;
+  for (PyFrameObject* f : frames) {
+    freeRetainedFrame(f);
+  }
+}
+
+void destroyArena(PyObject* capsule) {
+  auto arena =
+      static_cast<FrameArena*>(PyCapsule_GetPointer(capsule, kCapsuleName));
+  if (t_arena == arena) {
+    t_arena = nullptr;
+    t_tstate_id = 0;
+    t_interp = nullptr;
+  }
+  clearArena(arena);
+  delete arena;
+}
+
+FrameArena* cachedArena(PyThreadState* tstate) {
+  if (t_arena != nullptr && t_tstate_id == tstate->id &&
+      t_interp == tstate->interp) {
+    return t_arena;
+  }
+  return nullptr;
+}
+
+// Return the arena for tstate, creating it if needed, or nullptr if that
+// fails. Any exception that is already set is preserved.
+FrameArena* arenaFor(PyThreadState* tstate) {
+  FrameArena* arena = cachedArena(tstate);
+  if (arena != nullptr) {
+    return arena;
+  }
+
+  _Py_IDENTIFIER(__cinderx_frame_arena__);
+  PyObject *exc, *val, *tb;
+  PyErr_Fetch(&exc, &val, &tb);
+  PyObject* dict = _PyThreadState_GetDict(tstate);
+  if (dict != nullptr) {
+    PyObject* capsule =
+        _PyDict_GetItemIdWithError(dict, &PyId___cinderx_frame_arena__);
+    if (capsule != nullptr) {
+      arena =
+          static_cast<FrameArena*>(PyCapsule_GetPointer(capsule, kCapsuleName));
+    } else if (!PyErr_Occurred()) {
+      auto new_arena = new FrameArena();
+      capsule = PyCapsule_New(new_arena, kCapsuleName, destroyArena);
+      if (capsule == nullptr) {
+        delete new_arena;
+      } else {
+        if (_PyDict_SetItemId(
+                dict, &PyId___cinderx_frame_arena__, capsule) == 0) {
+          arena = new_arena;
+        }
+        // On failure, this deletes new_arena.
+        Py_DECREF(capsule);
+      }
+    }
+  }
+  PyErr_Clear();
+  PyErr_Restore(exc, val, tb);
+
+  if (arena != nullptr) {
+    t_arena = arena;
+    t_tstate_id = tstate->id;
+    t_interp = tstate->interp;
+  }
+  return arena;
+}
+
+// Drop everything f references, as frame_dealloc() does before putting a
+// frame on its free list, so that a retained frame doesn't keep its code or
+// namespaces alive.
+void clearFrame(PyFrameObject* f) {
+  for (PyObject** p = f->f_localsplus; p < f->f_valuestack; p++) {
+    Py_CLEAR(*p);
+  }
+  for (int i = 0; i < f->f_stackdepth; i++) {
+    Py_CLEAR(f->f_valuestack[i]);
+  }
+  f->f_stackdepth = 0;
+  Py_CLEAR(f->f_back);
+  Py_CLEAR(f->f_locals);
+  Py_CLEAR(f->f_trace);
+  Py_CLEAR(f->f_builtins);
+  Py_CLEAR(f->f_globals);
+  Py_CLEAR(f->f_code);
+}
+
+} // namespace
+
+PyFrameObject* Ci_FrameArena_New(
+    PyThreadState* tstate,
+    PyFrameConstructor* con,
+    PyObject* locals) {
+  FrameArena* arena = s_enabled ? arenaFor(tstate) : nullptr;
+  if (arena == nullptr) {
+    return _PyFrame_New_NoTrack(tstate, con, locals);
+  }
+  arena->stats.allocs++;
+
+  // Only the most recently released frame is considered, which for calls
+  // made in a loop or recursively is usually one for the same code.
+  auto code = reinterpret_cast<PyCodeObject*>(con->fc_code);
+  Py_ssize_t nslots = frameSlots(code);
+  if (arena->frames.empty() ||
+      Py_SIZE(arena->frames.back()) < nslots + code->co_stacksize) {
+    return _PyFrame_New_NoTrack(tstate, con, locals);
+  }
+  PyFrameObject* f = arena->frames.back();
+  arena->frames.pop_back();
+  arena->retained_bytes -= frameBytes(f);
+  arena->stats.retained--;
+  arena->stats.reuses++;
+
+  // Slots past the previous code's locals may hold stale stack entries.
+  for (Py_ssize_t i = 0; i < nslots; i++) {
+    f->f_localsplus[i] = nullptr;
+  }
+  f->f_valuestack = f->f_localsplus + nslots;
+
+  // The same initialization as _PyFrame_New_NoTrack().
+  f->f_code = reinterpret_cast<PyCodeObject*>(Py_NewRef(code));
+  f->f_builtins = Py_NewRef(con->fc_builtins);
+  f->f_globals = Py_NewRef(con->fc_globals);
+  f->f_back = reinterpret_cast<PyFrameObject*>(Py_XNewRef(tstate->frame));
+  f->f_locals = Py_XNewRef(locals);
+  f->f_trace = nullptr;
+  f->f_stackdepth = 0;
+  f->f_trace_lines = 1;
+  f->f_trace_opcodes = 0;
+  f->f_gen = nullptr;
+  f->f_lasti = -1;
+  f->f_lineno = 0;
+  f->f_iblock = 0;
+  f->f_state = FRAME_CREATED;
+  return f;
+}
+
+void Ci_FrameArena_Release(PyThreadState* tstate, PyFrameObject* f) {
+  FrameArena* arena = cachedArena(tstate);
+  if (Py_REFCNT(f) > 1) {
+    // The frame escaped, so it's now an ordinary heap frame.
+    Py_DECREF(f);
+    if (!_PyObject_GC_IS_TRACKED(f)) {
+      _PyObject_GC_TRACK(f);
+    }
+    if (arena != nullptr) {
+      arena->stats.escapes++;
+    }
+    return;
+  }
+
+  // Clearing or decref'ing the frame can cause __del__ methods to get
+  // invoked, which can call back into Python. While we're done with the
+  // Python frame, the C stack of its caller is still in use, so
+  // recursion_depth must be boosted for the duration.
+  ++tstate->recursion_depth;
+  size_t bytes = frameBytes(f);
+  if (!s_enabled || arena == nullptr || f->f_gen != nullptr ||
+      arena->retained_bytes + bytes > kMaxRetainedBytes) {
+    Py_DECREF(f);
+  } else {
+    if (_PyObject_GC_IS_TRACKED(f)) {
+      _PyObject_GC_UNTRACK(f);
+    }
+    clearFrame(f);
+    arena->frames.push_back(f);
+    arena->retained_bytes += bytes;
+    arena->stats.retained++;
+  }
+  --tstate->recursion_depth;
+}
+
+void Ci_FrameArena_Clear() {
+  FrameArena* arena = cachedArena(PyThreadState_GET());
+  if (arena != nullptr) {
+    clearArena(arena);
+  }
+}
+
+void Ci_FrameArena_SetEnabled(int enabled) {
+  s_enabled = enabled;
+}
+
+int Ci_FrameArena_IsEnabled() {
+  return s_enabled;
+}
+
+void Ci_FrameArena_GetStats(Ci_FrameArenaStats* stats) {
+  FrameArena* arena = cachedArena(PyThreadState_GET());
+  *stats = arena != nullptr ? arena->stats : Ci_FrameArenaStats{};
+}
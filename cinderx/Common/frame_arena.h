@@ -0,0 +1,76 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include <Python.h>
+#include "frameobject.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A per-thread arena of frame objects, for the frames whose lifetime CinderX
+ * manages: calls that the interpreter runs inline, frames of JIT-compiled
+ * functions, and frames materialized when JIT-compiled code deopts.
+ *
+ * These frames are released in stack order. A released frame that nothing
+ * else references, because it never escaped through sys._getframe(), a
+ * traceback or a generator, is cleared and kept for the next frame allocated
+ * on the same thread, avoiding the generic frame allocator. Like a frame on
+ * CPython's free list, a retained frame holds no references, including to its
+ * code, builtins and globals. A frame that did escape becomes an ordinary
+ * heap frame, tracked by the GC.
+ *
+ * All functions must be called while holding the GIL.
+ */
+
+/*
+ * Equivalent to _PyFrame_New_NoTrack(tstate, con, locals). Returns a new,
+ * untracked reference, or NULL with an exception set.
+ */
+PyAPI_FUNC(PyFrameObject*) Ci_FrameArena_New(
+    PyThreadState* tstate,
+    PyFrameConstructor* con,
+    PyObject* locals);
+
+/*
+ * Drop the owning reference to a frame that has finished running, retaining
+ * it for reuse if it didn't escape.
+ */
+PyAPI_FUNC(void) Ci_FrameArena_Release(PyThreadState* tstate, PyFrameObject* f);
+
+/*
+ * Release all frames retained by the current thread.
+ */
+PyAPI_FUNC(void) Ci_FrameArena_Clear(void);
+
+/*
+ * Enable or disable retaining frames, for all threads. Frames that are
+ * already retained are kept until they are reused or cleared.
+ */
+PyAPI_FUNC(void) Ci_FrameArena_SetEnabled(int enabled);
+
+PyAPI_FUNC(int) Ci_FrameArena_IsEnabled(void);
+
+typedef struct {
+  /* Frames allocated through the arena. */
+  uint64_t allocs;
+  /* Allocations satisfied by a retained frame. */
+  uint64_t reuses;
+  /* Released frames that were still referenced elsewhere. */
+  uint64_t escapes;
+  /* Frames currently retained. */
+  uint64_t retained;
+} Ci_FrameArenaStats;
+
+/*
+ * Get the statistics of the current thread's arena.
+ */
+PyAPI_FUNC(void) Ci_FrameArena_GetStats(Ci_FrameArenaStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -211,6 +211,32 @@ bool ensureVersionTag(BorrowedRef<PyTypeObject> type) {
   return PyUnstable_Type_AssignVersionTag(type);
 }
 
+bool visitTypeHierarchy(
+    BorrowedRef<PyTypeObject> type,
+    const std::function<bool(BorrowedRef<PyTypeObject>)>& visit) {
+  if (!visit(type)) {
+    return false;
+  }
+  BorrowedRef<> subclasses = type->tp_subclasses;
+  if (subclasses == nullptr) {
+    return true;
+  }
+  Py_ssize_t i = 0;
+  PyObject* ref;
+  while (PyDict_Next(subclasses, &i, nullptr, &ref)) {
+    JIT_DCHECK(PyWeakref_CheckRef(ref), "tp_subclasses should hold weakrefs");
+    BorrowedRef<> subclass = PyWeakref_GET_OBJECT(ref);
+    if (subclass == Py_None) {
+      continue;
+    }
+    if (!visitTypeHierarchy(
+            reinterpret_cast<PyTypeObject*>(subclass.get()), visit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 uint32_t hashBytecode(BorrowedRef<PyCodeObject> code) {
   uint32_t crc = crc32(0, nullptr, 0);
   BorrowedRef<> bc = code->co_code;
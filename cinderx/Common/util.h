@@ -14,6 +14,7 @@
 #include <charconv>
 #include <cstdarg>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -294,6 +295,12 @@ BorrowedRef<> typeLookupSafe(
 // true if successful.
 bool ensureVersionTag(BorrowedRef<PyTypeObject> type);
 
+// Call visit() on type and then, recursively, on each of its live subclasses.
+// Stops and returns false as soon as visit() returns false.
+bool visitTypeHierarchy(
+    BorrowedRef<PyTypeObject> type,
+    const std::function<bool(BorrowedRef<PyTypeObject>)>& visit);
+
 // Return a crc32 checksum of the bytecode for the given code object.
 uint32_t hashBytecode(BorrowedRef<PyCodeObject> code);
 
@@ -34,11 +34,11 @@ static void *opcode_targets[256] = {
     &&TARGET_MATCH_SEQUENCE,
     &&TARGET_MATCH_KEYS,
     &&TARGET_COPY_DICT_WITHOUT_KEYS,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_BINARY_ADD_INT,
+    &&TARGET_BINARY_ADD_FLOAT,
+    &&TARGET_BINARY_ADD_UNICODE,
+    &&TARGET_STORE_SUBSCR_LIST,
+    &&TARGET_STORE_SUBSCR_DICT,
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
@@ -200,10 +200,10 @@ static void *opcode_targets[256] = {
     &&TARGET_LOAD_METHOD_SUPER,
     &&TARGET_LOAD_ATTR_SUPER,
     &&TARGET_TP_ALLOC,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_COMPARE_OP_INT,
+    &&TARGET_FOR_ITER_LIST,
+    &&TARGET_FOR_ITER_RANGE,
+    &&TARGET_UNPACK_SEQUENCE_TUPLE,
     &&TARGET_LOAD_METHOD_UNSHADOWED_METHOD,
     &&TARGET_LOAD_METHOD_TYPE_METHODLIKE,
     &&TARGET_BUILD_CHECKED_LIST_CACHED,
@@ -213,7 +213,7 @@ static void *opcode_targets[256] = {
     &&TARGET_INVOKE_FUNCTION_CACHED,
     &&TARGET_INVOKE_FUNCTION_INDIRECT_CACHED,
     &&TARGET_BUILD_CHECKED_MAP_CACHED,
-    &&_unknown_opcode,
+    &&TARGET_CALL_FUNCTION_PY,
     &&TARGET_PRIMITIVE_STORE_FAST,
     &&TARGET_CAST_CACHED_OPTIONAL,
     &&TARGET_CAST_CACHED,
@@ -7,6 +7,7 @@
 #include "../../Python/ceval.c"
 #endif
 
+#include "cinderx/Common/frame_arena.h"
 #include "cinderx/Jit/pyjit.h"
 #include "cinderx/Shadowcode/shadowcode.h"
 #include "cinderx/StaticPython/checked_dict.h"
@@ -15,6 +16,18 @@
 
 #define PYSHADOW_INIT_THRESHOLD 50
 
+/* Jump to x, counting backward jumps towards on-stack replacement of the
+   running frame by JIT-compiled code. */
+#define JUMPTO_COUNT_BACKEDGE(x) \
+    do { \
+        if (osr_countdown > 0 && (x) < INSTR_OFFSET() && \
+            --osr_countdown == 0) { \
+            JUMPTO(x); \
+            goto on_stack_replace; \
+        } \
+        JUMPTO(x); \
+    } while (0)
+
 PyObject *Ci_GetAIter(PyThreadState *tstate, PyObject *obj) {
     unaryfunc getter = NULL;
     PyObject *iter = NULL;
@@ -250,6 +263,102 @@ invoke_static_function(PyObject *func, PyObject **args, Py_ssize_t nargs, int aw
 }
 
 
+/* Single-digit ints are the common case for counters and indices, and can be
+   operated on without overflow in a C long. */
+static inline int
+Ci_long_is_compact(PyObject *op)
+{
+    Py_ssize_t size = Py_SIZE(op);
+    return -1 <= size && size <= 1;
+}
+
+static inline long
+Ci_long_compact_value(PyObject *op)
+{
+    Py_ssize_t size = Py_SIZE(op);
+    return size == 0 ? 0 : (long)size * (long)((PyLongObject *)op)->ob_digit[0];
+}
+
+static inline int
+Ci_compare_longs(long left, long right, int op)
+{
+    switch (op) {
+        case Py_LT: return left < right;
+        case Py_LE: return left <= right;
+        case Py_EQ: return left == right;
+        case Py_NE: return left != right;
+        case Py_GT: return left > right;
+        case Py_GE: return left >= right;
+    }
+    Py_UNREACHABLE();
+}
+
+/* A frame suspended in the middle of a call whose callee runs in the same
+   Ci_EvalFrame invocation, holding the state of the caller that doesn't live
+   in its frame object. */
+typedef struct Ci_InlinedCall {
+    struct Ci_InlinedCall *prev;
+    PyFrameObject *caller;
+    int stack_depth;
+    Py_ssize_t profiled_instrs;
+    int profiling_candidate;
+    unsigned osr_countdown;
+    /* The callee's shadow frame. */
+    _PyShadowFrame shadow_frame;
+} Ci_InlinedCall;
+
+/* Return whether a call to func can run in the calling Ci_EvalFrame
+   invocation rather than recursing into a new one. That's the case for plain
+   Python functions that are neither JIT-compiled nor Static Python, and that
+   return their result rather than a generator or coroutine. */
+static inline int
+Ci_CanInlineCall(PyThreadState *tstate, PyObject *func, int use_tracing)
+{
+    if (!PyFunction_Check(func) ||
+        ((PyFunctionObject *)func)->vectorcall != _PyFunction_Vectorcall ||
+        use_tracing ||
+        tstate->interp->eval_frame != _PyEval_EvalFrameDefault) {
+        return 0;
+    }
+    int flags = ((PyCodeObject *)PyFunction_GET_CODE(func))->co_flags;
+    return (flags & (CO_GENERATOR | CO_COROUTINE | CO_ASYNC_GENERATOR)) == 0;
+}
+
+/* Create the frame for a call to func that Ci_CanInlineCall() accepted,
+   as _PyFunction_Vectorcall() would. Calls that pass exactly the declared
+   positional arguments to code without cells take their frame from the
+   thread's frame arena. */
+static inline PyFrameObject *
+Ci_MakeInlinedFrame(PyThreadState *tstate, PyObject *func,
+                    PyObject *const *args, Py_ssize_t nargs)
+{
+    PyFrameConstructor *con = PyFunction_AS_FRAME_CONSTRUCTOR(func);
+    PyCodeObject *co = (PyCodeObject *)con->fc_code;
+    PyObject *locals = NULL;
+    if (!(co->co_flags & CO_OPTIMIZED)) {
+        locals = con->fc_globals;
+    }
+    if (nargs != co->co_argcount || co->co_kwonlyargcount != 0 ||
+        (co->co_flags & (CO_VARARGS | CO_VARKEYWORDS)) ||
+        PyTuple_GET_SIZE(co->co_cellvars) != 0) {
+        return Cix_PyEval_MakeFrameVector(
+            tstate, con, locals, args, nargs, NULL);
+    }
+
+    PyFrameObject *f = Ci_FrameArena_New(tstate, con, locals);
+    if (f == NULL) {
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < nargs; i++) {
+        f->f_localsplus[i] = Py_NewRef(args[i]);
+    }
+    PyObject **freevars = f->f_localsplus + co->co_nlocals;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(co->co_freevars); i++) {
+        freevars[i] = Py_NewRef(PyTuple_GET_ITEM(con->fc_closure, i));
+    }
+    return f;
+}
+
 static inline void try_profile_next_instr(PyFrameObject* f,
                                           PyObject** stack_pointer,
                                           const _Py_CODEUNIT* next_instr) {
@@ -279,6 +388,30 @@ static inline void try_profile_next_instr(PyFrameObject* f,
     }
 }
 
+/* Load the locals of Ci_EvalFrame that are derived from the code of frame f,
+   running its shadow code if it has any. */
+#define LOAD_CODE_STATE() \
+    do { \
+        names = co->co_names; \
+        consts = co->co_consts; \
+        fastlocals = f->f_localsplus; \
+        freevars = f->f_localsplus + co->co_nlocals; \
+        /* facebook begin t39538061 */ \
+        shadow.code = co; \
+        shadow.first_instr = &first_instr; \
+        if (co->co_mutable->shadow != NULL && \
+            PyDict_CheckExact(f->f_globals)) { \
+            shadow.shadow = co->co_mutable->shadow; \
+            global_cache = shadow.shadow->globals; \
+            first_instr = &shadow.shadow->code[0]; \
+        } else { \
+            shadow.shadow = NULL; \
+            global_cache = NULL; \
+            first_instr = (_Py_CODEUNIT *)PyBytes_AS_STRING(co->co_code); \
+        } \
+        /* facebook end t39538061 */ \
+    } while (0)
+
 PyObject* _Py_HOT_FUNCTION
 Ci_EvalFrame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 {
@@ -302,12 +435,20 @@ Ci_EvalFrame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
     _Py_atomic_int * const eval_breaker = &tstate->interp->ceval.eval_breaker;
     PyCodeObject *co;
     _PyShadowFrame shadow_frame;
+    _PyShadowFrame *cur_shadow_frame = &shadow_frame;
     Py_ssize_t profiled_instrs = 0;
+    unsigned osr_countdown = 0;
+    /* Callers suspended while their callees run in this invocation, innermost
+       first, and records to reuse for them. */
+    Ci_InlinedCall *inlined_calls = NULL;
+    Ci_InlinedCall *free_inlined_calls = NULL;
+    PyFrameObject *inline_callee = NULL;
 
     const _Py_CODEUNIT *first_instr;
     PyObject *names;
     PyObject *consts;
     _PyShadow_EvalState shadow = {}; /* facebook T39538061 */
+    PyObject ***global_cache = NULL;
 
 #ifdef LLTRACE
     _Py_IDENTIFIER(__ltrace__);
@@ -330,6 +471,9 @@ Ci_EvalFrame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
     trace_info.cframe.previous = prev_cframe;
     tstate->cframe = &trace_info.cframe;
 
+    /* Frames for inlined calls start running here, in place of a new
+       invocation. */
+enter_frame:
     /*
      * When shadow-frame mode is active, `tstate->frame` may have changed
      * between when `f` was allocated and now. Reset `f->f_back` to point to
@@ -347,7 +491,7 @@ Ci_EvalFrame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 
     // Generator shadow frames are managed by the send implementation.
     if (f->f_gen == NULL) {
-        _PyShadowFrame_PushInterp(tstate, &shadow_frame, f);
+        _PyShadowFrame_PushInterp(tstate, cur_shadow_frame, f);
     }
 
     if (trace_info.cframe.use_tracing) {
@@ -407,28 +551,18 @@ Ci_EvalFrame(PyThreadState *tstate, PyFrameObject *f, int throwflag)
       profiling_candidate = _PyJIT_IsProfilingCandidate(co);
     }
 
-    names = co->co_names;
-    consts = co->co_consts;
-    fastlocals = f->f_localsplus;
-    freevars = f->f_localsplus + co->co_nlocals;
+    /* Only fresh calls are candidates for on-stack replacement; frames that
+       are resumed, e.g. after a JIT deopt, keep running here. */
+    if (f->f_lasti == -1 && f->f_gen == NULL) {
+        osr_countdown = _PyJIT_OSRThreshold();
+    }
+
     assert(PyBytes_Check(co->co_code));
     assert(PyBytes_GET_SIZE(co->co_code) <= INT_MAX);
     assert(PyBytes_GET_SIZE(co->co_code) % sizeof(_Py_CODEUNIT) == 0);
     assert(_Py_IS_ALIGNED(PyBytes_AS_STRING(co->co_code), sizeof(_Py_CODEUNIT)));
-
-    /* facebook begin t39538061 */
-    shadow.code = co;
-    shadow.first_instr = &first_instr;
     assert(PyDict_CheckExact(f->f_builtins));
-    PyObject ***global_cache = NULL;
-    if (co->co_mutable->shadow != NULL && PyDict_CheckExact(f->f_globals)) {
-        shadow.shadow = co->co_mutable->shadow;
-        global_cache = shadow.shadow->globals;
-        first_instr = &shadow.shadow->code[0];
-    } else {
-        first_instr = (_Py_CODEUNIT *)PyBytes_AS_STRING(co->co_code);
-    }
-    /* facebook end t39538061 */
+    LOAD_CODE_STATE();
 
     /*
        f->f_lasti refers to the index of the last instruction,
@@ -835,9 +969,13 @@ f->lazy_imports_cache_seq = -1;
         }
 
         case TARGET(BINARY_ADD): {
+            PREDICTED(BINARY_ADD);
             PyObject *right = POP();
             PyObject *left = TOP();
             PyObject *sum;
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeBinaryAdd(&shadow, next_instr, left, right);
+            }
             /* NOTE(vstinner): Please don't try to micro-optimize int+int on
                CPython using bytecode, it is simply worthless.
                See http://bugs.python.org/issue21955 and
@@ -1146,10 +1284,15 @@ f->lazy_imports_cache_seq = -1;
         }
 
         case TARGET(STORE_SUBSCR): {
+            PREDICTED(STORE_SUBSCR);
             PyObject *sub = TOP();
             PyObject *container = SECOND();
             PyObject *v = THIRD();
             int err;
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeStoreSubscr(
+                    &shadow, next_instr, container, sub);
+            }
             STACK_SHRINK(3);
             /* container[sub] = v */
             err = PyObject_SetItem(container, sub, v);
@@ -1511,6 +1654,10 @@ f->lazy_imports_cache_seq = -1;
         case TARGET(UNPACK_SEQUENCE): {
             PREDICTED(UNPACK_SEQUENCE);
             PyObject *seq = POP(), *item, **items;
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeUnpackSequence(
+                    &shadow, next_instr, seq, oparg);
+            }
             if (PyTuple_CheckExact(seq) &&
                 PyTuple_GET_SIZE(seq) == oparg) {
                 items = ((PyTupleObject *)seq)->ob_item;
@@ -2114,9 +2261,14 @@ f->lazy_imports_cache_seq = -1;
         }
 
         case TARGET(COMPARE_OP): {
+            PREDICTED(COMPARE_OP);
             assert(oparg <= Py_GE);
             PyObject *right = POP();
             PyObject *left = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeCompareOp(
+                    &shadow, next_instr, left, right, oparg);
+            }
             PyObject *res = PyObject_RichCompare(left, right, oparg);
             SET_TOP(res);
             Py_DECREF(left);
@@ -2302,7 +2454,7 @@ f->lazy_imports_cache_seq = -1;
             }
             if (Py_IsFalse(cond)) {
                 Py_DECREF(cond);
-                JUMPTO(oparg);
+                JUMPTO_COUNT_BACKEDGE(oparg);
                 CHECK_EVAL_BREAKER();
                 DISPATCH();
             }
@@ -2311,7 +2463,7 @@ f->lazy_imports_cache_seq = -1;
             if (err > 0)
                 ;
             else if (err == 0) {
-                JUMPTO(oparg);
+                JUMPTO_COUNT_BACKEDGE(oparg);
                 CHECK_EVAL_BREAKER();
             }
             else
@@ -2329,14 +2481,14 @@ f->lazy_imports_cache_seq = -1;
             }
             if (Py_IsTrue(cond)) {
                 Py_DECREF(cond);
-                JUMPTO(oparg);
+                JUMPTO_COUNT_BACKEDGE(oparg);
                 CHECK_EVAL_BREAKER();
                 DISPATCH();
             }
             err = PyObject_IsTrue(cond);
             Py_DECREF(cond);
             if (err > 0) {
-                JUMPTO(oparg);
+                JUMPTO_COUNT_BACKEDGE(oparg);
                 CHECK_EVAL_BREAKER();
             }
             else if (err == 0)
@@ -2397,7 +2549,7 @@ f->lazy_imports_cache_seq = -1;
 
         case TARGET(JUMP_ABSOLUTE): {
             PREDICTED(JUMP_ABSOLUTE);
-            JUMPTO(oparg);
+            JUMPTO_COUNT_BACKEDGE(oparg);
             CHECK_EVAL_BREAKER();
             DISPATCH();
         }
@@ -2550,6 +2702,9 @@ f->lazy_imports_cache_seq = -1;
             PREDICTED(FOR_ITER);
             /* before: [iter]; after: [iter, iter()] *or* [] */
             PyObject *iter = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeForIter(&shadow, next_instr, iter, oparg);
+            }
             PyObject *next = (*Py_TYPE(iter)->tp_iternext)(iter);
             if (next != NULL) {
                 PUSH(next);
@@ -2719,6 +2874,26 @@ f->lazy_imports_cache_seq = -1;
             int awaited = IS_AWAITED();
 
             meth = PEEK(oparg + 2);
+            if (!awaited) {
+                /* The callable and its arguments, including self for a
+                   method call. */
+                PyObject **pfunc = meth == NULL
+                    ? stack_pointer - oparg - 1
+                    : stack_pointer - oparg - 2;
+                if (Ci_CanInlineCall(
+                        tstate, *pfunc, trace_info.cframe.use_tracing)) {
+                    inline_callee = Ci_MakeInlinedFrame(
+                        tstate, *pfunc, pfunc + 1, stack_pointer - pfunc - 1);
+                    while (stack_pointer > pfunc) {
+                        PyObject *w = POP();
+                        Py_DECREF(w);
+                    }
+                    if (meth == NULL) {
+                        (void)POP(); /* POP the NULL. */
+                    }
+                    goto inline_call;
+                }
+            }
             if (meth == NULL) {
                 /* `meth` is NULL when LOAD_METHOD thinks that it's not
                    a method call.
@@ -2781,8 +2956,24 @@ f->lazy_imports_cache_seq = -1;
         case TARGET(CALL_FUNCTION): {
             PREDICTED(CALL_FUNCTION);
             PyObject **sp, *res;
+            if (shadow.shadow != NULL) {
+                _PyShadow_SpecializeCallFunction(
+                    &shadow, next_instr, stack_pointer[-oparg - 1], oparg);
+            }
             sp = stack_pointer;
             int awaited = IS_AWAITED();
+            PyObject **pfunc = stack_pointer - oparg - 1;
+            if (!awaited &&
+                Ci_CanInlineCall(
+                    tstate, *pfunc, trace_info.cframe.use_tracing)) {
+                inline_callee =
+                    Ci_MakeInlinedFrame(tstate, *pfunc, pfunc + 1, oparg);
+                while (stack_pointer > pfunc) {
+                    PyObject *w = POP();
+                    Py_DECREF(w);
+                }
+                goto inline_call;
+            }
             res = call_function(tstate,
                                 &trace_info,
                                 &sp,
@@ -3435,6 +3626,256 @@ f->lazy_imports_cache_seq = -1;
             DISPATCH();
         }
 
+        case TARGET(BINARY_ADD_INT): {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            if (!PyLong_CheckExact(left) || !PyLong_CheckExact(right)) {
+                _PyShadow_Unquicken(&shadow, next_instr, BINARY_ADD, 0);
+                goto PREDICT_ID(BINARY_ADD);
+            }
+            PyObject *sum;
+            if (Ci_long_is_compact(left) && Ci_long_is_compact(right)) {
+                sum = PyLong_FromLong(
+                    Ci_long_compact_value(left) + Ci_long_compact_value(right));
+            } else {
+                sum = PyNumber_Add(left, right);
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(sum);
+            if (sum == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        case TARGET(BINARY_ADD_FLOAT): {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            if (!PyFloat_CheckExact(left) || !PyFloat_CheckExact(right)) {
+                _PyShadow_Unquicken(&shadow, next_instr, BINARY_ADD, 0);
+                goto PREDICT_ID(BINARY_ADD);
+            }
+            PyObject *sum = PyFloat_FromDouble(
+                PyFloat_AS_DOUBLE(left) + PyFloat_AS_DOUBLE(right));
+            STACK_SHRINK(1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(sum);
+            if (sum == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        case TARGET(BINARY_ADD_UNICODE): {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            if (!PyUnicode_CheckExact(left) || !PyUnicode_CheckExact(right)) {
+                _PyShadow_Unquicken(&shadow, next_instr, BINARY_ADD, 0);
+                goto PREDICT_ID(BINARY_ADD);
+            }
+            STACK_SHRINK(1);
+            /* unicode_concatenate consumes the reference to left */
+            PyObject *sum =
+                unicode_concatenate(tstate, left, right, f, next_instr);
+            Py_DECREF(right);
+            SET_TOP(sum);
+            if (sum == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        case TARGET(COMPARE_OP_INT): {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            if (!PyLong_CheckExact(left) || !PyLong_CheckExact(right)) {
+                _PyShadow_Unquicken(&shadow, next_instr, COMPARE_OP, oparg);
+                goto PREDICT_ID(COMPARE_OP);
+            }
+            PyObject *res;
+            if (Ci_long_is_compact(left) && Ci_long_is_compact(right)) {
+                res = Ci_compare_longs(Ci_long_compact_value(left),
+                                       Ci_long_compact_value(right),
+                                       oparg)
+                          ? Py_True
+                          : Py_False;
+                Py_INCREF(res);
+            } else {
+                res = PyObject_RichCompare(left, right, oparg);
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
+
+        case TARGET(FOR_ITER_LIST): {
+            PyObject *iter = TOP();
+            if (!Py_IS_TYPE(iter, &PyListIter_Type)) {
+                _PyShadow_Unquicken(&shadow, next_instr, FOR_ITER, oparg);
+                goto PREDICT_ID(FOR_ITER);
+            }
+            PyObject *next = PyListIter_Type.tp_iternext(iter);
+            if (next != NULL) {
+                PUSH(next);
+                PREDICT(STORE_FAST);
+                PREDICT(UNPACK_SEQUENCE);
+                DISPATCH();
+            }
+            /* List iterators don't raise StopIteration when exhausted. */
+            assert(!_PyErr_Occurred(tstate));
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            DISPATCH();
+        }
+
+        case TARGET(FOR_ITER_RANGE): {
+            PyObject *iter = TOP();
+            if (!Py_IS_TYPE(iter, &PyRangeIter_Type)) {
+                _PyShadow_Unquicken(&shadow, next_instr, FOR_ITER, oparg);
+                goto PREDICT_ID(FOR_ITER);
+            }
+            PyObject *next = PyRangeIter_Type.tp_iternext(iter);
+            if (next != NULL) {
+                PUSH(next);
+                PREDICT(STORE_FAST);
+                PREDICT(UNPACK_SEQUENCE);
+                DISPATCH();
+            }
+            /* Range iterators only fail when allocating the next value, and
+               don't raise StopIteration when exhausted. */
+            if (_PyErr_Occurred(tstate)) {
+                goto error;
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            DISPATCH();
+        }
+
+        case TARGET(STORE_SUBSCR_LIST): {
+            PyObject *sub = TOP();
+            PyObject *container = SECOND();
+            PyObject *v = THIRD();
+            if (!PyList_CheckExact(container) || !PyLong_CheckExact(sub)) {
+                _PyShadow_Unquicken(&shadow, next_instr, STORE_SUBSCR, 0);
+                goto PREDICT_ID(STORE_SUBSCR);
+            }
+            STACK_SHRINK(3);
+            Py_ssize_t i = PyNumber_AsSsize_t(sub, PyExc_IndexError);
+            Py_DECREF(sub);
+            if (i == -1 && _PyErr_Occurred(tstate)) {
+                Py_DECREF(container);
+                Py_DECREF(v);
+                goto error;
+            }
+            if (i < 0) {
+                i += PyList_GET_SIZE(container);
+            }
+            if (i < 0 || i >= PyList_GET_SIZE(container)) {
+                _PyErr_SetString(tstate, PyExc_IndexError,
+                                 "list assignment index out of range");
+                Py_DECREF(container);
+                Py_DECREF(v);
+                goto error;
+            }
+            PyObject *old = PyList_GET_ITEM(container, i);
+            /* Steals the reference to v */
+            PyList_SET_ITEM(container, i, v);
+            Py_DECREF(old);
+            Py_DECREF(container);
+            DISPATCH();
+        }
+
+        case TARGET(STORE_SUBSCR_DICT): {
+            PyObject *sub = TOP();
+            PyObject *container = SECOND();
+            PyObject *v = THIRD();
+            if (!PyDict_CheckExact(container)) {
+                _PyShadow_Unquicken(&shadow, next_instr, STORE_SUBSCR, 0);
+                goto PREDICT_ID(STORE_SUBSCR);
+            }
+            STACK_SHRINK(3);
+            int err = PyDict_SetItem(container, sub, v);
+            Py_DECREF(v);
+            Py_DECREF(container);
+            Py_DECREF(sub);
+            if (err != 0)
+                goto error;
+            DISPATCH();
+        }
+
+        case TARGET(UNPACK_SEQUENCE_TUPLE): {
+            PyObject *seq = TOP();
+            if (!PyTuple_CheckExact(seq) || PyTuple_GET_SIZE(seq) != oparg) {
+                _PyShadow_Unquicken(
+                    &shadow, next_instr, UNPACK_SEQUENCE, oparg);
+                goto PREDICT_ID(UNPACK_SEQUENCE);
+            }
+            STACK_SHRINK(1);
+            PyObject **items = ((PyTupleObject *)seq)->ob_item;
+            while (oparg--) {
+                PyObject *item = items[oparg];
+                Py_INCREF(item);
+                PUSH(item);
+            }
+            Py_DECREF(seq);
+            DISPATCH();
+        }
+
+        case TARGET(CALL_FUNCTION_PY): {
+            PyObject **pfunc = stack_pointer - oparg - 1;
+            PyObject *func = *pfunc;
+            if (!PyFunction_Check(func)) {
+                _PyShadow_Unquicken(
+                    &shadow, next_instr, CALL_FUNCTION, oparg);
+                goto PREDICT_ID(CALL_FUNCTION);
+            }
+            if (trace_info.cframe.use_tracing) {
+                goto PREDICT_ID(CALL_FUNCTION);
+            }
+            int awaited = IS_AWAITED();
+            if (!awaited && Ci_CanInlineCall(tstate, func, 0)) {
+                inline_callee =
+                    Ci_MakeInlinedFrame(tstate, func, pfunc + 1, oparg);
+                while (stack_pointer > pfunc) {
+                    PyObject *w = POP();
+                    Py_DECREF(w);
+                }
+                goto inline_call;
+            }
+            /* Python functions don't need the C-call tracing done by
+               call_function(), so their vectorcall entry can be called
+               directly. */
+            PyObject *res = ((PyFunctionObject *)func)->vectorcall(
+                func,
+                pfunc + 1,
+                oparg | PY_VECTORCALL_ARGUMENTS_OFFSET |
+                    (awaited ? Ci_Py_AWAITED_CALL_MARKER : 0),
+                NULL);
+            while (stack_pointer > pfunc) {
+                PyObject *w = POP();
+                Py_DECREF(w);
+            }
+            if (res == NULL) {
+                PUSH(NULL);
+                goto error;
+            }
+            if (awaited && Ci_PyWaitHandle_CheckExact(res)) {
+                DISPATCH_EAGER_CORO_RESULT(res, PUSH);
+            }
+            assert(!Ci_PyWaitHandle_CheckExact(res));
+            PUSH(res);
+            CHECK_EVAL_BREAKER();
+            DISPATCH();
+        }
+
         case TARGET(BINARY_SUBSCR_TUPLE_CONST_INT): {
             PyObject *container = TOP();
             PyObject *res;
@@ -4360,6 +4801,14 @@ f->lazy_imports_cache_seq = -1;
                     Py_DECREF(idx);
                     goto error;
                 }
+            } else if (oparg == SEQ_CHECKED_LIST_INT64 ||
+                       oparg == SEQ_CHECKED_LIST_DOUBLE) {
+                item = Ci_CheckedPrimitiveList_GetItem(sequence, val);
+                Py_DECREF(sequence);
+                if (item == NULL) {
+                    Py_DECREF(idx);
+                    goto error;
+                }
             } else if (oparg == SEQ_ARRAY_INT64) {
                 item = _Ci_StaticArray_Get(sequence, val);
                 Py_DECREF(sequence);
@@ -4426,6 +4875,14 @@ f->lazy_imports_cache_seq = -1;
                         goto error;
                     }
                 }
+            } else if (oparg == SEQ_CHECKED_LIST_INT64 ||
+                       oparg == SEQ_CHECKED_LIST_DOUBLE) {
+                err = Ci_CheckedPrimitiveList_SetItem(sequence, idx, v);
+                Py_DECREF(v);
+                Py_DECREF(sequence);
+                if (err != 0) {
+                    goto error;
+                }
             } else if (oparg == SEQ_ARRAY_INT64) {
                 err = _Ci_StaticArray_Set(sequence, idx, v);
 
@@ -4870,6 +5327,118 @@ f->lazy_imports_cache_seq = -1;
            or goto error. */
         Py_UNREACHABLE();
 
+on_stack_replace:
+        /* A loop has run long enough that the rest of this call should run in
+           JIT-compiled code. next_instr is the loop header. */
+        {
+            vectorcallfunc osr_entry = NULL;
+            if (f->f_iblock == 0 && !trace_info.cframe.use_tracing &&
+                !tstate->profile_interp) {
+                osr_entry = _PyJIT_GetOSREntry(
+                    f, INSTR_OFFSET(), (int)STACK_LEVEL());
+            }
+            if (osr_entry == NULL) {
+                DISPATCH();
+            }
+
+            /* The JIT links its own frame in place of this one and borrows
+               the locals and value stack, which are contiguous since OSR is
+               never used for code with cells or free variables. */
+            assert(f->f_valuestack == fastlocals + co->co_nlocals);
+            tstate->frame = f->f_back;
+            _PyShadowFrame_Pop(tstate, cur_shadow_frame);
+            retval = osr_entry(
+                NULL, fastlocals, co->co_nlocals + STACK_LEVEL(), NULL);
+            _PyShadowFrame_PushInterp(tstate, cur_shadow_frame, f);
+            tstate->frame = f;
+
+            while (!EMPTY()) {
+                PyObject *o = POP();
+                Py_XDECREF(o);
+            }
+            f->f_stackdepth = 0;
+            /* Any traceback entry was added for the JIT's frame. */
+            f->f_state = retval != NULL ? FRAME_RETURNED : FRAME_RAISED;
+            goto exiting;
+        }
+
+inline_call:
+        /* Run inline_callee in this invocation, suspending the current frame
+           until it returns. The call and its arguments have been popped, and
+           inline_callee is NULL if creating its frame failed. */
+        {
+            if (inline_callee == NULL) {
+                PUSH(NULL);
+                goto error;
+            }
+            if (_Py_EnterRecursiveCall(tstate, "")) {
+                Ci_FrameArena_Release(tstate, inline_callee);
+                PUSH(NULL);
+                goto error;
+            }
+            Ci_InlinedCall *call = free_inlined_calls;
+            if (call != NULL) {
+                free_inlined_calls = call->prev;
+            }
+            else {
+                call = PyMem_Malloc(sizeof(Ci_InlinedCall));
+                if (call == NULL) {
+                    _Py_LeaveRecursiveCall(tstate);
+                    Ci_FrameArena_Release(tstate, inline_callee);
+                    PyErr_NoMemory();
+                    PUSH(NULL);
+                    goto error;
+                }
+            }
+            call->prev = inlined_calls;
+            call->caller = f;
+            call->stack_depth = (int)STACK_LEVEL();
+            call->profiled_instrs = profiled_instrs;
+            call->profiling_candidate = profiling_candidate;
+            call->osr_countdown = osr_countdown;
+            inlined_calls = call;
+
+            f = inline_callee;
+            cur_shadow_frame = &call->shadow_frame;
+            profiled_instrs = 0;
+            osr_countdown = 0;
+            throwflag = 0;
+            goto enter_frame;
+        }
+
+return_to_caller:
+        /* The frame of an inlined call has finished, with its result (or NULL
+           if it raised) in retval. Resume its caller. */
+        {
+            Ci_InlinedCall *call = inlined_calls;
+            PyFrameObject *callee = f;
+            inlined_calls = call->prev;
+            f = call->caller;
+            profiled_instrs = call->profiled_instrs;
+            profiling_candidate = call->profiling_candidate;
+            osr_countdown = call->osr_countdown;
+            cur_shadow_frame = inlined_calls != NULL
+                ? &inlined_calls->shadow_frame
+                : &shadow_frame;
+            call->prev = free_inlined_calls;
+            free_inlined_calls = call;
+            Ci_FrameArena_Release(tstate, callee);
+
+            co = f->f_code;
+            LOAD_CODE_STATE();
+            next_instr = first_instr + f->f_lasti + 1;
+            stack_pointer = f->f_valuestack + call->stack_depth;
+            PyObject *res = retval;
+            retval = NULL;
+            if (res == NULL) {
+                PUSH(NULL);
+                goto error;
+            }
+            PUSH(res);
+            CHECK_EVAL_BREAKER();
+            DISPATCH();
+        }
+
 error:
         /* Double-check exception status. */
 #ifdef NDEBUG
@@ -4978,16 +5547,12 @@ f->lazy_imports_cache_seq = -1;
 
     /* pop frame */
 exit_eval_frame:
-    /* Restore previous cframe */
-    tstate->cframe = trace_info.cframe.previous;
-    tstate->cframe->use_tracing = trace_info.cframe.use_tracing;
-
     if (profiled_instrs != 0) {
         _PyJIT_CountProfiledInstrs(f->f_code, profiled_instrs);
     }
 
     if (f->f_gen == NULL) {
-        _PyShadowFrame_Pop(tstate, &shadow_frame);
+        _PyShadowFrame_Pop(tstate, cur_shadow_frame);
     }
 
     if (PyDTrace_FUNCTION_RETURN_ENABLED())
@@ -4996,6 +5561,19 @@ f->lazy_imports_cache_seq = -1;
     tstate->frame = f->f_back;
     co->co_mutable->curcalls--;
 
+    if (inlined_calls != NULL) {
+        goto return_to_caller;
+    }
+    while (free_inlined_calls != NULL) {
+        Ci_InlinedCall *call = free_inlined_calls;
+        free_inlined_calls = call->prev;
+        PyMem_Free(call);
+    }
+
+    /* Restore previous cframe */
+    tstate->cframe = trace_info.cframe.previous;
+    tstate->cframe->use_tracing = trace_info.cframe.use_tracing;
+
     return _Py_CheckFunctionResult(tstate, NULL, retval, __func__);
 }
 
@@ -5193,21 +5771,7 @@ _CiStaticEval_Vector(PyThreadState *tstate, PyFrameConstructor *con,
         return make_coro(con, f);
     }
     PyObject *retval = _PyEval_EvalFrame(tstate, f, 0);
-
-    /* decref'ing the frame can cause __del__ methods to get invoked,
-       which can call back into Python.  While we're done with the
-       current Python frame (f), the associated C stack is still in use,
-       so recursion_depth must be boosted for the duration.
-    */
-    if (Py_REFCNT(f) > 1) {
-        Py_DECREF(f);
-        _PyObject_GC_TRACK(f);
-    }
-    else {
-        ++tstate->recursion_depth;
-        Py_DECREF(f);
-        --tstate->recursion_depth;
-    }
+    Ci_FrameArena_Release(tstate, f);
     return retval;
 }
 
@@ -5315,6 +5879,19 @@ PyEntry_AutoJIT(PyFunctionObject *func,
       }
     }
 
+    if (_PyJIT_IsAutoJITAsync()) {
+      // Keep interpreting the function until the background compile thread
+      // installs its compiled entry point.
+      if (_PyJIT_ScheduleCompile(func) == PYJIT_RESULT_PYTHON_EXCEPTION) {
+        return NULL;
+      }
+      if (!_PyJIT_IsCompiled(func)) {
+        func->vectorcall = (vectorcallfunc)PyEntry_LazyInit;
+        PyEntry_initnow(func);
+      }
+      return func->vectorcall((PyObject *)func, stack, nargsf, kwnames);
+    }
+
     _PyJIT_Result result = _PyJIT_CompileFunction(func);
     if (result == PYJIT_RESULT_PYTHON_EXCEPTION) {
         return NULL;
@@ -36,6 +36,11 @@ extern "C" {
   X(MATCH_SEQUENCE,                   32) \
   X(MATCH_KEYS,                       33) \
   X(COPY_DICT_WITHOUT_KEYS,           34) \
+  X(BINARY_ADD_INT,                   35) \
+  X(BINARY_ADD_FLOAT,                 36) \
+  X(BINARY_ADD_UNICODE,               37) \
+  X(STORE_SUBSCR_LIST,                38) \
+  X(STORE_SUBSCR_DICT,                39) \
   X(WITH_EXCEPT_START,                49) \
   X(GET_AITER,                        50) \
   X(GET_ANEXT,                        51) \
@@ -170,6 +175,10 @@ extern "C" {
   X(LOAD_METHOD_SUPER,               198) \
   X(LOAD_ATTR_SUPER,                 199) \
   X(TP_ALLOC,                        200) \
+  X(COMPARE_OP_INT,                  201) \
+  X(FOR_ITER_LIST,                   202) \
+  X(FOR_ITER_RANGE,                  203) \
+  X(UNPACK_SEQUENCE_TUPLE,           204) \
   X(LOAD_METHOD_UNSHADOWED_METHOD,   205) \
   X(LOAD_METHOD_TYPE_METHODLIKE,     206) \
   X(BUILD_CHECKED_LIST_CACHED,       207) \
@@ -179,6 +188,7 @@ extern "C" {
   X(INVOKE_FUNCTION_CACHED,          211) \
   X(INVOKE_FUNCTION_INDIRECT_CACHED, 212) \
   X(BUILD_CHECKED_MAP_CACHED,        213) \
+  X(CALL_FUNCTION_PY,                214) \
   X(PRIMITIVE_STORE_FAST,            215) \
   X(CAST_CACHED_OPTIONAL,            216) \
   X(CAST_CACHED,                     217) \
@@ -229,7 +239,7 @@ static uint32_t _PyOpcode_RelativeJump[8] = {
     67125248U,
     67141632U,
     0U,
-    0U,
+    3072U,
     0U,
 };
 static uint32_t _PyOpcode_Jump[8] = {
@@ -239,7 +249,7 @@ static uint32_t _PyOpcode_Jump[8] = {
     101695488U,
     67141632U,
     50429952U,
-    0U,
+    3072U,
     0U,
 };
 #endif /* OPCODE_TABLES */
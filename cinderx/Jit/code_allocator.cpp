@@ -85,9 +85,12 @@ asmjit::Error CodeAllocatorCinder::addCode(
   ASMJIT_PROPAGATE(code->resolveUnresolvedLinks());
 
   size_t max_code_size = code->codeSize();
+  auto [base, block_size] = takeFreeBlock(max_code_size);
+  bool from_free_list = base != nullptr;
   size_t alloc_size = ((max_code_size / kAllocSize) + 1) * kAllocSize;
-  if (current_alloc_free_ < max_code_size) {
-    lost_bytes_ += current_alloc_free_;
+  if (!from_free_list && current_alloc_free_ < max_code_size) {
+    // Keep the tail of the old chunk around for smaller code.
+    addFreeBlock(current_alloc_, current_alloc_free_);
 
     uint8_t* res = allocPages(alloc_size);
     if (!setHugePages(res, alloc_size)) {
@@ -99,8 +102,11 @@ asmjit::Error CodeAllocatorCinder::addCode(
     allocations_.emplace_back(res);
     current_alloc_free_ = alloc_size;
   }
+  if (!from_free_list) {
+    base = current_alloc_;
+  }
 
-  ASMJIT_PROPAGATE(code->relocateToBase(uintptr_t(current_alloc_)));
+  ASMJIT_PROPAGATE(code->relocateToBase(uintptr_t(base)));
 
   size_t actual_code_size = code->codeSize();
   JIT_CHECK(actual_code_size <= max_code_size, "Code grew during relocation");
@@ -112,25 +118,77 @@ asmjit::Error CodeAllocatorCinder::addCode(
 
     JIT_CHECK(
         offset + buffer_size <= actual_code_size, "Inconsistent code size");
-    std::memcpy(current_alloc_ + offset, section->data(), buffer_size);
+    std::memcpy(base + offset, section->data(), buffer_size);
 
     if (virtual_size > buffer_size) {
       JIT_CHECK(
           offset + virtual_size <= actual_code_size, "Inconsistent code size");
-      std::memset(
-          current_alloc_ + offset + buffer_size, 0, virtual_size - buffer_size);
+      std::memset(base + offset + buffer_size, 0, virtual_size - buffer_size);
     }
   }
 
-  *dst = current_alloc_;
+  *dst = base;
 
-  current_alloc_ += actual_code_size;
-  current_alloc_free_ -= actual_code_size;
+  if (from_free_list) {
+    addFreeBlock(base + actual_code_size, block_size - actual_code_size);
+    reused_bytes_ += actual_code_size;
+  } else {
+    current_alloc_ += actual_code_size;
+    current_alloc_free_ -= actual_code_size;
+  }
   used_bytes_ += actual_code_size;
 
   return asmjit::kErrorOk;
 }
 
+void CodeAllocatorCinder::releaseCode(void* code, size_t size) noexcept {
+  ThreadedCompileSerialize guard;
+  JIT_DCHECK(size <= used_bytes_, "Releasing more code than was allocated");
+  used_bytes_ -= size;
+  freed_bytes_ += size;
+  addFreeBlock(static_cast<uint8_t*>(code), size);
+}
+
+size_t CodeAllocatorCinder::sizeClass(size_t size) {
+  size_t cls = 0;
+  while (cls + 1 < kNumSizeClasses && (kMinFreeBlock << (cls + 1)) <= size) {
+    cls++;
+  }
+  return cls;
+}
+
+void CodeAllocatorCinder::addFreeBlock(uint8_t* start, size_t size) {
+  if (size < kMinFreeBlock) {
+    lost_bytes_ += size;
+    return;
+  }
+  free_lists_[sizeClass(size)].emplace_back(start, size);
+  free_list_bytes_ += size;
+}
+
+std::pair<uint8_t*, size_t> CodeAllocatorCinder::takeFreeBlock(
+    size_t min_size) {
+  if (free_list_bytes_ < min_size) {
+    return {nullptr, 0};
+  }
+  // Blocks in the smallest candidate class may still be too small, but any
+  // block in a larger class will do.
+  for (size_t cls = sizeClass(min_size); cls < kNumSizeClasses; cls++) {
+    auto& blocks = free_lists_[cls];
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+      if (it->second < min_size) {
+        continue;
+      }
+      std::pair<uint8_t*, size_t> block = *it;
+      *it = blocks.back();
+      blocks.pop_back();
+      free_list_bytes_ -= block.second;
+      return block;
+    }
+  }
+  return {nullptr, 0};
+}
+
 MultipleSectionCodeAllocator::~MultipleSectionCodeAllocator() {
   if (code_alloc_ == nullptr) {
     return;
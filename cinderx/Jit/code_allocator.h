@@ -8,6 +8,7 @@
 
 #include "cinderx/ThirdParty/asmjit/src/asmjit/asmjit.h"
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -50,6 +51,13 @@ class CodeAllocator {
     return runtime_->add(dst, code);
   }
 
+  // Release code previously returned by addCode(). size is the code size of
+  // the CodeHolder that was added. The caller must guarantee that nothing can
+  // still execute the code.
+  virtual void releaseCode(void* code, size_t /* size */) noexcept {
+    runtime_->release(code);
+  }
+
  protected:
   std::unique_ptr<asmjit::JitRuntime> runtime_{
       std::make_unique<asmjit::JitRuntime>()};
@@ -65,6 +73,8 @@ class CodeAllocatorCinder : public CodeAllocator {
 
   asmjit::Error addCode(void** dst, asmjit::CodeHolder* code) noexcept override;
 
+  void releaseCode(void* code, size_t size) noexcept override;
+
   size_t usedBytes() const {
     return used_bytes_;
   }
@@ -81,23 +91,61 @@ class CodeAllocatorCinder : public CodeAllocator {
     return huge_allocs_;
   }
 
+  size_t freedBytes() const {
+    return freed_bytes_;
+  }
+
+  size_t reusedBytes() const {
+    return reused_bytes_;
+  }
+
+  size_t freeListBytes() const {
+    return free_list_bytes_;
+  }
+
  private:
+  // Released code is kept on segregated free lists. Size class i holds blocks
+  // of [kMinFreeBlock << i, kMinFreeBlock << (i + 1)) bytes, except for the
+  // last class which also holds everything larger. Adjacent free blocks are
+  // not coalesced.
+  static constexpr size_t kMinFreeBlock = 64;
+  static constexpr size_t kNumSizeClasses = 16;
+
+  static size_t sizeClass(size_t size);
+
+  // Add a block of released or leftover memory to the free lists.
+  void addFreeBlock(uint8_t* start, size_t size);
+
+  // Remove and return the first free block of at least min_size bytes, or
+  // {nullptr, 0} if there isn't one.
+  std::pair<uint8_t*, size_t> takeFreeBlock(size_t min_size);
+
   // List of chunks allocated for use in deallocation
   std::vector<void*> allocations_;
 
+  std::array<std::vector<std::pair<uint8_t*, size_t>>, kNumSizeClasses>
+      free_lists_;
+
   // Pointer to next free address in the current chunk
   uint8_t* current_alloc_{nullptr};
   // Free space in the current chunk
   size_t current_alloc_free_{0};
 
   size_t used_bytes_{0};
-  // Number of bytes in total lost when allocations didn't fit neatly into
-  // the bytes remaining in a chunk so a new one was allocated.
+  // Number of bytes in total lost to pieces of chunks too small to put on a
+  // free list, e.g. when an allocation didn't fit neatly into the bytes
+  // remaining in a chunk so a new one was allocated.
   size_t lost_bytes_{0};
   // Number of chunks allocated (= to number of huge pages used)
   size_t huge_allocs_{0};
   // Number of chunks allocated which did not use huge pages.
   size_t fragmented_allocs_{0};
+  // Total bytes passed to releaseCode().
+  size_t freed_bytes_{0};
+  // Total bytes of new code placed in previously released memory.
+  size_t reused_bytes_{0};
+  // Bytes currently sitting on the free lists.
+  size_t free_list_bytes_{0};
 };
 
 class MultipleSectionCodeAllocator : public CodeAllocator {
@@ -106,6 +154,10 @@ class MultipleSectionCodeAllocator : public CodeAllocator {
 
   asmjit::Error addCode(void** dst, asmjit::CodeHolder* code) noexcept override;
 
+  // Code is split across the hot and cold slabs, which are only ever bump
+  // allocated, so released code is not reused.
+  void releaseCode(void* /* code */, size_t /* size */) noexcept override {}
+
  private:
   void createSlabs() noexcept;
 
@@ -0,0 +1,105 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Jit/code_layout.h"
+
+#include "cinderx/Common/log.h"
+
+#include "cinderx/Jit/containers.h"
+#include "cinderx/Jit/runtime.h"
+
+#include <algorithm>
+
+namespace jit {
+
+std::vector<CodeLayoutEntry> planCodeLayout(
+    std::vector<BorrowedRef<>>& units,
+    const std::function<hir::Preloader*(BorrowedRef<>)>& get_preloader) {
+  UnorderedMap<PyCodeObject*, int64_t> profiled_hits;
+  for (const auto& [code, profile] : Runtime::get()->profileRuntime()) {
+    profiled_hits.emplace(code.get(), profile.total_hits);
+  }
+
+  UnorderedMap<PyObject*, size_t> unit_index;
+  for (size_t i = 0; i < units.size(); i++) {
+    unit_index.emplace(units[i], i);
+  }
+
+  std::vector<int64_t> hotness(units.size());
+  std::vector<std::vector<size_t>> callees(units.size());
+  for (size_t i = 0; i < units.size(); i++) {
+    hir::Preloader* preloader = get_preloader(units[i]);
+    JIT_CHECK(preloader != nullptr, "Unit without a preloader");
+    BorrowedRef<PyCodeObject> code = preloader->code();
+    auto hits = profiled_hits.find(code);
+    if (hits != profiled_hits.end()) {
+      hotness[i] = hits->second;
+    } else if (code->co_mutable != nullptr) {
+      hotness[i] = code->co_mutable->ncalls;
+    }
+    for (const auto& [idx, name] : preloader->globalNames()) {
+      BorrowedRef<> obj = preloader->global(idx);
+      auto callee = obj == nullptr ? unit_index.end() : unit_index.find(obj);
+      if (callee != unit_index.end() && callee->second != i) {
+        callees[i].emplace_back(callee->second);
+      }
+    }
+  }
+
+  auto hotter = [&](size_t a, size_t b) {
+    return hotness[a] != hotness[b] ? hotness[a] > hotness[b] : a < b;
+  };
+  std::vector<size_t> roots;
+  for (size_t i = 0; i < units.size(); i++) {
+    if (hotness[i] > 0) {
+      roots.emplace_back(i);
+    }
+    std::sort(callees[i].begin(), callees[i].end(), hotter);
+  }
+  std::sort(roots.begin(), roots.end(), hotter);
+
+  constexpr size_t kNoCaller = static_cast<size_t>(-1);
+  std::vector<bool> placed(units.size());
+  std::vector<std::pair<size_t, size_t>> order;
+  std::vector<std::pair<size_t, size_t>> stack;
+  for (size_t root : roots) {
+    stack.emplace_back(root, kNoCaller);
+    while (!stack.empty()) {
+      auto [unit, caller] = stack.back();
+      stack.pop_back();
+      if (placed[unit]) {
+        continue;
+      }
+      placed[unit] = true;
+      order.emplace_back(unit, caller);
+      // Push in reverse so the hottest callee is placed next.
+      for (auto it = callees[unit].rbegin(); it != callees[unit].rend(); ++it) {
+        if (!placed[*it] && hotness[*it] > 0) {
+          stack.emplace_back(*it, unit);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < units.size(); i++) {
+    if (!placed[i]) {
+      order.emplace_back(i, kNoCaller);
+    }
+  }
+
+  std::vector<BorrowedRef<>> ordered_units;
+  std::vector<CodeLayoutEntry> layout;
+  ordered_units.reserve(units.size());
+  layout.reserve(units.size());
+  for (auto [unit, caller] : order) {
+    ordered_units.emplace_back(units[unit]);
+    CodeLayoutEntry& entry = layout.emplace_back();
+    entry.name = get_preloader(units[unit])->fullname();
+    entry.hotness = hotness[unit];
+    if (caller != kNoCaller) {
+      entry.caller = get_preloader(units[caller])->fullname();
+    }
+  }
+  units = std::move(ordered_units);
+  return layout;
+}
+
+} // namespace jit
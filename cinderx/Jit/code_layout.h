@@ -0,0 +1,43 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "Python.h"
+#include "cinderx/Common/ref.h"
+
+#include "cinderx/Jit/hir/preload.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace jit {
+
+// Where planCodeLayout() put one unit of a batch compile, and why.
+struct CodeLayoutEntry {
+  std::string name;
+  // How hot the unit was before it was compiled: the number of bytecodes the
+  // interpreter profiler saw it execute or, without a profile, the number of
+  // times the interpreter entered it.
+  int64_t hotness{0};
+  // The hot caller this unit was placed right after, or empty if it starts a
+  // new group.
+  std::string caller;
+  // Location of the compiled code, filled in after the batch compile.
+  void* code{nullptr};
+  size_t code_size{0};
+};
+
+// Reorder the units of a batch compile so that code which runs together is
+// allocated together. The hottest unit goes first, followed depth-first by the
+// hot functions it calls through globals (in order of hotness), and so on;
+// units that never ran are moved to the end in their original order.
+//
+// Every unit must have a preloader, which provides its code object and the
+// functions its globals refer to. Returns one entry per unit, in the new
+// order.
+std::vector<CodeLayoutEntry> planCodeLayout(
+    std::vector<BorrowedRef<>>& units,
+    const std::function<hir::Preloader*(BorrowedRef<>)>& get_preloader);
+
+} // namespace jit
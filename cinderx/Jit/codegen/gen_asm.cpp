@@ -768,7 +768,9 @@ void NativeGenerator::generatePrologue(
     }
   }
 
-  if (!func_->has_primitive_args) {
+  // OSR entries are only called by the interpreter, which always passes the
+  // frame's locals and stack positionally.
+  if (!func_->has_primitive_args && !func_->osr_entry.has_value()) {
     as_->test(x86::rcx, x86::rcx); // test for kwargs
     if (!((code->co_flags & (CO_VARARGS | CO_VARKEYWORDS)) ||
           code->co_kwonlyargcount)) {
@@ -1155,6 +1157,15 @@ void NativeGenerator::generateDeoptExits(const asmjit::CodeHolder& code) {
   env_.addAnnotation("Deoptimization exits", deopt_cursor);
 }
 
+std::vector<DeoptPatcher*> NativeGenerator::getDeoptPatchers() const {
+  std::vector<DeoptPatcher*> patchers;
+  patchers.reserve(env_.pending_deopt_patchers.size());
+  for (const auto& udp : env_.pending_deopt_patchers) {
+    patchers.push_back(udp.patcher);
+  }
+  return patchers;
+}
+
 void NativeGenerator::linkDeoptPatchers(const asmjit::CodeHolder& code) {
   JIT_CHECK(code.hasBaseAddress(), "code not generated!");
   uint64_t base = code.baseAddress();
@@ -1421,6 +1432,7 @@ void NativeGenerator::generateCode(CodeHolder& codeholder) {
   env_.code_rt->debug_info()->resolvePending(
       env_.pending_debug_locs, *GetFunction(), codeholder);
 
+  code_start_ = code_top;
   vectorcall_entry_ = static_cast<char*>(code_top) +
       codeholder.labelOffsetFromBase(vectorcall_entry_label);
 
@@ -1450,9 +1462,11 @@ void NativeGenerator::generateCode(CodeHolder& codeholder) {
     ThreadedCompileSerialize guard;
     for (auto& x : env_.function_indirections) {
       Label trampoline = x.second.trampoline;
-      *x.second.indirect = reinterpret_cast<void*>(
-          codeholder.labelOffsetFromBase(trampoline) +
-          codeholder.baseAddress());
+      env_.rt->setFunctionEntryFallback(
+          x.first,
+          reinterpret_cast<void*>(
+              codeholder.labelOffsetFromBase(trampoline) +
+              codeholder.baseAddress()));
     }
   }
 
@@ -70,6 +70,13 @@ class NativeGenerator {
   std::string GetFunctionName() const;
   void* getVectorcallEntry();
   void* getStaticEntry();
+  // Start of the memory allocated for the compiled code, which is
+  // GetCompiledFunctionSize() bytes long.
+  void* getCodeStart() const {
+    return code_start_;
+  }
+  // Deopt patchers linked into the generated code.
+  std::vector<DeoptPatcher*> getDeoptPatchers() const;
   int GetCompiledFunctionSize() const;
   int GetCompiledFunctionStackSize() const;
   int GetCompiledFunctionSpillStackSize() const;
@@ -91,6 +98,7 @@ class NativeGenerator {
  private:
   const hir::Function* func_;
   void* vectorcall_entry_{nullptr};
+  void* code_start_{nullptr};
   asmjit::x86::Builder* as_{nullptr};
   CodeHolderMetadata metadata_{CodeSection::kHot};
   void* deopt_trampoline_{nullptr};
@@ -0,0 +1,221 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Jit/compile_failure_cache.h"
+
+#include "cinderx/Common/log.h"
+#include "cinderx/Jit/config.h"
+#include "cinderx/Jit/runtime.h"
+
+#include <elf.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace jit {
+
+namespace {
+
+struct BuildIdSearch {
+  uintptr_t addr;
+  std::string id;
+};
+
+size_t noteAlign(size_t size) {
+  return (size + 3) & ~size_t{3};
+}
+
+// dl_iterate_phdr() callback that identifies the object containing
+// search->addr by its GNU build ID or, if it wasn't linked with one, by the
+// size and modification time of its file.
+int findBuildId(struct dl_phdr_info* info, size_t, void* data) {
+  auto search = static_cast<BuildIdSearch*>(data);
+  bool contains_addr = false;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+    if (phdr.p_type == PT_LOAD && search->addr >= start &&
+        search->addr < start + phdr.p_memsz) {
+      contains_addr = true;
+      break;
+    }
+  }
+  if (!contains_addr) {
+    return 0;
+  }
+
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE) {
+      continue;
+    }
+    auto p = reinterpret_cast<const uint8_t*>(info->dlpi_addr + phdr.p_vaddr);
+    const uint8_t* end = p + phdr.p_memsz;
+    while (p + sizeof(ElfW(Nhdr)) <= end) {
+      auto note = reinterpret_cast<const ElfW(Nhdr)*>(p);
+      const uint8_t* name = p + sizeof(ElfW(Nhdr));
+      const uint8_t* desc = name + noteAlign(note->n_namesz);
+      if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 &&
+          std::memcmp(name, "GNU", 4) == 0 && desc + note->n_descsz <= end) {
+        search->id.clear();
+        for (size_t j = 0; j < note->n_descsz; j++) {
+          search->id += fmt::format("{:02x}", desc[j]);
+        }
+        return 1;
+      }
+      p = desc + noteAlign(note->n_descsz);
+    }
+  }
+
+  // The main executable has an empty name.
+  const char* path =
+      info->dlpi_name[0] != '\0' ? info->dlpi_name : "/proc/self/exe";
+  struct stat statbuf;
+  if (::stat(path, &statbuf) == 0) {
+    search->id = fmt::format(
+        "size={},mtime={}",
+        static_cast<long long>(statbuf.st_size),
+        static_cast<long long>(statbuf.st_mtime));
+  }
+  return 1;
+}
+
+// Identifies the build of the JIT itself, since a rebuilt JIT can succeed
+// where an old one failed even if the Python version string is unchanged.
+const std::string& buildIdentity() {
+  static const std::string id = [] {
+    BuildIdSearch search{reinterpret_cast<uintptr_t>(&findBuildId), "unknown"};
+    ::dl_iterate_phdr(findBuildId, &search);
+    return search.id;
+  }();
+  return id;
+}
+
+// First line of a cache file. Anything that changes the code the JIT
+// generates for a given code object, and so whether compiling it can fail,
+// belongs in here.
+std::string cacheHeader() {
+  std::string version{Py_GetVersion()};
+  std::replace(version.begin(), version.end(), '\n', ' ');
+  const Config& config = getConfig();
+  return fmt::format(
+      "cinderx-jit-compile-failure-cache v1; python {}; build {}; "
+      "frame_mode={} inliner={} licm={} code_sections={} attr_cache_size={}",
+      version,
+      buildIdentity(),
+      static_cast<int>(config.frame_mode),
+      config.hir_inliner_enabled,
+      config.hir_licm_enabled,
+      config.multiple_code_sections,
+      config.attr_cache_size);
+}
+
+std::string qualnameOfKey(const std::string& key) {
+  // Keys look like "filename:firstlineno:qualname:hash". The filename may
+  // contain colons but the other fields can't.
+  size_t hash_sep = key.rfind(':');
+  if (hash_sep == std::string::npos || hash_sep == 0) {
+    return key;
+  }
+  size_t qualname_sep = key.rfind(':', hash_sep - 1);
+  if (qualname_sep == std::string::npos) {
+    return key;
+  }
+  return key.substr(qualname_sep + 1, hash_sep - qualname_sep - 1);
+}
+
+} // namespace
+
+void CompileFailureCache::load(const std::string& path) {
+  path_ = path;
+  failures_.clear();
+  failed_qualnames_.clear();
+  dirty_ = false;
+
+  std::ifstream file{path};
+  if (!file) {
+    return;
+  }
+  std::string line;
+  if (!std::getline(file, line) || line != cacheHeader()) {
+    JIT_DLOG(
+        "Ignoring compile failure cache {} from a different build or config",
+        path);
+    // Rewrite the file for this build and config at shutdown.
+    dirty_ = true;
+    return;
+  }
+  while (std::getline(file, line)) {
+    if (!line.empty()) {
+      failed_qualnames_.emplace(qualnameOfKey(line));
+      failures_.emplace(std::move(line));
+    }
+  }
+  JIT_DLOG(
+      "Loaded {} entries from compile failure cache {}",
+      failures_.size(),
+      path);
+}
+
+void CompileFailureCache::save() {
+  if (!isEnabled() || !dirty_) {
+    return;
+  }
+  // Write to a temporary file and rename it into place, so concurrent
+  // processes never see a partially written cache.
+  std::string tmp_path = fmt::format("{}.tmp.{}", path_, getpid());
+  {
+    std::ofstream file{tmp_path};
+    if (!file) {
+      JIT_LOG("Failed to open {} for writing", tmp_path);
+      return;
+    }
+    file << cacheHeader() << '\n';
+    for (const std::string& key : failures_) {
+      file << key << '\n';
+    }
+    if (!file) {
+      JIT_LOG("Failed to write compile failure cache to {}", tmp_path);
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    JIT_LOG(
+        "Failed to move compile failure cache into place at {}", path_);
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  dirty_ = false;
+}
+
+bool CompileFailureCache::isKnownFailure(
+    BorrowedRef<PyCodeObject> code) const {
+  if (failed_qualnames_.empty() ||
+      !failed_qualnames_.contains(codeQualname(code))) {
+    return false;
+  }
+  auto& profile_runtime = Runtime::get()->profileRuntime();
+  if (!failures_.contains(profile_runtime.codeKey(code))) {
+    return false;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void CompileFailureCache::addFailure(BorrowedRef<PyCodeObject> code) {
+  if (!isEnabled()) {
+    return;
+  }
+  std::string key = Runtime::get()->profileRuntime().codeKey(code);
+  failed_qualnames_.emplace(qualnameOfKey(key));
+  if (failures_.emplace(std::move(key)).second) {
+    dirty_ = true;
+  }
+}
+
+} // namespace jit
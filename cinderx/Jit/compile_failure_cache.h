@@ -0,0 +1,67 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "Python.h"
+#include "cinderx/Common/ref.h"
+#include "cinderx/Common/util.h"
+
+#include <atomic>
+#include <string>
+#include <unordered_set>
+
+namespace jit {
+
+// A file that remembers, across process restarts, which code objects the JIT
+// failed to compile, so later processes don't spend time preloading and
+// lowering them again only to fail the same way.
+//
+// Only failures are recorded. Successfully compiled code isn't persisted:
+// it embeds the addresses of runtime objects, which would need relocating
+// when loaded into another process.
+//
+// Entries are keyed on ProfileRuntime::codeKey(), which covers the code's
+// filename, first line number, qualname and bytecode. The file also records
+// the Python version, the build of the JIT (its GNU build ID, or the size and
+// modification time of its file) and the JIT options that affect code
+// generation, and its entries are ignored if any of them doesn't match the
+// current process.
+class CompileFailureCache {
+ public:
+  CompileFailureCache() = default;
+
+  // Load entries from the file at path, which is also where save() writes. A
+  // missing or mismatched file isn't an error; the cache just starts empty.
+  void load(const std::string& path);
+
+  // Write the entries back out if any were added since load().
+  void save();
+
+  bool isEnabled() const {
+    return !path_.empty();
+  }
+
+  // Return true if compiling code failed in a previous process.
+  bool isKnownFailure(BorrowedRef<PyCodeObject> code) const;
+
+  // Record that compiling code failed.
+  void addFailure(BorrowedRef<PyCodeObject> code);
+
+  // Number of times isKnownFailure() returned true.
+  size_t hits() const {
+    return hits_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileFailureCache);
+
+  std::string path_;
+  std::unordered_set<std::string> failures_;
+  // Qualnames of everything in failures_, to avoid computing full code keys
+  // for the common case of code that isn't in the cache.
+  std::unordered_set<std::string> failed_qualnames_;
+  mutable std::atomic<size_t> hits_{0};
+  bool dirty_{false};
+};
+
+} // namespace jit
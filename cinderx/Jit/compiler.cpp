@@ -5,6 +5,7 @@
 #include "Python.h"
 #include "cinderx/Common/log.h"
 
+#include "cinderx/Jit/code_allocator.h"
 #include "cinderx/Jit/config.h"
 #include "cinderx/Jit/disassembler.h"
 #include "cinderx/Jit/hir/analysis.h"
@@ -13,7 +14,9 @@
 #include "cinderx/Jit/hir/preload.h"
 #include "cinderx/Jit/hir/printer.h"
 #include "cinderx/Jit/hir/ssa.h"
+#include "cinderx/Jit/jit_gdb_support.h"
 #include "cinderx/Jit/jit_time_log.h"
+#include "cinderx/Jit/perf_jitdump.h"
 
 #include "cinderx/ThirdParty/json/json.hpp"
 
@@ -22,6 +25,22 @@
 
 namespace jit {
 
+CompiledFunction::~CompiledFunction() {
+  if (code_start_ == nullptr) {
+    return;
+  }
+  Runtime::get()->forgetDeoptPatchers(deopt_patchers_);
+  unregister_debug_symbol(reinterpret_cast<void*>(vectorcall_entry_));
+  // Perf maps and jitdump files have no way to retract a symbol, so while
+  // either is being written the memory isn't reused and the symbols already
+  // written for it stay accurate.
+  if (perf::jit_perfmap || !perf::perf_jitdump_dir.empty()) {
+    return;
+  }
+  Runtime::get()->forgetFunctionEntryFallbacks(code_start_, code_size_);
+  CodeAllocator::get()->releaseCode(code_start_, code_size_);
+}
+
 void CompiledFunction::disassemble() const {
   JIT_ABORT("disassemble() cannot be called in a release build.");
 }
@@ -114,7 +133,13 @@ void Compiler::runPasses(
     runPass<jit::hir::BeginInlinedFunctionElimination>(irfunc, callback);
   }
   runPass<jit::hir::BuiltinLoadMethodElimination>(irfunc, callback);
+  runPass<jit::hir::FloatUnboxing>(irfunc, callback);
   runPass<jit::hir::Simplify>(irfunc, callback);
+  runPass<jit::hir::GlobalValueNumbering>(irfunc, callback);
+  if (!(config & PassConfig::kDisableLICM)) {
+    runPass<jit::hir::LoopInvariantCodeMotion>(irfunc, callback);
+  }
+  runPass<jit::hir::ScalarReplacement>(irfunc, callback);
   runPass<jit::hir::CleanCFG>(irfunc, callback);
   runPass<jit::hir::DeadCodeElimination>(irfunc, callback);
   runPass<jit::hir::CleanCFG>(irfunc, callback);
@@ -140,11 +165,15 @@ PassConfig createConfig() {
   if (getConfig().hir_inliner_enabled) {
     result = static_cast<PassConfig>(result | PassConfig::kEnableHIRInliner);
   }
+  if (!getConfig().hir_licm_enabled) {
+    result = static_cast<PassConfig>(result | PassConfig::kDisableLICM);
+  }
   return result;
 }
 
 std::unique_ptr<CompiledFunction> Compiler::Compile(
-    const jit::hir::Preloader& preloader) {
+    const jit::hir::Preloader& preloader,
+    std::optional<hir::OSREntry> osr_entry) {
   const std::string& fullname = preloader.fullname();
   if (!PyDict_CheckExact(preloader.globals())) {
     JIT_DLOG(
@@ -162,10 +191,18 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
         Py_TYPE(builtins)->tp_name);
     return nullptr;
   }
-  JIT_DLOG(
-      "Compiling {} @ {}",
-      fullname,
-      reinterpret_cast<void*>(preloader.code().get()));
+  if (osr_entry.has_value()) {
+    JIT_DLOG(
+        "Compiling {} @ {} for OSR at {}",
+        fullname,
+        reinterpret_cast<void*>(preloader.code().get()),
+        osr_entry->bc_offset);
+  } else {
+    JIT_DLOG(
+        "Compiling {} @ {}",
+        fullname,
+        reinterpret_cast<void*>(preloader.code().get()));
+  }
 
   std::unique_ptr<CompilationPhaseTimer> compilation_phase_timer{nullptr};
 
@@ -176,7 +213,8 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
   }
 
   PassTimer hir_build_timer;
-  std::unique_ptr<jit::hir::Function> irfunc(jit::hir::buildHIR(preloader));
+  std::unique_ptr<jit::hir::Function> irfunc(
+      jit::hir::buildHIR(preloader, osr_entry));
   std::size_t hir_build_time_ns = hir_build_timer.finish();
   if (nullptr != compilation_phase_timer) {
     compilation_phase_timer->end();
@@ -268,8 +306,12 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
   // Grab some fields off of irfunc and ngen before moving them.
   hir::Function::InlineFunctionStats inline_stats =
       std::move(irfunc->inline_function_stats);
+  hir::Function::OptimizationStats optimization_stats =
+      irfunc->optimization_stats;
   void* static_entry = ngen->getStaticEntry();
+  void* code_start = ngen->getCodeStart();
   CodeRuntime* code_runtime = ngen->codeRuntime();
+  std::vector<DeoptPatcher*> deopt_patchers = ngen->getDeoptPatchers();
 
   if (g_debug) {
     irfunc->setCompilationPhaseTimer(nullptr);
@@ -278,22 +320,28 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
         std::move(ngen),
         reinterpret_cast<vectorcallfunc>(entry),
         static_entry,
+        code_start,
         code_runtime,
+        std::move(deopt_patchers),
         func_size,
         stack_size,
         spill_stack_size,
         std::move(inline_stats),
-        hir_opcode_counts);
+        hir_opcode_counts,
+        optimization_stats);
   } else {
     return std::make_unique<CompiledFunction>(
         reinterpret_cast<vectorcallfunc>(entry),
         static_entry,
+        code_start,
         code_runtime,
+        std::move(deopt_patchers),
         func_size,
         stack_size,
         spill_stack_size,
         std::move(inline_stats),
-        hir_opcode_counts);
+        hir_opcode_counts,
+        optimization_stats);
   }
 }
 
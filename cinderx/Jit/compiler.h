@@ -10,7 +10,9 @@
 #include "cinderx/Jit/hir/preload.h"
 #include "cinderx/Jit/runtime.h"
 
+#include <optional>
 #include <utility>
+#include <vector>
 
 namespace jit {
 
@@ -24,22 +26,30 @@ class CompiledFunction {
   CompiledFunction(
       vectorcallfunc vectorcall_entry,
       void* static_entry,
+      void* code_start,
       CodeRuntime* code_runtime,
+      std::vector<DeoptPatcher*> deopt_patchers,
       int func_size,
       int stack_size,
       int spill_stack_size,
       hir::Function::InlineFunctionStats inline_function_stats,
-      const hir::OpcodeCounts& hir_opcode_counts)
+      const hir::OpcodeCounts& hir_opcode_counts,
+      const hir::Function::OptimizationStats& optimization_stats)
       : vectorcall_entry_(vectorcall_entry),
         static_entry_(static_entry),
+        code_start_(code_start),
         code_runtime_(code_runtime),
+        deopt_patchers_(std::move(deopt_patchers)),
         code_size_(func_size),
         stack_size_(stack_size),
         spill_stack_size_(spill_stack_size),
         inline_function_stats_(std::move(inline_function_stats)),
-        hir_opcode_counts_(hir_opcode_counts) {}
+        hir_opcode_counts_(hir_opcode_counts),
+        optimization_stats_(optimization_stats) {}
 
-  virtual ~CompiledFunction() {}
+  // Frees the executable memory, so the code must no longer be running or
+  // reachable through any function's entry point.
+  virtual ~CompiledFunction();
 
   vectorcallfunc vectorcallEntry() const {
     return vectorcall_entry_;
@@ -49,6 +59,10 @@ class CompiledFunction {
     return static_entry_;
   }
 
+  void* codeStart() const {
+    return code_start_;
+  }
+
   PyObject* invoke(PyObject* func, PyObject** args, Py_ssize_t nargs) const {
     return vectorcall_entry_(func, args, nargs, NULL);
   }
@@ -75,18 +89,25 @@ class CompiledFunction {
   const hir::OpcodeCounts& hirOpcodeCounts() const {
     return hir_opcode_counts_;
   }
+  const hir::Function::OptimizationStats& optimizationStats() const {
+    return optimization_stats_;
+  }
 
  private:
   DISALLOW_COPY_AND_ASSIGN(CompiledFunction);
 
   vectorcallfunc const vectorcall_entry_;
   void* const static_entry_;
+  void* const code_start_;
   CodeRuntime* const code_runtime_;
+  // Deopt patchers linked into this function's code.
+  const std::vector<DeoptPatcher*> deopt_patchers_;
   const int code_size_;
   const int stack_size_;
   const int spill_stack_size_;
   hir::Function::InlineFunctionStats inline_function_stats_;
   hir::OpcodeCounts hir_opcode_counts_;
+  hir::Function::OptimizationStats optimization_stats_;
 };
 
 // same as CompiledFunction class but keeps HIR and LIR classes for debug
@@ -117,6 +138,7 @@ typedef std::function<
 enum PassConfig : uint64_t {
   kDefault = 0,
   kEnableHIRInliner = 1 << 0,
+  kDisableLICM = 1 << 1,
 };
 
 // Compiler is the high-level interface for translating Python functions into
@@ -125,8 +147,12 @@ class Compiler {
  public:
   Compiler() = default;
 
-  // Compile the function / code object preloaded by the given Preloader.
-  std::unique_ptr<CompiledFunction> Compile(const hir::Preloader& preloader);
+  // Compile the function / code object preloaded by the given Preloader. If
+  // osr_entry is given, compile an on-stack replacement entry for the given
+  // loop header instead of a normal function entry.
+  std::unique_ptr<CompiledFunction> Compile(
+      const hir::Preloader& preloader,
+      std::optional<hir::OSREntry> osr_entry = std::nullopt);
 
   // Convenience wrapper to create and compile a preloader from a
   // PyFunctionObject.
@@ -30,19 +30,34 @@ struct Config {
   bool allow_jit_list_wildcards{false};
   bool compile_all_static_functions{false};
   bool hir_inliner_enabled{false};
+  // Run the LoopInvariantCodeMotion pass.
+  bool hir_licm_enabled{true};
   bool multiple_code_sections{false};
   bool multithreaded_compile_test{false};
   bool use_huge_pages{true};
   size_t batch_compile_workers{0};
+  // Order the units of a batch compile by profiled hotness and call-graph
+  // affinity instead of by size, so hot code is allocated together.
+  bool profile_guided_code_layout{false};
   // Sizes (in bytes) of the hot and cold code sections. Only applicable if
   // multiple code sections are enabled.
   size_t cold_code_section_size{0};
   size_t hot_code_section_size{0};
-  // Size (in number of entries) of the LoadAttr and StoreAttr inline caches
-  // used by the JIT.
-  uint32_t attr_cache_size{1};
+  // Maximum number of receiver types a LoadAttr, StoreAttr, or LoadMethod
+  // inline cache tracks before it goes megamorphic. Caches start out with a
+  // single entry and only grow when a second type is seen.
+  uint32_t attr_cache_size{4};
   uint32_t auto_jit_threshold{0};
   uint32_t auto_jit_profile_threshold{0};
+  // Compile functions that cross the auto-JIT threshold on a background thread
+  // instead of on the calling thread.
+  bool auto_jit_async{false};
+  // Number of times a single guard can fail before the function containing it
+  // is recompiled. Zero disables recompilation.
+  uint32_t reopt_threshold{0};
+  // Number of backward jumps an interpreted frame may take before it is
+  // replaced on the stack by JIT-compiled code. Zero disables OSR.
+  uint32_t osr_threshold{0};
   bool compile_perf_trampoline_prefork{false};
 };
 
@@ -2,6 +2,8 @@
 
 #include "cinderx/Jit/deopt.h"
 
+#include "structmember.h"
+
 #include "cinderx/Common/util.h"
 
 #include "cinderx/Jit/bytecode_offsets.h"
@@ -13,6 +15,7 @@
 #include <folly/tracing/StaticTracepoint.h>
 
 #include <bit>
+#include <cstring>
 #include <shared_mutex>
 
 using jit::codegen::PhyLocation;
@@ -79,7 +82,7 @@ Ref<> MemoryView::readOwned(const LiveValue& value) const {
     case jit::hir::ValueKind::kUnsigned:
       return Ref<>::steal(PyLong_FromSize_t(raw));
     case hir::ValueKind::kDouble:
-      return Ref<>::steal(PyFloat_FromDouble(raw));
+      return Ref<>::steal(PyFloat_FromDouble(bit_cast<double>(raw)));
     case jit::hir::ValueKind::kBool:
       return Ref<>::create(raw ? Py_True : Py_False);
     case jit::hir::ValueKind::kObject:
@@ -88,11 +91,134 @@ Ref<> MemoryView::readOwned(const LiveValue& value) const {
   JIT_ABORT("Unhandled ValueKind");
 }
 
+namespace {
+
+// Objects rebuilt while reifying a frame, indexed like
+// DeoptMetadata::virtual_objects. Sharing them between all the slots of the
+// frame keeps identity intact when one object was referenced from several
+// places.
+using VirtualObjectCache = std::vector<Ref<>>;
+
+// The size of a primitive member of a Static Python value class.
+std::size_t primitiveMemberSize(const PyMemberDef& member) {
+  switch (member.type) {
+    case T_BYTE:
+    case T_UBYTE:
+    case T_BOOL:
+    case T_CHAR:
+      return 1;
+    case T_SHORT:
+    case T_USHORT:
+      return 2;
+    case T_INT:
+    case T_UINT:
+      return 4;
+    case T_LONG:
+    case T_ULONG:
+    case T_DOUBLE:
+      return 8;
+    default:
+      JIT_ABORT("Unexpected value class member type {}", member.type);
+  }
+}
+
+Ref<> rematerialize(
+    const DeoptMetadata& meta,
+    const DeoptVirtualObject& obj,
+    const MemoryView& mem) {
+  auto read_field = [&](std::size_t i) -> Ref<> {
+    int idx = obj.fields.at(i);
+    if (idx == -1) {
+      return nullptr;
+    }
+    return mem.readOwned(meta.live_values[idx]);
+  };
+
+  Ref<> result;
+  switch (obj.kind) {
+    case hir::VirtualObject::Kind::kCell:
+      result = Ref<>::steal(PyCell_New(read_field(0)));
+      break;
+    case hir::VirtualObject::Kind::kFloat:
+      // Reading a double live value boxes it.
+      result = read_field(0);
+      break;
+    case hir::VirtualObject::Kind::kList: {
+      std::size_t size = obj.fields.size();
+      result = Ref<>::steal(PyList_New(size));
+      if (result != nullptr) {
+        for (std::size_t i = 0; i < size; i++) {
+          PyList_SET_ITEM(result.get(), i, read_field(i).release());
+        }
+      }
+      break;
+    }
+    case hir::VirtualObject::Kind::kSlice:
+      result = Ref<>::steal(
+          PySlice_New(read_field(0), read_field(1), read_field(2)));
+      break;
+    case hir::VirtualObject::Kind::kTuple: {
+      std::size_t size = obj.fields.size();
+      result = Ref<>::steal(PyTuple_New(size));
+      if (result != nullptr) {
+        for (std::size_t i = 0; i < size; i++) {
+          PyTuple_SET_ITEM(result.get(), i, read_field(i).release());
+        }
+      }
+      break;
+    }
+    case hir::VirtualObject::Kind::kValue: {
+      BorrowedRef<PyTypeObject> type = obj.type;
+      result = Ref<>::steal(type->tp_alloc(type, 0));
+      if (result != nullptr) {
+        // Members are written directly, since the interpreter would have to
+        // box and range check them to go through their descriptors.
+        PyMemberDef* members = PyHeapType_GET_MEMBERS(
+            reinterpret_cast<PyHeapTypeObject*>(type.get()));
+        auto base = reinterpret_cast<char*>(result.get());
+        for (std::size_t i = 0; i < obj.fields.size(); i++) {
+          int idx = obj.fields[i];
+          if (idx == -1) {
+            continue;
+          }
+          uint64_t raw = mem.readRaw(meta.live_values[idx]);
+          std::memcpy(
+              base + members[i].offset, &raw, primitiveMemberSize(members[i]));
+        }
+      }
+      break;
+    }
+  }
+  JIT_CHECK(
+      result != nullptr,
+      "Failed to rematerialize {} during deopt",
+      hir::GetVirtualObjectKindName(obj.kind));
+  return result;
+}
+
+Ref<> readValue(
+    const DeoptMetadata& meta,
+    const LiveValue& value,
+    const MemoryView& mem,
+    VirtualObjectCache& virtuals) {
+  if (!value.isVirtual()) {
+    return mem.readOwned(value);
+  }
+  Ref<>& obj = virtuals.at(value.virtual_object);
+  if (obj == nullptr) {
+    obj = rematerialize(meta, meta.virtual_objects[value.virtual_object], mem);
+  }
+  return Ref<>::create(obj);
+}
+
+} // namespace
+
 static void reifyLocalsplus(
     PyFrameObject* frame,
     const DeoptMetadata& meta,
     const DeoptFrameMetadata& frame_meta,
-    const MemoryView& mem) {
+    const MemoryView& mem,
+    VirtualObjectCache& virtuals) {
   for (std::size_t i = 0; i < frame_meta.localsplus.size(); i++) {
     auto value = meta.getLocalValue(i, frame_meta);
     if (value == nullptr) {
@@ -100,7 +226,7 @@ static void reifyLocalsplus(
       Py_CLEAR(frame->f_localsplus[i]);
       continue;
     }
-    PyObject* obj = mem.readOwned(*value).release();
+    PyObject* obj = readValue(meta, *value, mem, virtuals).release();
     Py_XSETREF(frame->f_localsplus[i], obj);
   }
 }
@@ -109,11 +235,12 @@ static void reifyStack(
     PyFrameObject* frame,
     const DeoptMetadata& meta,
     const DeoptFrameMetadata& frame_meta,
-    const MemoryView& mem) {
+    const MemoryView& mem,
+    VirtualObjectCache& virtuals) {
   frame->f_stackdepth = frame_meta.stack.size();
   for (int i = frame_meta.stack.size() - 1; i >= 0; i--) {
     const auto& value = meta.getStackValue(i, frame_meta);
-    Ref<> obj = mem.readOwned(value);
+    Ref<> obj = readValue(meta, value, mem, virtuals);
     if (value.isLoadMethodResult()) {
       // When we are deoptimizing a JIT-compiled function that contains an
       // optimizable LoadMethod, we need to be able to know whether or not the
@@ -207,8 +334,9 @@ static void reifyFrameImpl(
     frame->f_lasti--;
   }
   MemoryView mem{regs};
-  reifyLocalsplus(frame, meta, frame_meta, mem);
-  reifyStack(frame, meta, frame_meta, mem);
+  VirtualObjectCache virtuals(meta.virtual_objects.size());
+  reifyLocalsplus(frame, meta, frame_meta, mem, virtuals);
+  reifyStack(frame, meta, frame_meta, mem, virtuals);
   reifyBlockStack(frame, frame_meta.block_stack);
   // Generator/frame linkage happens in `materializePyFrame` in frame.cpp
 }
@@ -339,6 +467,35 @@ DeoptMetadata DeoptMetadata::fromInstr(
     return it->second;
   };
 
+  // Virtual objects get LiveValues after all the real ones, which are matched
+  // up with the inputs of the deopting instruction by position.
+  auto fs = instr.frameState();
+  for (hir::FrameState* frame = fs; frame != nullptr; frame = frame->parent) {
+    for (const hir::VirtualObject& obj : frame->virtual_objects) {
+      if (reg_idx.count(obj.reg) != 0) {
+        continue;
+      }
+      DeoptVirtualObject virtual_obj{obj.kind, {}, obj.type};
+      if (obj.type != nullptr && code_rt != nullptr) {
+        code_rt->addReference(reinterpret_cast<PyObject*>(obj.type));
+      }
+      for (hir::Register* field : obj.fields) {
+        virtual_obj.fields.emplace_back(get_reg_idx(field));
+      }
+      LiveValue lv = {
+          .location = 0,
+          .ref_kind = hir::RefKind::kUncounted,
+          .value_kind = hir::ValueKind::kObject,
+          .source = LiveValue::Source::kUnknown,
+          .virtual_object = static_cast<int>(meta.virtual_objects.size()),
+      };
+      meta.virtual_objects.emplace_back(std::move(virtual_obj));
+      meta.live_values.emplace_back(std::move(lv));
+      reg_idx[obj.reg] = i;
+      i++;
+    }
+  }
+
   auto populate_localsplus =
       [get_reg_idx](DeoptFrameMetadata& meta, hir::FrameState* fs) {
         std::size_t nlocals = fs->locals.size();
@@ -356,7 +513,8 @@ DeoptMetadata DeoptMetadata::fromInstr(
                             DeoptFrameMetadata& meta, hir::FrameState* fs) {
     std::unordered_set<jit::hir::Register*> lms_on_stack;
     for (auto& reg : fs->stack) {
-      if (isAnyLoadMethod(*reg->instr())) {
+      if (fs->findVirtualObject(reg) == nullptr &&
+          isAnyLoadMethod(*reg->instr())) {
         // Our logic for reconstructing the Python stack assumes that if a
         // value on the stack was produced by a LoadMethod instruction, it
         // corresponds to the output of a LOAD_METHOD opcode and will
@@ -372,7 +530,6 @@ DeoptMetadata DeoptMetadata::fromInstr(
     }
   };
 
-  auto fs = instr.frameState();
   JIT_DCHECK(
       fs != nullptr, "need FrameState to calculate inline depth of {}", instr);
 
@@ -64,7 +64,19 @@ struct LiveValue {
     return source == Source::kLoadMethod;
   }
 
+  // If not -1, this value has no location: it's an object that was removed by
+  // scalar replacement, and this is an index into
+  // DeoptMetadata::virtual_objects describing how to rebuild it.
+  int virtual_object{-1};
+
+  bool isVirtual() const {
+    return virtual_object != -1;
+  }
+
   std::string toString() const {
+    if (isVirtual()) {
+      return fmt::format("virtual:{}", virtual_object);
+    }
     return fmt::format(
         "{}:{}:{}:{}",
         location.toString(),
@@ -121,6 +133,19 @@ struct DeoptFrameMetadata {
   }
 };
 
+// An object that has to be allocated during deopt because the JIT-compiled
+// code never created it. See hir::VirtualObject.
+struct DeoptVirtualObject {
+  jit::hir::VirtualObject::Kind kind;
+
+  // Index into live_values for each field, or -1 for a missing slice step or
+  // a value class member that is still zero.
+  std::vector<int> fields;
+
+  // The value class of a Value object. Kept alive by the CodeRuntime.
+  BorrowedRef<PyTypeObject> type;
+};
+
 // DeoptMetadata captures all the information necessary to reconstruct a
 // PyFrameObject when deoptimization occurs.
 struct DeoptMetadata {
@@ -131,6 +156,10 @@ struct DeoptMetadata {
   // All live values
   std::vector<LiveValue> live_values;
 
+  // Objects referenced by virtual live values. These always come after the
+  // real values in live_values.
+  std::vector<DeoptVirtualObject> virtual_objects;
+
   // Stack of inlined frame metadata unwound from the deopting instruction.
   std::vector<DeoptFrameMetadata> frame_meta;
 
@@ -255,7 +284,6 @@ struct MemoryView {
   BorrowedRef<> readBorrowed(const LiveValue& value) const;
   Ref<> readOwned(const LiveValue& value) const;
 
- private:
   uint64_t readRaw(const LiveValue& value) const {
     jit::codegen::PhyLocation loc = value.location;
     if (loc.is_register()) {
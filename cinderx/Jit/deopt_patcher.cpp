@@ -29,9 +29,9 @@ void DeoptPatcher::link(uintptr_t patchpoint, uintptr_t deopt_exit) {
   JIT_CHECK(
       fitsInt32(deopt_exit - (patchpoint + kJmpSize)),
       "can't encode jump as relative");
-  init();
   jmp_disp_ = deopt_exit - (patchpoint + kJmpSize);
   patchpoint_ = reinterpret_cast<uint8_t*>(patchpoint);
+  init();
 }
 
 void DeoptPatcher::emitPatchpoint(asmjit::x86::Builder& as) {
@@ -56,7 +56,9 @@ class DeoptPatcher {
   static void emitPatchpoint(asmjit::x86::Builder& as);
 
  protected:
-  // Perform any initialization needed (e.g. subscribing to changes).
+  // Perform any initialization needed (e.g. subscribing to changes). This is
+  // called once the patcher is linked, so it may call patch() if the
+  // invariant no longer holds.
   virtual void init() = 0;
 
  private:
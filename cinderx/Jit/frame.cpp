@@ -5,6 +5,7 @@
 #include "Python.h"
 #include "cinder/exports.h"
 #include "cinder/genobject_jit.h"
+#include "cinderx/Common/frame_arena.h"
 #include "cinderx/Common/log.h"
 #include "cinderx/Common/util.h"
 #include "internal/pycore_pystate.h"
@@ -187,7 +188,7 @@ Ref<PyFrameObject> createPyFrame(
   py_frame_ctor.fc_builtins = frame_state->builtins();
   py_frame_ctor.fc_code = frame_state->code();
   Ref<PyFrameObject> py_frame = Ref<PyFrameObject>::steal(
-      _PyFrame_New_NoTrack(tstate, &py_frame_ctor, nullptr));
+      Ci_FrameArena_New(tstate, &py_frame_ctor, nullptr));
   _PyObject_GC_TRACK(py_frame);
   // _PyFrame_New_NoTrack links the frame into the thread stack.
   Py_CLEAR(py_frame->f_back);
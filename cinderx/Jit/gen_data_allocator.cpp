@@ -0,0 +1,129 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Jit/gen_data_allocator.h"
+
+#include "cinderx/Common/log.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace jit {
+
+namespace {
+
+size_t blockBytes(size_t spill_words) {
+  return spill_words * sizeof(uint64_t) + sizeof(GenDataFooter);
+}
+
+GenDataFooter* footerOf(void* block, size_t spill_words) {
+  return reinterpret_cast<GenDataFooter*>(
+      reinterpret_cast<uint64_t*>(block) + spill_words);
+}
+
+void* blockOf(GenDataFooter* footer) {
+  return reinterpret_cast<uint64_t*>(footer) - footer->spillWords;
+}
+
+} // namespace
+
+GenDataAllocator::GenDataAllocator() {
+  for (size_t i = 0; i < classes_.size(); i++) {
+    SizeClass& size_class = classes_[i];
+    size_class.stats.spill_words = kSizeClassWords[i];
+    size_class.max_retained =
+        kMaxRetainedBytesPerClass / blockBytes(kSizeClassWords[i]);
+  }
+}
+
+GenDataAllocator::~GenDataAllocator() {
+  clear();
+}
+
+GenDataAllocator& GenDataAllocator::get() {
+  // Never destroyed, since generators may outlive static destructors.
+  static auto allocator = new GenDataAllocator();
+  return *allocator;
+}
+
+size_t GenDataAllocator::blockSpillWords(size_t spill_words) {
+  for (size_t class_words : kSizeClassWords) {
+    if (spill_words <= class_words) {
+      return class_words;
+    }
+  }
+  return spill_words;
+}
+
+GenDataAllocator::SizeClass* GenDataAllocator::sizeClassFor(
+    size_t spill_words) {
+  for (size_t i = 0; i < classes_.size(); i++) {
+    if (spill_words == kSizeClassWords[i]) {
+      return &classes_[i];
+    }
+  }
+  return nullptr;
+}
+
+GenDataFooter* GenDataAllocator::allocate(size_t spill_words) {
+  spill_words = blockSpillWords(spill_words);
+  SizeClass* size_class = sizeClassFor(spill_words);
+  if (size_class == nullptr) {
+    large_allocs_++;
+  } else {
+    size_class->stats.allocs++;
+    if (FreeBlock* block = size_class->free_list) {
+      // spillWords is still set from the block's previous use.
+      size_class->free_list = block->next;
+      size_class->stats.retained--;
+      size_class->stats.reuses++;
+      return footerOf(block, spill_words);
+    }
+  }
+
+  void* block = malloc(blockBytes(spill_words));
+  JIT_CHECK(block != nullptr, "Failed to allocate generator data");
+  GenDataFooter* footer = footerOf(block, spill_words);
+  footer->spillWords = spill_words;
+  return footer;
+}
+
+void GenDataAllocator::free(GenDataFooter* footer) {
+  void* block = blockOf(footer);
+  SizeClass* size_class = sizeClassFor(footer->spillWords);
+  if (size_class == nullptr) {
+    ::free(block);
+    return;
+  }
+  if (size_class->stats.retained == size_class->max_retained) {
+    size_class->stats.released++;
+    ::free(block);
+    return;
+  }
+  auto free_block = static_cast<FreeBlock*>(block);
+  free_block->next = size_class->free_list;
+  size_class->free_list = free_block;
+  size_class->stats.retained++;
+}
+
+void GenDataAllocator::clear() {
+  for (SizeClass& size_class : classes_) {
+    while (FreeBlock* block = size_class.free_list) {
+      size_class.free_list = block->next;
+      ::free(block);
+    }
+    size_class.stats.retained = 0;
+  }
+}
+
+GenDataAllocator::Stats GenDataAllocator::stats() const {
+  Stats stats;
+  stats.large_allocs = large_allocs_;
+  for (const SizeClass& size_class : classes_) {
+    stats.size_classes.push_back(size_class.stats);
+    stats.retained_bytes +=
+        size_class.stats.retained * blockBytes(size_class.stats.spill_words);
+  }
+  return stats;
+}
+
+} // namespace jit
@@ -0,0 +1,103 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#pragma once
+
+#include "cinderx/Jit/runtime.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace jit {
+
+// Allocates the blocks that hold a JIT generator's spilled state, each
+// followed by its GenDataFooter.
+//
+// Requests are rounded up to one of a fixed set of size classes, each with its
+// own free list, so that blocks freed by one generator can be reused by any
+// other generator in the same class. Each free list retains a bounded number
+// of bytes; blocks freed beyond that, and blocks too big for any class, go
+// back to malloc.
+//
+// All operations must be performed while holding the GIL.
+class GenDataAllocator {
+ public:
+  struct SizeClassStats {
+    // Spill words in each block of this class.
+    size_t spill_words{0};
+    // Blocks handed out.
+    size_t allocs{0};
+    // Blocks handed out from the free list rather than malloc.
+    size_t reuses{0};
+    // Blocks currently on the free list.
+    size_t retained{0};
+    // Blocks returned to malloc because the free list was full.
+    size_t released{0};
+  };
+
+  struct Stats {
+    std::vector<SizeClassStats> size_classes;
+    // Blocks too big for any size class.
+    size_t large_allocs{0};
+    // Total size of the blocks on all free lists.
+    size_t retained_bytes{0};
+  };
+
+  // Bytes each size class may keep on its free list.
+  static constexpr size_t kMaxRetainedBytesPerClass = 1 << 20;
+
+  GenDataAllocator();
+  ~GenDataAllocator();
+
+  // The allocator used for all JIT generators.
+  static GenDataAllocator& get();
+
+  // Return the number of spill words in the blocks used to satisfy a request
+  // for spill_words.
+  static size_t blockSpillWords(size_t spill_words);
+
+  // Allocate a block with room for at least spill_words words of spilled
+  // state, returning its footer with spillWords initialized and all other
+  // fields uninitialized.
+  GenDataFooter* allocate(size_t spill_words);
+
+  // Free a block returned by allocate().
+  void free(GenDataFooter* footer);
+
+  // Return all retained blocks to malloc.
+  void clear();
+
+  Stats stats() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct SizeClass {
+    FreeBlock* free_list{nullptr};
+    size_t max_retained{0};
+    SizeClassStats stats;
+  };
+
+  static constexpr std::array<size_t, 10> kSizeClassWords{
+      kMinGenSpillWords,
+      128,
+      192,
+      256,
+      384,
+      512,
+      768,
+      1024,
+      1536,
+      2048};
+
+  // Return the class used for blocks with spill_words spill words, or nullptr
+  // if they're too big for any class.
+  SizeClass* sizeClassFor(size_t spill_words);
+
+  std::array<SizeClass, kSizeClassWords.size()> classes_;
+  size_t large_allocs_{0};
+};
+
+} // namespace jit
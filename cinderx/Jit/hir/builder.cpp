@@ -25,7 +25,9 @@
 #include "cinderx/Jit/hir/type.h"
 #include "cinderx/Jit/profile_runtime.h"
 #include "cinderx/Jit/pyjit.h"
+#include "cinderx/Jit/runtime.h"
 #include "cinderx/Jit/threaded_compile.h"
+#include "cinderx/Jit/type_deopt_patchers.h"
 
 #include <folly/tracing/StaticTracepoint.h>
 
@@ -528,8 +530,10 @@ BasicBlock* HIRBuilder::getBlockAtOff(BCOffset off) {
   return it->second;
 }
 
-std::unique_ptr<Function> buildHIR(const Preloader& preloader) {
-  return HIRBuilder{preloader}.buildHIR();
+std::unique_ptr<Function> buildHIR(
+    const Preloader& preloader,
+    std::optional<OSREntry> osr_entry) {
+  return HIRBuilder{preloader}.buildHIR(osr_entry);
 }
 
 // This performs an abstract interpretation over the bytecode for func in order
@@ -544,14 +548,18 @@ std::unique_ptr<Function> buildHIR(const Preloader& preloader) {
 // bytecode that we currently support maintain this invariant. However, there
 // are a few bytecodes that do not (e.g. SETUP_FINALLY). We will need to deal
 // with that if we ever want to support compiling them.
-std::unique_ptr<Function> HIRBuilder::buildHIR() {
+std::unique_ptr<Function> HIRBuilder::buildHIR(
+    std::optional<OSREntry> osr_entry) {
   if (!can_translate(code_)) {
     JIT_DLOG("Can't translate all opcodes in {}", preloader_.fullname());
     return nullptr;
   }
 
   std::unique_ptr<Function> irfunc = preloader_.makeFunction();
-  buildHIRImpl(irfunc.get(), /*frame_state=*/nullptr);
+  irfunc->osr_entry = osr_entry;
+  if (buildHIRImpl(irfunc.get(), /*frame_state=*/nullptr) == nullptr) {
+    return nullptr;
+  }
   // Use RemoveTrampolineBlocks and RemoveUnreachableBlocks directly instead of
   // Run because the rest of CleanCFG requires SSA.
   CleanCFG::RemoveTrampolineBlocks(&irfunc->cfg);
@@ -567,6 +575,10 @@ BasicBlock* HIRBuilder::buildHIRImpl(
   BytecodeInstructionBlock bc_instrs{code_};
   block_map_ = createBlocks(*irfunc, bc_instrs);
 
+  if (frame_state == nullptr && irfunc->osr_entry.has_value()) {
+    return buildOSREntry(irfunc, bc_instrs);
+  }
+
   // Ensure that the entry block isn't a loop header
   BasicBlock* entry_block = getBlockAtOff(BCOffset{0});
   for (const auto& bci : bc_instrs) {
@@ -623,6 +635,52 @@ BasicBlock* HIRBuilder::buildHIRImpl(
   return entry_block;
 }
 
+BasicBlock* HIRBuilder::buildOSREntry(
+    Function* irfunc,
+    const BytecodeInstructionBlock& bc_instrs) {
+  const OSREntry& osr_entry = *irfunc->osr_entry;
+  auto header_it = block_map_.blocks.find(osr_entry.bc_offset);
+  if (header_it == block_map_.blocks.end()) {
+    JIT_DLOG(
+        "No block at OSR entry {} in {}",
+        osr_entry.bc_offset,
+        preloader_.fullname());
+    return nullptr;
+  }
+  BasicBlock* header = header_it->second;
+
+  BasicBlock* entry_block = irfunc->cfg.AllocateBlock();
+  irfunc->cfg.entry_block = entry_block;
+
+  TranslationContext entry_tc{
+      entry_block,
+      FrameState{
+          code_,
+          preloader_.globals(),
+          preloader_.builtins(),
+          /*parent=*/nullptr}};
+  AllocateRegistersForLocals(&irfunc->env, entry_tc.frame);
+  AllocateRegistersForCells(&irfunc->env, entry_tc.frame);
+
+  // Locals that haven't been assigned yet are passed as nullptr. Stack values
+  // go in the canonical stack registers that the loop's back edges will use.
+  int nlocals = code_->co_nlocals;
+  for (int i = 0; i < nlocals; i++) {
+    entry_tc.emit<LoadArg>(entry_tc.frame.locals[i], i, TOptObject);
+  }
+  for (int i = 0; i < osr_entry.stack_depth; i++) {
+    Register* reg = temps_.GetOrAllocateStack(i);
+    entry_tc.emit<LoadArg>(reg, nlocals + i, TObject);
+    entry_tc.frame.stack.push(reg);
+  }
+  entry_block->appendWithOff<Branch>(osr_entry.bc_offset, header);
+
+  entry_tc.block = header;
+  translate(*irfunc, bc_instrs, entry_tc);
+
+  return entry_block;
+}
+
 void HIRBuilder::emitProfiledTypes(
     TranslationContext& tc,
     const ProfileRuntime& profile_runtime,
@@ -633,9 +691,20 @@ void HIRBuilder::emitProfiledTypes(
     // about its stack inputs.
     return;
   }
-
-  std::vector<Type> types = profile_runtime.getProfiledTypes(
-      tc.frame.code, code_key, bc_instr.offset());
+  std::vector<Type> types;
+  {
+    // Profiles are recorded by threads running Python code, which may run
+    // concurrently with a background compile.
+    ThreadedCompileSerialize guard;
+    // The recompile happens right after the guard failures that caused it,
+    // with the same interpreter profile, so guarding on the profiled types
+    // again would fail the same way.
+    if (Runtime::get()->numReopts(tc.frame.code, bc_instr.offset()) > 0) {
+      return;
+    }
+    types = profile_runtime.getProfiledTypes(
+        tc.frame.code, code_key, bc_instr.offset());
+  }
 
   if (types.empty() || types.size() > tc.frame.stack.size()) {
     // The types are either absent or invalid (e.g., from a different version
@@ -2042,6 +2111,11 @@ bool HIRBuilder::emitInvokeMethod(
     return false;
   }
 
+  if (target.devirtualized_type != nullptr && !is_awaited && !is_classmethod) {
+    emitDevirtualizedInvokeMethod(tc, bc_instr, target, nargs);
+    return false;
+  }
+
   std::vector<Register*> arg_regs =
       setupStaticArgs(tc, target, nargs, target.is_statically_typed);
 
@@ -2075,6 +2149,38 @@ bool HIRBuilder::emitInvokeMethod(
   return true;
 }
 
+void HIRBuilder::emitDevirtualizedInvokeMethod(
+    TranslationContext& tc,
+    const jit::BytecodeInstruction& bc_instr,
+    const InvokeTarget& target,
+    long nargs) {
+  // No type in the receiver's hierarchy overrides the method, so call it
+  // directly rather than through the vtable. If that stops being true, the
+  // patchpoint deopts and the interpreter performs the INVOKE_METHOD.
+  FrameState deopt_state = tc.frame;
+  deopt_state.next_instr_offset = bc_instr.offset();
+  auto patchpoint = tc.emit<DeoptPatchpoint>(
+      Runtime::get()->allocateDeoptPatcher<MethodOverrideDeoptPatcher>(
+          target.devirtualized_type, target.method_name, target.callable));
+  patchpoint->setFrameState(deopt_state);
+  patchpoint->setGuiltyReg(tc.frame.stack.peek(nargs));
+  patchpoint->setDescr("devirtualized INVOKE_METHOD");
+
+  jit::tryCompilePreloaded(target.func());
+
+  Register* funcreg = temps_.AllocateStack();
+  tc.emit<LoadConst>(funcreg, Type::fromObject(target.callable));
+  Register* out = temps_.AllocateStack();
+  auto call = tc.emit<InvokeStaticFunction>(
+      nargs + 1, out, target.func(), target.return_type);
+  call->SetOperand(0, funcreg);
+  for (auto i = nargs - 1; i >= 0; i--) {
+    call->SetOperand(i + 1, tc.frame.stack.pop());
+  }
+  call->setFrameState(tc.frame);
+  tc.frame.stack.push(out);
+}
+
 void HIRBuilder::emitIsOp(TranslationContext& tc, int oparg) {
   auto& stack = tc.frame.stack;
   Register* right = stack.pop();
@@ -2524,7 +2630,10 @@ static inline Type element_type_from_seq_type(int seq_type) {
     case SEQ_TUPLE:
       return TObject;
     case SEQ_ARRAY_INT64:
+    case SEQ_CHECKED_LIST_INT64:
       return TCInt64;
+    case SEQ_CHECKED_LIST_DOUBLE:
+      return TCDouble;
     default:
       JIT_ABORT("Invalid sequence type: ({})", seq_type);
       // NOTREACHED
@@ -2741,6 +2850,10 @@ void HIRBuilder::emitSequenceGet(
       oparg == SEQ_CHECKED_LIST) {
     int offset = offsetof(PyListObject, ob_item);
     tc.emit<LoadField>(ob_item, sequence, "ob_item", offset, TCPtr);
+  } else if (
+      oparg == SEQ_CHECKED_LIST_INT64 || oparg == SEQ_CHECKED_LIST_DOUBLE) {
+    int offset = offsetof(Ci_CheckedPrimitiveListObject, ob_item);
+    tc.emit<LoadField>(ob_item, sequence, "ob_item", offset, TCPtr);
   } else if (oparg == SEQ_ARRAY_INT64) {
     Register* offset_reg = temps_.AllocateStack();
     tc.emit<LoadConst>(
@@ -2784,6 +2897,10 @@ void HIRBuilder::emitSequenceSet(
   } else if (oparg == SEQ_LIST || oparg == SEQ_LIST_INEXACT) {
     int offset = offsetof(PyListObject, ob_item);
     tc.emit<LoadField>(ob_item, sequence, "ob_item", offset, TCPtr);
+  } else if (
+      oparg == SEQ_CHECKED_LIST_INT64 || oparg == SEQ_CHECKED_LIST_DOUBLE) {
+    int offset = offsetof(Ci_CheckedPrimitiveListObject, ob_item);
+    tc.emit<LoadField>(ob_item, sequence, "ob_item", offset, TCPtr);
   } else {
     JIT_ABORT("Unsupported oparg for SEQUENCE_SET: {}", oparg);
   }
@@ -2808,6 +2925,13 @@ void HIRBuilder::emitLoadGlobal(
     }
     tc.emit<LoadGlobalCached>(
         result, code_, preloader_.builtins(), preloader_.globals(), name_idx);
+    // A recompile guards on the global's new value, but once it has been
+    // rebound again after that, guarding on its current value only leads to
+    // deopts.
+    if (THREADED_COMPILE_SERIALIZED_CALL(
+            Runtime::get()->numReopts(code_, bc_instr.offset())) >= 2) {
+      return true;
+    }
     auto guard_is = tc.emit<GuardIs>(result, value, result);
     BorrowedRef<> name = PyTuple_GET_ITEM(code_->co_names, name_idx);
     guard_is->setDescr(fmt::format("LOAD_GLOBAL: {}", PyUnicode_AsUTF8(name)));
@@ -15,6 +15,7 @@
 #include <deque>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -88,7 +89,13 @@ class BlockCanonicalizer {
 // refcount operations or types flowed through it. Later passes will transform
 // to SSA, flow types, optimize, and insert refcount operations using liveness
 // analysis.
-std::unique_ptr<Function> buildHIR(const Preloader& preloader);
+//
+// If osr_entry is given, the resulting function is an on-stack replacement
+// entry that starts executing at the given loop header instead of at the
+// beginning of the code.
+std::unique_ptr<Function> buildHIR(
+    const Preloader& preloader,
+    std::optional<OSREntry> osr_entry = std::nullopt);
 
 // Inlining merges all of the different callee Returns (which terminate blocks,
 // leading to a bunch of distinct exit blocks) into Branches to one Return
@@ -120,7 +127,8 @@ class HIRBuilder {
   //
   // TODO(mpage): Consider using something like Either here to indicate reason
   // for failure.
-  std::unique_ptr<Function> buildHIR();
+  std::unique_ptr<Function> buildHIR(
+      std::optional<OSREntry> osr_entry = std::nullopt);
 
   // Given the preloader for the callee (passed into the constructor),
   // construct the CFG for the callee in the caller's CFG. Does not link the
@@ -140,6 +148,13 @@ class HIRBuilder {
   // Returns the entry block.
   BasicBlock* buildHIRImpl(Function* irfunc, FrameState* frame_state);
 
+  // Used by buildHIRImpl for OSR entries. Loads the frame's locals and stack
+  // from the arguments and translates the code reachable from the loop
+  // header. Returns nullptr if the loop header doesn't start a block.
+  BasicBlock* buildOSREntry(
+      Function* irfunc,
+      const jit::BytecodeInstructionBlock& bc_instrs);
+
   struct TranslationContext;
   void translate(
       Function& irfunc,
@@ -289,6 +304,11 @@ class HIRBuilder {
       TranslationContext& tc,
       const jit::BytecodeInstruction& bc_instr,
       bool is_awaited);
+  void emitDevirtualizedInvokeMethod(
+      TranslationContext& tc,
+      const jit::BytecodeInstruction& bc_instr,
+      const InvokeTarget& target,
+      long nargs);
   void emitLoadField(
       TranslationContext& tc,
       const jit::BytecodeInstruction& bc_instr);
@@ -0,0 +1,564 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Common/log.h"
+
+#include "cinderx/Jit/hir/hir.h"
+#include "cinderx/Jit/hir/optimization.h"
+#include "cinderx/Jit/hir/ssa.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jit::hir {
+
+// This file contains the FloatUnboxing pass, which keeps the results of float
+// arithmetic in XMM registers instead of allocating a float object for every
+// intermediate value.
+//
+// A register is float-valued if its type is already FloatExact, or if it's
+// defined by arithmetic (BinaryOp, InPlaceOp, UnaryOp<Negate>) or a Phi whose
+// operands are all float-valued. Int constants that convert to double exactly
+// may also appear as one operand of the arithmetic, since float's methods
+// convert them the same way. This is solved optimistically: we start by
+// assuming every candidate is float-valued and drop the ones whose operands
+// aren't until nothing changes, which lets loop-carried values through Phis
+// whose types the rest of the compiler sees as Object.
+//
+// Arithmetic on float-valued registers becomes a DoubleBinaryOp followed by a
+// PrimitiveBox of its result. Users that can work on the unboxed value (other
+// float arithmetic, ordered Compare and CompareBool) are switched over to it,
+// so the box is only needed at escape points. Simplify and DeadCodeElimination
+// remove boxes with no remaining users, and ScalarReplacement removes boxes
+// that are only referenced from FrameStates.
+//
+// Float-valued Phis get a CDouble Phi next to them and are then removed. Each
+// remaining user of the old Phi gets its own box, inserted before it using the
+// FrameState of the closest Snapshot, and FrameStates that referred to the Phi
+// get a VirtualObject so the interpreter still sees a float on deopt. This
+// means a value that leaves a loop is boxed once, when it leaves, rather than
+// on every iteration. Phis with users that can't be boxed this way are left
+// alone.
+//
+// Division is only unboxed when dividing by a nonzero constant, since dividing
+// by zero has to raise ZeroDivisionError. Equality comparisons are left alone,
+// since the backend can't tell an unordered comparison from an equal one.
+
+namespace {
+
+// Return the arithmetic that instr performs, if DoubleBinaryOp computes it the
+// same way float does.
+std::optional<BinaryOpKind> floatBinaryOpKind(const Instr& instr) {
+  if (instr.IsBinaryOp()) {
+    BinaryOpKind op = static_cast<const BinaryOp&>(instr).op();
+    switch (op) {
+      case BinaryOpKind::kAdd:
+      case BinaryOpKind::kSubtract:
+      case BinaryOpKind::kMultiply:
+      case BinaryOpKind::kTrueDivide:
+        return op;
+      default:
+        return std::nullopt;
+    }
+  }
+  if (instr.IsInPlaceOp()) {
+    // float doesn't implement any in-place methods, so these behave exactly
+    // like the corresponding binary operations.
+    switch (static_cast<const InPlaceOp&>(instr).op()) {
+      case InPlaceOpKind::kAdd:
+        return BinaryOpKind::kAdd;
+      case InPlaceOpKind::kSubtract:
+        return BinaryOpKind::kSubtract;
+      case InPlaceOpKind::kMultiply:
+        return BinaryOpKind::kMultiply;
+      case InPlaceOpKind::kTrueDivide:
+        return BinaryOpKind::kTrueDivide;
+      default:
+        return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+bool isFloatNegate(const Instr& instr) {
+  return instr.IsUnaryOp() &&
+      static_cast<const UnaryOp&>(instr).op() == UnaryOpKind::kNegate;
+}
+
+// Return the unboxed comparison for an ordered Compare or CompareBool, and
+// whether its operands have to be swapped. The backend compares doubles with
+// comisd, for which only the unsigned above and above-or-equal conditions are
+// false when either side is NaN.
+std::optional<std::pair<PrimitiveCompareOp, bool>> floatCompareOp(
+    const Instr& instr) {
+  CompareOp op;
+  if (instr.IsCompare()) {
+    op = static_cast<const Compare&>(instr).op();
+  } else if (instr.IsCompareBool()) {
+    op = static_cast<const CompareBool&>(instr).op();
+  } else {
+    return std::nullopt;
+  }
+  switch (op) {
+    case CompareOp::kGreaterThan:
+      return std::pair{PrimitiveCompareOp::kGreaterThanUnsigned, false};
+    case CompareOp::kGreaterThanEqual:
+      return std::pair{PrimitiveCompareOp::kGreaterThanEqualUnsigned, false};
+    case CompareOp::kLessThan:
+      return std::pair{PrimitiveCompareOp::kGreaterThanUnsigned, true};
+    case CompareOp::kLessThanEqual:
+      return std::pair{PrimitiveCompareOp::kGreaterThanEqualUnsigned, true};
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns true if reg is an int constant that converts to double without
+// rounding.
+bool isExactDoubleIntConst(Register* reg) {
+  Type type = reg->type();
+  if (!(type <= TLongExact && type.hasObjectSpec())) {
+    return false;
+  }
+  constexpr long kMaxExact = 1L << 53;
+  int overflow = 0;
+  long value = PyLong_AsLongAndOverflow(type.objectSpec(), &overflow);
+  return overflow == 0 && value >= -kMaxExact && value <= kMaxExact;
+}
+
+bool isNonZeroConst(Register* reg) {
+  Type type = reg->type();
+  if (type <= TFloatExact && type.hasObjectSpec()) {
+    return PyFloat_AS_DOUBLE(type.objectSpec()) != 0.0;
+  }
+  return isExactDoubleIntConst(reg) && Py_SIZE(type.objectSpec()) != 0;
+}
+
+class FloatUnboxer {
+ public:
+  explicit FloatUnboxer(Function& func) : func_(func) {}
+
+  // Returns the number of arithmetic and comparison instructions unboxed.
+  int run();
+
+ private:
+  void collect();
+  bool isFloat(Register* reg) const;
+  bool canUnboxOperands(Register* lhs, Register* rhs) const;
+  bool isConsumer(const Instr& instr) const;
+  bool isFloatValued(Register* reg, const Instr& instr);
+  Snapshot* boxSnapshot(Instr& site);
+  std::vector<Instr*> boxSites(Instr& user, Register* phi);
+
+  Register* unboxedAt(Register* reg, Instr& before);
+  void rewriteArithmetic(Instr& instr);
+  void rewriteCompare(Instr& instr);
+  void rewritePhi(Phi& phi);
+  void boxUses(Register* phi, const std::vector<Instr*>& users);
+  void virtualizeFrameStates();
+
+  Function& func_;
+
+  // Registers that are assumed to be float-valued, and their definitions.
+  std::unordered_map<Register*, Instr*> candidates_;
+
+  // Non-FrameState users of each register.
+  std::unordered_map<Register*, std::vector<Instr*>> users_;
+
+  // Registers referenced from more than one frame of a FrameState chain.
+  std::unordered_set<Register*> shared_;
+
+  // The Snapshot whose FrameState a box inserted before an instruction would
+  // use, or nullptr if there isn't one.
+  std::unordered_map<Instr*, Snapshot*> box_snapshots_;
+
+  // The CDouble holding the value of each float-valued register.
+  std::unordered_map<Register*, Register*> unboxed_;
+
+  std::vector<Register*> removed_phis_;
+  int num_unboxed_{0};
+};
+
+void FloatUnboxer::collect() {
+  for (BasicBlock* block : func_.cfg.GetRPOTraversal()) {
+    for (auto& instr : *block) {
+      for (Register* reg : instr.GetOperands()) {
+        users_[reg].emplace_back(&instr);
+      }
+
+      // Like ScalarReplacement, give up on values that would be rebuilt once
+      // per frame on deopt.
+      FrameState* fs = nullptr;
+      if (auto deopt = instr.asDeoptBase()) {
+        fs = deopt->frameState();
+      } else if (instr.IsSnapshot()) {
+        fs = static_cast<Snapshot&>(instr).frameState();
+      }
+      std::unordered_map<Register*, const FrameState*> seen;
+      for (; fs != nullptr; fs = fs->parent) {
+        auto visit = [&](Register* reg) {
+          auto [it, inserted] = seen.emplace(reg, fs);
+          if (!inserted && it->second != fs) {
+            shared_.emplace(reg);
+          }
+        };
+        for (Register* reg : fs->locals) {
+          visit(reg);
+        }
+        for (Register* reg : fs->cells) {
+          visit(reg);
+        }
+        for (Register* reg : fs->stack) {
+          visit(reg);
+        }
+      }
+
+      Register* output = instr.GetOutput();
+      if (instr.IsPhi() || floatBinaryOpKind(instr).has_value() ||
+          isFloatNegate(instr)) {
+        candidates_.emplace(output, &instr);
+      }
+    }
+  }
+}
+
+bool FloatUnboxer::isFloat(Register* reg) const {
+  return candidates_.count(reg) != 0 || reg->isA(TFloatExact);
+}
+
+bool FloatUnboxer::canUnboxOperands(Register* lhs, Register* rhs) const {
+  if (isFloat(lhs)) {
+    return isFloat(rhs) || isExactDoubleIntConst(rhs);
+  }
+  return isFloat(rhs) && isExactDoubleIntConst(lhs);
+}
+
+bool FloatUnboxer::isConsumer(const Instr& instr) const {
+  Register* output = instr.GetOutput();
+  if (output != nullptr && candidates_.count(output) != 0) {
+    return true;
+  }
+  return floatCompareOp(instr).has_value() &&
+      canUnboxOperands(instr.GetOperand(0), instr.GetOperand(1));
+}
+
+Snapshot* FloatUnboxer::boxSnapshot(Instr& site) {
+  auto [it, inserted] = box_snapshots_.emplace(&site, nullptr);
+  if (!inserted) {
+    return it->second;
+  }
+  // Deopting from the box resumes at the Snapshot, so everything between them
+  // has to be safe to execute again.
+  BasicBlock* block = site.block();
+  for (auto rit = std::make_reverse_iterator(block->iterator_to(site));
+       rit != block->rend();
+       ++rit) {
+    if (rit->IsSnapshot()) {
+      it->second = static_cast<Snapshot*>(&*rit);
+      break;
+    }
+    if (!rit->isReplayable()) {
+      break;
+    }
+  }
+  return it->second;
+}
+
+std::vector<Instr*> FloatUnboxer::boxSites(Instr& user, Register* phi) {
+  if (!user.IsPhi()) {
+    return {&user};
+  }
+  auto& user_phi = static_cast<Phi&>(user);
+  std::vector<Instr*> sites;
+  for (std::size_t i = 0, n = user_phi.NumOperands(); i < n; ++i) {
+    if (user_phi.GetOperand(i) == phi) {
+      sites.emplace_back(user_phi.basic_blocks()[i]->GetTerminator());
+    }
+  }
+  return sites;
+}
+
+bool FloatUnboxer::isFloatValued(Register* reg, const Instr& instr) {
+  if (isFloatNegate(instr)) {
+    return isFloat(instr.GetOperand(0));
+  }
+  if (std::optional<BinaryOpKind> op = floatBinaryOpKind(instr)) {
+    Register* lhs = instr.GetOperand(0);
+    Register* rhs = instr.GetOperand(1);
+    if (*op == BinaryOpKind::kTrueDivide && !isNonZeroConst(rhs)) {
+      return false;
+    }
+    return canUnboxOperands(lhs, rhs);
+  }
+
+  JIT_DCHECK(instr.IsPhi(), "Unexpected candidate {}", instr.opname());
+  if (shared_.count(reg) != 0) {
+    return false;
+  }
+  for (Register* input : instr.GetOperands()) {
+    if (!isFloat(input)) {
+      return false;
+    }
+  }
+  // Only replace Phis whose values are used unboxed somewhere; otherwise we'd
+  // just be moving boxes around.
+  bool has_consumer = false;
+  auto users = users_.find(reg);
+  if (users == users_.end()) {
+    return false;
+  }
+  for (Instr* user : users->second) {
+    if (isConsumer(*user)) {
+      has_consumer = true;
+    } else if (!user->IsUseType()) {
+      for (Instr* site : boxSites(*user, reg)) {
+        if (boxSnapshot(*site) == nullptr) {
+          return false;
+        }
+      }
+    }
+  }
+  return has_consumer;
+}
+
+Register* FloatUnboxer::unboxedAt(Register* reg, Instr& before) {
+  auto it = unboxed_.find(reg);
+  if (it != unboxed_.end()) {
+    return it->second;
+  }
+  Register* result = func_.env.AllocateRegister();
+  Instr* unbox;
+  if (reg->isA(TFloatExact)) {
+    unbox = PrimitiveUnbox::create(result, reg, TCDouble);
+  } else {
+    JIT_DCHECK(
+        isExactDoubleIntConst(reg), "Can't unbox {} as a double", reg->name());
+    unbox = LoadConst::create(
+        result, Type::fromCDouble(PyLong_AsDouble(reg->type().objectSpec())));
+  }
+  unbox->copyBytecodeOffset(before);
+  unbox->InsertBefore(before);
+  return result;
+}
+
+void FloatUnboxer::rewriteArithmetic(Instr& instr) {
+  Register* left;
+  Register* right;
+  BinaryOpKind op;
+  if (isFloatNegate(instr)) {
+    // Multiplying by -1.0 flips the sign of zeros and infinities too.
+    left = unboxedAt(instr.GetOperand(0), instr);
+    right = func_.env.AllocateRegister();
+    auto minus_one = LoadConst::create(right, Type::fromCDouble(-1.0));
+    minus_one->copyBytecodeOffset(instr);
+    minus_one->InsertBefore(instr);
+    op = BinaryOpKind::kMultiply;
+  } else {
+    left = unboxedAt(instr.GetOperand(0), instr);
+    right = unboxedAt(instr.GetOperand(1), instr);
+    op = *floatBinaryOpKind(instr);
+  }
+
+  Register* result = func_.env.AllocateRegister();
+  auto double_op = DoubleBinaryOp::create(result, op, left, right);
+  double_op->copyBytecodeOffset(instr);
+  double_op->InsertBefore(instr);
+
+  auto box = PrimitiveBox::create(
+      instr.GetOutput(),
+      result,
+      TCDouble,
+      *instr.asDeoptBase()->frameState());
+  box->copyBytecodeOffset(instr);
+  instr.ReplaceWith(*box);
+  delete &instr;
+
+  unboxed_[box->GetOutput()] = result;
+  num_unboxed_++;
+}
+
+void FloatUnboxer::rewriteCompare(Instr& instr) {
+  auto [op, swap] = *floatCompareOp(instr);
+  Register* left = unboxedAt(instr.GetOperand(0), instr);
+  Register* right = unboxedAt(instr.GetOperand(1), instr);
+  if (swap) {
+    std::swap(left, right);
+  }
+
+  Register* result = func_.env.AllocateRegister();
+  auto compare = PrimitiveCompare::create(result, op, left, right);
+  compare->copyBytecodeOffset(instr);
+  compare->InsertBefore(instr);
+
+  Instr* replacement;
+  if (instr.IsCompareBool()) {
+    replacement = IntConvert::create(instr.GetOutput(), result, TCInt32);
+  } else {
+    replacement = PrimitiveBoxBool::create(instr.GetOutput(), result);
+  }
+  replacement->copyBytecodeOffset(instr);
+  instr.ReplaceWith(*replacement);
+  delete &instr;
+  num_unboxed_++;
+}
+
+void FloatUnboxer::rewritePhi(Phi& phi) {
+  std::unordered_map<BasicBlock*, Register*> args;
+  for (std::size_t i = 0, n = phi.NumOperands(); i < n; ++i) {
+    BasicBlock* pred = phi.basic_blocks()[i];
+    args[pred] = unboxedAt(phi.GetOperand(i), *pred->GetTerminator());
+  }
+  Register* unboxed = unboxed_.at(phi.GetOutput());
+  phi.block()->push_front(Phi::create(unboxed, args));
+}
+
+void FloatUnboxer::boxUses(Register* phi, const std::vector<Instr*>& users) {
+  for (Instr* user : users) {
+    if (user->IsUseType()) {
+      user->unlink();
+      delete user;
+      continue;
+    }
+    for (Instr* site : boxSites(*user, phi)) {
+      Snapshot* snapshot = boxSnapshot(*site);
+      JIT_CHECK(snapshot != nullptr, "No Snapshot to box {}", phi->name());
+      Register* boxed = func_.env.AllocateRegister();
+      auto box = PrimitiveBox::create(
+          boxed, unboxed_.at(phi), TCDouble, *snapshot->frameState());
+      box->copyBytecodeOffset(*site);
+      box->InsertBefore(*site);
+
+      if (user->IsPhi()) {
+        auto& user_phi = static_cast<Phi&>(*user);
+        user_phi.SetOperand(user_phi.blockIndex(site->block()), boxed);
+        continue;
+      }
+      for (std::size_t i = 0, n = user->NumOperands(); i < n; ++i) {
+        if (user->GetOperand(i) == phi) {
+          user->SetOperand(i, boxed);
+        }
+      }
+      if (auto deopt = user->asDeoptBase()) {
+        if (deopt->guiltyReg() == phi) {
+          deopt->setGuiltyReg(boxed);
+        }
+      }
+    }
+  }
+}
+
+void FloatUnboxer::virtualizeFrameStates() {
+  std::unordered_set<Register*> removed(
+      removed_phis_.begin(), removed_phis_.end());
+  for (auto& block : func_.cfg.blocks) {
+    for (auto& instr : block) {
+      FrameState* fs = nullptr;
+      if (auto deopt = instr.asDeoptBase()) {
+        fs = deopt->frameState();
+      } else if (instr.IsSnapshot()) {
+        fs = static_cast<Snapshot&>(instr).frameState();
+      }
+      for (; fs != nullptr; fs = fs->parent) {
+        auto visit = [&](Register* reg) {
+          if (removed.count(reg) == 0 || fs->findVirtualObject(reg) != nullptr) {
+            return;
+          }
+          fs->virtual_objects.emplace_back(VirtualObject{
+              VirtualObject::Kind::kFloat, reg, {unboxed_.at(reg)}});
+        };
+        for (Register* reg : fs->locals) {
+          visit(reg);
+        }
+        for (Register* reg : fs->cells) {
+          visit(reg);
+        }
+        for (Register* reg : fs->stack) {
+          visit(reg);
+        }
+      }
+    }
+  }
+}
+
+int FloatUnboxer::run() {
+  collect();
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+      if (isFloatValued(it->first, *it->second)) {
+        ++it;
+      } else {
+        it = candidates_.erase(it);
+        changed = true;
+      }
+    }
+  }
+  if (candidates_.empty()) {
+    return 0;
+  }
+
+  // Find the users of each Phi that need it boxed before rewriting anything,
+  // since rewriting deletes the others.
+  std::vector<std::pair<Phi*, std::vector<Instr*>>> phis;
+  for (auto& [reg, instr] : candidates_) {
+    if (!instr->IsPhi()) {
+      continue;
+    }
+    std::vector<Instr*> escapes;
+    for (Instr* user : users_[reg]) {
+      if (!isConsumer(*user) &&
+          std::find(escapes.begin(), escapes.end(), user) == escapes.end()) {
+        escapes.emplace_back(user);
+      }
+    }
+    phis.emplace_back(static_cast<Phi*>(instr), std::move(escapes));
+    unboxed_[reg] = func_.env.AllocateRegister();
+  }
+
+  // Definitions come before their uses in RPO, except for Phi inputs, so all
+  // unboxed operands are available by the time we reach an instruction.
+  for (BasicBlock* block : func_.cfg.GetRPOTraversal()) {
+    for (auto it = block->begin(); it != block->end();) {
+      Instr& instr = *it;
+      ++it;
+      if (instr.IsPhi()) {
+        continue;
+      }
+      Register* output = instr.GetOutput();
+      if (output != nullptr && candidates_.count(output) != 0) {
+        rewriteArithmetic(instr);
+      } else if (isConsumer(instr)) {
+        rewriteCompare(instr);
+      }
+    }
+  }
+
+  for (auto& [phi, escapes] : phis) {
+    rewritePhi(*phi);
+  }
+  for (auto& [phi, escapes] : phis) {
+    Register* reg = phi->GetOutput();
+    boxUses(reg, escapes);
+    phi->unlink();
+    delete phi;
+    reg->set_instr(nullptr);
+    removed_phis_.emplace_back(reg);
+  }
+  virtualizeFrameStates();
+  return num_unboxed_;
+}
+
+} // namespace
+
+void FloatUnboxing::Run(Function& irfunc) {
+  int num_unboxed = FloatUnboxer{irfunc}.run();
+  if (num_unboxed == 0) {
+    return;
+  }
+  irfunc.optimization_stats.num_float_ops_unboxed += num_unboxed;
+  reflowTypes(irfunc);
+}
+
+} // namespace jit::hir
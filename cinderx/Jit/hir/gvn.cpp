@@ -0,0 +1,316 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Common/log.h"
+#include "cinderx/Common/util.h"
+
+#include "cinderx/Jit/hir/analysis.h"
+#include "cinderx/Jit/hir/hir.h"
+#include "cinderx/Jit/hir/memory_effects.h"
+#include "cinderx/Jit/hir/optimization.h"
+#include "cinderx/Jit/hir/ssa.h"
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace jit::hir {
+
+// This file contains the GlobalValueNumbering pass, which removes instructions
+// that recompute a value already computed by a dominating instruction.
+//
+// The dominator tree is walked in preorder, keeping a table of the values
+// available at the current point, keyed by opcode, operands, and any other
+// attributes that affect the result. There are two kinds of entries:
+// - Pure values (PrimitiveUnbox, IntBinaryOp, GuardType, ...) depend only on
+//   their operands, so they are available in every block their definition
+//   dominates.
+// - Loads (LoadField, LoadGlobalCached, ...) also depend on the contents of
+//   memory. An available load is killed by any instruction whose
+//   memoryEffects() may store to the location it reads. Loads are only carried
+//   from a block into its dominator-tree children whose sole predecessor is
+//   that block; any other path could contain a store we haven't seen.
+//
+// LoadAttr isn't numbered, since it can run arbitrary code (descriptors,
+// __getattr__) and produce a different value every time.
+
+namespace {
+
+// Describes the value computed by an instruction. Two instructions with equal
+// keys compute the same value, provided no memory they read has changed.
+struct ValueKey {
+  Opcode opcode;
+  std::array<Register*, 3> operands{};
+  std::array<std::uintptr_t, 3> attrs{};
+  Type type{TBottom};
+
+  bool operator==(const ValueKey& other) const {
+    return opcode == other.opcode && operands == other.operands &&
+        attrs == other.attrs && type == other.type;
+  }
+};
+
+struct ValueKeyHash {
+  std::size_t operator()(const ValueKey& key) const {
+    std::size_t hash = static_cast<std::size_t>(key.opcode);
+    for (Register* reg : key.operands) {
+      hash = combineHash(hash, std::hash<Register*>{}(reg));
+    }
+    for (std::uintptr_t attr : key.attrs) {
+      hash = combineHash(hash, attr);
+    }
+    return combineHash(hash, key.type.hash());
+  }
+};
+
+// Values whose truthiness can't change and can be computed without running
+// user code.
+const Type kImmutableTruthiness = TBool | TLongExact | TFloatExact |
+    TUnicodeExact | TTupleExact | TBytesExact | TNoneType;
+
+// Fill in key for instr and return the memory location it reads, which is
+// AEmpty for pure values. Returns std::nullopt if instr isn't a candidate for
+// numbering.
+std::optional<AliasClass> describeValue(const Instr& instr, ValueKey& key) {
+  // Reusing a value extends its live range, possibly across a deopt point, and
+  // raw pointers can't be described in deopt metadata.
+  Register* output = instr.GetOutput();
+  if (output != nullptr && output->type().couldBe(TCPtr)) {
+    return std::nullopt;
+  }
+
+  key.opcode = instr.opcode();
+  std::size_t num_operands = instr.NumOperands();
+  if (num_operands > key.operands.size()) {
+    return std::nullopt;
+  }
+  for (std::size_t i = 0; i < num_operands; ++i) {
+    key.operands[i] = instr.GetOperand(i);
+  }
+
+  switch (instr.opcode()) {
+    case Opcode::kDoubleBinaryOp:
+      key.attrs[0] = static_cast<std::uintptr_t>(
+          static_cast<const DoubleBinaryOp&>(instr).op());
+      return AEmpty;
+    case Opcode::kIntBinaryOp:
+      key.attrs[0] = static_cast<std::uintptr_t>(
+          static_cast<const IntBinaryOp&>(instr).op());
+      return AEmpty;
+    case Opcode::kIntConvert:
+      key.type = static_cast<const IntConvert&>(instr).type();
+      return AEmpty;
+    case Opcode::kPrimitiveCompare:
+      key.attrs[0] = static_cast<std::uintptr_t>(
+          static_cast<const PrimitiveCompare&>(instr).op());
+      return AEmpty;
+    case Opcode::kPrimitiveUnaryOp:
+      key.attrs[0] = static_cast<std::uintptr_t>(
+          static_cast<const PrimitiveUnaryOp&>(instr).op());
+      return AEmpty;
+    case Opcode::kPrimitiveUnbox:
+      key.type = static_cast<const PrimitiveUnbox&>(instr).type();
+      return AEmpty;
+    case Opcode::kGuardIs:
+      key.attrs[0] = reinterpret_cast<std::uintptr_t>(
+          static_cast<const GuardIs&>(instr).target());
+      return AEmpty;
+    case Opcode::kGuardType:
+      key.type = static_cast<const GuardType&>(instr).target();
+      return AEmpty;
+    case Opcode::kIsTruthy:
+      if (!(instr.GetOperand(0)->type() <= kImmutableTruthiness)) {
+        return std::nullopt;
+      }
+      return AEmpty;
+    case Opcode::kLoadTupleItem:
+      key.attrs[0] = static_cast<const LoadTupleItem&>(instr).idx();
+      return ATupleItem;
+    case Opcode::kLoadCellItem:
+      return ACellItem;
+    case Opcode::kLoadField: {
+      auto& load = static_cast<const LoadField&>(instr);
+      key.attrs[0] = load.offset();
+      key.attrs[1] = load.borrowed();
+      key.type = load.type();
+      return AInObjectAttr;
+    }
+    case Opcode::kLoadGlobalCached: {
+      auto& load = static_cast<const LoadGlobalCached&>(instr);
+      key.attrs[0] = load.name_idx();
+      key.attrs[1] = reinterpret_cast<std::uintptr_t>(load.globals().get());
+      key.attrs[2] = reinterpret_cast<std::uintptr_t>(load.builtins().get());
+      return AGlobal;
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+struct AvailableLoad {
+  Register* value;
+  AliasClass location;
+};
+
+using LoadTable = std::unordered_map<ValueKey, AvailableLoad, ValueKeyHash>;
+
+class ValueNumberer {
+ public:
+  explicit ValueNumberer(Function& func) : func_(func), doms_(func) {}
+
+  // Returns the number of instructions removed.
+  int run();
+
+ private:
+  void processBlock(BasicBlock* block, LoadTable& loads);
+  void killLoads(LoadTable& loads, AliasClass stores);
+  void eliminate(Instr& instr, Register* value);
+
+  Function& func_;
+  DominatorAnalysis doms_;
+
+  // Pure values available at the current point of the dominator tree walk,
+  // along with an undo log to restore the table when leaving a subtree.
+  std::unordered_map<ValueKey, Register*, ValueKeyHash> values_;
+  std::vector<std::pair<ValueKey, Register*>> undo_log_;
+
+  // Maps the output of each removed instruction to the value replacing it.
+  // Operands are canonicalized through this before building a key, since the
+  // Assigns we leave behind aren't cleaned up until after the pass.
+  std::unordered_map<Register*, Register*> replacements_;
+
+  int num_eliminated_{0};
+};
+
+void ValueNumberer::killLoads(LoadTable& loads, AliasClass stores) {
+  if (stores == AEmpty) {
+    return;
+  }
+  for (auto it = loads.begin(); it != loads.end();) {
+    if ((it->second.location & stores) != AEmpty) {
+      it = loads.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ValueNumberer::eliminate(Instr& instr, Register* value) {
+  if (Register* output = instr.GetOutput()) {
+    replacements_[output] = value;
+    auto assign = Assign::create(output, value);
+    assign->copyBytecodeOffset(instr);
+    instr.ReplaceWith(*assign);
+  } else {
+    instr.unlink();
+  }
+  delete &instr;
+  num_eliminated_++;
+}
+
+void ValueNumberer::processBlock(BasicBlock* block, LoadTable& loads) {
+  for (auto it = block->begin(); it != block->end();) {
+    Instr& instr = *it;
+    ++it;
+    if (instr.IsPhi() || instr.IsTerminator() || instr.IsSnapshot()) {
+      continue;
+    }
+    instr.visitUses([&](Register*& reg) {
+      auto found = replacements_.find(reg);
+      if (found != replacements_.end()) {
+        reg = found->second;
+      }
+      return true;
+    });
+
+    ValueKey key;
+    std::optional<AliasClass> location = describeValue(instr, key);
+    if (location.has_value() && *location == AEmpty) {
+      auto found = values_.find(key);
+      if (found != values_.end()) {
+        eliminate(instr, found->second);
+        continue;
+      }
+      if (Register* output = instr.GetOutput()) {
+        values_.emplace(key, output);
+        undo_log_.emplace_back(key, output);
+      } else {
+        values_.emplace(key, nullptr);
+        undo_log_.emplace_back(key, nullptr);
+      }
+      continue;
+    }
+
+    if (location.has_value()) {
+      auto found = loads.find(key);
+      if (found != loads.end()) {
+        eliminate(instr, found->second.value);
+        continue;
+      }
+    }
+    killLoads(loads, memoryEffects(instr).may_store);
+    if (location.has_value()) {
+      loads.insert_or_assign(
+          key, AvailableLoad{instr.GetOutput(), *location});
+    }
+  }
+}
+
+int ValueNumberer::run() {
+  std::unordered_map<const BasicBlock*, std::vector<BasicBlock*>> children;
+  std::vector<BasicBlock*> rpo = func_.cfg.GetRPOTraversal();
+  for (BasicBlock* block : rpo) {
+    if (block == func_.cfg.entry_block) {
+      continue;
+    }
+    children[doms_.immediateDominator(block)].emplace_back(block);
+  }
+
+  struct Visit {
+    BasicBlock* block;
+    LoadTable loads;
+    std::size_t undo_mark;
+  };
+  std::vector<Visit> stack;
+  stack.push_back(Visit{func_.cfg.entry_block, {}, 0});
+  while (!stack.empty()) {
+    Visit visit = std::move(stack.back());
+    stack.pop_back();
+
+    // Restore the value table to the state at the end of this block's
+    // immediate dominator.
+    while (undo_log_.size() > visit.undo_mark) {
+      values_.erase(undo_log_.back().first);
+      undo_log_.pop_back();
+    }
+
+    processBlock(visit.block, visit.loads);
+    std::size_t mark = undo_log_.size();
+    for (BasicBlock* child : children[visit.block]) {
+      LoadTable child_loads;
+      if (child->in_edges().size() == 1) {
+        child_loads = visit.loads;
+      }
+      stack.push_back(Visit{child, std::move(child_loads), mark});
+    }
+  }
+  return num_eliminated_;
+}
+
+} // namespace
+
+void GlobalValueNumbering::Run(Function& irfunc) {
+  int num_eliminated = ValueNumberer{irfunc}.run();
+  if (num_eliminated == 0) {
+    return;
+  }
+  irfunc.optimization_stats.num_gvn_eliminated += num_eliminated;
+  JIT_DLOG(
+      "Eliminated {} redundant instructions in {}",
+      num_eliminated,
+      irfunc.fullname);
+  CopyPropagation{}.Run(irfunc);
+  reflowTypes(irfunc);
+}
+
+} // namespace jit::hir
@@ -760,6 +760,25 @@ UnaryOpKind ParseUnaryOpName(std::string_view name) {
   JIT_ABORT("Invalid UnaryOpKind '{}'", name);
 }
 
+constexpr std::string_view kVirtualObjectKindNames[] = {
+#define KIND_STR(NAME) #NAME,
+    FOREACH_VIRTUAL_OBJECT_KIND(KIND_STR)
+#undef KIND_STR
+};
+
+std::string_view GetVirtualObjectKindName(VirtualObject::Kind kind) {
+  return kVirtualObjectKindNames[static_cast<int>(kind)];
+}
+
+VirtualObject::Kind ParseVirtualObjectKindName(std::string_view name) {
+  for (size_t i = 0; i < std::size(kVirtualObjectKindNames); ++i) {
+    if (name == kVirtualObjectKindNames[i]) {
+      return static_cast<VirtualObject::Kind>(i);
+    }
+  }
+  JIT_ABORT("Invalid VirtualObject::Kind '{}'", name);
+}
+
 constexpr std::array<std::string_view, kNumPrimitiveUnaryOpKinds>
     kPrimitiveUnaryOpNames = {
 #define OP_STR(NAME) #NAME,
@@ -903,6 +922,9 @@ int Function::numArgs() const {
     // code might be null if we parsed from textual ir
     return 0;
   }
+  if (osr_entry.has_value()) {
+    return code->co_nlocals + osr_entry->stack_depth;
+  }
   return code->co_argcount + code->co_kwonlyargcount +
       bool(code->co_flags & CO_VARARGS) + bool(code->co_flags & CO_VARKEYWORDS);
 }
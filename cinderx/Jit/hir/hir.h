@@ -91,6 +91,46 @@ struct ExecutionBlock {
 using BlockStack = jit::Stack<ExecutionBlock>;
 using OperandStack = jit::Stack<Register*>;
 
+#define FOREACH_VIRTUAL_OBJECT_KIND(V) \
+  V(Cell)                              \
+  V(Float)                             \
+  V(List)                              \
+  V(Slice)                             \
+  V(Tuple)                             \
+  V(Value)
+
+// An object whose allocation was removed by ScalarReplacement, but which is
+// still referenced by a FrameState. It is rebuilt from its fields if we deopt.
+struct VirtualObject {
+  enum class Kind : char {
+#define DEFINE_KIND(NAME) k##NAME,
+    FOREACH_VIRTUAL_OBJECT_KIND(DEFINE_KIND)
+#undef DEFINE_KIND
+  };
+
+  Kind kind;
+
+  // The register that held the object before its allocation was removed. It
+  // no longer has a defining instruction, and only appears in FrameStates.
+  Register* reg{nullptr};
+
+  // The values the object was created with, in the order they were passed to
+  // the allocating instruction. The step of a slice may be nullptr.
+  //
+  // For an instance of a Static Python value class, these are the values of
+  // its members, in the order of the type's PyMemberDefs, with nullptr for
+  // members that are still zero.
+  std::vector<Register*> fields;
+
+  // The value class of a Value object.
+  PyTypeObject* type{nullptr};
+
+  bool operator==(const VirtualObject& other) const = default;
+};
+
+std::string_view GetVirtualObjectKindName(VirtualObject::Kind kind);
+VirtualObject::Kind ParseVirtualObjectKindName(std::string_view name);
+
 // The abstract state of the python frame
 struct FrameState {
   FrameState() = default;
@@ -109,6 +149,7 @@ struct FrameState {
     code = other.code;
     globals = other.globals;
     builtins = other.builtins;
+    virtual_objects = other.virtual_objects;
     return *this;
   }
   FrameState(
@@ -160,6 +201,20 @@ struct FrameState {
   // functions during e.g. deopt.
   FrameState* parent{nullptr};
 
+  // Objects referenced by this frame whose allocations were removed by
+  // ScalarReplacement.
+  std::vector<VirtualObject> virtual_objects;
+
+  // Return the VirtualObject for reg, or nullptr if reg is a real value.
+  const VirtualObject* findVirtualObject(const Register* reg) const {
+    for (const VirtualObject& obj : virtual_objects) {
+      if (obj.reg == reg) {
+        return &obj;
+      }
+    }
+    return nullptr;
+  }
+
   // The bytecode offset of the current instruction, or -sizeof(_Py_CODEUNIT) if
   // no instruction has executed. This corresponds to the `f_lasti` field of
   // PyFrameObject.
@@ -169,22 +224,34 @@ struct FrameState {
         BCOffset{-int{sizeof(_Py_CODEUNIT)}});
   }
 
+  // Virtual objects aren't uses themselves, but their fields are.
   bool visitUses(const std::function<bool(Register*&)>& func) {
+    auto is_real = [&](const Register* reg) {
+      return reg != nullptr &&
+          (virtual_objects.empty() || findVirtualObject(reg) == nullptr);
+    };
     for (auto& reg : stack) {
-      if (!func(reg)) {
+      if (is_real(reg) && !func(reg)) {
         return false;
       }
     }
     for (auto& reg : locals) {
-      if (reg != nullptr && !func(reg)) {
+      if (is_real(reg) && !func(reg)) {
         return false;
       }
     }
     for (auto& reg : cells) {
-      if (reg != nullptr && !func(reg)) {
+      if (is_real(reg) && !func(reg)) {
         return false;
       }
     }
+    for (auto& obj : virtual_objects) {
+      for (auto& reg : obj.fields) {
+        if (reg != nullptr && !func(reg)) {
+          return false;
+        }
+      }
+    }
     if (parent != nullptr) {
       return parent->visitUses(func);
     }
@@ -195,7 +262,7 @@ struct FrameState {
     return (next_instr_offset == other.next_instr_offset) &&
         (stack == other.stack) && (block_stack == other.block_stack) &&
         (locals == other.locals) && (cells == other.cells) &&
-        (code == other.code);
+        (code == other.code) && (virtual_objects == other.virtual_objects);
   }
 
   bool operator!=(const FrameState& other) const {
@@ -4444,6 +4511,14 @@ struct TypedArgument {
   unsigned long thread_safe_flags;
 };
 
+// The loop header that an on-stack replacement (OSR) entry starts executing
+// at. OSR entries take all of the frame's locals, followed by the values on
+// its operand stack, as their arguments.
+struct OSREntry {
+  BCOffset bc_offset;
+  int stack_depth{0};
+};
+
 // Does the given code object need access to its containing PyFunctionObject at
 // runtime?
 bool usesRuntimeFunc(BorrowedRef<PyCodeObject> code);
@@ -4503,12 +4578,27 @@ class Function {
   // is the first argument a primitive?
   bool has_primitive_first_arg{false};
 
+  // Set if this function is an OSR entry into a running interpreter frame
+  // rather than a normal function entry.
+  std::optional<OSREntry> osr_entry;
+
   struct InlineFunctionStats {
     int num_inlined_functions{0};
     // map of {inline_failure_type -> function_names}
     InlineFailureStats failure_stats;
   } inline_function_stats;
 
+  struct OptimizationStats {
+    // Number of redundant instructions removed by GlobalValueNumbering.
+    int num_gvn_eliminated{0};
+
+    // Number of allocations removed by ScalarReplacement.
+    int num_scalar_replaced{0};
+
+    // Number of float operations rewritten by FloatUnboxing.
+    int num_float_ops_unboxed{0};
+  } optimization_stats;
+
   // vector of {locals_idx, type, optional}
   // in argument order, may have gaps for unchecked args
   std::vector<TypedArgument> typed_args;
@@ -4526,7 +4616,7 @@ class Function {
   // phases
   std::unique_ptr<CompilationPhaseTimer> compilation_phase_timer{nullptr};
   // Return the total number of arguments (positional + kwonly + varargs +
-  // varkeywords)
+  // varkeywords), or the number of locals and stack values for OSR entries.
   int numArgs() const;
 
   // Return the number of locals + cellvars + freevars
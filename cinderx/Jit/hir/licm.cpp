@@ -0,0 +1,724 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "cinderx/Common/log.h"
+#include "cinderx/Common/util.h"
+
+#include "cinderx/Jit/hir/analysis.h"
+#include "cinderx/Jit/hir/hir.h"
+#include "cinderx/Jit/hir/memory_effects.h"
+#include "cinderx/Jit/hir/optimization.h"
+#include "cinderx/Jit/hir/ssa.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jit::hir {
+
+// This file contains the LoopInvariantCodeMotion pass, which moves
+// instructions whose result doesn't change between iterations of a loop into
+// the loop's preheader, so they execute once per entry to the loop instead of
+// once per iteration.
+//
+// Only a small set of instructions are candidates, all of which are safe to
+// execute speculatively (they can't raise or crash, even if the loop would
+// have exited before reaching them):
+// - Pure operations on primitives (IntBinaryOp, PrimitiveCompare, ...).
+//   PrimitiveUnbox isn't one of them, since it raises on overflow.
+// - Guards (Guard, GuardIs, GuardType) on loop-invariant values, in blocks
+//   that dominate every exit from the loop, so a guard that fails in the
+//   preheader would also have failed before the loop exited. A hoisted guard
+//   deopts to the interpreter at the top of the loop, using a FrameState
+//   derived from the loop header's entry Snapshot with its Phis replaced by
+//   their values on entry to the loop.
+// - Loads (LoadGlobalCached, LoadField, LoadCellItem) from memory locations
+//   that no instruction in the loop may write to, according to memoryEffects().
+//
+// Every loop contains a RunPeriodicTasks on its eval breaker path, which may
+// run arbitrary code and therefore writes to every memory location. Since that
+// path is rarely taken, a load is still hoisted when RunPeriodicTasks is its
+// only clobber: the load is re-executed after each RunPeriodicTasks in the
+// loop, deopting if the value changed while periodic tasks were running.
+//
+// The pass also hoists the bounds checks of counted loops over staticarrays
+// (Array[int64]). When a loop's induction variable i starts at `start`, is
+// only ever incremented by a positive constant, and the loop is exited once
+// `i < limit` is false, every CheckSequenceBounds of an invariant array at
+// index i that is dominated by the loop test is replaced by two guards in the
+// preheader: `start >= 0` and `limit <= len(array)`. A staticarray can't be
+// resized, so its length is invariant. If either guard fails, we deopt at the
+// top of the loop and let the interpreter raise IndexError at the right
+// iteration.
+//
+// This only removes the per-element bounds checks; it doesn't vectorize the
+// loop body. The LIR has no vector data type (XMM registers only ever hold a
+// single kDouble), codegen has no CPUID-based dispatch to pick between SSE
+// and AVX2 encodings, and staticarray only supports int64 elements, so there
+// is no Array[double] to vectorize. Hoisting the checks is the prerequisite a
+// vectorizer would need, since a widened loop can't keep a bounds check per
+// element.
+
+namespace {
+
+struct Loop {
+  BasicBlock* header{nullptr};
+  std::unordered_set<BasicBlock*> body;
+  std::vector<BasicBlock*> latches;
+};
+
+// Find all natural loops in func, merging back edges with the same header into
+// one loop. Loops are returned innermost first.
+std::vector<Loop> findLoops(Function& func) {
+  std::vector<BasicBlock*> rpo = func.cfg.GetRPOTraversal();
+  std::unordered_set<BasicBlock*> reachable(rpo.begin(), rpo.end());
+  DominatorAnalysis doms{func};
+
+  std::vector<Loop> loops;
+  std::unordered_map<BasicBlock*, size_t> loop_idx;
+  for (BasicBlock* block : rpo) {
+    Instr* term = block->GetTerminator();
+    for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+      BasicBlock* succ = term->successor(i);
+      if (!doms.getBlocksDominatedBy(succ).count(block)) {
+        continue;
+      }
+      auto [it, inserted] = loop_idx.emplace(succ, loops.size());
+      if (inserted) {
+        loops.emplace_back().header = succ;
+      }
+      Loop& loop = loops[it->second];
+      loop.latches.emplace_back(block);
+
+      // Everything that can reach the latch without going through the header
+      // is part of the loop.
+      loop.body.insert(succ);
+      Worklist<BasicBlock*> worklist;
+      worklist.push(block);
+      while (!worklist.empty()) {
+        BasicBlock* cur = worklist.front();
+        worklist.pop();
+        if (!reachable.count(cur) || !loop.body.insert(cur).second) {
+          continue;
+        }
+        for (const Edge* edge : cur->in_edges()) {
+          worklist.push(edge->from());
+        }
+      }
+    }
+  }
+
+  std::stable_sort(loops.begin(), loops.end(), [](auto& a, auto& b) {
+    return a.body.size() < b.body.size();
+  });
+  return loops;
+}
+
+// Ensure the loop has a preheader: a block outside of the loop whose only
+// successor is the loop header, and which is the header's only predecessor
+// from outside of the loop. Returns true if the CFG was modified.
+bool insertPreheader(Function& func, const Loop& loop) {
+  BasicBlock* header = loop.header;
+  std::vector<const Edge*> entries;
+  for (const Edge* edge : header->in_edges()) {
+    if (!loop.body.count(edge->from())) {
+      entries.emplace_back(edge);
+    }
+  }
+  if (entries.size() == 1 && entries[0]->from()->GetTerminator()->IsBranch()) {
+    return false;
+  }
+  std::sort(entries.begin(), entries.end(), [](auto a, auto b) {
+    return a->from()->id < b->from()->id;
+  });
+
+  BasicBlock* preheader = func.cfg.AllocateBlock();
+  std::unordered_set<BasicBlock*> entry_blocks;
+  for (const Edge* edge : entries) {
+    entry_blocks.insert(edge->from());
+  }
+
+  // Phi inputs from outside the loop are merged in the preheader, either by
+  // the single value they all agree on or by a new Phi.
+  std::vector<Phi*> phis;
+  header->forEachPhi([&](Phi& phi) { phis.emplace_back(&phi); });
+  for (Phi* phi : phis) {
+    std::unordered_map<BasicBlock*, Register*> outer_args;
+    std::unordered_map<BasicBlock*, Register*> header_args;
+    Register* outer_value = nullptr;
+    bool all_same = true;
+    for (std::size_t i = 0, n = phi->NumOperands(); i < n; ++i) {
+      BasicBlock* pred = phi->basic_blocks()[i];
+      Register* value = phi->GetOperand(i);
+      if (!entry_blocks.count(pred)) {
+        header_args[pred] = value;
+        continue;
+      }
+      outer_args[pred] = value;
+      all_same &= outer_value == nullptr || outer_value == value;
+      outer_value = value;
+    }
+    if (!all_same) {
+      Register* merged = func.env.AllocateRegister();
+      auto outer_phi = Phi::create(merged, outer_args);
+      outer_phi->copyBytecodeOffset(*phi);
+      preheader->Append(outer_phi);
+      outer_value = merged;
+    }
+    header_args[preheader] = outer_value;
+    auto new_phi = Phi::create(phi->GetOutput(), header_args);
+    phi->ReplaceWith(*new_phi);
+    delete phi;
+  }
+
+  auto branch = preheader->append<Branch>(header);
+  branch->setBytecodeOffset(header->begin()->bytecodeOffset());
+  for (const Edge* edge : entries) {
+    const_cast<Edge*>(edge)->set_to(preheader);
+  }
+  return true;
+}
+
+BasicBlock* getPreheader(const Loop& loop) {
+  for (const Edge* edge : loop.header->in_edges()) {
+    if (!loop.body.count(edge->from())) {
+      return edge->from();
+    }
+  }
+  JIT_ABORT("Loop header bb {} has no preheader", loop.header->id);
+}
+
+// Find a FrameState that describes the interpreter state on entry to the loop
+// header. This is either the header's entry Snapshot or, when the header only
+// contains replayable instructions (as with the eval breaker check), the entry
+// Snapshot of one of its Phi-free successors.
+const FrameState* findHeaderFrameState(const Loop& loop) {
+  BasicBlock* header = loop.header;
+  if (Snapshot* snap = header->entrySnapshot()) {
+    return snap->frameState();
+  }
+  Instr* term = header->GetTerminator();
+  for (auto& instr : *header) {
+    if (&instr != term && !instr.IsPhi() && !instr.isReplayable()) {
+      return nullptr;
+    }
+  }
+  for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+    BasicBlock* succ = term->successor(i);
+    if (!loop.body.count(succ) || succ == header || succ->front().IsPhi()) {
+      continue;
+    }
+    if (Snapshot* snap = succ->entrySnapshot()) {
+      return snap->frameState();
+    }
+  }
+  return nullptr;
+}
+
+// Translate the given header FrameState to one that is valid at the end of the
+// preheader, replacing the header's Phis with their inputs from the preheader.
+// Returns nullptr if the FrameState refers to any other value defined inside
+// the loop.
+std::unique_ptr<FrameState> mapToPreheader(
+    const FrameState& fs,
+    const Loop& loop,
+    BasicBlock* preheader) {
+  auto result = std::make_unique<FrameState>(fs);
+  bool ok = true;
+  auto map_reg = [&](Register*& reg) {
+    // Virtual objects have no definition; their fields are mapped below.
+    if (reg == nullptr || result->findVirtualObject(reg) != nullptr) {
+      return;
+    }
+    Instr* def = reg->instr();
+    if (!loop.body.count(def->block())) {
+      return;
+    }
+    if (def->IsPhi() && def->block() == loop.header) {
+      auto phi = static_cast<Phi*>(def);
+      reg = phi->GetOperand(phi->blockIndex(preheader));
+      return;
+    }
+    ok = false;
+  };
+  for (auto& reg : result->locals) {
+    map_reg(reg);
+  }
+  for (auto& reg : result->cells) {
+    map_reg(reg);
+  }
+  for (auto& reg : result->stack) {
+    map_reg(reg);
+  }
+  for (auto& obj : result->virtual_objects) {
+    for (auto& reg : obj.fields) {
+      map_reg(reg);
+    }
+  }
+  return ok ? std::move(result) : nullptr;
+}
+
+// Return true if instr is a pure operation that can be executed speculatively
+// whenever its operands are available.
+bool isPure(const Instr& instr) {
+  switch (instr.opcode()) {
+    case Opcode::kDoubleBinaryOp:
+    case Opcode::kIntConvert:
+    case Opcode::kLoadFieldAddress:
+    case Opcode::kPrimitiveCompare:
+    case Opcode::kPrimitiveUnaryOp:
+      return true;
+    case Opcode::kIntBinaryOp: {
+      // Division by zero traps, and Power calls out to a helper.
+      switch (static_cast<const IntBinaryOp&>(instr).op()) {
+        case BinaryOpKind::kFloorDivide:
+        case BinaryOpKind::kFloorDivideUnsigned:
+        case BinaryOpKind::kModulo:
+        case BinaryOpKind::kModuloUnsigned:
+        case BinaryOpKind::kPower:
+        case BinaryOpKind::kPowerUnsigned:
+          return false;
+        default:
+          return true;
+      }
+    }
+    default:
+      return false;
+  }
+}
+
+// Return the memory location read by instr, if it's a load that is safe to
+// execute speculatively, or AEmpty otherwise.
+AliasClass loadLocation(const Instr& instr) {
+  switch (instr.opcode()) {
+    case Opcode::kLoadCellItem:
+    case Opcode::kLoadGlobalCached:
+      return memoryEffects(instr).borrow_support;
+    case Opcode::kLoadField:
+      return AInObjectAttr;
+    default:
+      return AEmpty;
+  }
+}
+
+// Increments larger than this could overflow before the loop test fails.
+constexpr intptr_t kMaxInductionStep = INT32_MAX;
+
+// If reg is a Phi in the loop's header that is incremented by a small positive
+// constant on every back edge, return its value on entry to the loop.
+Register*
+inductionVarStart(Register* reg, const Loop& loop, BasicBlock* preheader) {
+  Instr* def = reg->instr();
+  if (!def->IsPhi() || def->block() != loop.header || !reg->isA(TCInt64)) {
+    return nullptr;
+  }
+  auto phi = static_cast<Phi*>(def);
+  Register* start = nullptr;
+  for (std::size_t i = 0, n = phi->NumOperands(); i < n; ++i) {
+    Register* value = phi->GetOperand(i);
+    if (phi->basic_blocks()[i] == preheader) {
+      start = value;
+      continue;
+    }
+    if (!value->instr()->IsIntBinaryOp()) {
+      return nullptr;
+    }
+    auto incr = static_cast<const IntBinaryOp*>(value->instr());
+    if (incr->op() != BinaryOpKind::kAdd) {
+      return nullptr;
+    }
+    Register* step = incr->left() == reg ? incr->right()
+        : incr->right() == reg           ? incr->left()
+                                         : nullptr;
+    if (step == nullptr || !step->type().hasIntSpec() ||
+        step->type().intSpec() < 1 ||
+        step->type().intSpec() > kMaxInductionStep) {
+      return nullptr;
+    }
+  }
+  return start;
+}
+
+class LoopHoister {
+ public:
+  LoopHoister(Function& func, const Loop& loop, DominatorAnalysis& doms)
+      : func_(func), loop_(loop), doms_(doms) {}
+
+  // Returns the number of instructions hoisted.
+  int run();
+
+ private:
+  bool dominatesAll(BasicBlock* block, const std::vector<BasicBlock*>& blocks);
+  bool isInvariant(Register* reg) const;
+  bool canHoistGuard(const Instr& guard);
+  Snapshot* preheaderSnapshot();
+  Register* preheaderValue(Register* reg);
+  void insertInPreheader(Instr* instr);
+  void hoist(Instr& instr);
+  Instr* reload(const Instr& load);
+  void revalidateLoads();
+  int hoistBoundsChecks(const std::vector<BasicBlock*>& blocks);
+
+  Function& func_;
+  const Loop& loop_;
+  DominatorAnalysis& doms_;
+
+  BasicBlock* preheader_{nullptr};
+  // FrameState at the end of the preheader, if one could be constructed.
+  std::unique_ptr<FrameState> preheader_fs_;
+  Snapshot* preheader_snapshot_{nullptr};
+
+  // Memory locations written by instructions in the loop, not counting
+  // RunPeriodicTasks.
+  AliasClass stores_{AEmpty};
+  std::vector<RunPeriodicTasks*> periodic_tasks_;
+  // Blocks in the loop with a successor outside of it.
+  std::vector<BasicBlock*> exits_;
+  // Hoisted loads that RunPeriodicTasks may clobber.
+  std::vector<Instr*> revalidated_loads_;
+};
+
+bool LoopHoister::dominatesAll(
+    BasicBlock* block,
+    const std::vector<BasicBlock*>& blocks) {
+  auto& dominated = doms_.getBlocksDominatedBy(block);
+  return std::all_of(blocks.begin(), blocks.end(), [&](BasicBlock* other) {
+    return dominated.count(other) != 0;
+  });
+}
+
+bool LoopHoister::isInvariant(Register* reg) const {
+  Instr* def = reg->instr();
+  return !loop_.body.count(def->block()) || def->IsLoadConst();
+}
+
+bool LoopHoister::canHoistGuard(const Instr& guard) {
+  return preheader_fs_ != nullptr && dominatesAll(guard.block(), exits_);
+}
+
+Snapshot* LoopHoister::preheaderSnapshot() {
+  if (preheader_snapshot_ == nullptr) {
+    Instr* term = preheader_->GetTerminator();
+    preheader_snapshot_ = Snapshot::create(*preheader_fs_);
+    preheader_snapshot_->setBytecodeOffset(term->bytecodeOffset());
+    preheader_snapshot_->InsertBefore(*term);
+  }
+  return preheader_snapshot_;
+}
+
+// Return a register holding the value of the invariant reg at the end of the
+// preheader. Constants are cheap to rematerialize, so a constant defined in
+// the loop gets its own copy rather than extending the live range of the
+// original.
+Register* LoopHoister::preheaderValue(Register* reg) {
+  Instr* def = reg->instr();
+  if (!def->IsLoadConst() || !loop_.body.count(def->block())) {
+    return reg;
+  }
+  Register* copy = func_.env.AllocateRegister();
+  auto load = LoadConst::create(copy, reg->type());
+  load->copyBytecodeOffset(*def);
+  load->InsertBefore(*preheader_->GetTerminator());
+  return copy;
+}
+
+void LoopHoister::insertInPreheader(Instr* instr) {
+  Instr* term = preheader_->GetTerminator();
+  instr->setBytecodeOffset(term->bytecodeOffset());
+  instr->InsertBefore(*term);
+}
+
+void LoopHoister::hoist(Instr& instr) {
+  if (auto deopt = instr.asDeoptBase()) {
+    preheaderSnapshot();
+    if (deopt->frameState() != nullptr) {
+      deopt->setFrameState(*preheader_fs_);
+    }
+  }
+  for (std::size_t i = 0, n = instr.NumOperands(); i < n; ++i) {
+    instr.SetOperand(i, preheaderValue(instr.GetOperand(i)));
+  }
+  instr.unlink();
+  instr.InsertBefore(*preheader_->GetTerminator());
+}
+
+// Return a copy of the given hoisted load with a new output.
+Instr* LoopHoister::reload(const Instr& load) {
+  Register* value = func_.env.AllocateRegister();
+  switch (load.opcode()) {
+    case Opcode::kLoadCellItem:
+      return LoadCellItem::create(value, load.GetOperand(0));
+    case Opcode::kLoadField: {
+      auto& field = static_cast<const LoadField&>(load);
+      return LoadField::create(
+          value,
+          field.receiver(),
+          field.name(),
+          field.offset(),
+          field.type(),
+          field.borrowed());
+    }
+    case Opcode::kLoadGlobalCached: {
+      auto& global = static_cast<const LoadGlobalCached&>(load);
+      return LoadGlobalCached::create(
+          value,
+          global.code(),
+          global.builtins(),
+          global.globals(),
+          global.name_idx());
+    }
+    default:
+      JIT_ABORT("Can't reload {}", load.opname());
+  }
+}
+
+void LoopHoister::revalidateLoads() {
+  for (RunPeriodicTasks* tasks : periodic_tasks_) {
+    JIT_CHECK(
+        tasks->frameState() != nullptr, "RunPeriodicTasks needs a FrameState");
+    Instr* cursor = tasks;
+    auto insert = [&](Instr* instr) {
+      instr->copyBytecodeOffset(*tasks);
+      instr->InsertAfter(*cursor);
+      cursor = instr;
+    };
+    insert(Snapshot::create(*tasks->frameState()));
+    for (Instr* load : revalidated_loads_) {
+      Instr* value = reload(*load);
+      insert(value);
+      Register* same = func_.env.AllocateRegister();
+      insert(PrimitiveCompare::create(
+          same,
+          PrimitiveCompareOp::kEqual,
+          value->GetOutput(),
+          load->GetOutput()));
+      auto guard = Guard::create(same);
+      guard->setDescr("loop invariant load");
+      insert(guard);
+    }
+  }
+}
+
+int LoopHoister::run() {
+  preheader_ = getPreheader(loop_);
+  if (const FrameState* fs = findHeaderFrameState(loop_)) {
+    preheader_fs_ = mapToPreheader(*fs, loop_, preheader_);
+  }
+
+  std::vector<BasicBlock*> blocks;
+  for (BasicBlock* block : func_.cfg.GetRPOTraversal()) {
+    if (!loop_.body.count(block)) {
+      continue;
+    }
+    blocks.emplace_back(block);
+    Instr* term = block->GetTerminator();
+    for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+      if (!loop_.body.count(term->successor(i))) {
+        exits_.emplace_back(block);
+        break;
+      }
+    }
+    for (Instr& instr : *block) {
+      if (instr.IsRunPeriodicTasks()) {
+        periodic_tasks_.emplace_back(static_cast<RunPeriodicTasks*>(&instr));
+      } else if (
+          !instr.IsPhi() && !instr.IsBranch() && !instr.IsCondBranch() &&
+          !instr.IsCondBranchCheckType() && !instr.IsCondBranchIterNotDone()) {
+        stores_ = stores_ | memoryEffects(instr).may_store;
+      }
+    }
+  }
+
+  int num_hoisted = 0;
+  for (BasicBlock* block : blocks) {
+    if (!dominatesAll(block, loop_.latches)) {
+      continue;
+    }
+    for (auto it = block->begin(); it != block->end();) {
+      Instr& instr = *it;
+      ++it;
+
+      // Hoisting an instruction extends the live range of its output across
+      // every deopt point in the loop, and deopt metadata can't describe raw
+      // pointers.
+      Register* output = instr.GetOutput();
+      if (output != nullptr && output->type().couldBe(TCPtr)) {
+        continue;
+      }
+      auto operands = instr.GetOperands();
+      if (!std::all_of(operands.begin(), operands.end(), [&](Register* reg) {
+            return isInvariant(reg);
+          })) {
+        continue;
+      }
+
+      bool hoistable = false;
+      if (isPure(instr)) {
+        hoistable = true;
+      } else if (
+          instr.IsGuard() || instr.IsGuardIs() || instr.IsGuardType()) {
+        hoistable = canHoistGuard(instr);
+      } else if (AliasClass loc = loadLocation(instr); loc != AEmpty) {
+        hoistable = (stores_ & loc) == AEmpty;
+        if (hoistable && !periodic_tasks_.empty()) {
+          // Revalidation compares the reloaded value with an equality test,
+          // which never holds for a NaN double and would deopt every time.
+          if (output != nullptr && output->type().couldBe(TCDouble)) {
+            continue;
+          }
+          revalidated_loads_.emplace_back(&instr);
+        }
+      }
+      if (hoistable) {
+        hoist(instr);
+        num_hoisted++;
+      }
+    }
+  }
+
+  num_hoisted += hoistBoundsChecks(blocks);
+
+  if (!revalidated_loads_.empty()) {
+    revalidateLoads();
+  }
+  return num_hoisted;
+}
+
+int LoopHoister::hoistBoundsChecks(const std::vector<BasicBlock*>& blocks) {
+  if (preheader_fs_ == nullptr) {
+    return 0;
+  }
+
+  int num_hoisted = 0;
+  for (BasicBlock* block : blocks) {
+    Instr* term = block->GetTerminator();
+    if (!term->IsCondBranch() ||
+        !term->GetOperand(0)->instr()->IsPrimitiveCompare()) {
+      continue;
+    }
+    auto branch = static_cast<CondBranch*>(term);
+    auto test = static_cast<const PrimitiveCompare*>(
+        branch->GetOperand(0)->instr());
+    Register* index;
+    Register* limit;
+    if (test->op() == PrimitiveCompareOp::kLessThan) {
+      index = test->left();
+      limit = test->right();
+    } else if (test->op() == PrimitiveCompareOp::kGreaterThan) {
+      index = test->right();
+      limit = test->left();
+    } else {
+      continue;
+    }
+
+    // Everything dominated by the edge that stays in the loop runs with
+    // start <= index < limit.
+    BasicBlock* body = branch->true_bb();
+    if (!loop_.body.count(body) || loop_.body.count(branch->false_bb()) ||
+        body->in_edges().size() != 1) {
+      continue;
+    }
+    if (!limit->isA(TCInt64) || !isInvariant(limit)) {
+      continue;
+    }
+    Register* start = inductionVarStart(index, loop_, preheader_);
+    if (start == nullptr ||
+        (start->type().hasIntSpec() && start->type().intSpec() < 0)) {
+      continue;
+    }
+
+    std::vector<Instr*> checks;
+    auto& dominated = doms_.getBlocksDominatedBy(body);
+    for (BasicBlock* check_block : blocks) {
+      if (!dominated.count(check_block)) {
+        continue;
+      }
+      for (Instr& instr : *check_block) {
+        if (instr.IsCheckSequenceBounds() && instr.GetOperand(1) == index &&
+            instr.GetOperand(0)->isA(TArray) &&
+            isInvariant(instr.GetOperand(0))) {
+          checks.emplace_back(&instr);
+        }
+      }
+    }
+    if (checks.empty()) {
+      continue;
+    }
+
+    preheaderSnapshot();
+    auto guard_compare = [&](PrimitiveCompareOp op,
+                             Register* left,
+                             Register* right,
+                             const char* descr) {
+      Register* ok = func_.env.AllocateRegister();
+      insertInPreheader(PrimitiveCompare::create(ok, op, left, right));
+      auto guard = Guard::create(ok);
+      guard->setFrameState(*preheader_fs_);
+      guard->setDescr(descr);
+      insertInPreheader(guard);
+    };
+    if (!start->type().hasIntSpec()) {
+      Register* zero = func_.env.AllocateRegister();
+      insertInPreheader(LoadConst::create(zero, Type::fromCInt(0, TCInt64)));
+      guard_compare(
+          PrimitiveCompareOp::kGreaterThanEqual, start, zero, "loop start");
+    }
+    Register* preheader_limit = preheaderValue(limit);
+    std::unordered_set<Register*> guarded;
+    for (Instr* check : checks) {
+      Register* array = check->GetOperand(0);
+      if (guarded.insert(array).second) {
+        Register* len = func_.env.AllocateRegister();
+        insertInPreheader(
+            LoadVarObjectSize::create(len, preheaderValue(array)));
+        guard_compare(
+            PrimitiveCompareOp::kLessThanEqual,
+            preheader_limit,
+            len,
+            "loop limit");
+      }
+      auto assign = Assign::create(check->GetOutput(), index);
+      assign->copyBytecodeOffset(*check);
+      check->ReplaceWith(*assign);
+      delete check;
+      num_hoisted++;
+    }
+  }
+  return num_hoisted;
+}
+
+} // namespace
+
+void LoopInvariantCodeMotion::Run(Function& irfunc) {
+  std::vector<Loop> loops = findLoops(irfunc);
+  if (loops.empty()) {
+    return;
+  }
+  bool changed = false;
+  for (const Loop& loop : loops) {
+    changed |= insertPreheader(irfunc, loop);
+  }
+  // Adding preheaders can add blocks to enclosing loops, so recompute them.
+  if (changed) {
+    loops = findLoops(irfunc);
+  }
+
+  DominatorAnalysis doms{irfunc};
+  int num_hoisted = 0;
+  for (const Loop& loop : loops) {
+    num_hoisted += LoopHoister{irfunc, loop, doms}.run();
+  }
+  if (num_hoisted > 0) {
+    JIT_DLOG(
+        "Hoisted {} loop-invariant instructions in {}",
+        num_hoisted,
+        irfunc.fullname);
+  }
+  // Preheaders may have introduced new Phis, so types must be recomputed even
+  // if nothing was hoisted.
+  if (changed || num_hoisted > 0) {
+    reflowTypes(irfunc);
+  }
+}
+
+} // namespace jit::hir
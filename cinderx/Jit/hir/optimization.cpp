@@ -59,6 +59,10 @@ PassRegistry::PassRegistry() {
   addPass(GuardTypeRemoval::Factory);
   addPass(BeginInlinedFunctionElimination::Factory);
   addPass(BuiltinLoadMethodElimination::Factory);
+  addPass(FloatUnboxing::Factory);
+  addPass(GlobalValueNumbering::Factory);
+  addPass(LoopInvariantCodeMotion::Factory);
+  addPass(ScalarReplacement::Factory);
   // AllPasses is only used for testing.
   addPass(AllPasses::Factory);
 }
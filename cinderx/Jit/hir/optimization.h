@@ -169,6 +169,59 @@ class CleanCFG : public Pass {
   }
 };
 
+// Remove instructions that recompute a value already available from a
+// dominating instruction. See the comment at the top of gvn.cpp for details.
+class GlobalValueNumbering : public Pass {
+ public:
+  GlobalValueNumbering() : Pass("GlobalValueNumbering") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<GlobalValueNumbering> Factory() {
+    return std::make_unique<GlobalValueNumbering>();
+  }
+};
+
+// Hoist loop-invariant instructions out of loops and into their preheaders.
+// See the comment at the top of licm.cpp for which instructions are hoisted.
+class LoopInvariantCodeMotion : public Pass {
+ public:
+  LoopInvariantCodeMotion() : Pass("LoopInvariantCodeMotion") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<LoopInvariantCodeMotion> Factory() {
+    return std::make_unique<LoopInvariantCodeMotion>();
+  }
+};
+
+// Keep the results of arithmetic on floats unboxed, boxing them only where
+// they escape. See the comment at the top of float_unboxing.cpp for details.
+class FloatUnboxing : public Pass {
+ public:
+  FloatUnboxing() : Pass("FloatUnboxing") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<FloatUnboxing> Factory() {
+    return std::make_unique<FloatUnboxing>();
+  }
+};
+
+// Remove tuple, list, cell, slice and float allocations that don't escape, keeping
+// enough information in FrameStates to rebuild them on deopt. See the comment
+// at the top of scalar_replacement.cpp for details.
+class ScalarReplacement : public Pass {
+ public:
+  ScalarReplacement() : Pass("ScalarReplacement") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<ScalarReplacement> Factory() {
+    return std::make_unique<ScalarReplacement>();
+  }
+};
+
 class InlineFunctionCalls : public Pass {
  public:
   InlineFunctionCalls() : Pass("InlineFunctionCalls") {}
@@ -305,6 +305,27 @@ HIRParser::parseInstr(std::string_view opcode, Register* dst, int bb_index) {
     expect(">");
     auto receiver = ParseRegister();
     NEW_INSTR(LoadTupleItem, dst, receiver, idx);
+  } else if (opcode == "LoadVarObjectSize") {
+    auto receiver = ParseRegister();
+    NEW_INSTR(LoadVarObjectSize, dst, receiver);
+  } else if (opcode == "LoadField") {
+    expect("<");
+    std::string_view field = GetNextToken();
+    std::size_t at = field.find('@');
+    JIT_CHECK(at != std::string_view::npos, "Expected name@offset");
+    std::string name{field.substr(0, at)};
+    std::size_t offset = std::stoull(std::string{field.substr(at + 1)});
+    expect(",");
+    Type ty = parseType(GetNextToken());
+    expect(",");
+    std::string_view kind = GetNextToken();
+    JIT_CHECK(
+        kind == "borrowed" || kind == "owned",
+        "Expected 'borrowed' or 'owned', got '{}'",
+        kind);
+    expect(">");
+    auto receiver = ParseRegister();
+    NEW_INSTR(LoadField, dst, receiver, name, offset, ty, kind == "borrowed");
   } else if (opcode == "CallMethod") {
     expect("<");
     int num_args = GetNextInteger();
@@ -658,6 +679,13 @@ HIRParser::parseInstr(std::string_view opcode, Register* dst, int bb_index) {
       snapshot->setFrameState(parseFrameState());
     }
     instruction = snapshot;
+  } else if (opcode == "LoadCellItem") {
+    auto cell = ParseRegister();
+    NEW_INSTR(LoadCellItem, dst, cell);
+  } else if (opcode == "LoadEvalBreaker") {
+    NEW_INSTR(LoadEvalBreaker, dst);
+  } else if (opcode == "RunPeriodicTasks") {
+    instruction = newInstr<RunPeriodicTasks>(dst);
   } else if (opcode == "Deopt") {
     instruction = newInstr<Deopt>();
   } else if (opcode == "Unreachable") {
@@ -707,6 +735,28 @@ HIRParser::parseInstr(std::string_view opcode, Register* dst, int bb_index) {
   return instruction;
 }
 
+BorrowedRef<PyTypeObject> HIRParser::parseValueType(std::string_view name) {
+  // Split off the module name, defaulting to builtins.
+  size_t dot = name.rfind('.');
+  std::string_view mod_name =
+      dot == std::string_view::npos ? "builtins" : name.substr(0, dot);
+  std::string_view type_name =
+      dot == std::string_view::npos ? name : name.substr(dot + 1);
+  auto type_descr = Ref<>::steal(Py_BuildValue(
+      "(s#s#)",
+      mod_name.data(),
+      static_cast<Py_ssize_t>(mod_name.size()),
+      type_name.data(),
+      static_cast<Py_ssize_t>(type_name.size())));
+  JIT_CHECK(type_descr != nullptr, "failed to allocate type descriptor");
+  int optional, exact;
+  PyTypeObject* type =
+      _PyClassLoader_ResolveType(type_descr, &optional, &exact);
+  JIT_CHECK(type != nullptr, "unknown type '{}'", name);
+  env_->addReference(Ref<>::steal(reinterpret_cast<PyObject*>(type)));
+  return type;
+}
+
 std::vector<Register*> HIRParser::parseRegisterVector() {
   expect("<");
   int num_items = GetNextInteger();
@@ -750,6 +800,18 @@ FrameState HIRParser::parseFrameState() {
       for (Register* r : parseRegisterVector()) {
         fs.stack.push(r);
       }
+    } else if (token == "Virtual") {
+      VirtualObject obj;
+      obj.reg = ParseRegister();
+      expect("=");
+      obj.kind = ParseVirtualObjectKindName(GetNextToken());
+      if (obj.kind == VirtualObject::Kind::kValue) {
+        expect("<");
+        obj.type = parseValueType(GetNextToken());
+        expect(">");
+      }
+      obj.fields = parseRegisterVector();
+      fs.virtual_objects.emplace_back(std::move(obj));
     } else if (token == "BlockStack") {
       expect("{");
       while (peekNextToken() != "}") {
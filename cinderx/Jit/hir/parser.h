@@ -85,6 +85,7 @@ class HIRParser {
   ListOrTuple parseListOrTuple();
   FrameState parseFrameState();
   std::vector<Register*> parseRegisterVector();
+  BorrowedRef<PyTypeObject> parseValueType(std::string_view name);
   std::vector<RegState> parseRegStates();
 
   template <class T, typename... Args>
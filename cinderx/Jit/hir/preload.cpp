@@ -126,6 +126,26 @@ static void fill_primitive_arg_types_builtin(
   }
 }
 
+// Return true if an INVOKE_METHOD of descr always calls func: func is what
+// the container type resolves the method to, and no existing subclass of it
+// overrides the method.
+static bool hasSingleImplementation(
+    BorrowedRef<> descr,
+    BorrowedRef<> container,
+    BorrowedRef<> func) {
+  BorrowedRef<> name =
+      PyTuple_GET_ITEM(descr.get(), PyTuple_GET_SIZE(descr.get()) - 1);
+  if (container == nullptr || !PyType_Check(container) ||
+      !PyUnicode_CheckExact(name)) {
+    return false;
+  }
+  return visitTypeHierarchy(
+      BorrowedRef<PyTypeObject>{container.get()},
+      [&](BorrowedRef<PyTypeObject> type) {
+        return typeLookupSafe(type, name) == func;
+      });
+}
+
 std::unique_ptr<InvokeTarget> Preloader::resolve_target_descr(
     BorrowedRef<> descr,
     int opcode) {
@@ -182,6 +202,12 @@ std::unique_ptr<InvokeTarget> Preloader::resolve_target_descr(
   if (opcode == INVOKE_METHOD) {
     target->slot = _PyClassLoader_ResolveMethod(descr);
     JIT_CHECK(target->slot != -1, "method lookup failed: {}", repr(descr));
+    if (target->is_function && target->is_statically_typed &&
+        hasSingleImplementation(descr, container, target->callable)) {
+      target->devirtualized_type.reset(container);
+      target->method_name.reset(
+          PyTuple_GET_ITEM(descr.get(), PyTuple_GET_SIZE(descr.get()) - 1));
+    }
   } else { // the rest of this only used by INVOKE_FUNCTION currently
     target->uses_runtime_func =
         target->is_function && usesRuntimeFunc(target->func()->func_code);
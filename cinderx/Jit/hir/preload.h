@@ -45,6 +45,11 @@ struct InvokeTarget {
   PyObject** indirect_ptr{nullptr};
   // vtable slot number (INVOKE_METHOD only)
   Py_ssize_t slot{-1};
+  // The type that declares the method and the method's name, if callable is
+  // the only implementation of the method in that type's hierarchy, so the
+  // call can bypass the vtable (INVOKE_METHOD only)
+  Ref<PyTypeObject> devirtualized_type;
+  Ref<PyUnicodeObject> method_name;
   // is a CO_STATICALLY_COMPILED Python function or METH_TYPED builtin
   bool is_statically_typed{false};
   // is PyFunctionObject
@@ -193,6 +193,18 @@ static std::string escape_unicode(PyObject* str) {
   return escape_unicode(data, size);
 }
 
+// The name of a value class as "module.Name", or just "Name" for builtins,
+// which is what HIRParser resolves it from.
+static std::string format_value_type(PyTypeObject* type) {
+  PyObject* module = type->tp_dict != nullptr
+      ? PyDict_GetItemString(type->tp_dict, "__module__")
+      : nullptr;
+  if (module != nullptr && PyUnicode_Check(module)) {
+    return fmt::format("{}.{}", unicodeAsString(module), _PyType_Name(type));
+  }
+  return type->tp_name;
+}
+
 static std::string format_name_impl(int idx, PyObject* names) {
   return fmt::format(
       "{}; {}", idx, escape_unicode(PyTuple_GET_ITEM(names, idx)));
@@ -811,6 +823,23 @@ void HIRPrinter::Print(std::ostream& os, const FrameState& state) {
     os << std::endl;
   }
 
+  for (const VirtualObject& obj : state.virtual_objects) {
+    Indented(os) << "Virtual " << obj.reg->name() << " = "
+                 << GetVirtualObjectKindName(obj.kind);
+    if (obj.type != nullptr) {
+      os << "<" << format_value_type(obj.type) << ">";
+    }
+    os << "<" << obj.fields.size() << ">";
+    for (auto reg : obj.fields) {
+      if (reg == nullptr) {
+        os << " <null>";
+      } else {
+        os << " " << reg->name();
+      }
+    }
+    os << std::endl;
+  }
+
   auto& bs = state.block_stack;
   if (bs.size() > 0) {
     Indented(os) << "BlockStack {" << std::endl;
@@ -0,0 +1,510 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+
+#include "Python.h"
+#include "cinderx/StaticPython/classloader.h"
+#include "structmember.h"
+
+#include "cinderx/Common/log.h"
+
+#include "cinderx/Jit/hir/hir.h"
+#include "cinderx/Jit/hir/optimization.h"
+#include "cinderx/Jit/hir/ssa.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jit::hir {
+
+// This file contains the ScalarReplacement pass, which removes allocations of
+// tuples, lists, cells, slices, boxed floats and Static Python value class
+// instances that never escape the function being compiled.
+//
+// An allocation doesn't escape if every use of it is either:
+// - A read that we can answer from the values the object was created with
+//   (LoadTupleItem, LoadVarObjectSize, LoadCellItem, PrimitiveUnbox of a
+//   float), or an instruction that only exists to carry type information
+//   (UseType) or whose result is unused.
+// - A reference from a FrameState, which means the interpreter needs the
+//   object if we deopt at that point.
+//
+// Since none of these uses can mutate the object, its fields are exactly the
+// operands of the allocating instruction. Reads are replaced with those
+// operands, and each FrameState that refers to the object gets a
+// VirtualObject describing how to rebuild it during deopt. A FrameState's
+// VirtualObjects keep their fields alive (see FrameState::visitUses), so
+// RefcountInsertion and the backend treat them like any other deopt value.
+//
+// We give up on objects that are referenced from more than one frame of the
+// same FrameState chain, since each frame would get its own copy when
+// rematerialized and `is` would stop holding between them.
+//
+// Instances of Static Python value classes (TpAlloc of a type set up by
+// _PyClassLoader_InitValueClass) are the one kind of mutable object we handle.
+// Their primitive members may be read and written with LoadField and
+// StoreField, so the values of their fields depend on where we are in the
+// function. To keep that simple, every use of such an object, including
+// FrameStates, has to be in the block that allocates it, and FrameStates may
+// only refer to it from their innermost frame. Walking the block in order then
+// tells us the value of each member at every use.
+
+namespace {
+
+std::optional<VirtualObject::Kind> allocationKind(const Instr& instr) {
+  switch (instr.opcode()) {
+    case Opcode::kBuildSlice:
+      return VirtualObject::Kind::kSlice;
+    case Opcode::kMakeCell:
+      return VirtualObject::Kind::kCell;
+    case Opcode::kMakeList:
+      return VirtualObject::Kind::kList;
+    case Opcode::kMakeTuple:
+      return VirtualObject::Kind::kTuple;
+    case Opcode::kTpAlloc:
+      if (_PyClassLoader_IsValueClass(
+              static_cast<const TpAlloc&>(instr).pytype())) {
+        return VirtualObject::Kind::kValue;
+      }
+      return std::nullopt;
+    case Opcode::kPrimitiveBox:
+      // Float arithmetic lowered by Simplify leaves boxes behind that are often
+      // only needed by FrameStates.
+      if (static_cast<const PrimitiveBox&>(instr).type() <= TCDouble) {
+        return VirtualObject::Kind::kFloat;
+      }
+      return std::nullopt;
+    default:
+      return std::nullopt;
+  }
+}
+
+std::vector<Register*> allocationFields(const Instr& instr) {
+  if (instr.IsBuildSlice()) {
+    auto& slice = static_cast<const BuildSlice&>(instr);
+    return {slice.start(), slice.stop(), slice.step()};
+  }
+  if (instr.IsTpAlloc()) {
+    // Freshly allocated objects are zeroed.
+    PyTypeObject* type = static_cast<const TpAlloc&>(instr).pytype();
+    return std::vector<Register*>(Py_SIZE(type), nullptr);
+  }
+  std::vector<Register*> fields;
+  for (std::size_t i = 0, n = instr.NumOperands(); i < n; ++i) {
+    fields.emplace_back(instr.GetOperand(i));
+  }
+  return fields;
+}
+
+// The index of the primitive member of a value class at offset, if there is
+// one.
+std::optional<std::size_t> valueMemberIndex(
+    PyTypeObject* type,
+    std::size_t offset) {
+  PyMemberDef* members =
+      PyHeapType_GET_MEMBERS(reinterpret_cast<PyHeapTypeObject*>(type));
+  for (Py_ssize_t i = 0; i < Py_SIZE(type); i++) {
+    if (static_cast<std::size_t>(members[i].offset) != offset) {
+      continue;
+    }
+    // Single precision floats are widened in registers, so they can't be
+    // rematerialized from the raw register contents.
+    if (members[i].type == T_OBJECT_EX || members[i].type == T_FLOAT) {
+      return std::nullopt;
+    }
+    return static_cast<std::size_t>(i);
+  }
+  return std::nullopt;
+}
+
+// Whether the innermost frame of fs refers to reg.
+bool frameRefersTo(const FrameState& fs, Register* reg) {
+  auto matches = [&](Register* r) { return r == reg; };
+  return std::any_of(fs.locals.begin(), fs.locals.end(), matches) ||
+      std::any_of(fs.cells.begin(), fs.cells.end(), matches) ||
+      std::any_of(fs.stack.begin(), fs.stack.end(), matches);
+}
+
+struct Allocation {
+  Instr* instr;
+  VirtualObject::Kind kind;
+  std::vector<Register*> fields;
+  bool escapes{false};
+
+  PyTypeObject* valueType() const {
+    return kind == VirtualObject::Kind::kValue
+        ? static_cast<const TpAlloc*>(instr)->pytype()
+        : nullptr;
+  }
+
+  // Non-FrameState uses of the object, which will be rewritten or removed.
+  std::vector<Instr*> uses;
+};
+
+class ScalarReplacer {
+ public:
+  explicit ScalarReplacer(Function& func) : func_(func) {}
+
+  // Returns the number of allocations removed.
+  int run();
+
+ private:
+  void findAllocations();
+  void analyzeUse(Instr& instr, Allocation& alloc);
+  bool analyzeValueUse(Instr& instr, Allocation& alloc);
+  void analyzeFrameStates(Instr& instr, FrameState* fs);
+  void analyzeValueObject(Allocation& alloc);
+  void rewriteUse(Instr& instr, const Allocation& alloc);
+  void replaceValueObject(const Allocation& alloc);
+  void virtualizeFrameState(FrameState* fs);
+
+  Allocation* allocationFor(Register* reg) {
+    auto it = allocs_.find(reg);
+    return it == allocs_.end() ? nullptr : &it->second;
+  }
+
+  Function& func_;
+  std::unordered_map<Register*, Allocation> allocs_;
+  std::unordered_set<Register*> used_;
+};
+
+void ScalarReplacer::findAllocations() {
+  for (auto& block : func_.cfg.blocks) {
+    for (auto& instr : block) {
+      instr.visitUses([&](Register* reg) {
+        used_.emplace(reg);
+        return true;
+      });
+      std::optional<VirtualObject::Kind> kind = allocationKind(instr);
+      if (kind.has_value()) {
+        allocs_.emplace(
+            instr.GetOutput(),
+            Allocation{&instr, *kind, allocationFields(instr)});
+      }
+    }
+  }
+}
+
+void ScalarReplacer::analyzeUse(Instr& instr, Allocation& alloc) {
+  if (alloc.kind == VirtualObject::Kind::kValue) {
+    if (!analyzeValueUse(instr, alloc)) {
+      alloc.escapes = true;
+    }
+    return;
+  }
+  Register* output = instr.GetOutput();
+  switch (instr.opcode()) {
+    case Opcode::kUseType:
+      alloc.uses.emplace_back(&instr);
+      return;
+    case Opcode::kLoadTupleItem:
+      if (alloc.kind == VirtualObject::Kind::kTuple &&
+          static_cast<const LoadTupleItem&>(instr).idx() <
+              alloc.fields.size()) {
+        alloc.uses.emplace_back(&instr);
+        return;
+      }
+      break;
+    case Opcode::kLoadVarObjectSize:
+      if (alloc.kind == VirtualObject::Kind::kTuple ||
+          alloc.kind == VirtualObject::Kind::kList) {
+        alloc.uses.emplace_back(&instr);
+        return;
+      }
+      break;
+    case Opcode::kLoadCellItem:
+      if (alloc.kind == VirtualObject::Kind::kCell) {
+        alloc.uses.emplace_back(&instr);
+        return;
+      }
+      break;
+    case Opcode::kPrimitiveUnbox:
+      if (alloc.kind == VirtualObject::Kind::kFloat &&
+          static_cast<const PrimitiveUnbox&>(instr).type() <= TCDouble) {
+        alloc.uses.emplace_back(&instr);
+        return;
+      }
+      break;
+    case Opcode::kLoadField:
+    case Opcode::kLoadFieldAddress:
+      // Left behind by Simplify after it forwarded the items of a MakeTuple.
+      if (output != nullptr && used_.count(output) == 0) {
+        alloc.uses.emplace_back(&instr);
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  alloc.escapes = true;
+}
+
+bool ScalarReplacer::analyzeValueUse(Instr& instr, Allocation& alloc) {
+  if (instr.block() != alloc.instr->block()) {
+    return false;
+  }
+  Register* reg = alloc.instr->GetOutput();
+  switch (instr.opcode()) {
+    case Opcode::kUseType:
+      return true;
+    case Opcode::kLoadField: {
+      auto& load = static_cast<const LoadField&>(instr);
+      return load.type() <= TPrimitive &&
+          valueMemberIndex(alloc.valueType(), load.offset()).has_value();
+    }
+    case Opcode::kStoreField: {
+      auto& store = static_cast<const StoreField&>(instr);
+      return store.receiver() == reg && store.value() != reg &&
+          store.type() <= TPrimitive &&
+          valueMemberIndex(alloc.valueType(), store.offset()).has_value();
+    }
+    default:
+      return false;
+  }
+}
+
+void ScalarReplacer::analyzeFrameStates(Instr& instr, FrameState* fs) {
+  // Which allocations each frame of the chain refers to, so we can spot
+  // objects shared between an inlined function and its caller.
+  std::unordered_map<Register*, const FrameState*> seen;
+  FrameState* innermost = fs;
+  for (; fs != nullptr; fs = fs->parent) {
+    auto visit = [&](Register* reg) {
+      if (reg == nullptr) {
+        return;
+      }
+      Allocation* alloc = allocationFor(reg);
+      if (alloc == nullptr) {
+        return;
+      }
+      if (alloc->kind == VirtualObject::Kind::kValue &&
+          (fs != innermost || instr.block() != alloc->instr->block())) {
+        alloc->escapes = true;
+      }
+      auto [it, inserted] = seen.emplace(reg, fs);
+      if (!inserted && it->second != fs) {
+        alloc->escapes = true;
+      }
+    };
+    for (Register* reg : fs->locals) {
+      visit(reg);
+    }
+    for (Register* reg : fs->cells) {
+      visit(reg);
+    }
+    for (Register* reg : fs->stack) {
+      visit(reg);
+    }
+  }
+}
+
+// Check that every member of a value object is written before it's read, so
+// reads can be replaced with the value that was last written.
+void ScalarReplacer::analyzeValueObject(Allocation& alloc) {
+  Register* reg = alloc.instr->GetOutput();
+  PyTypeObject* type = alloc.valueType();
+  std::vector<bool> written(alloc.fields.size(), false);
+  BasicBlock* block = alloc.instr->block();
+  for (auto it = std::next(block->iterator_to(*alloc.instr));
+       it != block->end();
+       ++it) {
+    if (it->IsStoreField()) {
+      auto& store = static_cast<const StoreField&>(*it);
+      if (store.receiver() == reg) {
+        written[*valueMemberIndex(type, store.offset())] = true;
+      }
+    } else if (it->IsLoadField()) {
+      auto& load = static_cast<const LoadField&>(*it);
+      if (load.receiver() == reg &&
+          !written[*valueMemberIndex(type, load.offset())]) {
+        alloc.escapes = true;
+        return;
+      }
+    }
+  }
+}
+
+void ScalarReplacer::replaceValueObject(const Allocation& alloc) {
+  Register* reg = alloc.instr->GetOutput();
+  PyTypeObject* type = alloc.valueType();
+  std::vector<Register*> fields = alloc.fields;
+  BasicBlock* block = alloc.instr->block();
+  for (auto it = std::next(block->iterator_to(*alloc.instr));
+       it != block->end();) {
+    Instr& instr = *it++;
+
+    FrameState* fs = nullptr;
+    if (auto deopt = instr.asDeoptBase()) {
+      fs = deopt->frameState();
+    } else if (instr.IsSnapshot()) {
+      fs = static_cast<Snapshot&>(instr).frameState();
+    }
+    if (fs != nullptr && fs->findVirtualObject(reg) == nullptr &&
+        frameRefersTo(*fs, reg)) {
+      fs->virtual_objects.emplace_back(
+          VirtualObject{VirtualObject::Kind::kValue, reg, fields, type});
+    }
+
+    if (instr.IsStoreField()) {
+      auto& store = static_cast<StoreField&>(instr);
+      if (store.receiver() == reg) {
+        fields[*valueMemberIndex(type, store.offset())] = store.value();
+        store.unlink();
+        delete &store;
+      }
+    } else if (instr.IsLoadField()) {
+      auto& load = static_cast<LoadField&>(instr);
+      if (load.receiver() == reg) {
+        auto assign = Assign::create(
+            load.GetOutput(), fields[*valueMemberIndex(type, load.offset())]);
+        assign->copyBytecodeOffset(load);
+        load.ReplaceWith(*assign);
+        delete &load;
+      }
+    } else if (instr.IsUseType() && instr.GetOperand(0) == reg) {
+      instr.unlink();
+      delete &instr;
+    }
+  }
+}
+
+void ScalarReplacer::rewriteUse(Instr& instr, const Allocation& alloc) {
+  Register* output = instr.GetOutput();
+  Instr* replacement = nullptr;
+  switch (instr.opcode()) {
+    case Opcode::kLoadTupleItem: {
+      std::size_t idx = static_cast<const LoadTupleItem&>(instr).idx();
+      replacement = Assign::create(output, alloc.fields[idx]);
+      break;
+    }
+    case Opcode::kLoadCellItem:
+    case Opcode::kPrimitiveUnbox:
+      replacement = Assign::create(output, alloc.fields[0]);
+      break;
+    case Opcode::kLoadVarObjectSize:
+      replacement = LoadConst::create(
+          output, Type::fromCInt(alloc.fields.size(), TCInt64));
+      break;
+    default:
+      break;
+  }
+  if (replacement != nullptr) {
+    replacement->copyBytecodeOffset(instr);
+    instr.ReplaceWith(*replacement);
+  } else {
+    instr.unlink();
+  }
+  delete &instr;
+}
+
+void ScalarReplacer::virtualizeFrameState(FrameState* fs) {
+  for (; fs != nullptr; fs = fs->parent) {
+    auto visit = [&](Register* reg) {
+      if (reg == nullptr || fs->findVirtualObject(reg) != nullptr) {
+        return;
+      }
+      Allocation* alloc = allocationFor(reg);
+      if (alloc == nullptr || alloc->escapes ||
+          alloc->kind == VirtualObject::Kind::kValue) {
+        return;
+      }
+      fs->virtual_objects.emplace_back(
+          VirtualObject{alloc->kind, reg, alloc->fields});
+    };
+    for (Register* reg : fs->locals) {
+      visit(reg);
+    }
+    for (Register* reg : fs->cells) {
+      visit(reg);
+    }
+    for (Register* reg : fs->stack) {
+      visit(reg);
+    }
+  }
+}
+
+int ScalarReplacer::run() {
+  findAllocations();
+  if (allocs_.empty()) {
+    return 0;
+  }
+
+  std::vector<FrameState*> frame_states;
+  for (auto& block : func_.cfg.blocks) {
+    for (auto& instr : block) {
+      FrameState* fs = nullptr;
+      if (auto deopt = instr.asDeoptBase()) {
+        fs = deopt->frameState();
+        if (Allocation* alloc = allocationFor(deopt->guiltyReg())) {
+          alloc->escapes = true;
+        }
+      } else if (instr.IsSnapshot()) {
+        fs = static_cast<Snapshot&>(instr).frameState();
+      }
+      if (fs != nullptr) {
+        analyzeFrameStates(instr, fs);
+        frame_states.emplace_back(fs);
+      }
+
+      for (std::size_t i = 0, n = instr.NumOperands(); i < n; ++i) {
+        if (Allocation* alloc = allocationFor(instr.GetOperand(i))) {
+          analyzeUse(instr, *alloc);
+        }
+      }
+    }
+  }
+
+  for (auto& [reg, alloc] : allocs_) {
+    if (alloc.kind == VirtualObject::Kind::kValue && !alloc.escapes) {
+      analyzeValueObject(alloc);
+    }
+  }
+
+  int num_removed = 0;
+  for (auto& [reg, alloc] : allocs_) {
+    if (alloc.escapes) {
+      continue;
+    }
+    JIT_DLOG("Scalar replacing {} in {}", reg->name(), func_.fullname);
+    if (alloc.kind == VirtualObject::Kind::kValue) {
+      replaceValueObject(alloc);
+    } else {
+      for (Instr* use : alloc.uses) {
+        rewriteUse(*use, alloc);
+      }
+    }
+    num_removed++;
+  }
+  if (num_removed == 0) {
+    return 0;
+  }
+
+  // Frame states have to be updated before the allocations are deleted, since
+  // parents may be shared between many instructions.
+  for (FrameState* fs : frame_states) {
+    virtualizeFrameState(fs);
+  }
+  for (auto& [reg, alloc] : allocs_) {
+    if (!alloc.escapes) {
+      alloc.instr->unlink();
+      delete alloc.instr;
+      reg->set_instr(nullptr);
+    }
+  }
+  return num_removed;
+}
+
+} // namespace
+
+void ScalarReplacement::Run(Function& irfunc) {
+  int num_removed = ScalarReplacer{irfunc}.run();
+  if (num_removed == 0) {
+    return;
+  }
+  irfunc.optimization_stats.num_scalar_replaced += num_removed;
+  CopyPropagation{}.Run(irfunc);
+  reflowTypes(irfunc);
+}
+
+} // namespace jit::hir
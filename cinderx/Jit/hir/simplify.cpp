@@ -591,6 +591,7 @@ Register* simplifyBinaryOp(Env& env, const BinaryOp* instr) {
     if (lhs_type <= TUnicodeExact && rhs_type <= TLongExact) { // Unicode subscr
       if (lhs_type.hasObjectSpec() && rhs_type.hasObjectSpec()) {
         // Constant propagation
+        ThreadedCompileSerialize guard;
         Py_ssize_t idx = PyLong_AsSsize_t(rhs_type.objectSpec());
         if (idx == -1 && PyErr_Occurred()) {
           PyErr_Clear();
@@ -606,7 +607,6 @@ Register* simplifyBinaryOp(Env& env, const BinaryOp* instr) {
           idx += n;
         }
 
-        ThreadedCompileSerialize guard;
         Py_UCS4 c = PyUnicode_ReadChar(lhs_type.objectSpec(), idx);
         PyObject* substr =
             PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &c, 1);
@@ -892,10 +892,14 @@ Register* simplifyLoadAttrMemberDescr(Env& env, const DescrInfo& info) {
   }
 
   if (def->type == T_OBJECT || def->type == T_OBJECT_EX) {
-    const char* name_cstr = PyUnicode_AsUTF8(info.attr_name);
-    if (name_cstr == nullptr) {
-      PyErr_Clear();
-      name_cstr = "<unknown>";
+    const char* name_cstr;
+    {
+      ThreadedCompileSerialize guard;
+      name_cstr = PyUnicode_AsUTF8(info.attr_name);
+      if (name_cstr == nullptr) {
+        PyErr_Clear();
+        name_cstr = "<unknown>";
+      }
     }
     emitTypeAttrDeoptPatcher(env, info, "member descriptor attribute");
     env.emit<UseType>(info.receiver, info.type);
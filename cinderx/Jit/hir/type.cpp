@@ -157,6 +157,10 @@ std::string Type::specString() const {
     return typeSpec()->tp_name;
   }
 
+  // Formatting some objects caches data in them or can set and clear an
+  // exception.
+  ThreadedCompileSerialize guard;
+
   if (*this <= TUnicode) {
     Py_ssize_t size;
     auto utf8 = PyUnicode_AsUTF8AndSize(objectSpec(), &size);
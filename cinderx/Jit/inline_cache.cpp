@@ -4,12 +4,14 @@
 
 #include "Objects/dict-common.h"
 #include "Python.h"
+#include "cinderx/Common/attr_lookup_cache.h"
 #include "cinderx/Common/util.h"
 #include "cinderx/Common/watchers.h"
 #include "cinderx/StaticPython/strictmoduleobject.h"
 
 #include "cinderx/Jit/codegen/gen_asm.h"
 #include "cinderx/Jit/containers.h"
+#include "cinderx/Jit/runtime.h"
 
 #include <algorithm>
 #include <memory>
@@ -131,31 +133,105 @@ AttributeMutator::Kind AttributeMutator::get_kind() const {
   return static_cast<Kind>(type_ & kKindMask);
 }
 
-AttributeCache::AttributeCache() {
-  for (auto& entry : entries()) {
-    entry.reset();
+std::string_view inlineCacheStateName(InlineCacheState state) {
+  switch (state) {
+    case InlineCacheState::kEmpty:
+      return "empty";
+    case InlineCacheState::kMonomorphic:
+      return "monomorphic";
+    case InlineCacheState::kPolymorphic:
+      return "polymorphic";
+    case InlineCacheState::kMegamorphic:
+      return "megamorphic";
+  }
+  JIT_ABORT("Unknown inline cache state {}", static_cast<int>(state));
+}
+
+// Number of entries a cache can hold before it becomes megamorphic, including
+// the inline monomorphic entry.
+static size_t maxCacheEntries() {
+  return getConfig().attr_cache_size;
+}
+
+// Compute the state of a cache from the number of entries in use.
+static InlineCacheState cacheState(size_t num_used, bool megamorphic) {
+  if (megamorphic) {
+    return InlineCacheState::kMegamorphic;
+  }
+  switch (num_used) {
+    case 0:
+      return InlineCacheState::kEmpty;
+    case 1:
+      return InlineCacheState::kMonomorphic;
+    default:
+      return InlineCacheState::kPolymorphic;
   }
 }
 
 AttributeCache::~AttributeCache() {
-  for (auto& entry : entries()) {
+  auto unwatch = [this](AttributeMutator& entry) {
     if (entry.type() != nullptr) {
       ac_watcher.unwatch(entry.type(), this);
       entry.reset();
     }
+  };
+  unwatch(mono_);
+  for (size_t i = 0; i < numPolyEntries(); i++) {
+    unwatch(poly_[i]);
   }
 }
 
 void AttributeCache::typeChanged(PyTypeObject*) {
-  for (auto& entry : entries()) {
-    entry.reset();
+  mono_.reset();
+  for (size_t i = 0; i < numPolyEntries(); i++) {
+    poly_[i].reset();
+  }
+}
+
+InlineCacheState AttributeCache::state() const {
+  size_t num_used = mono_.isEmpty() ? 0 : 1;
+  for (size_t i = 0; i < numPolyEntries(); i++) {
+    num_used += poly_[i].isEmpty() ? 0 : 1;
+  }
+  return cacheState(num_used, megamorphic_);
+}
+
+size_t AttributeCache::numPolyEntries() const {
+  return poly_ == nullptr ? 0 : maxCacheEntries() - 1;
+}
+
+AttributeMutator* AttributeCache::findEntry(PyTypeObject* type) {
+  if (mono_.type() == type) {
+    return &mono_;
   }
+  for (size_t i = 0; i < numPolyEntries(); i++) {
+    if (poly_[i].type() == type) {
+      return &poly_[i];
+    }
+  }
+  return nullptr;
+}
+
+AttributeMutator* AttributeCache::findEmptyEntry() {
+  if (mono_.isEmpty()) {
+    return &mono_;
+  }
+  if (poly_ == nullptr && maxCacheEntries() > 1) {
+    poly_ = std::make_unique<AttributeMutator[]>(maxCacheEntries() - 1);
+  }
+  for (size_t i = 0; i < numPolyEntries(); i++) {
+    if (poly_[i].isEmpty()) {
+      return &poly_[i];
+    }
+  }
+  return nullptr;
 }
 
 void AttributeCache::fill(
     BorrowedRef<PyTypeObject> type,
     BorrowedRef<> name,
-    BorrowedRef<> descr) {
+    BorrowedRef<> descr,
+    MegamorphicCache<AttributeMutator>* shared) {
   if (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
     // The type must have a valid version tag in order for us to be able to
     // invalidate the cache when the type is modified. See the comment at
@@ -163,9 +239,16 @@ void AttributeCache::fill(
     return;
   }
 
-  AttributeMutator* mut = findEmptyEntry();
-  if (mut == nullptr) {
-    return;
+  AttributeMutator* mut = megamorphic_ ? nullptr : findEmptyEntry();
+  // Entries in the shared cache are invalidated by the type's version tag
+  // rather than by watching the type.
+  bool is_shared = mut == nullptr;
+  if (is_shared) {
+    megamorphic_ = true;
+    if (shared == nullptr) {
+      return;
+    }
+    mut = shared->claim(type, name);
   }
 
   if (descr != nullptr) {
@@ -175,6 +258,11 @@ void AttributeCache::fill(
       // Data descriptor
       if (descr_type == &PyMemberDescr_Type) {
         mut->set_member_descr(type, descr);
+      } else if (is_shared) {
+        // Changes to descr_type can't be detected through type's version
+        // tag, so don't share the entry.
+        mut->reset();
+        return;
       } else {
         // If someone deletes descr_types's __set__ method, it will no longer
         // be a data descriptor, and the cache kind has to change.
@@ -185,7 +273,9 @@ void AttributeCache::fill(
       // Non-data descriptor or class var
       mut->set_descr_or_classvar(type, descr);
     }
-    ac_watcher.watch(type, this);
+    if (!is_shared) {
+      ac_watcher.watch(type, this);
+    }
     return;
   }
 
@@ -193,6 +283,7 @@ void AttributeCache::fill(
       !PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)) {
     // We only support the common case for objects - fixed-size instances
     // (tp_dictoffset >= 0) of heap types (Py_TPFLAGS_HEAPTYPE).
+    mut->reset();
     return;
   }
 
@@ -207,17 +298,9 @@ void AttributeCache::fill(
   } else {
     mut->set_combined(type);
   }
-  ac_watcher.watch(type, this);
-}
-
-std::span<AttributeMutator> AttributeCache::entries() {
-  return {entries_, getConfig().attr_cache_size};
-}
-
-AttributeMutator* AttributeCache::findEmptyEntry() {
-  auto it = std::ranges::find_if(
-      entries(), [](const AttributeMutator& e) { return e.isEmpty(); });
-  return it == entries().end() ? nullptr : &*it;
+  if (!is_shared) {
+    ac_watcher.watch(type, this);
+  }
 }
 
 inline PyObject*
@@ -488,7 +571,7 @@ StoreAttrCache::invokeSlowPath(PyObject* obj, PyObject* name, PyObject* value) {
     descrsetfunc f = descr->ob_type->tp_descr_set;
     if (f != nullptr) {
       int res = f(descr, obj, value);
-      fill(tp, name, descr);
+      fill(tp, name, descr, &Runtime::get()->megamorphicStoreAttrCache());
       return (res == -1) ? nullptr : Py_None;
     }
   }
@@ -512,7 +595,7 @@ StoreAttrCache::invokeSlowPath(PyObject* obj, PyObject* name, PyObject* value) {
     _PyType_ClearNoShadowingInstances(tp, descr);
   }
   if (res != -1) {
-    fill(tp, name, descr);
+    fill(tp, name, descr, &Runtime::get()->megamorphicStoreAttrCache());
   }
 
   return (res == -1) ? nullptr : Py_None;
@@ -529,9 +612,14 @@ PyObject* StoreAttrCache::invoke(
 PyObject*
 StoreAttrCache::doInvoke(PyObject* obj, PyObject* name, PyObject* value) {
   PyTypeObject* tp = Py_TYPE(obj);
-  for (auto& entry : entries()) {
-    if (entry.type() == tp) {
-      return entry.setAttr(obj, name, value);
+  if (AttributeMutator* entry = findEntry(tp)) {
+    return entry->setAttr(obj, name, value);
+  }
+  if (isMegamorphic()) {
+    AttributeMutator* entry =
+        Runtime::get()->megamorphicStoreAttrCache().lookup(tp, name);
+    if (entry != nullptr && !entry->isEmpty()) {
+      return entry->setAttr(obj, name, value);
     }
   }
   return invokeSlowPath(obj, name, value);
@@ -556,7 +644,7 @@ LoadAttrCache::invokeSlowPath(PyObject* obj, PyObject* name) {
   if (descr != nullptr) {
     f = descr->ob_type->tp_descr_get;
     if (f != nullptr && PyDescr_IsData(descr)) {
-      fill(tp, name, descr);
+      fill(tp, name, descr, nullptr);
       return f(descr, obj, tp);
     }
   }
@@ -570,18 +658,18 @@ LoadAttrCache::invokeSlowPath(PyObject* obj, PyObject* name) {
   if (dict != nullptr) {
     auto res = Ref<>::create(PyDict_GetItem(dict, name));
     if (res != nullptr) {
-      fill(tp, name, descr);
+      fill(tp, name, descr, nullptr);
       return res.release();
     }
   }
 
   if (f != nullptr) {
-    fill(tp, name, descr);
+    fill(tp, name, descr, nullptr);
     return f(descr, obj, tp);
   }
 
   if (descr != nullptr) {
-    fill(tp, name, descr);
+    fill(tp, name, descr, nullptr);
     return descr.release();
   }
 
@@ -632,10 +720,11 @@ LoadAttrCache::invoke(LoadAttrCache* cache, PyObject* obj, PyObject* name) {
 
 PyObject* LoadAttrCache::doInvoke(PyObject* obj, PyObject* name) {
   PyTypeObject* tp = Py_TYPE(obj);
-  for (auto& entry : entries()) {
-    if (entry.type() == tp) {
-      return entry.getAttr(obj, name);
-    }
+  if (AttributeMutator* entry = findEntry(tp)) {
+    return entry->getAttr(obj, name);
+  }
+  if (isMegamorphic()) {
+    return Ci_AttrLookupCache_GetAttr(obj, name);
   }
   return invokeSlowPath(obj, name);
 }
@@ -863,26 +952,50 @@ const CacheStats* LoadMethodCache::cacheStats() {
 }
 
 LoadMethodCache::~LoadMethodCache() {
-  for (auto& entry : entries_) {
+  auto unwatch = [this](Entry& entry) {
     if (entry.type != nullptr) {
       lm_watcher.unwatch(entry.type, this);
       entry.type.reset();
       entry.value.reset();
     }
+  };
+  unwatch(mono_);
+  for (auto& entry : polyEntries()) {
+    unwatch(entry);
   }
 }
 
 void LoadMethodCache::typeChanged(PyTypeObject* type) {
-  for (auto& entry : entries_) {
+  auto invalidate = [type](Entry& entry) {
     if (entry.type == type) {
       entry.type.reset();
       entry.value.reset();
     }
+  };
+  invalidate(mono_);
+  for (auto& entry : polyEntries()) {
+    invalidate(entry);
+  }
+}
+
+InlineCacheState LoadMethodCache::state() const {
+  size_t num_used = mono_.type == nullptr ? 0 : 1;
+  for (auto& entry : polyEntries()) {
+    num_used += entry.type == nullptr ? 0 : 1;
+  }
+  return cacheState(num_used, megamorphic_);
+}
+
+std::span<LoadMethodCache::Entry> LoadMethodCache::polyEntries() const {
+  if (poly_ == nullptr) {
+    return {};
   }
+  return {poly_.get(), maxCacheEntries() - 1};
 }
 
 void LoadMethodCache::fill(
     BorrowedRef<PyTypeObject> type,
+    BorrowedRef<> name,
     BorrowedRef<> value) {
   if (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
     // The type must have a valid version tag in order for us to be able to
@@ -896,14 +1009,29 @@ void LoadMethodCache::fill(
     return;
   }
 
-  for (auto& entry : entries_) {
-    if (entry.type == nullptr) {
+  if (!megamorphic_) {
+    if (poly_ == nullptr && mono_.type != nullptr && maxCacheEntries() > 1) {
+      poly_ = std::make_unique<Entry[]>(maxCacheEntries() - 1);
+    }
+    Entry* empty = mono_.type == nullptr ? &mono_ : nullptr;
+    for (auto& entry : polyEntries()) {
+      if (empty == nullptr && entry.type == nullptr) {
+        empty = &entry;
+      }
+    }
+    if (empty != nullptr) {
       lm_watcher.watch(type, this);
-      entry.type = type;
-      entry.value = value;
+      empty->type = type;
+      empty->value = value;
       return;
     }
+    megamorphic_ = true;
   }
+
+  // Shadowing an attribute on an instance clears
+  // Py_TPFLAGS_NO_SHADOWING_INSTANCES through PyType_Modified(), which also
+  // invalidates the type's version tag and with it this entry.
+  *Runtime::get()->megamorphicLoadMethodCache().claim(type, name) = value;
 }
 
 static void maybeCollectCacheStats(
@@ -977,7 +1105,7 @@ LoadMethodCache::lookupSlowPath(BorrowedRef<> obj, BorrowedRef<> name) {
   }
 
   if (is_method) {
-    fill(tp, descr);
+    fill(tp, name, descr);
     Py_INCREF(obj);
     return {descr, obj};
   }
@@ -1011,12 +1139,24 @@ JITRT_LoadMethodResult LoadMethodCache::lookup(
     BorrowedRef<> name) {
   BorrowedRef<PyTypeObject> tp = Py_TYPE(obj);
 
-  for (auto& entry : entries_) {
+  auto hit = [&](BorrowedRef<> value) -> JITRT_LoadMethodResult {
+    Py_INCREF(value);
+    Py_INCREF(obj);
+    return {value, obj};
+  };
+  if (mono_.type == tp) {
+    return hit(mono_.value);
+  }
+  for (auto& entry : polyEntries()) {
     if (entry.type == tp) {
-      PyObject* result = entry.value;
-      Py_INCREF(result);
-      Py_INCREF(obj);
-      return {result, obj};
+      return hit(entry.value);
+    }
+  }
+  if (megamorphic_) {
+    BorrowedRef<>* value =
+        Runtime::get()->megamorphicLoadMethodCache().lookup(tp, name);
+    if (value != nullptr && *value != nullptr) {
+      return hit(*value);
     }
   }
 
@@ -15,7 +15,9 @@
 #include <array>
 #include <memory>
 #include <span>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace jit {
 
@@ -76,8 +78,19 @@ class AttributeMutator {
       static_cast<uint8_t>(Kind::kMaxValue) <= 8,
       "Kind enum should fit in 3 bits");
 
+  // Generated code handles split dict attributes inline: an entry holds one
+  // for type iff the word at typeWord() is the address of type tagged with
+  // kSplitTag, in which case split() describes where to find it.
+  static constexpr uintptr_t kSplitTag = static_cast<uintptr_t>(Kind::kSplit);
+
   AttributeMutator();
   PyTypeObject* type() const;
+  uintptr_t* typeWord() {
+    return &type_;
+  }
+  SplitMutator& split() {
+    return split_;
+  }
   void reset();
   bool isEmpty() const;
   void set_combined(PyTypeObject* type);
@@ -106,30 +119,122 @@ class AttributeMutator {
   };
 };
 
+// A direct-mapped cache from (type, name) to a value, shared by all inline
+// caches of one kind once they have seen too many receiver types. Entries are
+// keyed on the type's version tag, so they go stale as soon as the type is
+// modified and don't need to be invalidated.
+template <typename T>
+class MegamorphicCache {
+ public:
+  // Return the value cached for type and name, or nullptr if there isn't one.
+  T* lookup(BorrowedRef<PyTypeObject> type, BorrowedRef<> name) {
+    if (!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+      return nullptr;
+    }
+    Entry& entry = entries_[index(type, name)];
+    if (entry.type != type || entry.name.get() != name ||
+        entry.version != type->tp_version_tag) {
+      return nullptr;
+    }
+    return &entry.value;
+  }
+
+  // Evict whatever is in the slot for type and name and return its value to be
+  // filled in. The type must have a valid version tag.
+  T* claim(BorrowedRef<PyTypeObject> type, BorrowedRef<> name) {
+    JIT_DCHECK(
+        PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG),
+        "Type must have a valid version tag");
+    Entry& entry = entries_[index(type, name)];
+    entry.type = type;
+    entry.version = type->tp_version_tag;
+    entry.name = Ref<>::create(name);
+    entry.value = T{};
+    return &entry.value;
+  }
+
+ private:
+  static constexpr size_t kNumEntries = 1024;
+
+  struct Entry {
+    BorrowedRef<PyTypeObject> type;
+    unsigned int version{0};
+    // Owned, so that a different name can't later show up at the same address.
+    Ref<> name;
+    T value{};
+  };
+
+  static size_t index(BorrowedRef<PyTypeObject> type, BorrowedRef<> name) {
+    return (type->tp_version_tag ^
+            (reinterpret_cast<uintptr_t>(name.get()) >> 4)) %
+        kNumEntries;
+  }
+
+  std::array<Entry, kNumEntries> entries_;
+};
+
+// How many receiver types an inline cache has seen. Caches start out empty,
+// hold a single entry while monomorphic and grow to getConfig().attr_cache_size
+// entries while polymorphic. When they run out of entries they become
+// megamorphic and use a cache shared by all caches of their kind:
+// Ci_AttrLookupCache for LoadAttr, a MegamorphicCache for the others.
+enum class InlineCacheState : uint8_t {
+  kEmpty,
+  kMonomorphic,
+  kPolymorphic,
+  kMegamorphic,
+};
+
+constexpr size_t kNumInlineCacheStates = 4;
+
+std::string_view inlineCacheStateName(InlineCacheState state);
+
+// Number of inline caches of one kind in each state, indexed by state.
+using InlineCacheStateCounts = std::array<size_t, kNumInlineCacheStates>;
+
 class AttributeCache {
  public:
-  AttributeCache();
+  AttributeCache() = default;
   ~AttributeCache();
 
   void typeChanged(PyTypeObject* type);
 
+  InlineCacheState state() const;
+
+  // The entry used while the cache is monomorphic. It lives inside the cache,
+  // so its address is fixed and generated code can check it inline.
+  AttributeMutator& monoEntry() {
+    return mono_;
+  }
+
  protected:
-  std::span<AttributeMutator> entries();
+  // Find the per-site entry for type, or nullptr.
+  AttributeMutator* findEntry(PyTypeObject* type);
+
+  // Cache the attribute, either in a per-site entry or, once the cache is
+  // megamorphic, in shared. Caches whose megamorphic lookups go elsewhere pass
+  // nullptr for shared.
+  void fill(
+      BorrowedRef<PyTypeObject> type,
+      BorrowedRef<> name,
+      BorrowedRef<> descr,
+      MegamorphicCache<AttributeMutator>* shared);
+
+  bool isMegamorphic() const {
+    return megamorphic_;
+  }
 
+ private:
+  // Return an empty per-site entry, growing the cache if needed, or nullptr if
+  // it is full.
   AttributeMutator* findEmptyEntry();
 
-  void
-  fill(BorrowedRef<PyTypeObject> type, BorrowedRef<> name, BorrowedRef<> descr);
-
-  AttributeMutator entries_[0];
-};
+  size_t numPolyEntries() const;
 
-struct AttributeCacheSizeTrait {
-  static size_t size() {
-    auto base = sizeof(AttributeCache);
-    auto extra = sizeof(AttributeMutator) * getConfig().attr_cache_size;
-    return base + extra;
-  }
+  AttributeMutator mono_;
+  // Entries after the first, allocated when a second receiver type shows up.
+  std::unique_ptr<AttributeMutator[]> poly_;
+  bool megamorphic_{false};
 };
 
 // A cache for an individual StoreAttr instruction.
@@ -238,15 +343,25 @@ class LoadMethodCache {
   JITRT_LoadMethodResult lookup(BorrowedRef<> obj, BorrowedRef<> name);
   void typeChanged(PyTypeObject* type);
 
+  InlineCacheState state() const;
+
   void initCacheStats(const char* filename, const char* method_name);
   void clearCacheStats();
   const CacheStats* cacheStats();
 
  private:
   JITRT_LoadMethodResult lookupSlowPath(BorrowedRef<> obj, BorrowedRef<> name);
-  void fill(BorrowedRef<PyTypeObject> type, BorrowedRef<> value);
+  void fill(
+      BorrowedRef<PyTypeObject> type,
+      BorrowedRef<> name,
+      BorrowedRef<> value);
+
+  std::span<Entry> polyEntries() const;
 
-  std::array<Entry, 4> entries_;
+  Entry mono_;
+  // Entries after the first, allocated when a second receiver type shows up.
+  std::unique_ptr<Entry[]> poly_;
+  bool megamorphic_{false};
   std::unique_ptr<CacheStats> cache_stats_;
 };
 
@@ -321,6 +436,10 @@ void notifyICsTypeChanged(BorrowedRef<PyTypeObject> type);
 
 struct FunctionEntryCacheValue {
   void** ptr{nullptr};
+  // Stubs that call the function through JITRT_FailedDeferredCompileShim(),
+  // one per compiled caller; *ptr holds the newest one while the function
+  // isn't compiled. Each stub lives in its caller's code.
+  std::vector<void*> fallbacks;
   Ref<_PyTypedArgsInfo> arg_info;
 };
 
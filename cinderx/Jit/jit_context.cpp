@@ -3,11 +3,14 @@
 #include "cinderx/Jit/jit_context.h"
 
 #include "cinderx/Common/log.h"
+#include "frameobject.h"
+#include "pycore_shadow_frame.h"
 
 #include "cinderx/Jit/codegen/gen_asm.h"
 #include "cinderx/Jit/jit_gdb_support.h"
 #include "cinderx/Jit/pyjit.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 namespace jit {
@@ -45,6 +48,66 @@ _PyJIT_Result Context::compilePreloader(
   return PYJIT_RESULT_OK;
 }
 
+vectorcallfunc Context::compileOSR(
+    BorrowedRef<PyCodeObject> code,
+    BorrowedRef<PyDictObject> builtins,
+    BorrowedRef<PyDictObject> globals,
+    const hir::OSREntry& osr_entry) {
+  CompilationKey key{code, builtins, globals};
+  {
+    ThreadedCompileSerialize guard;
+    auto& entries = osr_codes_[key];
+    auto it = entries.find(osr_entry.bc_offset);
+    if (it != entries.end()) {
+      return it->second != nullptr ? it->second->vectorcallEntry() : nullptr;
+    }
+  }
+
+  // OSR entries receive the interpreter's fastlocals and value stack as one
+  // contiguous array, which rules out cells and free variables. Generators
+  // and Static Python functions have their own entry protocols.
+  int required_flags = CO_OPTIMIZED | CO_NEWLOCALS;
+  int prohibited_flags =
+      CO_SUPPRESS_JIT | CO_STATICALLY_COMPILED | kCoFlagsAnyGenerator;
+  std::unique_ptr<CompiledFunction> compiled;
+  if ((code->co_flags & required_flags) == required_flags &&
+      (code->co_flags & prohibited_flags) == 0 &&
+      PyTuple_GET_SIZE(code->co_cellvars) == 0 &&
+      PyTuple_GET_SIZE(code->co_freevars) == 0 &&
+      compile_depth < kMaxCompileDepth) {
+    BorrowedRef<> module = PyDict_GetItemString(globals, "__name__");
+    std::unique_ptr<hir::Preloader> preloader = hir::Preloader::makePreloader(
+        code, builtins, globals, codeFullname(module, code));
+    if (preloader == nullptr) {
+      // The interpreter will raise the same error if it matters, at the point
+      // where it would normally happen.
+      PyErr_Clear();
+    } else {
+      compile_depth++;
+      compiled = jit_compiler_.Compile(*preloader, osr_entry);
+      compile_depth--;
+    }
+  }
+
+  ThreadedCompileSerialize guard;
+  auto pair = osr_codes_[key].emplace(osr_entry.bc_offset, std::move(compiled));
+  CompiledFunction* result = pair.first->second.get();
+  return result != nullptr ? result->vectorcallEntry() : nullptr;
+}
+
+void Context::codeDestroyed(BorrowedRef<PyCodeObject> code) {
+  ThreadedCompileSerialize guard;
+  std::vector<CompilationKey> keys;
+  for (const auto& [key, entries] : osr_codes_) {
+    if (key.code == code) {
+      keys.emplace_back(key);
+    }
+  }
+  for (const CompilationKey& key : keys) {
+    osr_codes_.erase(key);
+  }
+}
+
 _PyJIT_Result Context::attachCompiledCode(BorrowedRef<PyFunctionObject> func) {
   JIT_DCHECK(!didCompile(func), "Function is already compiled");
 
@@ -60,7 +123,19 @@ void Context::funcModified(BorrowedRef<PyFunctionObject> func) {
 }
 
 void Context::funcDestroyed(BorrowedRef<PyFunctionObject> func) {
-  compiled_funcs_.erase(func);
+  if (compiled_funcs_.erase(func) == 0) {
+    return;
+  }
+  // If the only other reference to the code object is the one held by its
+  // CodeRuntime, the code isn't shared with another function or nested in
+  // another code object, so no function can use the compiled code again.
+  // func_code is null if the function was cleared by the GC.
+  PyObject* code = func->func_code;
+  if (code == nullptr || Py_REFCNT(code) > 2) {
+    return;
+  }
+  retireCode(CompilationKey{code, func->func_builtins, func->func_globals});
+  reclaimRetiredCode();
 }
 
 bool Context::didCompile(BorrowedRef<PyFunctionObject> func) {
@@ -137,6 +212,31 @@ const hir::OpcodeCounts* Context::hirOpcodeCounts(
   return jit_func != nullptr ? &jit_func->hirOpcodeCounts() : nullptr;
 }
 
+Ref<> Context::optimizationStats(BorrowedRef<PyFunctionObject> func) {
+  CompiledFunction* jitfunc = lookupFunc(func);
+  if (jitfunc == nullptr) {
+    return nullptr;
+  }
+  const hir::Function::OptimizationStats& stats = jitfunc->optimizationStats();
+  auto py_stats = Ref<>::steal(PyDict_New());
+  if (py_stats == nullptr) {
+    return nullptr;
+  }
+  std::pair<const char*, int> entries[] = {
+      {"num_gvn_eliminated", stats.num_gvn_eliminated},
+      {"num_scalar_replaced", stats.num_scalar_replaced},
+      {"num_float_ops_unboxed", stats.num_float_ops_unboxed},
+  };
+  for (auto& [name, value] : entries) {
+    auto py_value = Ref<>::steal(PyLong_FromLong(value));
+    if (py_value == nullptr ||
+        PyDict_SetItemString(py_stats, name, py_value) < 0) {
+      return nullptr;
+    }
+  }
+  return py_stats;
+}
+
 int Context::printHIR(BorrowedRef<PyFunctionObject> func) {
   CompiledFunction* jit_func = lookupFunc(func);
   if (jit_func == nullptr) {
@@ -170,6 +270,97 @@ void Context::clearCache() {
   compiled_codes_.clear();
 }
 
+bool Context::evictCode(CodeRuntime* code_rt) {
+  ThreadedCompileSerialize guard;
+  const RuntimeFrameState* frame_state = code_rt->frameState();
+  CompilationKey key{
+      frame_state->code(), frame_state->builtins(), frame_state->globals()};
+  auto it = compiled_codes_.find(key);
+  if (it == compiled_codes_.end() || it->second->codeRuntime() != code_rt) {
+    return false;
+  }
+  retireCode(key);
+
+  std::vector<BorrowedRef<PyFunctionObject>> funcs;
+  for (BorrowedRef<PyFunctionObject> func : compiled_funcs_) {
+    if (func->func_code == key.code && func->func_builtins == key.builtins &&
+        func->func_globals == key.globals) {
+      funcs.emplace_back(func);
+    }
+  }
+  for (BorrowedRef<PyFunctionObject> func : funcs) {
+    deoptFunc(func);
+  }
+  // The caller is usually still executing the evicted code, so it will be
+  // freed by a later call.
+  reclaimRetiredCode();
+  return true;
+}
+
+void Context::retireCode(const CompilationKey& key) {
+  ThreadedCompileSerialize guard;
+  auto retire = [this](std::unique_ptr<CompiledFunction> compiled) {
+    if (compiled == nullptr) {
+      return;
+    }
+    BorrowedRef<PyCodeObject> code =
+        compiled->codeRuntime()->frameState()->code();
+    if (code->co_flags & (kCoFlagsAnyGenerator | CO_STATICALLY_COMPILED)) {
+      orphaned_compiled_codes_.emplace_back(std::move(compiled));
+    } else {
+      retired_compiled_codes_.emplace_back(std::move(compiled));
+    }
+  };
+  if (auto it = compiled_codes_.find(key); it != compiled_codes_.end()) {
+    retire(std::move(it->second));
+    compiled_codes_.erase(it);
+  }
+  if (auto it = osr_codes_.find(key); it != osr_codes_.end()) {
+    for (auto& [bc_offset, compiled] : it->second) {
+      retire(std::move(compiled));
+    }
+    osr_codes_.erase(it);
+  }
+}
+
+void Context::reclaimRetiredCode() {
+  ThreadedCompileSerialize guard;
+  if (retired_compiled_codes_.empty()) {
+    return;
+  }
+  // Retired code can't be entered again since the entry points of functions
+  // using it have been reset, so it's safe to free once no thread has a frame
+  // for its code object. Every frame, including inlined and interpreted ones,
+  // is on its thread's shadow stack; the frame chain also covers a JIT
+  // function that has linked its frame but not yet its shadow frame.
+  std::unordered_set<PyCodeObject*> running;
+  for (PyThreadState* tstate =
+           PyInterpreterState_ThreadHead(PyInterpreterState_Main());
+       tstate != nullptr;
+       tstate = PyThreadState_Next(tstate)) {
+    for (_PyShadowFrame* sf = tstate->shadow_frame; sf != nullptr;
+         sf = sf->prev) {
+      running.emplace(_PyShadowFrame_GetCode(sf));
+    }
+    for (PyFrameObject* frame = tstate->frame; frame != nullptr;
+         frame = frame->f_back) {
+      running.emplace(frame->f_code);
+    }
+  }
+  auto dead_begin = std::stable_partition(
+      retired_compiled_codes_.begin(),
+      retired_compiled_codes_.end(),
+      [&](const auto& compiled) {
+        return running.contains(compiled->codeRuntime()->frameState()->code());
+      });
+  // Destroying compiled code can release references to Python objects and
+  // reenter this function, so finish updating retired_compiled_codes_ first.
+  std::vector<std::unique_ptr<CompiledFunction>> dead{
+      std::make_move_iterator(dead_begin),
+      std::make_move_iterator(retired_compiled_codes_.end())};
+  retired_compiled_codes_.erase(dead_begin, retired_compiled_codes_.end());
+}
+
 Context::CompilationResult Context::compilePreloader(
     const hir::Preloader& preloader) {
   BorrowedRef<PyCodeObject> code = preloader.code();
@@ -232,9 +423,11 @@ CompiledFunction* Context::lookupCode(
 }
 
 void Context::deoptFunc(BorrowedRef<PyFunctionObject> func) {
+  ThreadedCompileSerialize guard;
   if (compiled_funcs_.erase(func) != 0) {
-    // Reset the entry point.
+    // Reset the entry points, including the one Static Python callers use.
     func->vectorcall = (vectorcallfunc)PyEntry_LazyInit;
+    Runtime::get()->resetFunctionEntryCache(func);
   }
 }
 
@@ -242,6 +435,14 @@ void Context::finalizeFunc(
     BorrowedRef<PyFunctionObject> func,
     const CompiledFunction& compiled) {
   ThreadedCompileSerialize guard;
+  // A function compiled on the background compile thread may have had its
+  // code replaced in the meantime.
+  const RuntimeFrameState* frame_state = compiled.codeRuntime()->frameState();
+  if (func->func_code != frame_state->code() ||
+      func->func_builtins != frame_state->builtins() ||
+      func->func_globals != frame_state->globals()) {
+    return;
+  }
   if (!compiled_funcs_.emplace(func).second) {
     // Someone else compiled the function between when our caller checked and
     // called us.
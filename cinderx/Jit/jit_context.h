@@ -64,6 +64,26 @@ class Context {
       BorrowedRef<PyFunctionObject> func,
       const hir::Preloader& preloader);
 
+  /*
+   * Get an on-stack replacement entry for code that continues executing at the
+   * loop header described by osr_entry, compiling it if necessary. The entry
+   * takes the frame's locals followed by its operand stack as arguments.
+   *
+   * Returns nullptr if the code can't be compiled. Failures are remembered so
+   * that the same loop header isn't retried.
+   */
+  vectorcallfunc compileOSR(
+      BorrowedRef<PyCodeObject> code,
+      BorrowedRef<PyDictObject> builtins,
+      BorrowedRef<PyDictObject> globals,
+      const hir::OSREntry& osr_entry);
+
+  /*
+   * Forget any OSR compilation failures recorded for a code object that is
+   * being destroyed.
+   */
+  void codeDestroyed(BorrowedRef<PyCodeObject> code);
+
   /*
    * Attach already-compiled code to the given function, if it exists.
    *
@@ -78,6 +98,10 @@ class Context {
   /*
    * Callbacks invoked by the runtime when a PyFunctionObject is modified or
    * destroyed.
+   *
+   * When the last function using some compiled code is destroyed and nothing
+   * else can create a new function from the code object, the compiled code is
+   * retired.
    */
   void funcModified(BorrowedRef<PyFunctionObject> func);
   void funcDestroyed(BorrowedRef<PyFunctionObject> func);
@@ -92,6 +116,15 @@ class Context {
    */
   CompiledFunction* lookupFunc(BorrowedRef<PyFunctionObject> func);
 
+  /*
+   * Look up the compiled code for a code object with the given builtins and
+   * globals, which may not belong to any function yet.
+   */
+  CompiledFunction* lookupCode(
+      BorrowedRef<PyCodeObject> code,
+      BorrowedRef<PyDictObject> builtins,
+      BorrowedRef<PyDictObject> globals);
+
   /*
    * Returns the number of functions inlined into a specified JIT-compiled
    * function.
@@ -114,6 +147,13 @@ class Context {
    */
   const hir::OpcodeCounts* hirOpcodeCounts(BorrowedRef<PyFunctionObject> func);
 
+  /*
+   * Return a dict of HIR optimization stats for a JIT-compiled function.
+   *
+   * Will return nullptr if the supplied function has not been JIT-compiled.
+   */
+  Ref<> optimizationStats(BorrowedRef<PyFunctionObject> func);
+
   /*
    * Print the HIR for func to stdout if it was JIT-compiled.
    * This function is a no-op if func was not JIT-compiled.
@@ -147,6 +187,16 @@ class Context {
    */
   void clearCache();
 
+  /*
+   * Forget the compiled code owning code_rt so that functions using it are
+   * recompiled on their next call. The code is retired rather than freed, as
+   * frames may still be executing it.
+   *
+   * Returns false if code_rt does not belong to the current compiled code
+   * for its code object, e.g. because it was already evicted.
+   */
+  bool evictCode(CodeRuntime* code_rt);
+
  private:
   struct CompilationResult {
     CompiledFunction* compiled;
@@ -155,10 +205,16 @@ class Context {
 
   CompilationResult compilePreloader(const hir::Preloader& preloader);
 
-  CompiledFunction* lookupCode(
-      BorrowedRef<PyCodeObject> code,
-      BorrowedRef<PyDictObject> builtins,
-      BorrowedRef<PyDictObject> globals);
+  /*
+   * Move the compiled code (including OSR entries) for key out of the cache,
+   * to be freed by reclaimRetiredCode() once no frames are executing it.
+   */
+  void retireCode(const CompilationKey& key);
+
+  /*
+   * Free retired code that isn't being executed by any thread.
+   */
+  void reclaimRetiredCode();
 
   /*
    * Reset a function's entry point if it was JIT-compiled.
@@ -187,12 +243,27 @@ class Context {
       compiled_codes_;
 
   /*
-   * Code which is being kept alive in case it was in use when
-   * clearCache was called. Only intended to be used during
-   * multithreaded_compile_test.
+   * Code which is being kept alive in case it was in use when clearCache was
+   * called, or which was retired but can't safely be freed: generators may be
+   * suspended in it without a frame on any stack, and Static Python callers
+   * may hold its static entry point.
    */
   std::vector<std::unique_ptr<CompiledFunction>> orphaned_compiled_codes_;
 
+  /*
+   * Retired code waiting for any frames executing it to return.
+   */
+  std::vector<std::unique_ptr<CompiledFunction>> retired_compiled_codes_;
+
+  /*
+   * OSR entries, keyed by the same key as compiled_codes_ and then by loop
+   * header. A null entry records that compilation failed.
+   */
+  UnorderedMap<
+      CompilationKey,
+      UnorderedMap<BCOffset, std::unique_ptr<CompiledFunction>>>
+      osr_codes_;
+
   Ref<> cinderjit_module_;
 };
 
@@ -11,6 +11,8 @@
 #include <stddef.h>
 #include <stdio.h>
 
+#include <unordered_map>
+
 int g_gdb_support = 0;
 int g_gdb_write_elf_objects = 0;
 int g_gdb_stubs_support = 0;
@@ -51,6 +53,10 @@ void __attribute__((noinline)) __jit_debug_register_code() {
  * becomes multithreaded this will need to be protected by a mutex. */
 JITDescriptor __jit_debug_descriptor = {1, JIT_NOACTION, NULL, NULL};
 
+/* Entries registered for each code address, so they can be unregistered when
+ * the code is freed. */
+static std::unordered_map<void*, JITCodeEntry*> jit_code_entries;
+
 /* End GDB hook */
 
 // Forward declarations.
@@ -119,9 +125,37 @@ register_elf_ctx(ELFObjectContext* ctx, const char* type, void* ptr) {
   // Call the registration hook.
   __jit_debug_register_code();
 
+  jit_code_entries[ptr] = entry;
   return 1;
 }
 
+void unregister_debug_symbol(void* code_addr) {
+  auto it = jit_code_entries.find(code_addr);
+  if (it == jit_code_entries.end()) {
+    return;
+  }
+  JITCodeEntry* entry = it->second;
+  jit_code_entries.erase(it);
+
+  // Unlink from the list.
+  if (entry->prev_entry) {
+    entry->prev_entry->next_entry = entry->next_entry;
+  } else {
+    __jit_debug_descriptor.first_entry = entry->next_entry;
+  }
+  if (entry->next_entry) {
+    entry->next_entry->prev_entry = entry->prev_entry;
+  }
+  __jit_debug_descriptor.relevant_entry = entry;
+  __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+
+  // Call the registration hook, which lets GDB drop the symbols before the
+  // entry goes away.
+  __jit_debug_register_code();
+
+  free(entry);
+}
+
 int register_raw_debug_symbol(
     const char* function_name,
     const char* filename,
@@ -26,3 +26,7 @@ int register_pycode_debug_symbol(
     PyCodeObject* codeobj,
     const char* fullname,
     jit::CompiledFunction* compiled_func);
+
+// Unregister the debug symbol for code at code_addr, which is about to be
+// freed. Does nothing if no symbol was registered for it.
+void unregister_debug_symbol(void* code_addr);
@@ -5,6 +5,7 @@
 #include "Objects/dict-common.h"
 #include "Python.h"
 #include "cinder/exports.h"
+#include "cinderx/Common/frame_arena.h"
 #include "cinderx/Common/log.h"
 #include "cinderx/Common/ref.h"
 #include "cinderx/Common/util.h"
@@ -17,6 +18,7 @@
 
 #include "cinderx/Jit/codegen/gen_asm.h"
 #include "cinderx/Jit/frame.h"
+#include "cinderx/Jit/gen_data_allocator.h"
 #include "cinderx/Jit/pyjit.h"
 #include "cinderx/Jit/runtime.h"
 #include "cinderx/Jit/runtime_support.h"
@@ -543,7 +545,7 @@ static PyFrameObject* allocateFrame(
   frame_ctor.fc_globals = globals;
   frame_ctor.fc_builtins = builtins;
   frame_ctor.fc_code = reinterpret_cast<PyObject*>(code);
-  return _PyFrame_New_NoTrack(tstate, &frame_ctor, nullptr);
+  return Ci_FrameArena_New(tstate, &frame_ctor, nullptr);
 }
 
 PyThreadState* JITRT_AllocateAndLinkFrame(
@@ -565,15 +567,7 @@ PyThreadState* JITRT_AllocateAndLinkFrame(
 }
 
 void JITRT_DecrefFrame(PyFrameObject* frame) {
-  if (Py_REFCNT(frame) > 1) {
-    // If the frame escaped it needs to be tracked
-    Py_DECREF(frame);
-    if (!_PyObject_GC_IS_TRACKED(frame)) {
-      PyObject_GC_Track(frame);
-    }
-  } else {
-    Py_DECREF(frame);
-  }
+  Ci_FrameArena_Release(PyThreadState_GET(), frame);
 }
 
 void JITRT_UnlinkFrame(PyThreadState* tstate) {
@@ -1225,48 +1219,9 @@ void JITRT_DoRaise(PyThreadState* tstate, PyObject* exc, PyObject* cause) {
   Cix_do_raise(tstate, exc, cause);
 }
 
-// JIT generator data free-list globals
-const size_t kGenDataFreeListMaxSize = 1024;
-static size_t gen_data_free_list_size = 0;
-static void* gen_data_free_list_tail;
-
-static void* gen_data_allocate(size_t spill_words) {
-  if (spill_words > jit::kMinGenSpillWords || !gen_data_free_list_size) {
-    auto data =
-        malloc(spill_words * sizeof(uint64_t) + sizeof(jit::GenDataFooter));
-    auto footer = reinterpret_cast<jit::GenDataFooter*>(
-        reinterpret_cast<uint64_t*>(data) + spill_words);
-    footer->spillWords = spill_words;
-    return data;
-  }
-
-  // All free list entries are spill-word size 89, so we don't need to set
-  // footer->spillWords again, it should still be set to 89 from previous use.
-  JIT_DCHECK(spill_words == jit::kMinGenSpillWords, "invalid size");
-
-  gen_data_free_list_size--;
-  auto res = gen_data_free_list_tail;
-  gen_data_free_list_tail = *reinterpret_cast<void**>(gen_data_free_list_tail);
-  return res;
-}
-
 void JITRT_GenJitDataFree(PyGenObject* gen) {
-  auto gen_data_footer =
-      reinterpret_cast<jit::GenDataFooter*>(gen->gi_jit_data);
-  auto gen_data = reinterpret_cast<uint64_t*>(gen_data_footer) -
-      gen_data_footer->spillWords;
-
-  if (gen_data_footer->spillWords != jit::kMinGenSpillWords ||
-      gen_data_free_list_size == kGenDataFreeListMaxSize) {
-    free(gen_data);
-    return;
-  }
-
-  if (gen_data_free_list_size) {
-    *reinterpret_cast<void**>(gen_data) = gen_data_free_list_tail;
-  }
-  gen_data_free_list_size++;
-  gen_data_free_list_tail = gen_data;
+  jit::GenDataAllocator::get().free(
+      reinterpret_cast<jit::GenDataFooter*>(gen->gi_jit_data));
 }
 
 enum class MakeGenObjectMode {
@@ -1321,11 +1276,8 @@ static inline PyObject* make_gen_object(
       ? _PyShadowFrame_MakeData(code_rt, PYSF_CODE_RT, PYSF_JIT)
       : _PyShadowFrame_MakeData(gen->gi_frame, PYSF_PYFRAME, PYSF_JIT);
 
-  spill_words = std::max(spill_words, jit::kMinGenSpillWords);
-
-  auto suspend_data = gen_data_allocate(spill_words);
-  auto footer = reinterpret_cast<jit::GenDataFooter*>(
-      reinterpret_cast<uint64_t*>(suspend_data) + spill_words);
+  jit::GenDataFooter* footer =
+      jit::GenDataAllocator::get().allocate(spill_words);
   footer->resumeEntry = resume_entry;
   footer->yieldPoint = nullptr;
   footer->state = Ci_JITGenState_JustStarted;
@@ -209,6 +209,14 @@ class BasicBlockBuilder {
     return instr;
   }
 
+  // Terminate the current block with an unconditional jump to target and
+  // switch to next. The jump itself is materialized after register allocation,
+  // and only if target doesn't immediately follow the current block.
+  void appendJump(BasicBlock* target, BasicBlock* next) {
+    cur_bb_->addSuccessor(target);
+    switchBlock(next);
+  }
+
   template <
       typename FuncReturnType,
       typename... FuncArgs,
@@ -15,6 +15,7 @@
 #include "internal/pycore_pystate.h"
 #include "internal/pycore_shadow_frame.h"
 #include "listobject.h"
+#include "longintrepr.h"
 #include "pystate.h"
 
 #include "cinderx/Jit/codegen/x86_64.h"
@@ -103,10 +104,36 @@ void emitVectorCall(
   }
 }
 
+// Return the LIR value to pass to instr for the live HIR value reg.
+//
+// DeoptMetadata can only describe values in general purpose registers or
+// memory, so doubles are copied out of XMM registers first. instr must be the
+// last instruction in its block.
+Instruction* deoptLiveValue(
+    BasicBlockBuilder& bbb,
+    Instruction* instr,
+    const hir::Register* reg) {
+  Instruction* def = bbb.getDefInstr(reg);
+  if (!def->output()->isFp()) {
+    return def;
+  }
+  BasicBlock* block = instr->basicblock();
+  JIT_DCHECK(
+      block->getLastInstr() == instr,
+      "Deopting instruction must be the last one in its block");
+  return block->allocateInstrBefore(
+      block->getLastInstrIter(),
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      VReg{def});
+}
+
 void finishYield(
     BasicBlockBuilder& bbb,
     Instruction* instr,
     const DeoptBase* hir_instr) {
+  // Everything live across a yield is spilled, so doubles don't need the
+  // special handling in deoptLiveValue().
   for (const RegState& rs : hir_instr->live_regs()) {
     instr->addOperands(VReg{bbb.getDefInstr(rs.reg)});
   }
@@ -208,6 +235,324 @@ uint8_t multiplierFromSize(int num_bytes) {
   JIT_ABORT("Unexpected num_bytes {}", num_bytes);
 }
 
+// Increment the reference count of obj and continue in end_incref.
+void emitIncref(
+    BasicBlockBuilder& bbb,
+    Instruction* obj,
+    bool maybe_immortal,
+    BasicBlock* end_incref) {
+  // If this could be an immortal object then we need to load the refcount as a
+  // 32-bit integer to see if it overflows on increment, indicating that it's
+  // immortal.  For mortal objects the refcount is a regular 64-bit integer.
+  if (kImmortalInstances && maybe_immortal) {
+    auto mortal = bbb.allocateBlock();
+    Instruction* r1 = bbb.appendInstr(
+        OutVReg{OperandBase::k32bit},
+        Instruction::kMove,
+        Ind{obj, kRefcountOffset});
+    bbb.appendInstr(Instruction::kInc, r1);
+    bbb.appendBranch(Instruction::kBranchE, end_incref);
+    bbb.appendBlock(mortal);
+    bbb.appendInstr(OutInd{obj, kRefcountOffset}, Instruction::kMove, r1)
+        ->output()
+        ->setDataType(Operand::k32bit);
+  } else {
+    Instruction* r1 =
+        bbb.appendInstr(OutVReg{}, Instruction::kMove, Ind{obj, kRefcountOffset});
+    bbb.appendInstr(Instruction::kInc, r1);
+    bbb.appendInstr(OutInd{obj, kRefcountOffset}, Instruction::kMove, r1);
+  }
+
+  if (kRefTotalAddr != 0) {
+    auto r0 =
+        bbb.appendInstr(OutVReg{}, Instruction::kMove, MemImm{kRefTotalAddr});
+    bbb.appendInstr(Instruction::kInc, r0);
+    bbb.appendInstr(OutMemImm{kRefTotalAddr}, Instruction::kMove, r0);
+  }
+  bbb.appendBlock(end_incref);
+}
+
+// Ints with an ob_size of -1, 0, or 1 have the value ob_size * ob_digit[0].
+// Their values are below 2**30 in magnitude, so adding, subtracting, or
+// multiplying two of them can't overflow 64 bits.
+static_assert(PyLong_SHIFT <= 31, "Single-digit products must fit in 64 bits");
+
+// If reg is a known single-digit int, return its value.
+std::optional<int64_t> smallLongConstant(hir::Register* reg) {
+  Type type = reg->type();
+  if (!type.hasObjectSpec()) {
+    return std::nullopt;
+  }
+  auto obj = reinterpret_cast<PyLongObject*>(type.objectSpec());
+  Py_ssize_t size = Py_SIZE(obj);
+  if (size < -1 || size > 1) {
+    return std::nullopt;
+  }
+  return size * static_cast<int64_t>(obj->ob_digit[0]);
+}
+
+// Whether reg could hold a single-digit int at runtime.
+bool couldBeSmallLong(hir::Register* reg) {
+  return !reg->type().hasObjectSpec() || smallLongConstant(reg).has_value();
+}
+
+// Load the value of the int in reg as a 64-bit integer, jumping to slow_path
+// if it has more than one digit.
+Instruction* emitSmallLongValue(
+    BasicBlockBuilder& bbb,
+    hir::Register* reg,
+    BasicBlock* slow_path) {
+  if (auto value = smallLongConstant(reg)) {
+    return bbb.appendInstr(
+        Instruction::kMove,
+        OutVReg{OperandBase::k64bit},
+        Imm{static_cast<uint64_t>(*value)});
+  }
+  Instruction* obj = bbb.getDefInstr(reg);
+  Instruction* size = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      Ind{obj, offsetof(PyVarObject, ob_size)});
+  // -1 <= size <= 1 iff (size + 1) <= 2 when compared as unsigned.
+  Instruction* biased_size = bbb.appendInstr(
+      Instruction::kAdd, OutVReg{OperandBase::k64bit}, size, Imm{1});
+  bbb.appendInstr(Instruction::kCmp, biased_size, Imm{2});
+  bbb.appendBranch(Instruction::kBranchA, slow_path);
+  bbb.appendBlock(bbb.allocateBlock());
+  Instruction* digit = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k32bit},
+      Ind{obj, offsetof(PyLongObject, ob_digit)});
+  Instruction* wide_digit = bbb.appendInstr(
+      Instruction::kZext, OutVReg{OperandBase::k64bit}, digit);
+  return bbb.appendInstr(
+      Instruction::kMul, OutVReg{OperandBase::k64bit}, size, wide_digit);
+}
+
+// Join the results of the fast and slow paths of an instruction into dst.
+void emitFastPathJoin(
+    BasicBlockBuilder& bbb,
+    hir::Register* dst,
+    Instruction* fast_result,
+    Instruction* slow_result,
+    BasicBlock* done) {
+  bbb.appendBlock(done);
+  Instruction* phi = bbb.appendInstr(dst, Instruction::kPhi);
+  phi->allocateLabelInput(fast_result->basicblock());
+  phi->allocateLinkedInput(fast_result);
+  phi->allocateLabelInput(slow_result->basicblock());
+  phi->allocateLinkedInput(slow_result);
+}
+
+void emitLongBinaryOp(BasicBlockBuilder& bbb, const LongBinaryOp& instr) {
+  if (instr.op() == BinaryOpKind::kPower) {
+    bbb.appendCallInstruction(
+        instr.dst(),
+        PyLong_Type.tp_as_number->nb_power,
+        instr.left(),
+        instr.right(),
+        Py_None);
+    return;
+  }
+
+  auto op = Instruction::kNop;
+  switch (instr.op()) {
+    case BinaryOpKind::kAdd:
+      op = Instruction::kAdd;
+      break;
+    case BinaryOpKind::kSubtract:
+      op = Instruction::kSub;
+      break;
+    case BinaryOpKind::kMultiply:
+      op = Instruction::kMul;
+      break;
+    case BinaryOpKind::kAnd:
+      op = Instruction::kAnd;
+      break;
+    case BinaryOpKind::kOr:
+      op = Instruction::kOr;
+      break;
+    case BinaryOpKind::kXor:
+      op = Instruction::kXor;
+      break;
+    default:
+      break;
+  }
+  bool both_constant = smallLongConstant(instr.left()).has_value() &&
+      smallLongConstant(instr.right()).has_value();
+  if (op == Instruction::kNop || both_constant ||
+      !couldBeSmallLong(instr.left()) || !couldBeSmallLong(instr.right())) {
+    bbb.appendCallInstruction(
+        instr.dst(), instr.slotMethod(), instr.left(), instr.right());
+    return;
+  }
+
+  // Single-digit ints use native arithmetic; the result only needs boxing,
+  // which is allocation-free for values in the small int cache.
+  auto slow_path = bbb.allocateBlock();
+  auto done = bbb.allocateBlock();
+  Instruction* left = emitSmallLongValue(bbb, instr.left(), slow_path);
+  Instruction* right = emitSmallLongValue(bbb, instr.right(), slow_path);
+  Instruction* value =
+      bbb.appendInstr(op, OutVReg{OperandBase::k64bit}, left, right);
+  Instruction* fast_result =
+      bbb.appendCallInstruction(OutVReg{}, PyLong_FromLong, value);
+  bbb.appendJump(done, slow_path);
+  Instruction* slow_result = bbb.appendCallInstruction(
+      OutVReg{}, instr.slotMethod(), instr.left(), instr.right());
+  emitFastPathJoin(bbb, instr.dst(), fast_result, slow_result, done);
+}
+
+void emitLongCompare(BasicBlockBuilder& bbb, const LongCompare& instr) {
+  auto op = Instruction::kNop;
+  switch (instr.op()) {
+    case CompareOp::kLessThan:
+      op = Instruction::kLessThanSigned;
+      break;
+    case CompareOp::kLessThanEqual:
+      op = Instruction::kLessThanEqualSigned;
+      break;
+    case CompareOp::kEqual:
+      op = Instruction::kEqual;
+      break;
+    case CompareOp::kNotEqual:
+      op = Instruction::kNotEqual;
+      break;
+    case CompareOp::kGreaterThan:
+      op = Instruction::kGreaterThanSigned;
+      break;
+    case CompareOp::kGreaterThanEqual:
+      op = Instruction::kGreaterThanEqualSigned;
+      break;
+    default:
+      break;
+  }
+  bool both_constant = smallLongConstant(instr.left()).has_value() &&
+      smallLongConstant(instr.right()).has_value();
+  // The fast path hands out Py_True or Py_False without a new reference, which
+  // is only correct when they're immortal.
+  if (!kImmortalInstances || op == Instruction::kNop || both_constant ||
+      !couldBeSmallLong(instr.left()) || !couldBeSmallLong(instr.right())) {
+    bbb.appendCallInstruction(
+        instr.dst(),
+        PyLong_Type.tp_richcompare,
+        instr.left(),
+        instr.right(),
+        static_cast<int>(instr.op()));
+    return;
+  }
+
+  auto slow_path = bbb.allocateBlock();
+  auto done = bbb.allocateBlock();
+  Instruction* left = emitSmallLongValue(bbb, instr.left(), slow_path);
+  Instruction* right = emitSmallLongValue(bbb, instr.right(), slow_path);
+  Instruction* cond =
+      bbb.appendInstr(op, OutVReg{OperandBase::k8bit}, left, right);
+  Instruction* true_value = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{},
+      Imm{reinterpret_cast<uint64_t>(Py_True), OperandBase::kObject});
+  Instruction* fast_result = bbb.appendInstr(
+      Instruction::kSelect,
+      OutVReg{},
+      cond,
+      true_value,
+      Imm{reinterpret_cast<uint64_t>(Py_False), OperandBase::kObject});
+  bbb.appendJump(done, slow_path);
+  Instruction* slow_result = bbb.appendCallInstruction(
+      OutVReg{},
+      PyLong_Type.tp_richcompare,
+      instr.left(),
+      instr.right(),
+      static_cast<int>(instr.op()));
+  emitFastPathJoin(bbb, instr.dst(), fast_result, slow_result, done);
+}
+
+// Load an attribute through cache, checking the cache's monomorphic entry
+// inline when it holds an instance attribute in a split dict.
+void emitSplitDictLoadAttr(
+    BasicBlockBuilder& bbb,
+    const LoadAttr& instr,
+    LoadAttrCache* cache) {
+  AttributeMutator& entry = cache->monoEntry();
+  SplitMutator& split = entry.split();
+  auto slow_path = bbb.allocateBlock();
+  auto done = bbb.allocateBlock();
+  Instruction* obj = bbb.getDefInstr(instr.GetOperand(0));
+
+  Instruction* type = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      Ind{obj, offsetof(PyObject, ob_type)});
+  Instruction* tagged_type = bbb.appendInstr(
+      Instruction::kOr,
+      OutVReg{OperandBase::k64bit},
+      type,
+      Imm{AttributeMutator::kSplitTag});
+  Instruction* cached_type = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      MemImm{entry.typeWord()});
+  bbb.appendInstr(Instruction::kCmp, tagged_type, cached_type);
+  bbb.appendBranch(Instruction::kBranchNZ, slow_path);
+  bbb.appendBlock(bbb.allocateBlock());
+
+  // A missing dict or one that no longer shares the type's cached keys takes
+  // the slow path, as does an attribute that isn't set.
+  Instruction* dict_offset = bbb.appendInstr(
+      Instruction::kZext,
+      OutVReg{OperandBase::k64bit},
+      bbb.appendInstr(
+          Instruction::kMove,
+          OutVReg{OperandBase::k32bit},
+          MemImm{&split.dict_offset}));
+  Instruction* dict = bbb.appendInstr(
+      Instruction::kMove, OutVReg{}, Ind{obj, dict_offset, 0, 0});
+  bbb.appendInstr(Instruction::kTest, dict, dict);
+  bbb.appendBranch(Instruction::kBranchZ, slow_path);
+  bbb.appendBlock(bbb.allocateBlock());
+  Instruction* keys = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      Ind{dict, offsetof(PyDictObject, ma_keys)});
+  Instruction* cached_keys = bbb.appendInstr(
+      Instruction::kMove, OutVReg{OperandBase::k64bit}, MemImm{&split.keys});
+  bbb.appendInstr(Instruction::kCmp, keys, cached_keys);
+  bbb.appendBranch(Instruction::kBranchNZ, slow_path);
+  bbb.appendBlock(bbb.allocateBlock());
+  Instruction* values = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{OperandBase::k64bit},
+      Ind{dict, offsetof(PyDictObject, ma_values)});
+  Instruction* val_offset = bbb.appendInstr(
+      Instruction::kZext,
+      OutVReg{OperandBase::k64bit},
+      bbb.appendInstr(
+          Instruction::kMove,
+          OutVReg{OperandBase::k32bit},
+          MemImm{&split.val_offset}));
+  Instruction* value = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{},
+      Ind{values, val_offset, multiplierFromSize(sizeof(PyObject*)), 0});
+  bbb.appendInstr(Instruction::kTest, value, value);
+  bbb.appendBranch(Instruction::kBranchZ, slow_path);
+  bbb.appendBlock(bbb.allocateBlock());
+  emitIncref(bbb, value, true, bbb.allocateBlock());
+  Instruction* fast_result =
+      bbb.appendInstr(Instruction::kMove, OutVReg{}, value);
+  bbb.appendJump(done, slow_path);
+
+  Instruction* name = bbb.appendInstr(
+      Instruction::kMove,
+      OutVReg{},
+      // TODO(T140174965): This should be MemImm.
+      Imm{reinterpret_cast<uint64_t>(instr.name().get())});
+  Instruction* slow_result = bbb.appendCallInstruction(
+      OutVReg{}, jit::LoadAttrCache::invoke, cache, instr.GetOperand(0), name);
+  emitFastPathJoin(bbb, instr.dst(), fast_result, slow_result, done);
+}
+
 } // namespace
 
 LIRGenerator::LIRGenerator(
@@ -362,7 +707,7 @@ void LIRGenerator::addLiveRegOperands(
   auto& regstates = hir_instr.live_regs();
   for (const auto& reg_state : regstates) {
     hir::Register* reg = reg_state.reg;
-    instr->addOperands(VReg{bbb.getDefInstr(reg)});
+    instr->addOperands(VReg{deoptLiveValue(bbb, instr, reg)});
   }
 }
 
@@ -371,6 +716,33 @@ bool LIRGenerator::TranslateSpecializedCall(
     BasicBlockBuilder& bbb,
     const hir::VectorCallBase& hir_instr) {
   hir::Register* callable = hir_instr.func();
+  if (callable->type() <= TFunc) {
+    // The callable is a Python function, either because it's a constant or
+    // because of a type guard from profiling. Call its vectorcall entry
+    // directly rather than going through _PyObject_Vectorcall(). The entry is
+    // loaded at call time, so once the callee is compiled this jumps straight
+    // into its compiled code, and it stays correct if the callee is later
+    // recompiled or has its code replaced.
+    //
+    // This only removes the type dispatch. Arguments are still passed in a
+    // vectorcall array, and the callee's entry still checks them and sets up
+    // its frame. Nothing here depends on which function is called, so no
+    // guard on the callee's identity is needed.
+    Instruction* entry = bbb.appendInstr(
+        OutVReg{},
+        Instruction::kMove,
+        Ind{bbb.getDefInstr(callable),
+            offsetof(PyFunctionObject, vectorcall)});
+    size_t flags = hir_instr.isAwaited() ? Ci_Py_AWAITED_CALL_MARKER : 0;
+    Instruction* instr = bbb.appendInstr(
+        hir_instr.dst(), Instruction::kVectorCall, entry, Imm{flags});
+    for (hir::Register* arg : hir_instr.GetOperands()) {
+      instr->addOperands(VReg{bbb.getDefInstr(arg)});
+    }
+    // kwnames
+    instr->addOperands(Imm{0});
+    return true;
+  }
   if (!callable->type().hasValueSpec(TObject)) {
     return false;
   }
@@ -483,41 +855,11 @@ void LIRGenerator::MakeIncref(
     bbb.appendBlock(cont);
   }
 
-  // If this could be an immortal object then we need to load the refcount as a
-  // 32-bit integer to see if it overflows on increment, indicating that it's
-  // immortal.  For mortal objects the refcount is a regular 64-bit integer.
-  if (kImmortalInstances && obj->type().couldBe(TImmortalObject)) {
-    auto mortal = bbb.allocateBlock();
-    Instruction* r1 = bbb.appendInstr(
-        OutVReg{OperandBase::k32bit},
-        Instruction::kMove,
-        Ind{bbb.getDefInstr(obj), kRefcountOffset});
-    bbb.appendInstr(Instruction::kInc, r1);
-    bbb.appendBranch(Instruction::kBranchE, end_incref);
-    bbb.appendBlock(mortal);
-    bbb.appendInstr(
-           OutInd{bbb.getDefInstr(obj), kRefcountOffset},
-           Instruction::kMove,
-           r1)
-        ->output()
-        ->setDataType(Operand::k32bit);
-  } else {
-    Instruction* r1 = bbb.appendInstr(
-        OutVReg{},
-        Instruction::kMove,
-        Ind{bbb.getDefInstr(obj), kRefcountOffset});
-    bbb.appendInstr(Instruction::kInc, r1);
-    bbb.appendInstr(
-        OutInd{bbb.getDefInstr(obj), kRefcountOffset}, Instruction::kMove, r1);
-  }
-
-  if (kRefTotalAddr != 0) {
-    auto r0 =
-        bbb.appendInstr(OutVReg{}, Instruction::kMove, MemImm{kRefTotalAddr});
-    bbb.appendInstr(Instruction::kInc, r0);
-    bbb.appendInstr(OutMemImm{kRefTotalAddr}, Instruction::kMove, r0);
-  }
-  bbb.appendBlock(end_incref);
+  emitIncref(
+      bbb,
+      bbb.getDefInstr(obj),
+      obj->type().couldBe(TImmortalObject),
+      end_incref);
 }
 
 void LIRGenerator::MakeDecref(
@@ -1217,17 +1559,24 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto instr = static_cast<const LoadAttr*>(&i);
         PyObject* name = instr->name();
 
-        Instruction* move = bbb.appendInstr(
-            Instruction::kMove,
-            OutVReg{},
-            // TODO(T140174965): This should be MemImm.
-            Imm{reinterpret_cast<uint64_t>(name)});
-        bbb.appendCallInstruction(
-            instr->dst(),
-            jit::LoadAttrCache::invoke,
-            Runtime::get()->allocateLoadAttrCache(),
-            instr->GetOperand(0),
-            move);
+        LoadAttrCache* cache = Runtime::get()->allocateLoadAttrCache();
+        PyTypeObject* exact_type = instr->GetOperand(0)->type().runtimePyType();
+        if (exact_type != nullptr &&
+            !PyType_HasFeature(exact_type, Py_TPFLAGS_HEAPTYPE)) {
+          Instruction* move = bbb.appendInstr(
+              Instruction::kMove,
+              OutVReg{},
+              // TODO(T140174965): This should be MemImm.
+              Imm{reinterpret_cast<uint64_t>(name)});
+          bbb.appendCallInstruction(
+              instr->dst(),
+              jit::LoadAttrCache::invoke,
+              cache,
+              instr->GetOperand(0),
+              move);
+          break;
+        }
+        emitSplitDictLoadAttr(bbb, *instr, cache);
         break;
       }
       case Opcode::kLoadAttrSpecial: {
@@ -1430,18 +1779,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         break;
       }
       case Opcode::kLongBinaryOp: {
-        auto instr = static_cast<const LongBinaryOp*>(&i);
-        if (instr->op() == BinaryOpKind::kPower) {
-          bbb.appendCallInstruction(
-              instr->dst(),
-              PyLong_Type.tp_as_number->nb_power,
-              instr->left(),
-              instr->right(),
-              Py_None);
-        } else {
-          bbb.appendCallInstruction(
-              instr->dst(), instr->slotMethod(), instr->left(), instr->right());
-        }
+        emitLongBinaryOp(bbb, static_cast<const LongBinaryOp&>(i));
         break;
       }
       case Opcode::kUnaryOp: {
@@ -1503,14 +1841,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         break;
       }
       case Opcode::kLongCompare: {
-        auto instr = static_cast<const LongCompare*>(&i);
-
-        bbb.appendCallInstruction(
-            instr->dst(),
-            PyLong_Type.tp_richcompare,
-            instr->left(),
-            instr->right(),
-            static_cast<int>(instr->op()));
+        emitLongCompare(bbb, static_cast<const LongCompare&>(i));
         break;
       }
       case Opcode::kUnicodeCompare: {
@@ -1661,7 +1992,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             MemImm{instr.patcher()},
             Imm{deopt_id});
         for (const auto& reg_state : regstates) {
-          lir->addOperands(VReg{bbb.getDefInstr(reg_state.reg)});
+          lir->addOperands(VReg{deoptLiveValue(bbb, lir, reg_state.reg)});
         }
         break;
       }
@@ -2156,6 +2487,20 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kStoreArrayItem: {
         auto instr = static_cast<const StoreArrayItem*>(&i);
         auto type = instr->type();
+        if (type <= TCDouble) {
+          // The value is in a floating-point register, so store it directly
+          // rather than passing it to a helper as an integer.
+          Instruction* lir = bbb.appendInstr(
+              OutInd{
+                  bbb.getDefInstr(instr->ob_item()),
+                  bbb.getDefInstr(instr->idx()),
+                  multiplierFromSize(type.sizeInBytes()),
+                  0},
+              Instruction::kMove,
+              instr->value());
+          lir->output()->setDataType(lir->getInput(0)->dataType());
+          break;
+        }
         decltype(JITRT_SetI8_InArray)* func = nullptr;
 
         if (type <= TCInt8) {
@@ -2838,6 +3183,24 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
   auto bbs = bbb.Generate();
   basic_blocks_.insert(basic_blocks_.end(), bbs.begin(), bbs.end());
 
+  // Blocks that can only leave the function by deopting or raising run at
+  // most once per call, so keep them out of the hot section.
+  if (getConfig().multiple_code_sections) {
+    switch (hir_bb->GetTerminator()->opcode()) {
+      case Opcode::kDeopt:
+      case Opcode::kRaise:
+      case Opcode::kRaiseAwaitableError:
+      case Opcode::kRaiseStatic:
+      case Opcode::kUnreachable:
+        for (BasicBlock* bb : bbs) {
+          bb->setSection(codegen::CodeSection::kCold);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
   return {bbs.front(), bbs.back()};
 }
 
@@ -2849,6 +3212,11 @@ void LIRGenerator::resolvePhiOperands(
 
   for (auto& block : basic_blocks_) {
     block->foreachPhiInstr([&](Instruction* instr) {
+      // Phis joining the fast and slow paths of a single HIR instruction
+      // already have their operands.
+      if (!instr->origin()->IsPhi()) {
+        return;
+      }
       auto hir_instr = static_cast<const Phi*>(instr->origin());
       for (size_t i = 0; i < hir_instr->NumOperands(); ++i) {
         hir::BasicBlock* hir_block = hir_instr->basic_blocks().at(i);
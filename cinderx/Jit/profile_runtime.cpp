@@ -337,8 +337,15 @@ void ProfileRuntime::profileInstr(
     case LOAD_METHOD_UNCACHABLE:
     case LOAD_METHOD_UNSHADOWED_METHOD:
     case LOAD_PRIMITIVE_FIELD:
+    case FOR_ITER_LIST:
+    case FOR_ITER_RANGE:
+    case UNPACK_SEQUENCE_TUPLE:
       profile_stack(0);
       break;
+    case BINARY_ADD_FLOAT:
+    case BINARY_ADD_INT:
+    case BINARY_ADD_UNICODE:
+    case COMPARE_OP_INT:
     case BINARY_SUBSCR_DICT:
     case BINARY_SUBSCR_DICT_STR:
     case BINARY_SUBSCR_LIST:
@@ -351,6 +358,13 @@ void ProfileRuntime::profileInstr(
     case STORE_PRIMITIVE_FIELD:
       profile_stack(1, 0);
       break;
+    case STORE_SUBSCR_DICT:
+    case STORE_SUBSCR_LIST:
+      profile_stack(2, 1, 0);
+      break;
+    case CALL_FUNCTION_PY:
+      profile_stack(oparg);
+      break;
     case BINARY_SUBSCR_TUPLE_CONST_INT:
       // This instruction replaces a LOAD_CONST and a BINARY_SUBSCR.  The index
       // field is stored within the oparg instead of on the stack.
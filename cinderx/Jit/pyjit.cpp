@@ -14,11 +14,14 @@
 #include "pycore_interp.h"
 
 #include "cinderx/Jit/code_allocator.h"
+#include "cinderx/Jit/code_layout.h"
 #include "cinderx/Jit/codegen/gen_asm.h"
+#include "cinderx/Jit/compile_failure_cache.h"
 #include "cinderx/Jit/config.h"
 #include "cinderx/Jit/containers.h"
 #include "cinderx/Jit/elf.h"
 #include "cinderx/Jit/frame.h"
+#include "cinderx/Jit/gen_data_allocator.h"
 #include "cinderx/Jit/hir/builder.h"
 #include "cinderx/Jit/hir/preload.h"
 #include "cinderx/Jit/inline_cache.h"
@@ -35,14 +38,19 @@
 
 #include "cinderx/ThirdParty/i386-dis/dis-asm.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
 #include <unordered_set>
 #include <utility>
@@ -92,6 +100,9 @@ static UnitDeletedCallback handle_unit_deleted_during_preload = nullptr;
 static std::unordered_map<BorrowedRef<PyCodeObject>, CodeData> jit_code_data;
 // Every unit has an entry in jit_preloaders during batch compile.
 static PreloaderMap jit_preloaders;
+// Set only on the background compile thread, where it is used instead of
+// jit_preloaders.
+static thread_local PreloaderMap* background_preloaders{nullptr};
 
 namespace jit {
 
@@ -136,8 +147,11 @@ hir::Preloader* lookupPreloader(BorrowedRef<> unit) {
       "Compilation unit has to be a code object but is instead {}",
       typeFullname(Py_TYPE(code)));
 
-  auto it = jit_preloaders.find(code);
-  return it != jit_preloaders.end() ? it->second.get() : nullptr;
+  const PreloaderMap& preloaders = background_preloaders != nullptr
+      ? *background_preloaders
+      : jit_preloaders;
+  auto it = preloaders.find(code);
+  return it != preloaders.end() ? it->second.get() : nullptr;
 }
 
 bool isPreloaded(BorrowedRef<> unit) {
@@ -157,6 +171,12 @@ static std::string g_write_profile_file;
 // at shutdown.
 static std::string g_write_compiled_functions_file;
 
+// Code objects that failed to compile in earlier processes.
+static CompileFailureCache g_compile_failure_cache;
+
+// Layout of the most recent batch compile, if it was planned.
+static std::vector<CodeLayoutEntry> g_code_layout;
+
 // Frequently-used strings that we intern at JIT startup and hold references to.
 #define INTERNED_STRINGS(X) \
   X(bc_offset)              \
@@ -216,6 +236,9 @@ struct CompilationTimer {
 static std::atomic<int> g_compile_workers_attempted;
 static int g_compile_workers_retries;
 
+// Number of times an interpreted frame was handed off to an OSR entry.
+static size_t g_num_osr_entries{0};
+
 void setJitLogFile(std::string log_filename) {
   // Redirect logging to a file if configured.
   const char* kPidMarker = "{pid}";
@@ -252,6 +275,7 @@ static int use_jit = 0;
 static int jit_help = 0;
 static std::string read_profile_file;
 static std::string write_profile_file;
+static std::string compile_failure_cache_file;
 static int jit_profile_interp = 0;
 static int jit_profile_interp_period = 0;
 static std::string jl_fn;
@@ -264,6 +288,7 @@ void initFlagProcessor() {
   use_jit = 0;
   read_profile_file = "";
   write_profile_file = "";
+  compile_failure_cache_file = "";
   jit_profile_interp = 0;
   jl_fn = "";
   jit_help = 0;
@@ -290,6 +315,12 @@ void initFlagProcessor() {
         },
         "Combined with -X jit-auto, configure the runtime to type profile each "
         "function for a number of calls before compiling it");
+    xarg_flag_processor.addOption(
+        "jit-auto-async",
+        "PYTHONJITAUTOASYNC",
+        [](int val) { getMutableConfig().auto_jit_async = val; },
+        "Combined with -X jit-auto, compile hot functions on a background "
+        "thread while they keep running in the interpreter");
 
     xarg_flag_processor.addOption(
         "jit-debug",
@@ -456,6 +487,12 @@ void initFlagProcessor() {
         [](std::string) { getMutableConfig().use_huge_pages = false; },
         "disable huge page support");
 
+    xarg_flag_processor.addOption(
+        "jit-disable-licm",
+        "PYTHONJITDISABLELICM",
+        [](std::string) { getMutableConfig().hir_licm_enabled = false; },
+        "disable JIT loop-invariant code motion");
+
     xarg_flag_processor.addOption(
         "jit-enable-jit-list-wildcards",
         "PYTHONJITENABLEJITLISTWILDCARDS",
@@ -495,6 +532,15 @@ void initFlagProcessor() {
             "Write profiling data to <filename>")
         .withFlagParamName("filename");
 
+    xarg_flag_processor
+        .addOption(
+            "jit-compile-failure-cache",
+            "PYTHONJITCOMPILEFAILURECACHE",
+            compile_failure_cache_file,
+            "Remember functions that failed to compile in <filename>, and "
+            "don't try to compile them again in later processes")
+        .withFlagParamName("filename");
+
     xarg_flag_processor
         .addOption(
             "jit-profile-strip-pattern",
@@ -553,6 +599,19 @@ void initFlagProcessor() {
             "set the number of batch compile workers to <COUNT>")
         .withFlagParamName("COUNT");
 
+    xarg_flag_processor.addOption(
+        "jit-code-layout",
+        "PYTHONJITCODELAYOUT",
+        [](int val) {
+          if (use_jit) {
+            getMutableConfig().profile_guided_code_layout = val;
+          } else {
+            warnJITOff("jit-code-layout");
+          }
+        },
+        "Lay out batch-compiled code by profiled hotness and call-graph "
+        "affinity");
+
     xarg_flag_processor
         .addOption(
             "jit-multithreaded-compile-test",
@@ -664,8 +723,26 @@ void initFlagProcessor() {
               entries);
           getMutableConfig().attr_cache_size = entries;
         },
-        "Set the number of entries in the JIT's attribute access inline "
-        "caches");
+        "Set the maximum number of receiver types an attribute access inline "
+        "cache tracks before it switches to the shared megamorphic cache");
+
+    xarg_flag_processor
+        .addOption(
+            "jit-reopt-threshold",
+            "PYTHONJITREOPTTHRESHOLD",
+            [](uint32_t count) { getMutableConfig().reopt_threshold = count; },
+            "recompile a function once one of its guards has failed <COUNT> "
+            "times, dropping the speculation if the same guard keeps failing")
+        .withFlagParamName("COUNT");
+
+    xarg_flag_processor
+        .addOption(
+            "jit-osr-threshold",
+            "PYTHONJITOSRTHRESHOLD",
+            [](uint32_t count) { getMutableConfig().osr_threshold = count; },
+            "switch an interpreted function call to JIT-compiled code at a "
+            "loop header after <COUNT> backward jumps")
+        .withFlagParamName("COUNT");
 
     xarg_flag_processor.addOption(
         "jit-perfmap",
@@ -723,6 +800,14 @@ static std::string unitFullname(BorrowedRef<> unit) {
       "<Unknown Python object {}>", static_cast<void*>(unit.get()));
 }
 
+// Size of a unit's bytecode, used to estimate how long it takes to compile.
+static Py_ssize_t unitBytecodeSize(BorrowedRef<> unit) {
+  BorrowedRef<PyCodeObject> code = PyFunction_Check(unit)
+      ? reinterpret_cast<PyFunctionObject*>(unit.get())->func_code
+      : unit.get();
+  return PyBytes_GET_SIZE(code->co_code);
+}
+
 namespace jit {
 
 // Compile the given function or code object with a preloader from the global
@@ -733,18 +818,32 @@ _PyJIT_Result tryCompilePreloaded(BorrowedRef<> unit) {
     func = BorrowedRef<PyFunctionObject>{unit};
   }
   hir::Preloader* preloader = lookupPreloader(unit);
-  return preloader ? jit_ctx->compilePreloader(func, *preloader)
-                   : PYJIT_RESULT_NO_PRELOADER;
+  if (preloader == nullptr) {
+    return PYJIT_RESULT_NO_PRELOADER;
+  }
+  _PyJIT_Result result = jit_ctx->compilePreloader(func, *preloader);
+  // Compiles are refused when globals or builtins aren't plain dicts, which
+  // says nothing about the code itself.
+  if (result == PYJIT_RESULT_UNKNOWN_ERROR &&
+      PyDict_CheckExact(preloader->globals()) &&
+      PyDict_CheckExact(preloader->builtins())) {
+    ThreadedCompileSerialize guard;
+    g_compile_failure_cache.addFailure(preloader->code());
+  }
+  return result;
 }
 
 } // namespace jit
 
-static void compile_worker_thread() {
+static void compile_worker_thread(size_t worker_id) {
   JIT_DLOG("Started compile worker in thread {}", std::this_thread::get_id());
   BorrowedRef<> unit;
-  while ((unit = g_threaded_compile_context.nextUnit()) != nullptr) {
+  while ((unit = g_threaded_compile_context.nextUnit(worker_id)) != nullptr) {
     g_compile_workers_attempted++;
+    std::chrono::time_point start = std::chrono::steady_clock::now();
     _PyJIT_Result res = tryCompilePreloaded(unit);
+    g_threaded_compile_context.addBusyTime(
+        worker_id, std::chrono::steady_clock::now() - start);
     if (res == PYJIT_RESULT_RETRY) {
       ThreadedCompileSerialize guard;
       g_compile_workers_retries++;
@@ -758,6 +857,194 @@ static void compile_worker_thread() {
   JIT_DLOG("Finished compile worker in thread {}", std::this_thread::get_id());
 }
 
+namespace {
+
+// A function queued for background compilation, along with the preloaders for
+// it and its dependencies. Only created and destroyed while holding the GIL.
+struct BackgroundCompileJob {
+  explicit BackgroundCompileJob(const CompilationKey& key) : key{key} {}
+
+  Ref<PyFunctionObject> func;
+  // The code, builtins and globals of func when it was preloaded. They are
+  // kept alive by the preloader for func.
+  CompilationKey key;
+  // Other functions with the same key that became hot while this job was
+  // pending. They're given the compiled code once it's ready.
+  std::vector<Ref<PyFunctionObject>> waiters;
+  PreloaderMap preloaders;
+};
+
+// Compiles functions that auto-JIT found to be hot on a dedicated thread, so
+// the threads calling them keep running in the interpreter rather than waiting
+// for the compile. Preloading can run Python code, so it happens on the calling
+// thread before a job is queued. Everything after that runs on the compile
+// thread, which takes the GIL only while holding the threaded-compile lock.
+class BackgroundCompiler {
+ public:
+  // Queue a job, starting the compile thread if needed. Returns false if the
+  // compiler has been stopped. Requires the GIL.
+  bool enqueue(std::unique_ptr<BackgroundCompileJob>& job) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (stopping_) {
+      return false;
+    }
+    pending_.emplace(job->key, job.get());
+    queue_.emplace_back(std::move(job));
+    if (thread_ == nullptr) {
+      thread_ = new std::thread{[this] { run(); }};
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  // If a job for the same code, builtins and globals is already queued or
+  // being compiled, have it give func the compiled code as well and return
+  // true. Functions that share a code object, such as closures, would
+  // otherwise each compile it again. Requires the GIL.
+  bool addWaiter(
+      const CompilationKey& key,
+      BorrowedRef<PyFunctionObject> func) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto it = pending_.find(key);
+    if (it == pending_.end()) {
+      return false;
+    }
+    it->second->waiters.emplace_back(Ref<PyFunctionObject>::create(func));
+    return true;
+  }
+
+  // Wait until every queued job has been compiled. Requires the GIL, which is
+  // released while waiting.
+  void wait() {
+    Py_BEGIN_ALLOW_THREADS;
+    std::unique_lock<std::mutex> lock{mutex_};
+    cv_.wait(lock, [this] { return queue_.empty() && num_running_ == 0; });
+    Py_END_ALLOW_THREADS;
+  }
+
+  // Stop the compile thread once it finishes its current job and drop any
+  // queued jobs. No more jobs are accepted afterwards. Requires the GIL, which
+  // is released while waiting.
+  void stop() {
+    std::thread* thread;
+    std::deque<std::unique_ptr<BackgroundCompileJob>> dropped;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      thread = std::exchange(thread_, nullptr);
+      stopping_ = true;
+      queue_.swap(dropped);
+      pending_.clear();
+      cv_.notify_all();
+    }
+    if (thread != nullptr) {
+      Py_BEGIN_ALLOW_THREADS;
+      thread->join();
+      Py_END_ALLOW_THREADS;
+      delete thread;
+    }
+  }
+
+  // The compile thread doesn't exist in a forked child, and may have held
+  // mutex_ at the time of the fork. Abandon both and start a new thread for
+  // the jobs that are still queued. A job that was being compiled during the
+  // fork is lost, and its function stays interpreted.
+  void afterForkChild() {
+    new (&mutex_) std::mutex{};
+    new (&cv_) std::condition_variable{};
+    thread_ = nullptr;
+    num_running_ = 0;
+    pending_.clear();
+    for (auto& job : queue_) {
+      pending_.emplace(job->key, job.get());
+    }
+    if (!stopping_ && !queue_.empty()) {
+      thread_ = new std::thread{[this] { run(); }};
+    }
+  }
+
+  // Number of jobs that are queued or being compiled.
+  size_t numPending() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return queue_.size() + num_running_;
+  }
+
+ private:
+  void run() {
+    PyGILState_STATE gil_state = PyGILState_Ensure();
+    PyThreadState* tstate = PyEval_SaveThread();
+    g_threaded_compile_context.setBackgroundThreadState(tstate);
+    JIT_DLOG("Started background compile thread {}", std::this_thread::get_id());
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    for (;;) {
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (stopping_) {
+        break;
+      }
+      std::unique_ptr<BackgroundCompileJob> job = std::move(queue_.front());
+      queue_.pop_front();
+      num_running_++;
+      lock.unlock();
+
+      compile(std::move(job));
+
+      lock.lock();
+      num_running_--;
+      cv_.notify_all();
+    }
+    lock.unlock();
+
+    JIT_DLOG(
+        "Finished background compile thread {}", std::this_thread::get_id());
+    g_threaded_compile_context.setBackgroundThreadState(nullptr);
+    PyEval_RestoreThread(tstate);
+    PyGILState_Release(gil_state);
+  }
+
+  void compile(std::unique_ptr<BackgroundCompileJob> job) {
+    BorrowedRef<PyFunctionObject> func = job->func;
+    std::optional<CompilationTimer> timer{func};
+    background_preloaders = &job->preloaders;
+    _PyJIT_Result result = tryCompilePreloaded(func);
+    background_preloaders = nullptr;
+    JIT_DLOG(
+        "Background compile of {} finished with result {}",
+        funcFullname(func),
+        static_cast<int>(result));
+    {
+      // No more waiters can be added once the job is no longer pending.
+      std::lock_guard<std::mutex> lock{mutex_};
+      pending_.erase(job->key);
+    }
+
+    // Releasing the job drops references to Python objects.
+    ThreadedCompileSerialize guard;
+    if (result == PYJIT_RESULT_OK) {
+      for (BorrowedRef<PyFunctionObject> waiter : job->waiters) {
+        if (!jit_ctx->didCompile(waiter)) {
+          jit_ctx->attachCompiledCode(waiter);
+        }
+      }
+    }
+    timer.reset();
+    job.reset();
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<BackgroundCompileJob>> queue_;
+  // Jobs that are queued or being compiled, by key.
+  UnorderedMap<CompilationKey, BackgroundCompileJob*> pending_;
+  size_t num_running_{0};
+  bool stopping_{false};
+  // Heap-allocated so that a forked child can abandon it.
+  std::thread* thread_{nullptr};
+};
+
+BackgroundCompiler g_background_compiler;
+
+} // namespace
+
 static void compile_perf_trampoline_entries() {
   for (const auto& unit : perf_trampoline_reg_units) {
     if (PyFunction_Check(unit)) {
@@ -791,17 +1078,27 @@ static void multithread_compile_units_preloaded(
   int old_gil_check_enabled = _PyRuntime.gilstate.check_enabled;
   _PyRuntime.gilstate.check_enabled = 0;
 
-  g_threaded_compile_context.startCompile(std::move(units));
-  std::vector<std::thread> worker_threads;
   size_t batch_compile_workers = getConfig().batch_compile_workers;
   JIT_CHECK(batch_compile_workers, "Zero workers for compile");
+  // Hand out the largest functions first, so the compile doesn't end with one
+  // worker stuck on a big function while the others sit idle. With a planned
+  // code layout, keep its order instead: workers then allocate the hot units
+  // first, close to each other and in roughly the planned order.
+  if (!getConfig().profile_guided_code_layout) {
+    std::stable_sort(
+        units.begin(), units.end(), [](BorrowedRef<> a, BorrowedRef<> b) {
+          return unitBytecodeSize(a) > unitBytecodeSize(b);
+        });
+  }
+  g_threaded_compile_context.startCompile(units, batch_compile_workers);
+  std::vector<std::thread> worker_threads;
   {
     // Ensure that no worker threads start compiling until they are all created,
     // in case something else in the process has hooked thread creation to run
     // arbitrary code.
     ThreadedCompileSerialize guard;
     for (size_t i = 0; i < batch_compile_workers; i++) {
-      worker_threads.emplace_back(compile_worker_thread);
+      worker_threads.emplace_back(compile_worker_thread, i);
     }
   }
   for (std::thread& worker_thread : worker_threads) {
@@ -857,12 +1154,38 @@ static bool compile_all() {
     live_compilation_units.emplace_back(unit);
   }
 
+  std::vector<CodeLayoutEntry> layout;
+  std::vector<BorrowedRef<>> layout_units;
+  if (getConfig().profile_guided_code_layout) {
+    layout = planCodeLayout(live_compilation_units, lookupPreloader);
+    layout_units = live_compilation_units;
+  }
+
   if (getConfig().batch_compile_workers > 0) {
     multithread_compile_units_preloaded(std::move(live_compilation_units));
   } else {
     compile_units_preloaded(std::move(live_compilation_units));
   }
 
+  if (getConfig().profile_guided_code_layout) {
+    for (size_t i = 0; i < layout.size(); i++) {
+      hir::Preloader* preloader = lookupPreloader(layout_units[i]);
+      CompiledFunction* compiled = jit_ctx->lookupCode(
+          preloader->code(), preloader->builtins(), preloader->globals());
+      if (compiled != nullptr) {
+        layout[i].code = compiled->codeStart();
+        layout[i].code_size = compiled->codeSize();
+      }
+      JIT_DLOG(
+          "Code layout: {} (hotness {}, after {}) at {}",
+          layout[i].name,
+          layout[i].hotness,
+          layout[i].caller.empty() ? "<none>" : layout[i].caller,
+          layout[i].code);
+    }
+    g_code_layout = std::move(layout);
+  }
+
   jit_preloaders.clear();
   return true;
 }
@@ -933,6 +1256,72 @@ static PyObject* get_batch_compilation_time_ms(PyObject*, PyObject*) {
   return PyLong_FromLong(g_batch_compilation_time_ms);
 }
 
+static PyObject* get_batch_compile_worker_stats(PyObject*, PyObject*) {
+  auto result = Ref<>::steal(PyList_New(0));
+  if (result == nullptr) {
+    return nullptr;
+  }
+  auto wall_time = g_threaded_compile_context.compileTime();
+  for (const CompileWorkerStats& worker :
+       g_threaded_compile_context.workerStats()) {
+    double utilization = wall_time.count() > 0
+        ? static_cast<double>(worker.busy.count()) / wall_time.count()
+        : 0.0;
+    auto stats = Ref<>::steal(Py_BuildValue(
+        "{s:n,s:n,s:L,s:d}",
+        "compiled",
+        static_cast<Py_ssize_t>(worker.compiled),
+        "stolen",
+        static_cast<Py_ssize_t>(worker.stolen),
+        "busy_ms",
+        static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(worker.busy)
+                .count()),
+        "utilization",
+        utilization));
+    if (stats == nullptr || PyList_Append(result, stats) < 0) {
+      return nullptr;
+    }
+  }
+  return result.release();
+}
+
+static PyObject* get_code_layout(PyObject*, PyObject*) {
+  auto result = Ref<>::steal(PyList_New(0));
+  if (result == nullptr) {
+    return nullptr;
+  }
+  for (const CodeLayoutEntry& entry : g_code_layout) {
+    auto item = Ref<>::steal(Py_BuildValue(
+        "{s:s,s:L,s:s,s:K,s:n}",
+        "name",
+        entry.name.c_str(),
+        "hotness",
+        static_cast<long long>(entry.hotness),
+        "caller",
+        entry.caller.c_str(),
+        "code",
+        static_cast<unsigned long long>(
+            reinterpret_cast<uintptr_t>(entry.code)),
+        "code_size",
+        static_cast<Py_ssize_t>(entry.code_size)));
+    if (item == nullptr || PyList_Append(result, item) < 0) {
+      return nullptr;
+    }
+  }
+  return result.release();
+}
+
+static PyObject* wait_for_background_compiles(PyObject*, PyObject*) {
+  g_background_compiler.wait();
+  Py_RETURN_NONE;
+}
+
+static PyObject* stop_background_compiles(PyObject*, PyObject*) {
+  g_background_compiler.stop();
+  Py_RETURN_NONE;
+}
+
 static PyObject* force_compile(PyObject* /* self */, PyObject* func_obj) {
   if (!PyFunction_Check(func_obj)) {
     PyErr_SetString(PyExc_TypeError, "force_compile expected a function");
@@ -1128,6 +1517,17 @@ static PyObject* get_inlined_functions_stats(PyObject*, PyObject* func) {
   return jit_ctx->inlinedFunctionsStats(func).release();
 }
 
+static PyObject* get_function_optimization_stats(PyObject*, PyObject* func) {
+  if (jit_ctx == nullptr) {
+    Py_RETURN_NONE;
+  }
+  Ref<> stats = jit_ctx->optimizationStats(func);
+  if (stats == nullptr) {
+    Py_RETURN_NONE;
+  }
+  return stats.release();
+}
+
 static PyObject* get_num_inlined_functions(PyObject*, PyObject* func) {
   int size = jit_ctx != nullptr ? jit_ctx->numInlinedFunctions(func) : 0;
   return PyLong_FromLong(size);
@@ -1272,6 +1672,17 @@ static PyObject* get_and_clear_runtime_stats(PyObject* /* self */, PyObject*) {
   try {
     Ref<> deopt_stats = make_deopt_stats();
     check(PyDict_SetItemString(stats, "deopt", deopt_stats));
+
+    Runtime* runtime = Runtime::get();
+    auto num_reoptimized =
+        Ref<>::steal(check(PyLong_FromSize_t(runtime->numReoptimized())));
+    check(PyDict_SetItemString(stats, "reoptimized", num_reoptimized));
+    runtime->clearNumReoptimized();
+
+    auto num_osr_entries =
+        Ref<>::steal(check(PyLong_FromSize_t(g_num_osr_entries)));
+    check(PyDict_SetItemString(stats, "osr_entries", num_osr_entries));
+    g_num_osr_entries = 0;
   } catch (const CAPIError&) {
     return nullptr;
   }
@@ -1281,6 +1692,8 @@ static PyObject* get_and_clear_runtime_stats(PyObject* /* self */, PyObject*) {
 
 static PyObject* clear_runtime_stats(PyObject* /* self */, PyObject*) {
   Runtime::get()->clearDeoptStats();
+  Runtime::get()->clearNumReoptimized();
+  g_num_osr_entries = 0;
   Py_RETURN_NONE;
 }
 
@@ -1385,8 +1798,28 @@ static PyObject* get_and_clear_inline_cache_stats(
     make_inline_cache_stats(load_type_method_stats, cache_stats);
   }
 
+  // How many caches of each kind are empty, monomorphic, polymorphic, or
+  // megamorphic. These describe the caches as they are now, so there is
+  // nothing to clear.
+  auto cache_states = Ref<>::steal(check(PyDict_New()));
+  check(PyDict_SetItemString(stats, "cache_states", cache_states));
+  auto add_counts = [&](const char* kind,
+                        const InlineCacheStateCounts& counts) {
+    auto counts_dict = Ref<>::steal(check(PyDict_New()));
+    for (size_t i = 0; i < kNumInlineCacheStates; i++) {
+      auto count = Ref<>::steal(check(PyLong_FromSize_t(counts[i])));
+      std::string name{inlineCacheStateName(static_cast<InlineCacheState>(i))};
+      check(PyDict_SetItemString(counts_dict, name.c_str(), count));
+    }
+    check(PyDict_SetItemString(cache_states, kind, counts_dict));
+  };
+  add_counts("load_attr", Runtime::get()->loadAttrCacheStates());
+  add_counts("store_attr", Runtime::get()->storeAttrCacheStates());
+  add_counts("load_method", Runtime::get()->loadMethodCacheStates());
+
   return stats.release();
 }
+
 static PyObject* jit_suppress(PyObject*, PyObject* func_obj) {
   if (!PyFunction_Check(func_obj)) {
     PyErr_SetString(PyExc_TypeError, "Input must be a function");
@@ -1431,6 +1864,59 @@ static PyObject* get_allocator_stats(PyObject*, PyObject*) {
       PyDict_SetItemString(stats, "huge_allocs", huge_allocs) < 0) {
     return nullptr;
   }
+  auto freed_bytes = Ref<>::steal(PyLong_FromLong(allocator->freedBytes()));
+  if (freed_bytes == nullptr ||
+      PyDict_SetItemString(stats, "freed_bytes", freed_bytes) < 0) {
+    return nullptr;
+  }
+  auto reused_bytes = Ref<>::steal(PyLong_FromLong(allocator->reusedBytes()));
+  if (reused_bytes == nullptr ||
+      PyDict_SetItemString(stats, "reused_bytes", reused_bytes) < 0) {
+    return nullptr;
+  }
+  auto free_list_bytes =
+      Ref<>::steal(PyLong_FromLong(allocator->freeListBytes()));
+  if (free_list_bytes == nullptr ||
+      PyDict_SetItemString(stats, "free_list_bytes", free_list_bytes) < 0) {
+    return nullptr;
+  }
+  return stats.release();
+}
+
+static PyObject* get_gen_data_allocator_stats(PyObject*, PyObject*) {
+  GenDataAllocator::Stats alloc_stats = GenDataAllocator::get().stats();
+  auto stats = Ref<>::steal(PyDict_New());
+  if (stats == nullptr) {
+    return nullptr;
+  }
+
+  try {
+    auto large_allocs =
+        Ref<>::steal(check(PyLong_FromSize_t(alloc_stats.large_allocs)));
+    check(PyDict_SetItemString(stats, "large_allocs", large_allocs));
+    auto retained_bytes =
+        Ref<>::steal(check(PyLong_FromSize_t(alloc_stats.retained_bytes)));
+    check(PyDict_SetItemString(stats, "retained_bytes", retained_bytes));
+
+    auto size_classes = Ref<>::steal(check(PyList_New(0)));
+    for (const auto& class_stats : alloc_stats.size_classes) {
+      auto class_dict = Ref<>::steal(check(PyDict_New()));
+      auto add_count = [&](const char* name, size_t value) {
+        auto count = Ref<>::steal(check(PyLong_FromSize_t(value)));
+        check(PyDict_SetItemString(class_dict, name, count));
+      };
+      add_count("spill_words", class_stats.spill_words);
+      add_count("allocs", class_stats.allocs);
+      add_count("reuses", class_stats.reuses);
+      add_count("retained", class_stats.retained);
+      add_count("released", class_stats.released);
+      check(PyList_Append(size_classes, class_dict));
+    }
+    check(PyDict_SetItemString(stats, "size_classes", size_classes));
+  } catch (const CAPIError&) {
+    return nullptr;
+  }
+
   return stats.release();
 }
 
@@ -1516,6 +2002,7 @@ static int deopt_gen_visitor(PyObject* obj, void*) {
 
 static PyObject* after_fork_child(PyObject*, PyObject*) {
   perf::afterForkChild();
+  g_background_compiler.afterForkChild();
   Py_RETURN_NONE;
 }
 
@@ -1584,7 +2071,9 @@ static PyMethodDef jit_methods[] = {
      METH_NOARGS,
      "Returns and clears information about the runtime inline cache stats "
      "behavior of JIT-compiled code. Stats will only be collected with X "
-     "flag jit-enable-inline-cache-stats-collection"},
+     "flag jit-enable-inline-cache-stats-collection, except for "
+     "'cache_states', which always counts the attribute caches in each "
+     "state."},
     {"is_inline_cache_stats_collection_enabled",
      is_inline_cache_stats_collection_enabled,
      METH_NOARGS,
@@ -1620,10 +2109,31 @@ static PyMethodDef jit_methods[] = {
      METH_NOARGS,
      "Return the number of milliseconds spent in batch compilation when "
      "disabling the JIT."},
+    {"get_code_layout",
+     get_code_layout,
+     METH_NOARGS,
+     "Return the code layout planned for the last batch compile, in layout "
+     "order."},
+    {"get_batch_compile_worker_stats",
+     get_batch_compile_worker_stats,
+     METH_NOARGS,
+     "Return a list with one dict per worker of the last multithreaded batch "
+     "compile: units compiled, units stolen from other workers, milliseconds "
+     "spent compiling, and that time as a fraction of the batch's wall time."},
+    {"wait_for_background_compiles",
+     wait_for_background_compiles,
+     METH_NOARGS,
+     "Wait until every function queued for compilation by -X jit-auto-async "
+     "has been compiled."},
     {"get_allocator_stats",
      get_allocator_stats,
      METH_NOARGS,
      "Return stats from the code allocator as a dictionary."},
+    {"get_gen_data_allocator_stats",
+     get_gen_data_allocator_stats,
+     METH_NOARGS,
+     "Return stats from the allocator for JIT generator spill data as a "
+     "dictionary, including per-size-class allocation and reuse counts."},
     {"is_hir_inliner_enabled",
      is_hir_inliner_enabled,
      METH_NOARGS,
@@ -1651,6 +2161,11 @@ static PyMethodDef jit_methods[] = {
      METH_O,
      "Return a map from HIR opcode name to the count of that opcode in the "
      "JIT-compiled version of this function."},
+    {"get_function_optimization_stats",
+     get_function_optimization_stats,
+     METH_O,
+     "Return a dict of HIR optimization stats for this JIT-compiled function: "
+     "{'num_gvn_eliminated' => int}, or None if it wasn't compiled."},
     {"mlock_profiler_dependencies",
      mlock_profiler_dependencies,
      METH_NOARGS,
@@ -1703,8 +2218,9 @@ static bool shouldAlwaysCompile(BorrowedRef<PyCodeObject> code) {
 
 // Check whether a function should be compiled.
 static bool shouldCompile(BorrowedRef<PyFunctionObject> func) {
-  return shouldAlwaysCompile(func->func_code) ||
-      g_jit_list->lookupFunc(func) == 1;
+  return (shouldAlwaysCompile(func->func_code) ||
+          g_jit_list->lookupFunc(func) == 1) &&
+      !g_compile_failure_cache.isKnownFailure(func->func_code);
 }
 
 // Check whether a code object should be compiled. Intended for nested code
@@ -1712,9 +2228,9 @@ static bool shouldCompile(BorrowedRef<PyFunctionObject> func) {
 static bool shouldCompile(
     BorrowedRef<> module_name,
     BorrowedRef<PyCodeObject> code) {
-  return (
-      shouldAlwaysCompile(code) || (g_jit_list->lookupCode(code) == 1) ||
-      (g_jit_list->lookupName(module_name, code->co_qualname) == 1));
+  return (shouldAlwaysCompile(code) || (g_jit_list->lookupCode(code) == 1) ||
+          (g_jit_list->lookupName(module_name, code->co_qualname) == 1)) &&
+      !g_compile_failure_cache.isKnownFailure(code);
 }
 
 namespace jit {
@@ -1777,6 +2293,34 @@ static _PyJIT_Result compile_func(BorrowedRef<PyFunctionObject> func) {
                                   : PYJIT_RESULT_PYTHON_EXCEPTION;
 }
 
+static PyMethodDef stop_background_compiles_def = {
+    "stop_background_compiles",
+    stop_background_compiles,
+    METH_NOARGS,
+    nullptr};
+
+// Register an atexit callback that stops the background compile thread. This
+// must happen before interpreter finalization starts, since from then on any
+// thread other than the main thread that tries to take the GIL is terminated.
+static int register_atexit_callback() {
+  if (!getConfig().auto_jit_async) {
+    return 0;
+  }
+  auto atexit_module = Ref<>::steal(
+      PyImport_ImportModuleLevel("atexit", nullptr, nullptr, nullptr, 0));
+  if (atexit_module == nullptr) {
+    return -1;
+  }
+  auto callback = Ref<>::steal(
+      PyCFunction_New(&stop_background_compiles_def, nullptr));
+  if (callback == nullptr) {
+    return -1;
+  }
+  auto result = Ref<>::steal(
+      PyObject_CallMethod(atexit_module, "register", "O", callback.get()));
+  return result == nullptr ? -1 : 0;
+}
+
 // Call posix.register_at_fork(None, None, cinderjit.after_fork_child), if it
 // exists. Returns 0 on success or if the module/function doesn't exist, and -1
 // on any other errors.
@@ -1971,9 +2515,18 @@ int _PyJIT_Initialize() {
     return 0;
   }
 
+  if (!compile_failure_cache_file.empty()) {
+    g_compile_failure_cache.load(compile_failure_cache_file);
+  }
+
   CodeAllocator::makeGlobalCodeAllocator();
 
   jit_ctx = new Context();
+  if (getConfig().reopt_threshold > 0) {
+    Runtime::get()->setReoptCallback([](CodeRuntime* code_rt) {
+      return jit_ctx != nullptr && jit_ctx->evictCode(code_rt);
+    });
+  }
 
   PyObject* mod = PyModule_Create(&jit_module);
   if (mod == nullptr) {
@@ -1994,7 +2547,8 @@ int _PyJIT_Initialize() {
     return -1;
   }
 
-  if (install_jit_audit_hook() < 0 || register_fork_callback(mod) < 0) {
+  if (install_jit_audit_hook() < 0 || register_fork_callback(mod) < 0 ||
+      register_atexit_callback() < 0) {
     return -1;
   }
 
@@ -2022,10 +2576,40 @@ unsigned _PyJIT_AutoJITProfileThreshold() {
   return getConfig().auto_jit_profile_threshold;
 }
 
+unsigned _PyJIT_OSRThreshold() {
+  return _PyJIT_IsEnabled() ? getConfig().osr_threshold : 0;
+}
+
+vectorcallfunc
+_PyJIT_GetOSREntry(PyFrameObject* frame, int instr_index, int stack_depth) {
+  if (jit_ctx == nullptr || !_PyJIT_IsEnabled()) {
+    return nullptr;
+  }
+  BorrowedRef<PyCodeObject> code = frame->f_code;
+  BorrowedRef<PyDictObject> builtins = frame->f_builtins;
+  BorrowedRef<PyDictObject> globals = frame->f_globals;
+  if (!PyDict_CheckExact(builtins) || !PyDict_CheckExact(globals) ||
+      !shouldCompile(PyDict_GetItemString(globals, "__name__"), code)) {
+    return nullptr;
+  }
+
+  hir::OSREntry osr_entry{BCIndex{instr_index}, stack_depth};
+  vectorcallfunc entry =
+      jit_ctx->compileOSR(code, builtins, globals, osr_entry);
+  if (entry != nullptr) {
+    g_num_osr_entries++;
+  }
+  return entry;
+}
+
 int _PyJIT_IsAutoJITEnabled() {
   return _PyJIT_AutoJITThreshold() > 0;
 }
 
+int _PyJIT_IsAutoJITAsync() {
+  return _PyJIT_IsAutoJITEnabled() && getConfig().auto_jit_async;
+}
+
 int _PyJIT_Enable() {
   if (getConfig().init_state != InitState::kInitialized) {
     return 0;
@@ -2054,6 +2638,38 @@ _PyJIT_Result _PyJIT_CompileFunction(PyFunctionObject* raw_func) {
   return compile_func(func);
 }
 
+_PyJIT_Result _PyJIT_ScheduleCompile(PyFunctionObject* raw_func) {
+  if (jit_ctx == nullptr) {
+    return PYJIT_NOT_INITIALIZED;
+  }
+
+  BorrowedRef<PyFunctionObject> func{raw_func};
+  if (jit_ctx->attachCompiledCode(func) == PYJIT_RESULT_OK) {
+    return PYJIT_RESULT_OK;
+  }
+  if (!shouldCompile(func)) {
+    return PYJIT_RESULT_NOT_ON_JITLIST;
+  }
+  jit_reg_units.erase(func);
+
+  CompilationKey key{func->func_code, func->func_builtins, func->func_globals};
+  if (g_background_compiler.addWaiter(key, func)) {
+    return PYJIT_RESULT_OK;
+  }
+
+  auto job = std::make_unique<BackgroundCompileJob>(key);
+  job->func = Ref<PyFunctionObject>::create(func);
+  {
+    IsolatedPreloaders ip;
+    if (!preloadFuncAndDeps(func)) {
+      return PYJIT_RESULT_PYTHON_EXCEPTION;
+    }
+    job->preloaders.swap(jit_preloaders);
+  }
+  return g_background_compiler.enqueue(job) ? PYJIT_RESULT_OK
+                                            : PYJIT_RESULT_UNKNOWN_ERROR;
+}
+
 // Recursively search the given co_consts tuple for any code objects that are
 // on the current jit-list, using the given module name to form a
 // fully-qualified function name.
@@ -2152,6 +2768,12 @@ void _PyJIT_TypeNameModified(PyTypeObject* type) {
   }
 }
 
+void _PyJIT_TypeSubclassed(PyTypeObject* base, PyTypeObject* type) {
+  if (auto rt = Runtime::getUnchecked()) {
+    rt->notifyTypeSubclassed(base, type);
+  }
+}
+
 void _PyJIT_TypeDestroyed(PyTypeObject* type) {
   auto& profile_runtime = jit::Runtime::get()->profileRuntime();
   profile_runtime.unregisterType(type);
@@ -2187,6 +2809,10 @@ void _PyJIT_CodeDestroyed(PyCodeObject* code) {
     auto code_obj = reinterpret_cast<PyObject*>(code);
     jit_reg_units.erase(code_obj);
     jit_code_data.erase(code);
+    if (jit_ctx != nullptr) {
+      jit_ctx->codeDestroyed(code);
+      Runtime::get()->forgetReoptSites(code);
+    }
     if (handle_unit_deleted_during_preload != nullptr) {
       handle_unit_deleted_during_preload(code_obj);
     }
@@ -2222,6 +2848,9 @@ int _PyJIT_Finalize() {
   // invoke the JIT while we're finalizing our data structures.
   getMutableConfig().is_enabled = 0;
 
+  // Normally already done by an atexit callback.
+  g_background_compiler.stop();
+
   // Deopt all JIT generators, since JIT generators reference code and other
   // metadata that we will be freeing later in this function.
   PyUnstable_GC_VisitObjects(deopt_gen_visitor, nullptr);
@@ -2238,6 +2867,13 @@ int _PyJIT_Finalize() {
 
   profile_runtime.clear();
 
+  if (g_compile_failure_cache.isEnabled()) {
+    JIT_DLOG(
+        "Skipped {} compiles of code in the compile failure cache",
+        g_compile_failure_cache.hits());
+    g_compile_failure_cache.save();
+  }
+
   if (!g_write_compiled_functions_file.empty()) {
     dump_jit_compiled_functions(g_write_compiled_functions_file);
     g_write_compiled_functions_file.clear();
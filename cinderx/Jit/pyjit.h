@@ -59,6 +59,12 @@ PyAPI_FUNC(int) _PyJIT_IsEnabled(void);
  */
 PyAPI_FUNC(int) _PyJIT_IsAutoJITEnabled(void);
 
+/*
+ * Returns 1 if auto-JIT compiles hot functions on a background thread and 0
+ * otherwise.
+ */
+PyAPI_FUNC(int) _PyJIT_IsAutoJITAsync(void);
+
 /*
  * Get the number of calls needed to mark a function for compilation by AutoJIT.
  * Returns 0 when AutoJIT is disabled.
@@ -72,6 +78,25 @@ PyAPI_FUNC(unsigned) _PyJIT_AutoJITThreshold(void);
  */
 PyAPI_FUNC(unsigned) _PyJIT_AutoJITProfileThreshold(void);
 
+/*
+ * Get the number of backward jumps an interpreted call may take before the
+ * interpreter tries to continue it in JIT-compiled code.  Returns 0 when
+ * on-stack replacement is disabled.
+ */
+PyAPI_FUNC(unsigned) _PyJIT_OSRThreshold(void);
+
+/*
+ * Get a JIT-compiled on-stack replacement entry for frame that continues
+ * executing at the loop header at instr_index (in code units), with
+ * stack_depth values on the operand stack.  The entry must be called with the
+ * frame's locals followed by its operand stack as positional arguments; the
+ * arguments are borrowed and remain owned by the frame.
+ *
+ * Returns NULL, without an exception set, if no entry is available.
+ */
+PyAPI_FUNC(vectorcallfunc)
+    _PyJIT_GetOSREntry(PyFrameObject* frame, int instr_index, int stack_depth);
+
 /*
  * JIT compile func and patch its entry point.
  *
@@ -81,6 +106,16 @@ PyAPI_FUNC(unsigned) _PyJIT_AutoJITProfileThreshold(void);
  */
 PyAPI_FUNC(_PyJIT_Result) _PyJIT_CompileFunction(PyFunctionObject* func);
 
+/*
+ * Preload func and hand it off to the background compile thread, which patches
+ * its entry point once it has been compiled.  func keeps its current entry
+ * point until then.
+ *
+ * Returns PYJIT_RESULT_OK if func was already compiled or has been queued for
+ * compilation.
+ */
+PyAPI_FUNC(_PyJIT_Result) _PyJIT_ScheduleCompile(PyFunctionObject* func);
+
 /*
  * Registers a function with the JIT to be compiled in the future.
  *
@@ -111,6 +146,11 @@ PyAPI_FUNC(void) _PyJIT_FuncModified(PyFunctionObject* func);
 PyAPI_FUNC(void) _PyJIT_FuncDestroyed(PyFunctionObject* func);
 PyAPI_FUNC(void) _PyJIT_CodeDestroyed(PyCodeObject* code);
 
+/*
+ * Informs the JIT that type is being created as a subclass of base.
+ */
+PyAPI_FUNC(void) _PyJIT_TypeSubclassed(PyTypeObject* base, PyTypeObject* type);
+
 /*
  * Clean up any resources allocated by the JIT.
  *
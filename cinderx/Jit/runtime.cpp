@@ -232,6 +232,40 @@ bool Runtime::hasFunctionEntryCache(PyFunctionObject* function) const {
   return function_entry_caches_.find(function) != function_entry_caches_.end();
 }
 
+void Runtime::setFunctionEntryFallback(
+    PyFunctionObject* function,
+    void* stub) {
+  auto it = function_entry_caches_.find(function);
+  JIT_CHECK(it != function_entry_caches_.end(), "Function has no entry cache");
+  it->second.fallbacks.push_back(stub);
+  *it->second.ptr = stub;
+}
+
+void Runtime::resetFunctionEntryCache(PyFunctionObject* function) {
+  auto it = function_entry_caches_.find(function);
+  if (it != function_entry_caches_.end() && !it->second.fallbacks.empty()) {
+    *it->second.ptr = it->second.fallbacks.back();
+  }
+}
+
+void Runtime::forgetFunctionEntryFallbacks(const void* start, size_t size) {
+  ThreadedCompileSerialize guard;
+  auto begin = reinterpret_cast<uintptr_t>(start);
+  auto in_range = [&](const void* addr) {
+    auto p = reinterpret_cast<uintptr_t>(addr);
+    return p >= begin && p < begin + size;
+  };
+  for (auto& entry : function_entry_caches_) {
+    FunctionEntryCacheValue& cache = entry.second;
+    std::erase_if(cache.fallbacks, in_range);
+    if (in_range(*cache.ptr)) {
+      // Only callers in the freed code used this stub; any remaining caller
+      // has a stub of its own.
+      *cache.ptr = cache.fallbacks.empty() ? nullptr : cache.fallbacks.back();
+    }
+  }
+}
+
 _PyTypedArgsInfo* Runtime::findFunctionPrimitiveArgInfo(
     PyFunctionObject* function) {
   auto cache = function_entry_caches_.find(function);
@@ -265,6 +299,23 @@ void Runtime::recordDeopt(std::size_t idx, PyObject* guilty_value) {
   if (guilty_value != nullptr) {
     stat.types.recordType(Py_TYPE(guilty_value));
   }
+
+  uint32_t threshold = getConfig().reopt_threshold;
+  if (threshold == 0 || stat.count != threshold || !reopt_callback_) {
+    return;
+  }
+  const DeoptMetadata& meta = getDeoptMetadata(idx);
+  if (meta.reason != DeoptReason::kGuardFailure) {
+    return;
+  }
+  // The callback only evicts the code; the old code stays alive for any frames
+  // still running it, and the next call compiles a replacement. The HIR
+  // builder consults reopt_sites_ to decide how much to speculate at this
+  // guard in the replacement.
+  if (reopt_callback_(meta.code_rt)) {
+    reopt_sites_[meta.code()][meta.instr_offset()]++;
+    num_reoptimized_++;
+  }
 }
 
 const DeoptStats& Runtime::deoptStats() const {
@@ -275,6 +326,33 @@ void Runtime::clearDeoptStats() {
   deopt_stats_.clear();
 }
 
+void Runtime::setReoptCallback(Runtime::ReoptCallback cb) {
+  reopt_callback_ = std::move(cb);
+}
+
+int Runtime::numReopts(BorrowedRef<PyCodeObject> code, BCOffset bc_off)
+    const {
+  auto code_it = reopt_sites_.find(code);
+  if (code_it == reopt_sites_.end()) {
+    return 0;
+  }
+  auto site_it = code_it->second.find(bc_off);
+  return site_it == code_it->second.end() ? 0 : site_it->second;
+}
+
+void Runtime::forgetReoptSites(BorrowedRef<PyCodeObject> code) {
+  ThreadedCompileSerialize guard;
+  reopt_sites_.erase(code);
+}
+
+std::size_t Runtime::numReoptimized() const {
+  return num_reoptimized_;
+}
+
+void Runtime::clearNumReoptimized() {
+  num_reoptimized_ = 0;
+}
+
 InlineCacheStats Runtime::getAndClearLoadMethodCacheStats() {
   InlineCacheStats stats;
   for (auto& cache : load_method_caches_) {
@@ -303,6 +381,31 @@ InlineCacheStats Runtime::getAndClearLoadTypeMethodCacheStats() {
   return stats;
 }
 
+namespace {
+
+template <typename Arena>
+InlineCacheStateCounts countCacheStates(Arena& caches) {
+  InlineCacheStateCounts counts{};
+  for (auto& cache : caches) {
+    counts[static_cast<size_t>(cache.state())]++;
+  }
+  return counts;
+}
+
+} // namespace
+
+InlineCacheStateCounts Runtime::loadAttrCacheStates() {
+  return countCacheStates(load_attr_caches_);
+}
+
+InlineCacheStateCounts Runtime::storeAttrCacheStates() {
+  return countCacheStates(store_attr_caches_);
+}
+
+InlineCacheStateCounts Runtime::loadMethodCacheStates() {
+  return countCacheStates(load_method_caches_);
+}
+
 void Runtime::setGuardFailureCallback(Runtime::GuardFailureCallback cb) {
   guard_failure_callback_ = cb;
 }
@@ -350,6 +453,23 @@ std::optional<std::string> symbolize(const void* func) {
   return jit::demangle(std::string{*mangled_name});
 }
 
+void Runtime::forgetDeoptPatchers(const std::vector<DeoptPatcher*>& patchers) {
+  if (patchers.empty()) {
+    return;
+  }
+  ThreadedCompileSerialize guard;
+  std::unordered_set<const DeoptPatcher*> forget{
+      patchers.begin(), patchers.end()};
+  for (auto& [type, type_patchers] : type_deopt_patchers_) {
+    std::erase_if(type_patchers, [&](const TypeDeoptPatcher* patcher) {
+      return forget.count(patcher) != 0;
+    });
+  }
+  std::erase_if(deopt_patchers_, [&](const auto& patcher) {
+    return forget.count(patcher.get()) != 0;
+  });
+}
+
 void Runtime::watchType(
     BorrowedRef<PyTypeObject> type,
     TypeDeoptPatcher* patcher) {
@@ -384,4 +504,35 @@ void Runtime::notifyTypeModified(
   }
 }
 
+void Runtime::notifyTypeSubclassed(
+    BorrowedRef<PyTypeObject> base,
+    BorrowedRef<PyTypeObject> subclass) {
+  ThreadedCompileSerialize guard;
+  auto it = type_deopt_patchers_.find(base);
+  if (it == type_deopt_patchers_.end()) {
+    return;
+  }
+
+  // Patchers may start watching subclass, which can rehash
+  // type_deopt_patchers_, so work from a copy.
+  std::vector<TypeDeoptPatcher*> patchers = it->second;
+  std::unordered_set<TypeDeoptPatcher*> done;
+  for (TypeDeoptPatcher* patcher : patchers) {
+    if (patcher->maybePatchForSubclass(subclass)) {
+      done.emplace(patcher);
+    }
+  }
+  if (done.empty()) {
+    return;
+  }
+
+  it = type_deopt_patchers_.find(base);
+  std::erase_if(it->second, [&](TypeDeoptPatcher* patcher) {
+    return done.contains(patcher);
+  });
+  if (it->second.empty()) {
+    type_deopt_patchers_.erase(it);
+  }
+}
+
 } // namespace jit
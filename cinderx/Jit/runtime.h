@@ -85,10 +85,9 @@ static_assert(
     offsetof(GenDataFooter, yieldPoint) == Ci_GEN_JIT_DATA_OFFSET_YIELD_POINT,
     "Byte offset for yieldPoint shifted");
 
-// The number of words for pre-allocated blocks in the generator suspend data
-// free-list. I chose this based on it covering 99% of the JIT generator
-// spill-sizes needed when running 'make testcinder_jit' at the time I collected
-// this data. For reference:
+// The number of words in the smallest size class of GenDataAllocator. This
+// covered 99% of the JIT generator spill sizes needed when running
+// 'make testcinder_jit' at the time this data was collected. For reference:
 //   99.9% coverage came at 256 spill size
 //   99.99% was at 1552
 //   max was 4999
@@ -311,6 +310,9 @@ class Runtime {
 
   template <typename... Args>
   CodeRuntime* allocateCodeRuntime(Args&&... args) {
+    // The CodeRuntime constructor takes the threaded-compile lock, so take it
+    // before the arena's lock to keep a consistent lock order.
+    ThreadedCompileSerialize guard;
     return code_runtimes_.allocate(std::forward<Args>(args)...);
   }
 
@@ -333,6 +335,19 @@ class Runtime {
   // Checks to see if we already have an entry for indirect static entry point
   bool hasFunctionEntryCache(PyFunctionObject* function) const;
 
+  // Point the function's entry cache at a stub that calls the function
+  // without its compiled static entry, and remember the stub for
+  // resetFunctionEntryCache().
+  void setFunctionEntryFallback(PyFunctionObject* function, void* stub);
+
+  // Point the function's entry cache, if it has one, back at a fallback
+  // stub. Called when the function's compiled code is no longer used.
+  void resetFunctionEntryCache(PyFunctionObject* function);
+
+  // Forget the fallback stubs in [start, start + size), which is about to be
+  // freed, and move any entry cache still pointing into it to another stub.
+  void forgetFunctionEntryFallbacks(const void* start, size_t size);
+
   // Gets information about the primitive arguments that a function
   // is typed to.  Typed object references are explicitly excluded.
   _PyTypedArgsInfo* findFunctionPrimitiveArgInfo(PyFunctionObject* function);
@@ -360,10 +375,46 @@ class Runtime {
   const DeoptStats& deoptStats() const;
   void clearDeoptStats();
 
+  // Called when a guard in the given code has failed often enough to pass the
+  // reopt threshold. Should return true if the code was evicted so that its
+  // next call recompiles it.
+  using ReoptCallback = std::function<bool(CodeRuntime*)>;
+
+  // Set the function used to evict code that deopts too often. Recompilation
+  // is disabled while no callback is set.
+  void setReoptCallback(ReoptCallback cb);
+
+  // Get the number of times a guard at the given location has caused its
+  // function to be recompiled. The HIR builder uses this to stop speculating
+  // at locations where its guards keep failing.
+  int numReopts(BorrowedRef<PyCodeObject> code, BCOffset bc_off) const;
+
+  // Drop the recompilation counts for a code object that is being destroyed.
+  void forgetReoptSites(BorrowedRef<PyCodeObject> code);
+
+  // Get and/or clear the number of times compiled code was evicted for
+  // recompilation because of failing guards.
+  std::size_t numReoptimized() const;
+  void clearNumReoptimized();
+
   // Get and clear inline cache stats.
   InlineCacheStats getAndClearLoadMethodCacheStats();
   InlineCacheStats getAndClearLoadTypeMethodCacheStats();
 
+  // Count the LoadAttr, StoreAttr and LoadMethod caches in each state.
+  InlineCacheStateCounts loadAttrCacheStates();
+  InlineCacheStateCounts storeAttrCacheStates();
+  InlineCacheStateCounts loadMethodCacheStates();
+
+  // Caches shared by all megamorphic StoreAttr and LoadMethod caches.
+  // Megamorphic LoadAttr caches use Ci_AttrLookupCache instead.
+  MegamorphicCache<AttributeMutator>& megamorphicStoreAttrCache() {
+    return megamorphic_store_attr_cache_;
+  }
+  MegamorphicCache<BorrowedRef<>>& megamorphicLoadMethodCache() {
+    return megamorphic_load_method_cache_;
+  }
+
   using GuardFailureCallback = std::function<void(const DeoptMetadata&)>;
 
   // Add a function to be called when deoptimization occurs due to guard
@@ -387,11 +438,15 @@ class Runtime {
 
   template <typename T, typename... Args>
   T* allocateDeoptPatcher(Args&&... args) {
+    ThreadedCompileSerialize guard;
     deopt_patchers_.emplace_back(
         std::make_unique<T>(std::forward<Args>(args)...));
     return static_cast<T*>(deopt_patchers_.back().get());
   }
 
+  // Destroy the given deopt patchers, whose code is about to be freed.
+  void forgetDeoptPatchers(const std::vector<DeoptPatcher*>& patchers);
+
   LoadAttrCache* allocateLoadAttrCache() {
     return load_attr_caches_.allocate();
   }
@@ -461,6 +516,13 @@ class Runtime {
       BorrowedRef<PyTypeObject> lookup_type,
       BorrowedRef<PyTypeObject> new_type);
 
+  // Callback for when subclass is being created as a subclass of base, before
+  // it is added to base's tp_subclasses. Calls
+  // patcher->maybePatchForSubclass(subclass) for each patcher watching base.
+  void notifyTypeSubclassed(
+      BorrowedRef<PyTypeObject> base,
+      BorrowedRef<PyTypeObject> subclass);
+
  private:
   static Runtime* s_runtime_;
 
@@ -471,14 +533,17 @@ class Runtime {
   // These SlabAreas hold data that is allocated at compile-time and likely to
   // change at runtime, and should be isolated from other data to avoid COW
   // casualties.
-  SlabArena<LoadAttrCache, AttributeCacheSizeTrait> load_attr_caches_;
+  SlabArena<LoadAttrCache> load_attr_caches_;
   SlabArena<LoadTypeAttrCache> load_type_attr_caches_;
   SlabArena<LoadMethodCache> load_method_caches_;
   SlabArena<LoadModuleMethodCache> load_module_method_caches_;
   SlabArena<LoadTypeMethodCache> load_type_method_caches_;
-  SlabArena<StoreAttrCache, AttributeCacheSizeTrait> store_attr_caches_;
+  SlabArena<StoreAttrCache> store_attr_caches_;
   SlabArena<void*> pointer_caches_;
 
+  MegamorphicCache<AttributeMutator> megamorphic_store_attr_cache_;
+  MegamorphicCache<BorrowedRef<>> megamorphic_load_method_cache_;
+
   GlobalCacheMap global_caches_;
   FunctionEntryCacheMap function_entry_caches_;
 
@@ -486,6 +551,13 @@ class Runtime {
   DeoptStats deopt_stats_;
   GuardFailureCallback guard_failure_callback_;
 
+  // Number of recompilations triggered by each guard location, keyed by the
+  // innermost code object and bytecode offset of the guard.
+  UnorderedMap<BorrowedRef<PyCodeObject>, UnorderedMap<BCOffset, int>>
+      reopt_sites_;
+  ReoptCallback reopt_callback_;
+  std::size_t num_reoptimized_{0};
+
   // Note: Ideally this would be separate from JIT metadata.  It should be
   // usable even when the JIT is fully reset.
   ProfileRuntime profile_runtime_;
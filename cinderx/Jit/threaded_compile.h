@@ -7,55 +7,158 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 namespace jit {
 
+// Counters for one batch compile worker, reset at the start of each batch
+// compile. Each worker only writes its own entry, and the entries are padded
+// so that they don't share cache lines.
+struct alignas(64) CompileWorkerStats {
+  // Units handed to this worker, including stolen ones.
+  size_t compiled{0};
+  // Units this worker took from another worker's queue.
+  size_t stolen{0};
+  // Time spent compiling, as opposed to looking for work.
+  std::chrono::nanoseconds busy{0};
+};
+
+// One worker's share of a batch compile. The units are fixed before any worker
+// starts. The owner takes units from the front and other workers steal from the
+// back; both ends are packed into one word so the two sides can race for the
+// last unit with a single compare-and-swap.
+class CompileWorkQueue {
+ public:
+  // Add a unit. Only called before the compile starts.
+  void push(BorrowedRef<> unit) {
+    units_.emplace_back(unit);
+    range_.store(pack(0, units_.size()), std::memory_order_relaxed);
+  }
+
+  BorrowedRef<> take() {
+    return pop(true);
+  }
+
+  BorrowedRef<> steal() {
+    return pop(false);
+  }
+
+ private:
+  static uint64_t pack(uint64_t front, uint64_t back) {
+    return front | (back << 32);
+  }
+
+  BorrowedRef<> pop(bool from_front) {
+    uint64_t range = range_.load(std::memory_order_relaxed);
+    for (;;) {
+      uint64_t front = range & 0xffffffff;
+      uint64_t back = range >> 32;
+      if (front >= back) {
+        return nullptr;
+      }
+      uint64_t idx = from_front ? front++ : --back;
+      if (range_.compare_exchange_weak(
+              range, pack(front, back), std::memory_order_relaxed)) {
+        return units_[idx];
+      }
+    }
+  }
+
+  std::vector<BorrowedRef<>> units_;
+  alignas(64) std::atomic<uint64_t> range_{0};
+};
+
 // Threaded-compile state for the whole process.
 class ThreadedCompileContext {
  public:
-  void startCompile(std::vector<BorrowedRef<>>&& work_queue) {
+  // Start a compile of the given units, which should be ordered from most to
+  // least expensive, by num_workers workers. The units are dealt out
+  // round-robin so every worker starts on its share of the large ones.
+  void startCompile(
+      const std::vector<BorrowedRef<>>& units,
+      size_t num_workers) {
     // Can't use JIT_CHECK because we're included by log.h
     assert(!compile_running_);
-    work_queue_ = std::move(work_queue);
+    assert(num_workers > 0);
+    work_queues_ = std::vector<CompileWorkQueue>(num_workers);
+    for (size_t i = 0; i < units.size(); i++) {
+      work_queues_[i % num_workers].push(units[i]);
+    }
+    worker_stats_.assign(num_workers, CompileWorkerStats{});
+    compile_start_ = std::chrono::steady_clock::now();
     compile_running_ = true;
   }
 
   std::vector<BorrowedRef<>>&& endCompile() {
     compile_running_ = false;
+    compile_time_ = std::chrono::steady_clock::now() - compile_start_;
+    work_queues_.clear();
     return std::move(retry_list_);
   }
 
-  BorrowedRef<> nextUnit() {
-    lock();
-    if (work_queue_.empty()) {
-      unlock();
-      return nullptr;
+  // Return the next unit for the given worker, stealing from the other workers
+  // once its own queue is empty, or nullptr if there is no work left.
+  BorrowedRef<> nextUnit(size_t worker_id) {
+    CompileWorkerStats& stats = worker_stats_[worker_id];
+    BorrowedRef<> unit = work_queues_[worker_id].take();
+    for (size_t i = 1; unit == nullptr && i < work_queues_.size(); i++) {
+      unit = work_queues_[(worker_id + i) % work_queues_.size()].steal();
+      if (unit != nullptr) {
+        stats.stolen++;
+      }
+    }
+    if (unit != nullptr) {
+      stats.compiled++;
     }
-    BorrowedRef<> unit = std ::move(work_queue_.back());
-    work_queue_.pop_back();
-    unlock();
     return unit;
   }
 
-  // Assumes we have the lock
+  void addBusyTime(size_t worker_id, std::chrono::nanoseconds time) {
+    worker_stats_[worker_id].busy += time;
+  }
+
   void retryUnit(BorrowedRef<> unit) {
-    lock();
+    std::lock_guard<std::mutex> guard{retry_mutex_};
     retry_list_.emplace_back(unit);
-    unlock();
+  }
+
+  // Stats for each worker of the most recent batch compile. Only valid once it
+  // has finished.
+  const std::vector<CompileWorkerStats>& workerStats() const {
+    return worker_stats_;
+  }
+
+  // Wall time of the most recent batch compile.
+  std::chrono::nanoseconds compileTime() const {
+    return compile_time_;
   }
 
   bool compileRunning() const {
     return compile_running_;
   }
 
+  // Mark the calling thread as a background compile thread, or clear the mark
+  // if tstate is nullptr. A background compile thread runs while other threads
+  // keep executing Python code, so instead of the threaded-compile mutex it
+  // acquires the GIL, using tstate, whenever it takes the threaded-compile
+  // lock.
+  void setBackgroundThreadState(PyThreadState* tstate) {
+    assert(background_lock_depth_ == 0);
+    background_tstate_ = tstate;
+  }
+
   // Returns true if it's safe for the current thread to access data protected
   // by the threaded compile lock, either because no threaded compile is active
   // or the current thread holds the lock. May return true erroneously, but
   // shouldn't return false erroneously.
   bool canAccessSharedData() const {
+    if (background_tstate_ != nullptr) {
+      return background_lock_depth_ > 0;
+    }
     return !compileRunning() ||
         mutex_holder_.load(std::memory_order_relaxed) ==
         std::this_thread::get_id();
@@ -65,6 +168,12 @@ class ThreadedCompileContext {
   friend class ThreadedCompileSerialize;
 
   void lock() {
+    if (background_tstate_ != nullptr) {
+      if (background_lock_depth_++ == 0) {
+        PyEval_RestoreThread(background_tstate_);
+      }
+      return;
+    }
     if (compileRunning()) {
       mutex_.lock();
       mutex_holder_.store(
@@ -73,6 +182,12 @@ class ThreadedCompileContext {
   }
 
   void unlock() {
+    if (background_tstate_ != nullptr) {
+      if (--background_lock_depth_ == 0) {
+        PyEval_SaveThread();
+      }
+      return;
+    }
     if (compileRunning()) {
       mutex_holder_.store(std::thread::id{}, std::memory_order_relaxed);
       mutex_.unlock();
@@ -104,7 +219,19 @@ class ThreadedCompileContext {
   // later.
   std::atomic<std::thread::id> mutex_holder_;
 
-  std::vector<BorrowedRef<>> work_queue_;
+  // Set only on a background compile thread. Threads running Python code hold
+  // the GIL, so holding it while touching shared data is enough to serialize
+  // with them. It also excludes batch compiles, which are started and joined
+  // by a thread holding the GIL.
+  static inline thread_local PyThreadState* background_tstate_{nullptr};
+  static inline thread_local int background_lock_depth_{0};
+
+  std::vector<CompileWorkQueue> work_queues_;
+  std::vector<CompileWorkerStats> worker_stats_;
+  std::chrono::steady_clock::time_point compile_start_;
+  std::chrono::nanoseconds compile_time_{0};
+
+  std::mutex retry_mutex_;
   std::vector<BorrowedRef<>> retry_list_;
 };
 
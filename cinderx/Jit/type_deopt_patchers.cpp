@@ -17,6 +17,10 @@ bool TypeDeoptPatcher::maybePatch(BorrowedRef<PyTypeObject>) {
   return true;
 }
 
+bool TypeDeoptPatcher::maybePatchForSubclass(BorrowedRef<PyTypeObject>) {
+  return false;
+}
+
 void TypeDeoptPatcher::init() {
   Runtime::get()->watchType(type_, this);
 }
@@ -74,6 +78,74 @@ bool TypeAttrDeoptPatcher::maybePatch(BorrowedRef<PyTypeObject> new_ty) {
   return should_patch;
 }
 
+MethodOverrideDeoptPatcher::MethodOverrideDeoptPatcher(
+    BorrowedRef<PyTypeObject> type,
+    BorrowedRef<PyUnicodeObject> method_name,
+    BorrowedRef<> target_func)
+    : TypeDeoptPatcher{type} {
+  ThreadedCompileSerialize guard;
+  method_name_.reset(method_name);
+  target_func_.reset(target_func);
+}
+
+void MethodOverrideDeoptPatcher::init() {
+  // The hierarchy was checked when the call was devirtualized, but a
+  // subclass may have been created since then, so check it again while
+  // subscribing to every type in it.
+  ThreadedCompileSerialize guard;
+  visitTypeHierarchy(type_, [&](BorrowedRef<PyTypeObject> type) {
+    return watch(type);
+  });
+}
+
+bool MethodOverrideDeoptPatcher::watch(BorrowedRef<PyTypeObject> type) {
+  // PyType_Modified() only notifies watchers of types with a valid version
+  // tag.
+  if (typeLookupSafe(type, method_name_) != target_func_ ||
+      !ensureVersionTag(type)) {
+    doPatch();
+    return false;
+  }
+  Runtime::get()->watchType(type, this);
+  return true;
+}
+
+void MethodOverrideDeoptPatcher::doPatch() {
+  patch();
+  method_name_.reset();
+  target_func_.reset();
+}
+
+bool MethodOverrideDeoptPatcher::maybePatch(BorrowedRef<PyTypeObject> new_ty) {
+  if (method_name_ == nullptr) {
+    // Already patched through another type in the hierarchy.
+    return true;
+  }
+  if (new_ty == nullptr) {
+    // The type is being destroyed, so there are no instances of it left to
+    // call the method on.
+    return true;
+  }
+  // For __class__ assignment new_ty is the instance's new type, which is
+  // checked the same way as a modified type.
+  if (typeLookupSafe(new_ty, method_name_) != target_func_ ||
+      !ensureVersionTag(new_ty)) {
+    doPatch();
+    return true;
+  }
+  return false;
+}
+
+bool MethodOverrideDeoptPatcher::maybePatchForSubclass(
+    BorrowedRef<PyTypeObject> subclass) {
+  if (method_name_ == nullptr) {
+    return true;
+  }
+  // A subclass that doesn't override the method has to be watched too, since
+  // the method could be assigned on it later.
+  return !watch(subclass);
+}
+
 SplitDictDeoptPatcher::SplitDictDeoptPatcher(
     BorrowedRef<PyTypeObject> type,
     BorrowedRef<PyUnicodeObject> attr_name,
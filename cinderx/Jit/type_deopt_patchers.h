@@ -21,6 +21,11 @@ class TypeDeoptPatcher : public DeoptPatcher {
 
   virtual bool maybePatch(BorrowedRef<PyTypeObject> new_ty);
 
+  // Called when a subclass of a watched type is being created, before it is
+  // added to the base's tp_subclasses. Return true if the patcher no longer
+  // needs to watch the base.
+  virtual bool maybePatchForSubclass(BorrowedRef<PyTypeObject> subclass);
+
  protected:
   void init() override;
 
@@ -43,6 +48,32 @@ class TypeAttrDeoptPatcher : public TypeDeoptPatcher {
   Ref<> target_object_;
 };
 
+// Patch a DeoptPatchpoint when any type in the hierarchy rooted at the given
+// PyTypeObject, including subclasses created later, no longer resolves the
+// given method name to target_func. Used by devirtualized INVOKE_METHOD
+// calls.
+class MethodOverrideDeoptPatcher : public TypeDeoptPatcher {
+ public:
+  MethodOverrideDeoptPatcher(
+      BorrowedRef<PyTypeObject> type,
+      BorrowedRef<PyUnicodeObject> method_name,
+      BorrowedRef<> target_func);
+
+  bool maybePatch(BorrowedRef<PyTypeObject> new_ty) override;
+  bool maybePatchForSubclass(BorrowedRef<PyTypeObject> subclass) override;
+
+ protected:
+  void init() override;
+
+ private:
+  // Watch type, or patch and return false if it overrides the method.
+  bool watch(BorrowedRef<PyTypeObject> type);
+  void doPatch();
+
+  Ref<> method_name_;
+  Ref<> target_func_;
+};
+
 class SplitDictDeoptPatcher : public TypeDeoptPatcher {
  public:
   SplitDictDeoptPatcher(
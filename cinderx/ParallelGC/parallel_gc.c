@@ -1157,6 +1157,21 @@ Ci_deduce_unreachable_parallel(Ci_ParGCState *par_gc, PyGC_Head *base, PyGC_Head
 static int
 Ci_should_use_par_gc(Ci_ParGCState *par_gc, int gen);
 
+static int
+Ci_should_collect_incrementally(Ci_ParGCState *par_gc, GCState *gcstate,
+                                int gen, int nofail);
+
+static void
+Ci_reset_incremental_progress(Ci_ParGCState *par_gc);
+
+static Py_ssize_t
+Ci_take_increment(Ci_ParGCState *par_gc, GCState *gcstate,
+                  PyGC_Head *increment);
+
+static void
+Ci_record_pause(Ci_ParGCState *par_gc, int gen, int incremental,
+                _PyTime_t pause);
+
 /* This is the main function.  Read this to understand how the
  * collection process works. */
 static Py_ssize_t
@@ -1173,7 +1188,10 @@ gc_collect_main(Ci_PyGCImpl *gc_impl, PyThreadState *tstate, int generation,
     PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
     PyGC_Head *gc;
     _PyTime_t t1 = 0;   /* initialize to prevent a compiler warning */
+    _PyTime_t start = _PyTime_GetMonotonicClock();
     GCState *gcstate = &tstate->interp->gc;
+    Ci_ParGCState *par_gc = (Ci_ParGCState *) gc_impl;
+    PyGC_Head increment; /* objects examined by an incremental collection */
 
     // gc_collect_main() must not be called before _PyGC_Init
     // or after _PyGC_Fini()
@@ -1194,26 +1212,39 @@ gc_collect_main(Ci_PyGCImpl *gc_impl, PyThreadState *tstate, int generation,
         t1 = _PyTime_GetMonotonicClock();
     }
 
+    /* Must be decided before the counters are reset */
+    int incremental =
+        Ci_should_collect_incrementally(par_gc, gcstate, generation, nofail);
+
     /* update collection and allocation counters */
     if (generation+1 < NUM_GENERATIONS)
         gcstate->generations[generation+1].count += 1;
     for (i = 0; i <= generation; i++)
         gcstate->generations[i].count = 0;
 
-    /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, generation));
+    Py_ssize_t young_size = 0;
+    if (incremental) {
+        /* Examine the younger generations together with the next increment
+         * of the oldest one; see Ci_take_increment(). */
+        young = &increment;
+        old = GEN_HEAD(gcstate, NUM_GENERATIONS-1);
+        young_size = Ci_take_increment(par_gc, gcstate, young);
     }
+    else {
+        /* merge younger generations with one we are currently collecting */
+        for (i = 0; i < generation; i++) {
+            gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, generation));
+        }
 
-    /* handy references */
-    young = GEN_HEAD(gcstate, generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(gcstate, generation+1);
-    else
-        old = young;
+        /* handy references */
+        young = GEN_HEAD(gcstate, generation);
+        if (generation < NUM_GENERATIONS-1)
+            old = GEN_HEAD(gcstate, generation+1);
+        else
+            old = young;
+    }
     validate_list(old, collecting_clear_unreachable_clear);
 
-    Ci_ParGCState *par_gc = (Ci_ParGCState *) gc_impl;
     if (Ci_should_use_par_gc(par_gc, generation)) {
         Ci_deduce_unreachable_parallel(par_gc, young, &unreachable);
     } else {
@@ -1222,7 +1253,20 @@ gc_collect_main(Ci_PyGCImpl *gc_impl, PyThreadState *tstate, int generation,
 
     untrack_tuples(young);
     /* Move reachable objects to next generation. */
-    if (young != old) {
+    if (incremental) {
+        /* Survivors from the oldest generation go to the back of it, so the
+         * next increment picks up where this one left off. Only the
+         * survivors from the younger generations are newly long-lived. */
+        if (generation == NUM_GENERATIONS - 1) {
+            gcstate->long_lived_pending = 0;
+        }
+        else {
+            gcstate->long_lived_pending +=
+                Py_MIN(young_size, gc_list_size(young));
+        }
+        gc_list_merge(young, old);
+    }
+    else if (young != old) {
         if (generation == NUM_GENERATIONS - 2) {
             gcstate->long_lived_pending += gc_list_size(young);
         }
@@ -1234,6 +1278,7 @@ gc_collect_main(Ci_PyGCImpl *gc_impl, PyThreadState *tstate, int generation,
         untrack_dicts(young);
         gcstate->long_lived_pending = 0;
         gcstate->long_lived_total = gc_list_size(young);
+        Ci_reset_incremental_progress(par_gc);
     }
 
     /* All objects in unreachable are trash, but objects reachable from
@@ -1330,6 +1375,9 @@ gc_collect_main(Ci_PyGCImpl *gc_impl, PyThreadState *tstate, int generation,
     stats->collected += m;
     stats->uncollectable += n;
 
+    Ci_record_pause(par_gc, generation, incremental,
+                    _PyTime_GetMonotonicClock() - start);
+
     assert(!_PyErr_Occurred(tstate));
     return n + m;
 }
@@ -1528,6 +1576,29 @@ typedef struct {
     unsigned long thread_id;
 } Ci_ParGCWorker;
 
+// Kinds of collection whose pause times are tracked separately
+typedef enum {
+    // Collections of the younger generations only
+    CI_PAUSE_YOUNG,
+    // Collections that examined an increment of the oldest generation
+    CI_PAUSE_INCREMENTAL,
+    // Collections of the whole heap
+    CI_PAUSE_FULL,
+    CI_NUM_PAUSE_KINDS,
+} Ci_PauseKind;
+
+#define CI_NUM_PAUSE_BUCKETS 32
+
+// Histogram of pause times. Bucket i counts pauses of less than 2**i
+// microseconds that didn't fit in bucket i - 1; the last bucket also counts
+// anything longer.
+typedef struct {
+    unsigned long count;
+    _PyTime_t total_us;
+    _PyTime_t max_us;
+    unsigned long buckets[CI_NUM_PAUSE_BUCKETS];
+} Ci_PauseHistogram;
+
 struct Ci_ParGCState {
     Ci_PyGCImpl gc_impl;
 
@@ -1559,6 +1630,20 @@ struct Ci_ParGCState {
     // it is safe to destroy shared state.
     _Py_atomic_int num_workers_active;
 
+    // When non-zero, collections of the two oldest generations examine at most
+    // this many objects from the oldest generation. See Ci_take_increment().
+    size_t incremental_slice;
+
+    // Number of objects from the oldest generation examined by incremental
+    // collections since the last full collection.
+    size_t incremental_progress;
+
+    // Non-zero while a collection requested through gc.collect() is running.
+    // See Cinder_SetParallelGCCollectRequested().
+    int collect_requested;
+
+    Ci_PauseHistogram pauses[CI_NUM_PAUSE_KINDS];
+
     size_t num_workers;
     Ci_ParGCWorker workers[];
 };
@@ -1569,6 +1654,92 @@ Ci_should_use_par_gc(Ci_ParGCState *par_gc, int gen)
     return par_gc != NULL && gen >= par_gc->min_gen;
 }
 
+static int
+Ci_should_collect_incrementally(Ci_ParGCState *par_gc, GCState *gcstate,
+                                int gen, int nofail)
+{
+    // Explicit calls to gc.collect() and collections at shutdown expect
+    // everything unreachable to be gone afterwards.
+    if (par_gc == NULL || par_gc->incremental_slice == 0 || nofail ||
+        par_gc->collect_requested || gen < NUM_GENERATIONS - 2) {
+        return 0;
+    }
+    if (gen == NUM_GENERATIONS - 2) {
+        return 1;
+    }
+    // Cycles that never fit in one increment can only be found by looking at
+    // the whole heap, so once increments have covered the oldest generation
+    // the next collection of it is a full one.
+    return par_gc->incremental_progress < (size_t) gcstate->long_lived_total;
+}
+
+static void
+Ci_reset_incremental_progress(Ci_ParGCState *par_gc)
+{
+    if (par_gc != NULL) {
+        par_gc->incremental_progress = 0;
+    }
+}
+
+/* Move the objects examined by an incremental collection into increment:
+ * everything in the younger generations, followed by up to
+ * incremental_slice objects from the front of the oldest generation.
+ * Returns the number of objects from the younger generations.
+ *
+ * Collecting any subset of the heap is safe, since references from outside
+ * the subset keep the objects they point to alive. Survivors are appended to
+ * the oldest generation, so successive increments walk through all of it,
+ * and cycles that were created together tend to end up in the same increment
+ * since the lists are kept in allocation order.
+ */
+static Py_ssize_t
+Ci_take_increment(Ci_ParGCState *par_gc, GCState *gcstate,
+                  PyGC_Head *increment)
+{
+    gc_list_init(increment);
+    for (int i = 0; i < NUM_GENERATIONS - 1; i++) {
+        gc_list_merge(GEN_HEAD(gcstate, i), increment);
+    }
+    Py_ssize_t young_size = gc_list_size(increment);
+
+    PyGC_Head *oldest = GEN_HEAD(gcstate, NUM_GENERATIONS - 1);
+    size_t taken = 0;
+    while (taken < par_gc->incremental_slice && !gc_list_is_empty(oldest)) {
+        gc_list_move(GC_NEXT(oldest), increment);
+        taken++;
+    }
+    par_gc->incremental_progress += taken;
+    CI_DLOG("Collecting %zd young objects and an increment of %zu",
+            young_size, taken);
+    return young_size;
+}
+
+static void
+Ci_record_pause(Ci_ParGCState *par_gc, int gen, int incremental,
+                _PyTime_t pause)
+{
+    if (par_gc == NULL) {
+        return;
+    }
+    Ci_PauseKind kind = CI_PAUSE_YOUNG;
+    if (incremental) {
+        kind = CI_PAUSE_INCREMENTAL;
+    }
+    else if (gen == NUM_GENERATIONS - 1) {
+        kind = CI_PAUSE_FULL;
+    }
+    Ci_PauseHistogram *hist = &par_gc->pauses[kind];
+    _PyTime_t us = _PyTime_AsMicroseconds(pause, _PyTime_ROUND_CEILING);
+    int bucket = 0;
+    while (bucket < CI_NUM_PAUSE_BUCKETS - 1 && us >= ((_PyTime_t) 1 << bucket)) {
+        bucket++;
+    }
+    hist->count++;
+    hist->total_us += us;
+    hist->max_us = Py_MAX(hist->max_us, us);
+    hist->buckets[bucket]++;
+}
+
 static inline int
 Ci_gc_is_collecting_atomic(PyGC_Head *g)
 {
@@ -2361,9 +2532,138 @@ Cinder_GetParallelGCSettings()
     }
     Py_DECREF(min_gen);
 
+    PyObject *slice = PyLong_FromSize_t(par_gc->incremental_slice);
+    if (slice == NULL) {
+        Py_DECREF(settings);
+        return NULL;
+    }
+    if (PyDict_SetItemString(settings, "incremental_slice", slice) < 0) {
+        Py_DECREF(slice);
+        Py_DECREF(settings);
+        return NULL;
+    }
+    Py_DECREF(slice);
+
     return settings;
 }
 
+int
+Cinder_SetParallelGCIncrementalSlice(size_t slice)
+{
+    PyThreadState *tstate = _PyThreadState_GET();
+    struct _gc_runtime_state *gc_state = &tstate->interp->gc;
+
+    Ci_PyGCImpl *impl = Ci_PyGC_GetImpl(gc_state);
+    if (!Ci_is_par_gc(impl)) {
+        _PyErr_SetString(tstate, PyExc_RuntimeError, "parallel gc is not enabled");
+        return -1;
+    }
+
+    Ci_ParGCState *par_gc = (Ci_ParGCState *) impl;
+    par_gc->incremental_slice = slice;
+    par_gc->incremental_progress = 0;
+    return 0;
+}
+
+void
+Cinder_SetParallelGCCollectRequested(int requested)
+{
+    PyThreadState *tstate = _PyThreadState_GET();
+    struct _gc_runtime_state *gc_state = &tstate->interp->gc;
+
+    Ci_PyGCImpl *impl = Ci_PyGC_GetImpl(gc_state);
+    if (!Ci_is_par_gc(impl)) {
+        return;
+    }
+
+    Ci_ParGCState *par_gc = (Ci_ParGCState *) impl;
+    if (requested) {
+        par_gc->collect_requested++;
+    }
+    else if (par_gc->collect_requested > 0) {
+        // The collector may have been enabled while gc.collect() was running
+        par_gc->collect_requested--;
+    }
+}
+
+static PyObject *
+Ci_PauseHistogram_AsDict(Ci_PauseHistogram *hist)
+{
+    PyObject *buckets = PyDict_New();
+    if (buckets == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < CI_NUM_PAUSE_BUCKETS; i++) {
+        if (hist->buckets[i] == 0) {
+            continue;
+        }
+        // Keyed by the exclusive upper bound of the bucket, in microseconds
+        PyObject *bound = PyLong_FromLongLong(1LL << i);
+        if (bound == NULL) {
+            Py_DECREF(buckets);
+            return NULL;
+        }
+        PyObject *count = PyLong_FromUnsignedLong(hist->buckets[i]);
+        if (count == NULL) {
+            Py_DECREF(bound);
+            Py_DECREF(buckets);
+            return NULL;
+        }
+        int err = PyDict_SetItem(buckets, bound, count);
+        Py_DECREF(bound);
+        Py_DECREF(count);
+        if (err < 0) {
+            Py_DECREF(buckets);
+            return NULL;
+        }
+    }
+
+    return Py_BuildValue(
+        "{s:k,s:L,s:L,s:N}",
+        "count", hist->count,
+        "total_us", (long long) hist->total_us,
+        "max_us", (long long) hist->max_us,
+        "histogram", buckets);
+}
+
+PyObject *
+Cinder_GetParallelGCPauseStats()
+{
+    PyThreadState *tstate = _PyThreadState_GET();
+    struct _gc_runtime_state *gc_state = &tstate->interp->gc;
+
+    Ci_PyGCImpl *impl = Ci_PyGC_GetImpl(gc_state);
+    if (!Ci_is_par_gc(impl)) {
+        Py_RETURN_NONE;
+    }
+
+    static const char *kind_names[CI_NUM_PAUSE_KINDS] = {
+        [CI_PAUSE_YOUNG] = "young",
+        [CI_PAUSE_INCREMENTAL] = "incremental",
+        [CI_PAUSE_FULL] = "full",
+    };
+
+    Ci_ParGCState *par_gc = (Ci_ParGCState *) impl;
+    PyObject *stats = PyDict_New();
+    if (stats == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < CI_NUM_PAUSE_KINDS; i++) {
+        PyObject *hist = Ci_PauseHistogram_AsDict(&par_gc->pauses[i]);
+        if (hist == NULL) {
+            Py_DECREF(stats);
+            return NULL;
+        }
+        int err = PyDict_SetItemString(stats, kind_names[i], hist);
+        Py_DECREF(hist);
+        if (err < 0) {
+            Py_DECREF(stats);
+            return NULL;
+        }
+    }
+    return stats;
+}
+
 void
 Cinder_DisableParallelGC()
 {
@@ -25,6 +25,39 @@ PyAPI_FUNC(int) Cinder_EnableParallelGC(size_t min_gen, size_t num_threads);
  */
 PyAPI_FUNC(PyObject *) Cinder_GetParallelGCSettings(void);
 
+/*
+ * Bound the work done by collections of the two oldest generations: when
+ * slice is non-zero they examine the younger generations plus at most slice
+ * objects from the oldest one, working through it a slice at a time. Once
+ * the whole of the oldest generation has been examined this way, the next
+ * collection of it is a full one, so that garbage cycles spanning several
+ * slices are still found. Collections requested through gc.collect() are
+ * never incremental. A slice of 0 restores full collections.
+ *
+ * Each slice is still collected with the world stopped, and the full
+ * collection that ends every pass over the oldest generation is as long as
+ * it would be without slicing, so this makes long pauses rarer rather than
+ * bounding every pause.
+ *
+ * Returns 0 on success or -1 with an exception set if parallel gc is
+ * disabled.
+ */
+PyAPI_FUNC(int) Cinder_SetParallelGCIncrementalSlice(size_t slice);
+
+/*
+ * Mark collections as requested through gc.collect() until the matching call
+ * with requested == 0, so that they are never incremental. Calls nest, and
+ * do nothing when parallel gc is disabled.
+ */
+PyAPI_FUNC(void) Cinder_SetParallelGCCollectRequested(int requested);
+
+/*
+ * Returns a dictionary of pause time statistics, keyed by the kind of
+ * collection ("young", "incremental" or "full"), or None when parallel gc is
+ * disabled.
+ */
+PyAPI_FUNC(PyObject *) Cinder_GetParallelGCPauseStats(void);
+
 /*
  * Disable parallel gc.
  *
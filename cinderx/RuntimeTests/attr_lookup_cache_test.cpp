@@ -0,0 +1,103 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#include <gtest/gtest.h>
+
+#include "Python.h"
+#include "cinderx/Common/attr_lookup_cache.h"
+#include "cinderx/Common/ref.h"
+
+#include "cinderx/RuntimeTests/fixtures.h"
+#include "cinderx/RuntimeTests/testutil.h"
+
+class AttrLookupCacheTest : public RuntimeTest {
+ public:
+  void TearDown() override {
+    // Entries hold references, which must go before the interpreter does.
+    Ci_AttrLookupCache_Clear();
+    RuntimeTest::TearDown();
+  }
+
+  Ref<> getAttr(BorrowedRef<> obj, const char* name) {
+    auto py_name = Ref<>::steal(PyUnicode_InternFromString(name));
+    return Ref<>::steal(Ci_AttrLookupCache_GetAttr(obj, py_name));
+  }
+
+  Ci_AttrLookupCacheStats stats() {
+    Ci_AttrLookupCacheStats stats;
+    Ci_AttrLookupCache_GetStats(&stats);
+    return stats;
+  }
+};
+
+TEST_F(AttrLookupCacheTest, CachesInstanceAttributes) {
+  const char* src = R"(
+class C:
+  def __init__(self):
+    self.x = 1
+
+obj = C()
+)";
+  Ref<> obj = compileAndGet(src, "obj");
+  ASSERT_NE(obj.get(), nullptr);
+
+  Ci_AttrLookupCacheStats before = stats();
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(isIntEquals(getAttr(obj, "x"), 1));
+  }
+  EXPECT_EQ(stats().misses - before.misses, 1u);
+  EXPECT_EQ(stats().hits - before.hits, 2u);
+}
+
+TEST_F(AttrLookupCacheTest, DataDescriptorTakesPrecedence) {
+  const char* src = R"(
+class C:
+  @property
+  def x(self):
+    return 2
+
+obj = C()
+obj.__dict__["x"] = 1
+)";
+  Ref<> obj = compileAndGet(src, "obj");
+  ASSERT_NE(obj.get(), nullptr);
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_TRUE(isIntEquals(getAttr(obj, "x"), 2));
+  }
+}
+
+TEST_F(AttrLookupCacheTest, TypeModificationInvalidates) {
+  const char* src = R"(
+class C:
+  x = 1
+
+obj = C()
+)";
+  Ref<> obj = compileAndGet(src, "obj");
+  ASSERT_NE(obj.get(), nullptr);
+
+  Ci_AttrLookupCacheStats before = stats();
+  EXPECT_TRUE(isIntEquals(getAttr(obj, "x"), 1));
+
+  auto two = Ref<>::steal(PyLong_FromLong(2));
+  ASSERT_EQ(PyObject_SetAttrString((PyObject*)Py_TYPE(obj), "x", two), 0);
+  EXPECT_TRUE(isIntEquals(getAttr(obj, "x"), 2));
+  EXPECT_EQ(stats().misses - before.misses, 2u);
+}
+
+TEST_F(AttrLookupCacheTest, MissingAttributeRaises) {
+  const char* src = R"(
+class C:
+  pass
+
+obj = C()
+)";
+  Ref<> obj = compileAndGet(src, "obj");
+  ASSERT_NE(obj.get(), nullptr);
+
+  for (int i = 0; i < 2; i++) {
+    Ref<> res = getAttr(obj, "missing");
+    EXPECT_EQ(res.get(), nullptr);
+    ASSERT_TRUE(PyErr_ExceptionMatches(PyExc_AttributeError));
+    PyErr_Clear();
+  }
+}
@@ -261,6 +261,14 @@ TEST_F(CmdLineTest, BasicFlags) {
           []() { ASSERT_FALSE(getConfig().use_huge_pages); }),
       0);
 
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-disable-licm",
+          "PYTHONJITDISABLELICM",
+          []() {},
+          []() { ASSERT_FALSE(getConfig().hir_licm_enabled); }),
+      0);
+
   ASSERT_EQ(
       try_flag_and_envvar_effect(
           L"jit-enable-jit-list-wildcards",
@@ -0,0 +1,76 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#include <gtest/gtest.h>
+
+#include "cinderx/Jit/code_layout.h"
+#include "cinderx/Jit/containers.h"
+
+#include "cinderx/RuntimeTests/fixtures.h"
+
+using namespace jit;
+
+using CodeLayoutTest = RuntimeTest;
+
+TEST_F(CodeLayoutTest, HotCalleesFollowTheirCallers) {
+  const char* src = R"(
+def never_called():
+    return 0
+
+def leaf():
+    return 1
+
+def helper():
+    return leaf() + leaf()
+
+def main():
+    total = 0
+    for i in range(10):
+        total += helper()
+    return total
+
+main()
+)";
+  ASSERT_NO_FATAL_FAILURE(runAndProfileCode(src));
+
+  std::vector<Ref<>> funcs;
+  std::vector<BorrowedRef<>> units;
+  UnorderedMap<PyObject*, std::unique_ptr<hir::Preloader>> preloaders;
+  for (const char* name : {"never_called", "leaf", "helper", "main"}) {
+    Ref<> func = getGlobal(name);
+    ASSERT_NE(func, nullptr);
+    auto preloader = hir::Preloader::makePreloader(
+        reinterpret_cast<PyFunctionObject*>(func.get()));
+    ASSERT_NE(preloader, nullptr);
+    preloaders.emplace(func.get(), std::move(preloader));
+    units.emplace_back(func);
+    funcs.emplace_back(std::move(func));
+  }
+
+  std::vector<CodeLayoutEntry> layout =
+      planCodeLayout(units, [&](BorrowedRef<> unit) {
+        return preloaders.at(unit.get()).get();
+      });
+  ASSERT_EQ(layout.size(), 4);
+  ASSERT_EQ(units.size(), 4);
+
+  auto position = [&](const char* name) {
+    PyObject* func = getGlobal(name).get();
+    for (size_t i = 0; i < units.size(); i++) {
+      if (units[i].get() == func) {
+        return i;
+      }
+    }
+    return units.size();
+  };
+  const std::string& helper_name =
+      preloaders.at(units[position("helper")].get())->fullname();
+
+  // leaf is only called from helper, so it's placed right after it.
+  EXPECT_EQ(position("leaf"), position("helper") + 1);
+  EXPECT_EQ(layout[position("leaf")].caller, helper_name);
+  EXPECT_GT(layout[position("leaf")].hotness, 0);
+
+  // Code that never ran goes last and starts its own group.
+  EXPECT_EQ(position("never_called"), 3);
+  EXPECT_EQ(layout[3].hotness, 0);
+  EXPECT_EQ(layout[3].caller, "");
+}
@@ -25,12 +25,15 @@ class DeoptPatcherTest : public RuntimeTest {
     return std::make_unique<jit::CompiledFunction>(
         reinterpret_cast<vectorcallfunc>(entry),
         ngen.getStaticEntry(),
+        ngen.getCodeStart(),
         ngen.codeRuntime(),
+        ngen.getDeoptPatchers(),
         func_size,
         stack_size,
         spill_stack_size,
         jit::hir::Function::InlineFunctionStats{},
-        jit::hir::OpcodeCounts{});
+        jit::hir::OpcodeCounts{},
+        jit::hir::Function::OptimizationStats{});
   }
 
  protected:
@@ -106,3 +109,54 @@ def func():
   ASSERT_EQ(PyLong_AsLong(res2), 314159);
   EXPECT_TRUE(did_deopt);
 }
+
+class TrackedDeoptPatcher : public jit::DeoptPatcher {
+ public:
+  explicit TrackedDeoptPatcher(bool* destroyed) : destroyed_(destroyed) {}
+
+  ~TrackedDeoptPatcher() override {
+    *destroyed_ = true;
+  }
+
+  void init() override {}
+
+ private:
+  bool* destroyed_;
+};
+
+TEST_F(DeoptPatcherTest, FreeingCodeOnlyForgetsItsOwnPatchers) {
+  const char* pycode = R"(
+def func():
+  a = 314159
+  return a
+)";
+
+  Ref<PyFunctionObject> pyfunc(compileAndGet(pycode, "func"));
+  ASSERT_NE(pyfunc, nullptr);
+
+  jit::Runtime* jit_rt = jit::Runtime::get();
+  auto compile = [&](bool* destroyed) {
+    auto irfunc = buildHIR(pyfunc);
+    jit::hir::Instr* term = irfunc->cfg.entry_block->GetTerminator();
+    auto patcher =
+        jit_rt->allocateDeoptPatcher<TrackedDeoptPatcher>(destroyed);
+    jit::hir::DeoptPatchpoint::create(patcher)->InsertBefore(*term);
+    jit::Compiler::runPasses(*irfunc, jit::PassConfig::kDefault);
+    jit::codegen::NativeGenerator ngen(irfunc.get());
+    return generateCode(ngen);
+  };
+
+  bool destroyed1 = false;
+  bool destroyed2 = false;
+  auto jitfunc1 = compile(&destroyed1);
+  ASSERT_NE(jitfunc1, nullptr);
+  auto jitfunc2 = compile(&destroyed2);
+  ASSERT_NE(jitfunc2, nullptr);
+
+  jitfunc1.reset();
+  EXPECT_TRUE(destroyed1);
+  EXPECT_FALSE(destroyed2);
+
+  jitfunc2.reset();
+  EXPECT_TRUE(destroyed2);
+}
@@ -756,6 +756,51 @@ def test(n):
   runTest(src, args, 1, result);
 }
 
+TEST_F(DeoptStressTest, ScalarReplacedTuple) {
+  const char* src = R"(
+def test(a, b):
+  t = (a, b)
+  res = t[0] * 10 + t[1]
+  return res + t[0] * t[1]
+)";
+  auto arg1 = Ref<>::steal(PyLong_FromLong(3));
+  auto arg2 = Ref<>::steal(PyLong_FromLong(4));
+  PyObject* args[] = {arg1, arg2};
+  auto result = Ref<>::steal(PyLong_FromLong(46));
+  runTest(src, args, 2, result);
+}
+
+TEST_F(DeoptStressTest, ScalarReplacedInlinedReturn) {
+  const char* src = R"(
+def bar(n):
+  return n, n + 1
+
+def test(n):
+  t = bar(n)
+  return t[0] * t[1]
+)";
+  auto arg1 = Ref<>::steal(PyLong_FromLong(10));
+  PyObject* args[] = {arg1};
+  auto result = Ref<>::steal(PyLong_FromLong(110));
+  getMutableConfig().hir_inliner_enabled = true;
+  runTest(src, args, 1, result);
+}
+
+TEST_F(DeoptStressTest, UnboxedFloatArithmetic) {
+  const char* src = R"(
+def test(n):
+  x = 1.0
+  for i in range(n):
+    t = x * 1.5
+    x = t - 0.25
+  return x
+)";
+  auto arg1 = Ref<>::steal(PyLong_FromLong(2));
+  PyObject* args[] = {arg1};
+  auto result = Ref<>::steal(PyFloat_FromDouble(1.625));
+  runTest(src, args, 1, result);
+}
+
 using DeoptTest = RuntimeTest;
 
 TEST_F(DeoptTest, ValueKind) {
@@ -0,0 +1,150 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#include <gtest/gtest.h>
+
+#include "Python.h"
+#include "cinderx/Common/frame_arena.h"
+#include "cinderx/Common/ref.h"
+
+#include "cinderx/RuntimeTests/fixtures.h"
+#include "cinderx/RuntimeTests/testutil.h"
+
+class FrameArenaTest : public RuntimeTest {
+ public:
+  void TearDown() override {
+    Ci_FrameArena_SetEnabled(1);
+    RuntimeTest::TearDown();
+  }
+
+  PyFrameObject* newFrame(BorrowedRef<> func) {
+    auto fn = reinterpret_cast<PyFunctionObject*>(func.get());
+    return Ci_FrameArena_New(
+        PyThreadState_GET(), PyFunction_AS_FRAME_CONSTRUCTOR(fn), nullptr);
+  }
+
+  void release(PyFrameObject* f) {
+    Ci_FrameArena_Release(PyThreadState_GET(), f);
+  }
+
+  Ci_FrameArenaStats stats() {
+    Ci_FrameArenaStats stats;
+    Ci_FrameArena_GetStats(&stats);
+    return stats;
+  }
+};
+
+static PyCodeObject* codeOf(BorrowedRef<> func) {
+  return reinterpret_cast<PyCodeObject*>(PyFunction_GET_CODE(func.get()));
+}
+
+TEST_F(FrameArenaTest, ReusesReleasedFrames) {
+  const char* src = R"(
+def f(a, b):
+  return a + b
+
+def g():
+  return 1
+)";
+  Ref<> f = compileAndGet(src, "f");
+  ASSERT_NE(f.get(), nullptr);
+  Ref<> g = compileAndGet(src, "g");
+  ASSERT_NE(g.get(), nullptr);
+
+  Ci_FrameArenaStats before = stats();
+  PyFrameObject* frame = newFrame(f);
+  ASSERT_NE(frame, nullptr);
+  frame->f_localsplus[0] = PyLong_FromLong(1);
+  frame->f_localsplus[1] = PyLong_FromLong(2);
+  release(frame);
+  EXPECT_EQ(stats().retained, before.retained + 1);
+
+  // The most recently released frame is reused, with its locals cleared.
+  PyFrameObject* frame2 = newFrame(f);
+  EXPECT_EQ(frame2, frame);
+  EXPECT_EQ(stats().reuses - before.reuses, 1u);
+  EXPECT_EQ(frame2->f_code, codeOf(f));
+  EXPECT_EQ(frame2->f_localsplus[0], nullptr);
+  EXPECT_EQ(frame2->f_localsplus[1], nullptr);
+  EXPECT_EQ(frame2->f_lasti, -1);
+  EXPECT_EQ(frame2->f_state, FRAME_CREATED);
+  release(frame2);
+
+  // It can also be used for a different function whose frame fits.
+  PyFrameObject* frame3 = newFrame(g);
+  EXPECT_EQ(frame3, frame);
+  EXPECT_EQ(frame3->f_code, codeOf(g));
+  EXPECT_EQ(frame3->f_valuestack, frame3->f_localsplus);
+  EXPECT_EQ(stats().allocs - before.allocs, 3u);
+  EXPECT_EQ(stats().reuses - before.reuses, 2u);
+  release(frame3);
+}
+
+TEST_F(FrameArenaTest, RetainedFramesDropCodeAndNamespaces) {
+  const char* src = R"(
+def f():
+  pass
+)";
+  Ref<> f = compileAndGet(src, "f");
+  ASSERT_NE(f.get(), nullptr);
+  BorrowedRef<> globals = PyFunction_GET_GLOBALS(f.get());
+  Py_ssize_t code_refs = Py_REFCNT(codeOf(f));
+  Py_ssize_t globals_refs = Py_REFCNT(globals);
+
+  PyFrameObject* frame = newFrame(f);
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(Py_REFCNT(codeOf(f)), code_refs + 1);
+  EXPECT_EQ(Py_REFCNT(globals), globals_refs + 1);
+  release(frame);
+
+  // Like frames on CPython's free list, retained frames don't keep their
+  // code or namespaces alive.
+  EXPECT_EQ(frame->f_code, nullptr);
+  EXPECT_EQ(frame->f_globals, nullptr);
+  EXPECT_EQ(frame->f_builtins, nullptr);
+  EXPECT_EQ(Py_REFCNT(codeOf(f)), code_refs);
+  EXPECT_EQ(Py_REFCNT(globals), globals_refs);
+  Ci_FrameArena_Clear();
+}
+
+TEST_F(FrameArenaTest, EscapedFramesAreNotReused) {
+  const char* src = R"(
+def f():
+  pass
+)";
+  Ref<> f = compileAndGet(src, "f");
+  ASSERT_NE(f.get(), nullptr);
+
+  PyFrameObject* frame = newFrame(f);
+  ASSERT_NE(frame, nullptr);
+  auto escaped = Ref<PyFrameObject>::create(frame);
+  Ci_FrameArenaStats before = stats();
+  release(frame);
+  EXPECT_EQ(stats().escapes - before.escapes, 1u);
+  EXPECT_EQ(stats().retained, before.retained);
+  EXPECT_TRUE(_PyObject_GC_IS_TRACKED(escaped.get()));
+
+  PyFrameObject* frame2 = newFrame(f);
+  EXPECT_NE(frame2, escaped.get());
+  release(frame2);
+}
+
+TEST_F(FrameArenaTest, DisablingStopsRetaining) {
+  const char* src = R"(
+def f():
+  pass
+)";
+  Ref<> f = compileAndGet(src, "f");
+  ASSERT_NE(f.get(), nullptr);
+
+  Ci_FrameArena_SetEnabled(0);
+  Ci_FrameArena_Clear();
+  release(newFrame(f));
+  EXPECT_EQ(stats().retained, 0u);
+
+  Ci_FrameArena_SetEnabled(1);
+  release(newFrame(f));
+  EXPECT_EQ(stats().retained, 1u);
+  release(newFrame(f));
+  EXPECT_EQ(stats().retained, 1u);
+  Ci_FrameArena_Clear();
+  EXPECT_EQ(stats().retained, 0u);
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#include <gtest/gtest.h>
+
+#include "cinderx/Jit/gen_data_allocator.h"
+
+#include <vector>
+
+using namespace jit;
+
+TEST(GenDataAllocatorTest, RoundsUpToSizeClasses) {
+  EXPECT_EQ(GenDataAllocator::blockSpillWords(0), kMinGenSpillWords);
+  EXPECT_EQ(
+      GenDataAllocator::blockSpillWords(kMinGenSpillWords), kMinGenSpillWords);
+  EXPECT_EQ(GenDataAllocator::blockSpillWords(kMinGenSpillWords + 1), 128u);
+  EXPECT_EQ(GenDataAllocator::blockSpillWords(300), 384u);
+  EXPECT_EQ(GenDataAllocator::blockSpillWords(5000), 5000u);
+}
+
+TEST(GenDataAllocatorTest, ReusesFreedBlocksOfTheSameClass) {
+  GenDataAllocator allocator;
+
+  GenDataFooter* a = allocator.allocate(100);
+  EXPECT_EQ(a->spillWords, 128u);
+  allocator.free(a);
+
+  // A different request in the same class gets the same block back.
+  GenDataFooter* b = allocator.allocate(120);
+  EXPECT_EQ(b, a);
+  EXPECT_EQ(b->spillWords, 128u);
+
+  // A request in another class doesn't.
+  GenDataFooter* c = allocator.allocate(10);
+  EXPECT_NE(c, a);
+  EXPECT_EQ(c->spillWords, kMinGenSpillWords);
+
+  GenDataAllocator::Stats stats = allocator.stats();
+  ASSERT_GE(stats.size_classes.size(), 2u);
+  EXPECT_EQ(stats.size_classes[0].spill_words, kMinGenSpillWords);
+  EXPECT_EQ(stats.size_classes[0].allocs, 1u);
+  EXPECT_EQ(stats.size_classes[0].reuses, 0u);
+  EXPECT_EQ(stats.size_classes[1].spill_words, 128u);
+  EXPECT_EQ(stats.size_classes[1].allocs, 2u);
+  EXPECT_EQ(stats.size_classes[1].reuses, 1u);
+  EXPECT_EQ(stats.retained_bytes, 0u);
+
+  allocator.free(b);
+  allocator.free(c);
+}
+
+TEST(GenDataAllocatorTest, LargeBlocksAreNotRetained) {
+  GenDataAllocator allocator;
+
+  GenDataFooter* footer = allocator.allocate(5000);
+  EXPECT_EQ(footer->spillWords, 5000u);
+  allocator.free(footer);
+
+  GenDataAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(stats.large_allocs, 1u);
+  EXPECT_EQ(stats.retained_bytes, 0u);
+}
+
+TEST(GenDataAllocatorTest, RetentionIsBounded) {
+  GenDataAllocator allocator;
+
+  std::vector<GenDataFooter*> blocks;
+  for (size_t i = 0; i < 2000; i++) {
+    blocks.push_back(allocator.allocate(2048));
+  }
+  for (GenDataFooter* footer : blocks) {
+    allocator.free(footer);
+  }
+
+  GenDataAllocator::Stats stats = allocator.stats();
+  const GenDataAllocator::SizeClassStats& class_stats =
+      stats.size_classes.back();
+  EXPECT_EQ(class_stats.spill_words, 2048u);
+  EXPECT_EQ(class_stats.retained + class_stats.released, blocks.size());
+  EXPECT_GT(class_stats.released, 0u);
+  EXPECT_LE(stats.retained_bytes, GenDataAllocator::kMaxRetainedBytesPerClass);
+
+  allocator.clear();
+  EXPECT_EQ(allocator.stats().retained_bytes, 0u);
+}
@@ -362,6 +362,26 @@ TEST_F(HIRParserTest, FormatValue) {
   EXPECT_EQ(HIRPrinter{}.ToString(*func), hir_source);
 }
 
+TEST_F(HIRParserTest, RoundtripsValueVirtualObject) {
+  const char* hir_source = R"(fun test {
+  bb 0 {
+    v0 = LoadArg<0>
+    v1 = LoadArg<1>
+    v2 = CheckExc v1 {
+      FrameState {
+        NextInstrOffset 2
+        Locals<1> v0
+        Virtual v3 = Value<float><2> v0 <null>
+      }
+    }
+    Return v2
+  }
+}
+)";
+  auto func = HIRParser{}.ParseHIR(hir_source);
+  EXPECT_EQ(HIRPrinter{}.ToString(*func), hir_source);
+}
+
 TEST_F(HIRParserTest, ParsesReturnType) {
   const char* hir_source = R"(fun test {
   bb 0 {
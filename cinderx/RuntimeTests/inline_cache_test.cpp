@@ -109,3 +109,54 @@ module_meth = functools._unwrap_partial
       PyObject_RichCompareBool(cache.moduleObj(), functools_mod, Py_EQ), 1)
       << "Expected functools to be cached as an obj";
 }
+
+TEST_F(InlineCacheTest, LoadAttrCacheGrowsUntilMegamorphic) {
+  const char* src = R"(
+def make_instances(n):
+  instances = []
+  for i in range(n):
+    class C:
+      def __init__(self, value):
+        self.x = value
+    instances.append(C(i))
+  return instances
+
+instances = make_instances(8)
+)";
+  Ref<PyObject> globals(MakeGlobals());
+  ASSERT_NE(globals.get(), nullptr) << "Failed creating globals";
+
+  auto locals = Ref<>::steal(PyDict_New());
+  ASSERT_NE(locals.get(), nullptr) << "Failed creating locals";
+
+  auto st = Ref<>::steal(PyRun_String(src, Py_file_input, globals, locals));
+  ASSERT_NE(st.get(), nullptr) << "Failed executing code";
+
+  PyObject* instances = PyDict_GetItemString(locals, "instances");
+  ASSERT_NE(instances, nullptr) << "Couldn't get instances";
+  size_t max_entries = jit::getConfig().attr_cache_size;
+  ASSERT_LT(max_entries, static_cast<size_t>(PyList_GET_SIZE(instances)));
+
+  auto name = Ref<>::steal(PyUnicode_InternFromString("x"));
+  jit::LoadAttrCache cache;
+  ASSERT_EQ(cache.state(), jit::InlineCacheState::kEmpty);
+
+  // Look each instance up twice, so the second lookup hits whichever entry
+  // the first one filled.
+  for (Py_ssize_t i = 0; i < PyList_GET_SIZE(instances); i++) {
+    PyObject* obj = PyList_GET_ITEM(instances, i);
+    for (int j = 0; j < 2; j++) {
+      auto res = Ref<>::steal(jit::LoadAttrCache::invoke(&cache, obj, name));
+      ASSERT_NE(res.get(), nullptr);
+      ASSERT_EQ(PyLong_AsLong(res), i);
+    }
+
+    jit::InlineCacheState expected = jit::InlineCacheState::kMegamorphic;
+    if (i == 0) {
+      expected = jit::InlineCacheState::kMonomorphic;
+    } else if (static_cast<size_t>(i) < max_entries) {
+      expected = jit::InlineCacheState::kPolymorphic;
+    }
+    ASSERT_EQ(cache.state(), expected) << "After " << i + 1 << " types";
+  }
+}
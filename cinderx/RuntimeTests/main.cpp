@@ -122,6 +122,10 @@ int main(int argc, char* argv[]) {
       "RuntimeTests/hir_tests/inliner_elimination_static_test.txt",
       HIRTest::kCompileStatic);
   register_test("RuntimeTests/hir_tests/phi_elimination_test.txt");
+  register_test("RuntimeTests/hir_tests/global_value_numbering_test.txt");
+  register_test("RuntimeTests/hir_tests/loop_invariant_code_motion_test.txt");
+  register_test("RuntimeTests/hir_tests/scalar_replacement_test.txt");
+  register_test("RuntimeTests/hir_tests/float_unboxing_test.txt");
   register_test("RuntimeTests/hir_tests/refcount_insertion_test.txt");
   register_test(
       "RuntimeTests/hir_tests/refcount_insertion_static_test.txt",
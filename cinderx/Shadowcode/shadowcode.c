@@ -12,6 +12,7 @@
  */
 
 #include "cinderx/CachedProperties/cached_properties.h"
+#include "cinderx/Common/attr_lookup_cache.h"
 #include "cinderx/Jit/pyjit.h"
 #include "Python.h"
 #include "cinderx/Shadowcode/shadowcode.h"
@@ -683,7 +684,10 @@ _PyShadow_LoadAttrPolymorphic(_PyShadow_EvalState *state,
 
     PyObject *name = _PyShadow_GetOriginalName(state, next_instr);
 
-    if (index == -1 || type->tp_getattro != PyObject_GenericGetAttr) {
+    if (index == -1) {
+        /* The call site is megamorphic, use the cache shared by all of them */
+        return Ci_AttrLookupCache_GetAttr(owner, name);
+    } else if (type->tp_getattro != PyObject_GenericGetAttr) {
         /* This type cannot be cached in a polymorphic cache */
         goto done;
     }
@@ -2187,6 +2191,145 @@ _PyShadow_BinarySubscrWithCache(_PyShadow_EvalState *shadow,
     return res;
 }
 
+/* Number of times a quickened site can fall back to its generic op before it
+ * is no longer quickened. */
+#define QUICKEN_MAX_MISSES 8
+
+/* Index of the code unit holding the instruction before next_instr. */
+static Py_ssize_t
+quicken_site(_PyShadow_EvalState *shadow, const _Py_CODEUNIT *next_instr)
+{
+    return next_instr - *shadow->first_instr - 1;
+}
+
+static int
+can_quicken(_PyShadow_EvalState *shadow, const _Py_CODEUNIT *next_instr)
+{
+    uint8_t *misses = shadow->shadow->quicken_misses;
+    return misses == NULL ||
+           misses[quicken_site(shadow, next_instr)] < QUICKEN_MAX_MISSES;
+}
+
+void
+_PyShadow_Unquicken(_PyShadow_EvalState *shadow,
+                    const _Py_CODEUNIT *next_instr,
+                    int op,
+                    int arg)
+{
+    _PyShadowCode *code = shadow->shadow;
+    if (code->quicken_misses == NULL) {
+        /* If this fails the site just keeps re-quickening. */
+        code->quicken_misses =
+            PyMem_Calloc(code->len / sizeof(_Py_CODEUNIT), sizeof(uint8_t));
+    }
+    if (code->quicken_misses != NULL) {
+        uint8_t *misses =
+            &code->quicken_misses[quicken_site(shadow, next_instr)];
+        if (*misses < QUICKEN_MAX_MISSES) {
+            (*misses)++;
+        }
+    }
+    _PyShadow_PatchByteCode(shadow, next_instr, op, arg);
+}
+
+void
+_PyShadow_SpecializeBinaryAdd(_PyShadow_EvalState *shadow,
+                              const _Py_CODEUNIT *next_instr,
+                              PyObject *left,
+                              PyObject *right)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    int shadow_op;
+    if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+        shadow_op = BINARY_ADD_INT;
+    } else if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+        shadow_op = BINARY_ADD_FLOAT;
+    } else if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
+        shadow_op = BINARY_ADD_UNICODE;
+    } else {
+        return;
+    }
+    _PyShadow_PatchByteCode(shadow, next_instr, shadow_op, 0);
+}
+
+void
+_PyShadow_SpecializeCompareOp(_PyShadow_EvalState *shadow,
+                              const _Py_CODEUNIT *next_instr,
+                              PyObject *left,
+                              PyObject *right,
+                              int oparg)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, COMPARE_OP_INT, oparg);
+    }
+}
+
+void
+_PyShadow_SpecializeForIter(_PyShadow_EvalState *shadow,
+                            const _Py_CODEUNIT *next_instr,
+                            PyObject *iter,
+                            int oparg)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    if (Py_IS_TYPE(iter, &PyListIter_Type)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, FOR_ITER_LIST, oparg);
+    } else if (Py_IS_TYPE(iter, &PyRangeIter_Type)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, FOR_ITER_RANGE, oparg);
+    }
+}
+
+void
+_PyShadow_SpecializeStoreSubscr(_PyShadow_EvalState *shadow,
+                                const _Py_CODEUNIT *next_instr,
+                                PyObject *container,
+                                PyObject *sub)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    if (PyList_CheckExact(container) && PyLong_CheckExact(sub)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, STORE_SUBSCR_LIST, 0);
+    } else if (PyDict_CheckExact(container)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, STORE_SUBSCR_DICT, 0);
+    }
+}
+
+void
+_PyShadow_SpecializeUnpackSequence(_PyShadow_EvalState *shadow,
+                                   const _Py_CODEUNIT *next_instr,
+                                   PyObject *seq,
+                                   int oparg)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    if (PyTuple_CheckExact(seq) && PyTuple_GET_SIZE(seq) == oparg) {
+        _PyShadow_PatchByteCode(
+            shadow, next_instr, UNPACK_SEQUENCE_TUPLE, oparg);
+    }
+}
+
+void
+_PyShadow_SpecializeCallFunction(_PyShadow_EvalState *shadow,
+                                 const _Py_CODEUNIT *next_instr,
+                                 PyObject *func,
+                                 int oparg)
+{
+    if (!can_quicken(shadow, next_instr)) {
+        return;
+    }
+    if (PyFunction_Check(func)) {
+        _PyShadow_PatchByteCode(shadow, next_instr, CALL_FUNCTION_PY, oparg);
+    }
+}
+
 #ifdef INLINE_CACHE_PROFILE
 
 /* Indexed by opcode */
@@ -2566,6 +2709,8 @@ _PyShadow_InitCache(PyCodeObject *co)
     shadow->field_caches = NULL;
     shadow->field_cache_size = 0;
 
+    shadow->quicken_misses = NULL;
+
     cache_init(&shadow->l1_cache);
     cache_init(&shadow->cast_cache);
     shadow->arg_checks = NULL;
@@ -2639,6 +2784,9 @@ _PyShadowCode_Free(_PyShadowCode *shadow)
     if (shadow->field_caches != NULL) {
         PyMem_Free(shadow->field_caches);
     }
+    if (shadow->quicken_misses != NULL) {
+        PyMem_Free(shadow->quicken_misses);
+    }
     PyMem_Free(shadow);
 }
 
@@ -185,6 +185,10 @@ typedef struct _PyShadowCode {
     _FieldCache *field_caches;
     Py_ssize_t field_cache_size;
 
+    /* How many times each quickened instruction has seen operands it doesn't
+     * handle, indexed by code unit. Allocated on the first miss. */
+    uint8_t *quicken_misses;
+
     Py_ssize_t update_count;
     Py_ssize_t len;
 
@@ -398,6 +402,48 @@ PyObject *_PyShadow_BinarySubscrWithCache(_PyShadow_EvalState *shadow,
                                           PyObject *sub,
                                           int oparg);
 
+/* Quicken generic instructions based on the operands they are executing with.
+ * These only patch the instruction; the caller still performs the operation.
+ * The specialized instructions patch themselves back to the generic ones with
+ * _PyShadow_Unquicken when they see operands they don't handle. */
+void _PyShadow_SpecializeBinaryAdd(_PyShadow_EvalState *shadow,
+                                   const _Py_CODEUNIT *next_instr,
+                                   PyObject *left,
+                                   PyObject *right);
+
+void _PyShadow_SpecializeCompareOp(_PyShadow_EvalState *shadow,
+                                   const _Py_CODEUNIT *next_instr,
+                                   PyObject *left,
+                                   PyObject *right,
+                                   int oparg);
+
+void _PyShadow_SpecializeForIter(_PyShadow_EvalState *shadow,
+                                 const _Py_CODEUNIT *next_instr,
+                                 PyObject *iter,
+                                 int oparg);
+
+void _PyShadow_SpecializeStoreSubscr(_PyShadow_EvalState *shadow,
+                                     const _Py_CODEUNIT *next_instr,
+                                     PyObject *container,
+                                     PyObject *sub);
+
+void _PyShadow_SpecializeUnpackSequence(_PyShadow_EvalState *shadow,
+                                        const _Py_CODEUNIT *next_instr,
+                                        PyObject *seq,
+                                        int oparg);
+
+void _PyShadow_SpecializeCallFunction(_PyShadow_EvalState *shadow,
+                                      const _Py_CODEUNIT *next_instr,
+                                      PyObject *func,
+                                      int oparg);
+
+/* Patch a quickened instruction back to the generic op. A site that has
+ * done this QUICKEN_MAX_MISSES times is polymorphic and stays generic. */
+void _PyShadow_Unquicken(_PyShadow_EvalState *shadow,
+                         const _Py_CODEUNIT *next_instr,
+                         int op,
+                         int arg);
+
 Py_ssize_t _Py_NO_INLINE _PyShadow_FixDictOffset(PyObject *obj,
                                                  Py_ssize_t dictoffset);
 
@@ -37,6 +37,10 @@ _static_exec(PyObject *m)
         return -1;
     }
 
+    if (PyType_Ready((PyTypeObject *)&Ci_CheckedPrimitiveList_Type) < 0) {
+        return -1;
+    }
+
     if (PyType_Ready(&PyStaticArray_Type) < 0 ||
         PyModule_AddObjectRef(m, "staticarray", (PyObject*)&PyStaticArray_Type)) {
         return -1;
@@ -88,6 +92,8 @@ _static_exec(PyObject *m)
     SET_TYPE_CODE(SEQ_REPEAT_PRIMITIVE_NUM)
 
     SET_TYPE_CODE(SEQ_CHECKED_LIST)
+    SET_TYPE_CODE(SEQ_CHECKED_LIST_INT64)
+    SET_TYPE_CODE(SEQ_CHECKED_LIST_DOUBLE)
 
     SET_TYPE_CODE(PRIM_OP_EQ_INT)
     SET_TYPE_CODE(PRIM_OP_NE_INT)
@@ -184,6 +190,13 @@ PyObject *is_type_static(PyObject *mod, PyObject *type) {
   Py_RETURN_FALSE;
 }
 
+PyObject *is_value_class(PyObject *mod, PyObject *type) {
+  if (PyType_Check(type) && _PyClassLoader_IsValueClass((PyTypeObject *)type)) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+}
+
 PyObject *set_type_static(PyObject *mod, PyObject *type) {
   if (!PyType_Check(type)) {
     PyErr_Format(PyExc_TypeError, "Expected a type object, not %.100s",
@@ -1433,6 +1446,9 @@ _static___build_cinder_class__(PyObject *self, PyObject *const *args, Py_ssize_t
     if (PyTuple_GET_SIZE(cached_properties) && init_cached_properties(pytype, cached_properties) < 0) {
         goto error;
     }
+    if (final && !leaked_type && _PyClassLoader_InitValueClass(pytype) < 0) {
+        goto error;
+    }
     // If we were subtyping a class which was known statically then the v-table will be eagerly
     // initialized before we completed the static initialization of the type.  In that case we
     // cleared out the cache earlier, and now we want to make sure we have the v-table in place
@@ -1548,6 +1564,7 @@ static PyMethodDef static_methods[] = {
     {"set_type_code", (PyCFunction)(void(*)(void))set_type_code, METH_FASTCALL, ""},
     {"rand", (PyCFunction)&static_rand_def, Ci_METH_TYPED, ""},
     {"is_type_static", (PyCFunction)(void(*)(void))is_type_static, METH_O, ""},
+    {"is_value_class", (PyCFunction)(void(*)(void))is_value_class, METH_O, ""},
     {"set_type_static", (PyCFunction)(void(*)(void))set_type_static, METH_O, ""},
     {"set_type_static_final", (PyCFunction)(void(*)(void))set_type_static_final, METH_O, ""},
     {"set_type_final", (PyCFunction)(void(*)(void))set_type_final, METH_O, ""},
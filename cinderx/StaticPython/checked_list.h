@@ -29,6 +29,24 @@ CiAPI_DATA(int) Ci_ListOrCheckedList_Append(PyListObject *self, PyObject *v);
 #define Ci_ListOrCheckedList_SET_ITEM(op, i, v) ((void)(((PyListObject *)(op))->ob_item[i] = (v)))
 #define Ci_ListOrCheckedList_GET_SIZE(op)    Py_SIZE((PyListObject *)(op))
 
+/* chklist[int64] and chklist[double] store their elements unboxed. */
+typedef struct {
+    PyObject_VAR_HEAD
+    /* The raw bits of the Py_SIZE(self) elements */
+    uint64_t *ob_item;
+    Py_ssize_t allocated;
+} Ci_CheckedPrimitiveListObject;
+
+CiAPI_DATA(_PyGenericTypeDef) Ci_CheckedPrimitiveList_Type;
+CiAPI_FUNC(PyObject *) Ci_CheckedPrimitiveList_New(PyTypeObject *type, Py_ssize_t);
+/* Returns a new reference to the boxed element, or NULL if i is out of
+ * range. */
+CiAPI_FUNC(PyObject *) Ci_CheckedPrimitiveList_GetItem(PyObject *self, Py_ssize_t i);
+/* Unboxes value into the list; does not steal a reference to it. */
+CiAPI_FUNC(int) Ci_CheckedPrimitiveList_SetItem(PyObject *self, Py_ssize_t i, PyObject *value);
+/* Whether chklist[type] is instantiated as a Ci_CheckedPrimitiveList_Type. */
+CiAPI_FUNC(int) Ci_CheckedPrimitiveList_IsElementType(PyObject *type);
+
 #ifdef __cplusplus
 }
 #endif
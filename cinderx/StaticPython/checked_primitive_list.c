@@ -0,0 +1,628 @@
+/* Copyright (c) Meta Platforms, Inc. and affiliates. */
+#include "Python.h"
+
+#include "cinderx/StaticPython/checked_list.h"
+#include "cinderx/StaticPython/classloader.h"
+
+/***********************************************************************
+ * chklist[int64] and chklist[double] - checked lists whose elements are
+ * stored unboxed in a contiguous buffer.  Statically typed code reads and
+ * writes the buffer directly through SEQUENCE_GET/SEQUENCE_SET; untyped
+ * code sees boxed values, which are created on access.
+ *
+ * Both element types are 8 bytes wide, so the buffer holds the raw bits of
+ * each value and the element type is only consulted when boxing and
+ * unboxing. */
+
+#define CHKPRIMLIST(op) ((Ci_CheckedPrimitiveListObject *)(op))
+
+static inline int
+chkprimlist_typecode(PyObject *self)
+{
+    _PyGenericTypeInst *inst = (_PyGenericTypeInst *)Py_TYPE(self);
+    return _PyClassLoader_GetTypeCode(inst->gti_inst[0].gtp_type);
+}
+
+static inline PyObject *
+chkprimlist_box(PyObject *self, Py_ssize_t i)
+{
+    return _PyClassLoader_Box(CHKPRIMLIST(self)->ob_item[i],
+                              chkprimlist_typecode(self));
+}
+
+/* Unbox value into *out, raising TypeError if it isn't of the list's
+ * element type. */
+static int
+chkprimlist_unbox(PyObject *self, PyObject *value, uint64_t *out)
+{
+    if (chkprimlist_typecode(self) == TYPED_DOUBLE) {
+        if (!PyFloat_Check(value)) {
+            goto bad_value;
+        }
+        double d = PyFloat_AS_DOUBLE(value);
+        memcpy(out, &d, sizeof(double));
+        return 0;
+    }
+
+    if (!PyLong_Check(value)) {
+        goto bad_value;
+    }
+    int overflow;
+    long long i = PyLong_AsLongLongAndOverflow(value, &overflow);
+    if (overflow) {
+        PyErr_SetString(PyExc_OverflowError, "int overflow");
+        return -1;
+    } else if (i == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    *out = (uint64_t)i;
+    return 0;
+
+bad_value:
+    PyErr_Format(PyExc_TypeError,
+                 "bad value '%s' for %s",
+                 Py_TYPE(value)->tp_name,
+                 Py_TYPE(self)->tp_name);
+    return -1;
+}
+
+/* Same growth pattern as list_resize(). */
+static int
+chkprimlist_resize(Ci_CheckedPrimitiveListObject *self, Py_ssize_t newsize)
+{
+    Py_ssize_t allocated = self->allocated;
+    if (allocated >= newsize && newsize >= (allocated >> 1)) {
+        assert(self->ob_item != NULL || newsize == 0);
+        Py_SET_SIZE(self, newsize);
+        return 0;
+    }
+
+    size_t new_allocated =
+        ((size_t)newsize + (newsize >> 3) + 6) & ~(size_t)3;
+    if (newsize - Py_SIZE(self) > (Py_ssize_t)(new_allocated - newsize)) {
+        new_allocated = ((size_t)newsize + 3) & ~(size_t)3;
+    }
+    if (newsize == 0) {
+        new_allocated = 0;
+    }
+    if (new_allocated > (size_t)PY_SSIZE_T_MAX / sizeof(uint64_t)) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    uint64_t *items =
+        PyMem_Realloc(self->ob_item, new_allocated * sizeof(uint64_t));
+    if (items == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->ob_item = items;
+    Py_SET_SIZE(self, newsize);
+    self->allocated = new_allocated;
+    return 0;
+}
+
+PyObject *
+Ci_CheckedPrimitiveList_New(PyTypeObject *type, Py_ssize_t size)
+{
+    Ci_CheckedPrimitiveListObject *op =
+        (Ci_CheckedPrimitiveListObject *)type->tp_alloc(type, 0);
+    if (op == NULL || size == 0) {
+        return (PyObject *)op;
+    }
+    op->ob_item = PyMem_Calloc(size, sizeof(uint64_t));
+    if (op->ob_item == NULL) {
+        Py_DECREF(op);
+        return PyErr_NoMemory();
+    }
+    op->allocated = size;
+    Py_SET_SIZE(op, size);
+    return (PyObject *)op;
+}
+
+int
+Ci_CheckedPrimitiveList_IsElementType(PyObject *type)
+{
+    if (!PyType_Check(type)) {
+        return 0;
+    }
+    int typecode = _PyClassLoader_GetTypeCode((PyTypeObject *)type);
+    return typecode == TYPED_INT64 || typecode == TYPED_DOUBLE;
+}
+
+static void
+chkprimlist_dealloc(PyObject *self)
+{
+    PyMem_Free(CHKPRIMLIST(self)->ob_item);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static Py_ssize_t
+chkprimlist_length(PyObject *self)
+{
+    return Py_SIZE(self);
+}
+
+static PyObject *
+chkprimlist_item(PyObject *self, Py_ssize_t i)
+{
+    if ((size_t)i >= (size_t)Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return NULL;
+    }
+    return chkprimlist_box(self, i);
+}
+
+static int
+chkprimlist_ass_item(PyObject *self, Py_ssize_t i, PyObject *value)
+{
+    if ((size_t)i >= (size_t)Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError,
+                        "list assignment index out of range");
+        return -1;
+    }
+    Ci_CheckedPrimitiveListObject *list = CHKPRIMLIST(self);
+    if (value == NULL) {
+        memmove(&list->ob_item[i],
+                &list->ob_item[i + 1],
+                (Py_SIZE(self) - i - 1) * sizeof(uint64_t));
+        return chkprimlist_resize(list, Py_SIZE(self) - 1);
+    }
+    return chkprimlist_unbox(self, value, &list->ob_item[i]);
+}
+
+PyObject *
+Ci_CheckedPrimitiveList_GetItem(PyObject *self, Py_ssize_t i)
+{
+    return chkprimlist_item(self, i);
+}
+
+int
+Ci_CheckedPrimitiveList_SetItem(PyObject *self, Py_ssize_t i, PyObject *value)
+{
+    return chkprimlist_ass_item(self, i, value);
+}
+
+static PyObject *
+chkprimlist_subscript(PyObject *self, PyObject *item)
+{
+    if (PyIndex_Check(item)) {
+        Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (i < 0) {
+            i += Py_SIZE(self);
+        }
+        return chkprimlist_item(self, i);
+    } else if (PySlice_Check(item)) {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(item, &start, &stop, &step) < 0) {
+            return NULL;
+        }
+        Py_ssize_t len =
+            PySlice_AdjustIndices(Py_SIZE(self), &start, &stop, step);
+        PyObject *res = Ci_CheckedPrimitiveList_New(Py_TYPE(self), len);
+        if (res == NULL) {
+            return NULL;
+        }
+        uint64_t *src = CHKPRIMLIST(self)->ob_item;
+        uint64_t *dest = CHKPRIMLIST(res)->ob_item;
+        for (Py_ssize_t i = 0, cur = start; i < len; i++, cur += step) {
+            dest[i] = src[cur];
+        }
+        return res;
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "list indices must be integers or slices, not %.200s",
+                 Py_TYPE(item)->tp_name);
+    return NULL;
+}
+
+/* Remove the slicelength elements selected by start and step. */
+static int
+chkprimlist_del_slice(Ci_CheckedPrimitiveListObject *self,
+                      Py_ssize_t start,
+                      Py_ssize_t step,
+                      Py_ssize_t slicelength)
+{
+    if (slicelength <= 0) {
+        return 0;
+    }
+    if (step < 0) {
+        start += step * (slicelength - 1);
+        step = -step;
+    }
+    /* Shift the elements between the removed ones down, then the tail. */
+    Py_ssize_t dest = start;
+    for (Py_ssize_t i = 0; i < slicelength; i++) {
+        Py_ssize_t from = start + i * step + 1;
+        Py_ssize_t to =
+            i + 1 < slicelength ? start + (i + 1) * step : Py_SIZE(self);
+        memmove(&self->ob_item[dest],
+                &self->ob_item[from],
+                (to - from) * sizeof(uint64_t));
+        dest += to - from;
+    }
+    return chkprimlist_resize(self, Py_SIZE(self) - slicelength);
+}
+
+/* Unbox all of the elements of value into a new buffer, which the caller
+ * must free with PyMem_Free. Returns -1 on error. */
+static Py_ssize_t
+chkprimlist_unbox_all(PyObject *self, PyObject *value, uint64_t **out)
+{
+    if (Py_TYPE(value) == Py_TYPE(self)) {
+        Py_ssize_t n = Py_SIZE(value);
+        *out = PyMem_Malloc(n > 0 ? n * sizeof(uint64_t) : 1);
+        if (*out == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memcpy(*out, CHKPRIMLIST(value)->ob_item, n * sizeof(uint64_t));
+        return n;
+    }
+
+    PyObject *seq = PySequence_Fast(value, "can only assign an iterable");
+    if (seq == NULL) {
+        return -1;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    *out = PyMem_Malloc(n > 0 ? n * sizeof(uint64_t) : 1);
+    if (*out == NULL) {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+    PyObject **items = PySequence_Fast_ITEMS(seq);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (chkprimlist_unbox(self, items[i], &(*out)[i]) < 0) {
+            PyMem_Free(*out);
+            Py_DECREF(seq);
+            return -1;
+        }
+    }
+    Py_DECREF(seq);
+    return n;
+}
+
+static int
+chkprimlist_ass_slice(PyObject *self, PyObject *item, PyObject *value)
+{
+    Ci_CheckedPrimitiveListObject *list = CHKPRIMLIST(self);
+    Py_ssize_t start, stop, step;
+    if (PySlice_Unpack(item, &start, &stop, &step) < 0) {
+        return -1;
+    }
+    Py_ssize_t slicelength =
+        PySlice_AdjustIndices(Py_SIZE(self), &start, &stop, step);
+    if (value == NULL) {
+        return chkprimlist_del_slice(list, start, step, slicelength);
+    }
+
+    /* Unbox everything up front so a bad value leaves the list unchanged.
+     * This also copies value when it is the list itself. */
+    uint64_t *values;
+    Py_ssize_t n = chkprimlist_unbox_all(self, value, &values);
+    if (n < 0) {
+        return -1;
+    }
+
+    int res = 0;
+    if (step == 1) {
+        if (slicelength < 0) {
+            slicelength = 0;
+        }
+        Py_ssize_t old_size = Py_SIZE(self);
+        Py_ssize_t tail = old_size - start - slicelength;
+        Py_ssize_t new_size = old_size - slicelength + n;
+        if (n > slicelength && chkprimlist_resize(list, new_size) < 0) {
+            res = -1;
+            goto done;
+        }
+        memmove(&list->ob_item[start + n],
+                &list->ob_item[start + slicelength],
+                tail * sizeof(uint64_t));
+        if (n < slicelength && chkprimlist_resize(list, new_size) < 0) {
+            res = -1;
+            goto done;
+        }
+        memcpy(&list->ob_item[start], values, n * sizeof(uint64_t));
+    } else if (n != slicelength) {
+        PyErr_Format(PyExc_ValueError,
+                     "attempt to assign sequence of size %zd "
+                     "to extended slice of size %zd",
+                     n,
+                     slicelength);
+        res = -1;
+    } else {
+        for (Py_ssize_t i = 0, cur = start; i < n; i++, cur += step) {
+            list->ob_item[cur] = values[i];
+        }
+    }
+
+done:
+    PyMem_Free(values);
+    return res;
+}
+
+static int
+chkprimlist_ass_subscript(PyObject *self, PyObject *item, PyObject *value)
+{
+    if (PyIndex_Check(item)) {
+        Py_ssize_t i = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        if (i < 0) {
+            i += Py_SIZE(self);
+        }
+        return chkprimlist_ass_item(self, i, value);
+    } else if (PySlice_Check(item)) {
+        return chkprimlist_ass_slice(self, item, value);
+    }
+    PyErr_Format(PyExc_TypeError,
+                 "%s indices must be integers or slices, not %.200s",
+                 Py_TYPE(self)->tp_name,
+                 Py_TYPE(item)->tp_name);
+    return -1;
+}
+
+static int
+chkprimlist_append_unboxed(Ci_CheckedPrimitiveListObject *self, uint64_t value)
+{
+    Py_ssize_t n = Py_SIZE(self);
+    if (n == PY_SSIZE_T_MAX) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "cannot add more objects to list");
+        return -1;
+    }
+    if (chkprimlist_resize(self, n + 1) < 0) {
+        return -1;
+    }
+    self->ob_item[n] = value;
+    return 0;
+}
+
+static PyObject *
+chkprimlist_append(PyObject *self, PyObject *value)
+{
+    uint64_t unboxed;
+    if (chkprimlist_unbox(self, value, &unboxed) < 0 ||
+        chkprimlist_append_unboxed(CHKPRIMLIST(self), unboxed) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static int
+chkprimlist_extend_impl(PyObject *self, PyObject *iterable)
+{
+    Ci_CheckedPrimitiveListObject *list = CHKPRIMLIST(self);
+    if (Py_TYPE(iterable) == Py_TYPE(self)) {
+        /* Same element type, so the values can be copied as is. This also
+         * covers extending a list with itself. */
+        Py_ssize_t m = Py_SIZE(self);
+        Py_ssize_t n = Py_SIZE(iterable);
+        if (n == 0) {
+            return 0;
+        }
+        if (m > PY_SSIZE_T_MAX - n) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        if (chkprimlist_resize(list, m + n) < 0) {
+            return -1;
+        }
+        memmove(&list->ob_item[m],
+                CHKPRIMLIST(iterable)->ob_item,
+                n * sizeof(uint64_t));
+        return 0;
+    }
+
+    PyObject *it = PyObject_GetIter(iterable);
+    if (it == NULL) {
+        return -1;
+    }
+    PyObject *item;
+    while ((item = PyIter_Next(it)) != NULL) {
+        uint64_t unboxed;
+        int err = chkprimlist_unbox(self, item, &unboxed);
+        Py_DECREF(item);
+        if (err < 0 || chkprimlist_append_unboxed(list, unboxed) < 0) {
+            Py_DECREF(it);
+            return -1;
+        }
+    }
+    Py_DECREF(it);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject *
+chkprimlist_extend(PyObject *self, PyObject *iterable)
+{
+    if (chkprimlist_extend_impl(self, iterable) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chkprimlist_pop(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (!_PyArg_CheckPositional("pop", nargs, 0, 1)) {
+        return NULL;
+    }
+    Py_ssize_t i = -1;
+    if (nargs == 1) {
+        i = PyNumber_AsSsize_t(args[0], PyExc_IndexError);
+        if (i == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+    if (Py_SIZE(self) == 0) {
+        PyErr_SetString(PyExc_IndexError, "pop from empty list");
+        return NULL;
+    }
+    if (i < 0) {
+        i += Py_SIZE(self);
+    }
+    PyObject *res = chkprimlist_item(self, i);
+    if (res == NULL) {
+        return NULL;
+    }
+    if (chkprimlist_ass_item(self, i, NULL) < 0) {
+        Py_DECREF(res);
+        return NULL;
+    }
+    return res;
+}
+
+static PyObject *
+chkprimlist_clear(PyObject *self, PyObject *Py_UNUSED(ignored))
+{
+    Ci_CheckedPrimitiveListObject *list = CHKPRIMLIST(self);
+    PyMem_Free(list->ob_item);
+    list->ob_item = NULL;
+    list->allocated = 0;
+    Py_SET_SIZE(list, 0);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chkprimlist_copy(PyObject *self, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *res = Ci_CheckedPrimitiveList_New(Py_TYPE(self), Py_SIZE(self));
+    if (res != NULL && Py_SIZE(self) > 0) {
+        memcpy(CHKPRIMLIST(res)->ob_item,
+               CHKPRIMLIST(self)->ob_item,
+               Py_SIZE(self) * sizeof(uint64_t));
+    }
+    return res;
+}
+
+/* Box all of the elements into a new list. */
+static PyObject *
+chkprimlist_to_list(PyObject *self)
+{
+    PyObject *list = PyList_New(Py_SIZE(self));
+    if (list == NULL) {
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++) {
+        PyObject *item = chkprimlist_box(self, i);
+        if (item == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static PyObject *
+chkprimlist_repr(PyObject *self)
+{
+    PyObject *list = chkprimlist_to_list(self);
+    if (list == NULL) {
+        return NULL;
+    }
+    PyObject *res = PyObject_Repr(list);
+    Py_DECREF(list);
+    return res;
+}
+
+static PyObject *
+chkprimlist_richcompare(PyObject *self, PyObject *other, int op)
+{
+    if (Py_TYPE(other) != Py_TYPE(self)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    PyObject *left = chkprimlist_to_list(self);
+    if (left == NULL) {
+        return NULL;
+    }
+    PyObject *right = chkprimlist_to_list(other);
+    if (right == NULL) {
+        Py_DECREF(left);
+        return NULL;
+    }
+    PyObject *res = PyObject_RichCompare(left, right, op);
+    Py_DECREF(left);
+    Py_DECREF(right);
+    return res;
+}
+
+PyDoc_STRVAR(chkprimlist___init____doc__,
+"chklist[T](iterable=(), /)\n"
+"--\n"
+"\n"
+"Mutable sequence of int64 or double values, stored unboxed.\n"
+"\n"
+"If no argument is given, the constructor creates a new empty list.\n"
+"The argument must be an iterable if specified.");
+
+static int
+chkprimlist_init(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    if (!_PyArg_NoKeywords("chklist", kwds) ||
+        !_PyArg_CheckPositional("chklist", PyTuple_GET_SIZE(args), 0, 1)) {
+        return -1;
+    }
+    chkprimlist_clear(self, NULL);
+    if (PyTuple_GET_SIZE(args) == 1) {
+        return chkprimlist_extend_impl(self, PyTuple_GET_ITEM(args, 0));
+    }
+    return 0;
+}
+
+static PySequenceMethods chkprimlist_as_sequence = {
+    .sq_length = chkprimlist_length,
+    .sq_item = chkprimlist_item,
+    .sq_ass_item = chkprimlist_ass_item,
+};
+
+static PyMappingMethods chkprimlist_as_mapping = {
+    .mp_length = chkprimlist_length,
+    .mp_subscript = chkprimlist_subscript,
+    .mp_ass_subscript = chkprimlist_ass_subscript,
+};
+
+static PyMethodDef chkprimlist_methods[] = {
+    {"append", chkprimlist_append, METH_O,
+     "Append object to the end of the list."},
+    {"extend", chkprimlist_extend, METH_O,
+     "Extend list by appending elements from the iterable."},
+    {"pop", (PyCFunction)(void (*)(void))chkprimlist_pop, METH_FASTCALL,
+     "Remove and return item at index (default last)."},
+    {"clear", chkprimlist_clear, METH_NOARGS, "Remove all items from list."},
+    {"copy", chkprimlist_copy, METH_NOARGS,
+     "Return a shallow copy of the list."},
+    {NULL, NULL} /* sentinel */
+};
+
+/* Instantiated in place of Ci_CheckedList_Type when the element type is
+ * int64 or double, see _PyClassLoader_GetGenericInst(). */
+_PyGenericTypeDef Ci_CheckedPrimitiveList_Type = {
+  .gtd_type =
+      {
+        PyVarObject_HEAD_INIT(&PyType_Type, 0)
+        .tp_name = "chklist[T]",
+        .tp_basicsize = sizeof(Ci_CheckedPrimitiveListObject),
+        .tp_dealloc = chkprimlist_dealloc,
+        .tp_repr = chkprimlist_repr,
+        .tp_as_sequence = &chkprimlist_as_sequence,
+        .tp_as_mapping = &chkprimlist_as_mapping,
+        .tp_hash = PyObject_HashNotImplemented,
+        .tp_getattro = PyObject_GenericGetAttr,
+        .tp_flags = Py_TPFLAGS_DEFAULT | Ci_Py_TPFLAGS_GENERIC_TYPE_DEF,
+        .tp_doc = chkprimlist___init____doc__,
+        .tp_richcompare = chkprimlist_richcompare,
+        .tp_methods = chkprimlist_methods,
+        .tp_init = chkprimlist_init,
+        .tp_alloc = PyType_GenericAlloc,
+        .tp_new = NULL,
+        .tp_free = PyObject_Del,
+      },
+  .gtd_size = 1,
+  .gtd_new = NULL,
+};
@@ -15,6 +15,7 @@
 #include "cinderx/CachedProperties/cached_properties.h"
 #include "cinderx/Interpreter/opcode.h"
 #include "cinderx/Jit/pyjit.h"
+#include "cinderx/StaticPython/checked_list.h"
 #include "cinderx/StaticPython/classloader.h"
 #include "cinderx/StaticPython/strictmoduleobject.h"
 
@@ -47,6 +48,11 @@ vtabledealloc(_PyType_VTable *op)
     for (Py_ssize_t i = 0; i < op->vt_size; i++) {
         Py_XDECREF(op->vt_entries[i].vte_state);
     }
+    while (op->vt_freelist != NULL) {
+        void *next = *(void **)op->vt_freelist;
+        PyObject_Free(op->vt_freelist);
+        op->vt_freelist = next;
+    }
     PyObject_GC_Del((PyObject *)op);
 }
 
@@ -3702,6 +3708,8 @@ _PyClassLoader_EnsureVtable(PyTypeObject *self, int init_subclasses)
     vtable->vt_specials = NULL;
     vtable->vt_slotmap = slotmap;
     vtable->vt_typecode = TYPED_OBJECT;
+    vtable->vt_freelist = NULL;
+    vtable->vt_freelist_size = 0;
     self->tp_cache = (PyObject *)vtable;
     memset(&vtable->vt_entries[0], 0, sizeof(_PyType_VTableEntry) * slot_count);
 
@@ -3766,6 +3774,67 @@ _PyClassLoader_ClearVtables()
     return clear_vtables_recurse(&PyBaseObject_Type);
 }
 
+/* The most freed instances of a value class kept for reuse */
+#define VALUE_CLASS_FREELIST_MAX 256
+
+int
+_PyClassLoader_InitValueClass(PyTypeObject *type)
+{
+    /* The GC flag was already dropped when the slots were laid out if none
+     * of them need it, and a final class can't be given a __dict__ or
+     * __weakref__ by a subclass. */
+    if (type->tp_flags & (Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC) ||
+        !(type->tp_flags & Ci_Py_TPFLAGS_IS_STATICALLY_DEFINED) ||
+        type->tp_itemsize != 0 ||
+        type->tp_alloc != PyType_GenericAlloc ||
+        type->tp_free != PyObject_Free) {
+        return 0;
+    }
+    if (_PyClassLoader_EnsureVtable(type, 0) == NULL) {
+        return -1;
+    }
+    type->tp_alloc = _PyClassLoader_ValueClassAlloc;
+    type->tp_free = _PyClassLoader_ValueClassFree;
+    return 0;
+}
+
+int
+_PyClassLoader_IsValueClass(PyTypeObject *type)
+{
+    return type->tp_alloc == _PyClassLoader_ValueClassAlloc;
+}
+
+PyObject *
+_PyClassLoader_ValueClassAlloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    assert(nitems == 0);
+    /* The v-table may have been cleared since the type was created, in which
+     * case we just don't reuse instances until it's rebuilt. */
+    _PyType_VTable *vtable = (_PyType_VTable *)type->tp_cache;
+    if (vtable == NULL || vtable->vt_freelist == NULL) {
+        return PyType_GenericAlloc(type, nitems);
+    }
+    PyObject *obj = (PyObject *)vtable->vt_freelist;
+    vtable->vt_freelist = *(void **)obj;
+    vtable->vt_freelist_size--;
+
+    memset(obj, 0, type->tp_basicsize);
+    return PyObject_Init(obj, type);
+}
+
+void
+_PyClassLoader_ValueClassFree(void *obj)
+{
+    _PyType_VTable *vtable = (_PyType_VTable *)Py_TYPE((PyObject *)obj)->tp_cache;
+    if (vtable == NULL || vtable->vt_freelist_size >= VALUE_CLASS_FREELIST_MAX) {
+        PyObject_Free(obj);
+        return;
+    }
+    *(void **)obj = vtable->vt_freelist;
+    vtable->vt_freelist = obj;
+    vtable->vt_freelist_size++;
+}
+
 PyObject *_PyClassLoader_GetGenericInst(PyObject *type,
                                         PyObject **args,
                                         Py_ssize_t nargs);
@@ -4379,6 +4448,10 @@ _PyClassLoader_ResolveMethodDef(PyObject *path)
 int
 _PyClassLoader_AddSubclass(PyTypeObject *base, PyTypeObject *type)
 {
+    /* Let the JIT invalidate INVOKE_METHOD calls it devirtualized based on
+     * base's hierarchy. */
+    _PyJIT_TypeSubclassed(base, type);
+
     if (base->tp_cache == NULL) {
         /* nop if base class vtable isn't initialized */
         return 0;
@@ -5202,7 +5275,15 @@ _PyClassLoader_GetGenericInst(PyObject *type,
             Py_DECREF(key);
             return NULL;
         }
-        res = gtd_new_inst(type, args, nargs);
+        if (type == (PyObject *)&Ci_CheckedList_Type &&
+            Ci_CheckedPrimitiveList_IsElementType(args[0])) {
+            /* Lists of primitives keep their elements unboxed, but are
+             * still cached under, and named after, chklist. */
+            res = gtd_new_inst(
+                (PyObject *)&Ci_CheckedPrimitiveList_Type, args, nargs);
+        } else {
+            res = gtd_new_inst(type, args, nargs);
+        }
     } else {
         if (nargs == 1) {
             res = PyObject_GetItem(type, args[0]);
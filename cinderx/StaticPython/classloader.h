@@ -45,6 +45,10 @@ typedef struct {
     /* Size of the vtable */
     Py_ssize_t vt_size;
     int vt_typecode;
+    /* Freed instances of a value class kept for reuse, linked through their
+       first word (see _PyClassLoader_InitValueClass) */
+    void *vt_freelist;
+    Py_ssize_t vt_freelist_size;
     _PyType_VTableEntry vt_entries[1];
 } _PyType_VTable;
 
@@ -163,6 +167,19 @@ CiAPI_FUNC(void) _PyClassLoader_ClearGenericTypes(void);
 CiAPI_FUNC(int)
 _PyClassLoader_IsPatchedThunk(PyObject *obj);
 
+/* Value classes are final static classes whose instances the cycle GC never
+ * needs to see, because every field is a primitive or a reference to an
+ * instance of another such type.  They're allocated from a freelist kept in
+ * their v-table, and the JIT may scalar replace instances which don't escape.
+ *
+ * Turns type into a value class if it qualifies, which must happen before any
+ * instances are created.  Returns -1 with an error set on failure.
+ */
+CiAPI_FUNC(int) _PyClassLoader_InitValueClass(PyTypeObject *type);
+CiAPI_FUNC(int) _PyClassLoader_IsValueClass(PyTypeObject *type);
+CiAPI_FUNC(PyObject *) _PyClassLoader_ValueClassAlloc(PyTypeObject *type, Py_ssize_t nitems);
+CiAPI_FUNC(void) _PyClassLoader_ValueClassFree(void *obj);
+
 
 /* Gets an indirect pointer for a function.  This should be used if
 * the given container is mutable, and the indirect pointer will
@@ -314,6 +331,9 @@ CiAPI_FUNC(int) _PyClassLoader_IsFinalMethodOverridden(PyTypeObject *base_type,
     SEQ_REPEAT_PRIMITIVE_NUM   \
 )
 #define SEQ_CHECKED_LIST (1 << 8)
+// chklist[int64] and chklist[double], whose elements are stored unboxed
+#define SEQ_CHECKED_LIST_INT64 (SEQ_CHECKED_LIST | (1 << 9))
+#define SEQ_CHECKED_LIST_DOUBLE (SEQ_CHECKED_LIST | (2 << 9))
 
 #define _Py_IS_TYPED_ARRAY(x) (x & TYPED_ARRAY)
 #define _Py_IS_TYPED_ARRAY_SIGNED(x) (x & (TYPED_INT_SIGNED << 4))
@@ -9,6 +9,9 @@
 #include "cinderx/StrictModules/parser_util.h"
 #include "cinderx/StrictModules/symbol_table.h"
 
+#include <fmt/format.h>
+
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <optional>
@@ -211,6 +214,8 @@ void ModuleLoader::deleteModule(const std::string& modName) {
     deletedModules_.emplace(std::move(exist->second));
     modules_.erase(exist);
   }
+  cachedModules_.erase(modName);
+  dependencyClosures_.erase(modName);
 }
 
 std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
@@ -219,6 +224,7 @@ std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
 }
 std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
     const std::string& modName) {
+  recordDependency(modName);
   AnalyzedModule* mod = loadModule(modName);
   if (mod) {
     return mod->getModuleValue();
@@ -226,6 +232,16 @@ std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
   return nullptr;
 }
 
+std::shared_ptr<StrictModuleObject> ModuleLoader::loadAnalyzedModuleValue(
+    const std::string& modName) {
+  if (cachedModules_.count(modName) != 0) {
+    log("Reanalyzing cached module for its value: %s", modName.c_str());
+    valueNeeded_.insert(modName);
+    deleteModule(modName);
+  }
+  return loadModuleValue(modName);
+}
+
 void ModuleLoader::recordLazyModule(const std::string& modName) {
   lazy_modules_.emplace(modName);
 }
@@ -234,6 +250,7 @@ std::shared_ptr<StrictModuleObject> ModuleLoader::tryGetModuleValue(
     const std::string& modName) {
   auto exist = modules_.find(modName);
   if (exist != modules_.end() && exist->second) {
+    recordDependency(modName);
     return exist->second->getModuleValue();
   } else {
     auto it = lazy_modules_.find(modName);
@@ -338,6 +355,7 @@ bool ModuleLoader::setAllowListRegex(std::vector<std::string> allowList) {
   for (const std::string& regex : allowList) {
     try {
       allowListRegexes_.emplace_back(regex);
+      allowListRegexSources_.push_back(regex);
     } catch (const std::regex_error&) {
       return -1;
     }
@@ -374,7 +392,8 @@ AnalyzedModule* ModuleLoader::loadModuleFromSource(
         std::move(result.symbols),
         stubKind,
         std::move(searchLocations));
-    return analyze(std::move(modinfo));
+    // the source may not match what's on disk, so bypass the cache
+    return analyze(std::move(modinfo), false);
   }
   return nullptr;
 }
@@ -512,7 +531,37 @@ std::unique_ptr<ModuleInfo> ModuleLoader::findModuleFromSource(
   return nullptr;
 }
 
-AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
+static std::shared_ptr<StrictModuleObject> makeModuleObject(
+    const ModuleInfo& moduleInfo,
+    std::shared_ptr<objects::DictType> globalScope) {
+  const std::string& name = moduleInfo.getModName();
+  auto mod = StrictModuleObject::makeStrictModule(
+      ModuleType(), name, std::move(globalScope));
+
+  // set __name__ and __path__
+  mod->setAttr(
+      "__name__",
+      std::make_shared<objects::StrictString>(objects::StrType(), mod, name));
+  const auto& subModuleLocs = moduleInfo.getSubmoduleSearchLocations();
+  if (!subModuleLocs.empty()) {
+    std::vector<std::shared_ptr<objects::BaseStrictObject>> pathVec;
+    pathVec.reserve(subModuleLocs.size());
+    for (const std::string& s : subModuleLocs) {
+      auto strObj =
+          std::make_shared<objects::StrictString>(objects::StrType(), mod, s);
+      pathVec.push_back(std::move(strObj));
+    }
+    mod->setAttr(
+        "__path__",
+        std::make_shared<objects::StrictList>(
+            objects::ListType(), mod, std::move(pathVec)));
+  }
+  return mod;
+}
+
+AnalyzedModule* ModuleLoader::analyze(
+    std::unique_ptr<ModuleInfo> modInfo,
+    bool cacheable) {
   const mod_ty ast = modInfo->getAst();
 
   // Following python semantics, publish the module before ast visits
@@ -564,31 +613,19 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
 
   if (analyzedModule->isStrict() || isForcedStrict(name, filename)) {
     assert(ast != nullptr);
+    if (cacheable && valueNeeded_.count(name) == 0 &&
+        should_analyze == ShouldAnalyze::kYes &&
+        loadCachedAnalysis(*analyzedModule)) {
+      log("Using cached analysis for module: %s", name.c_str());
+      if (hasAllowListedParent(name)) {
+        publishOnParent(name);
+      }
+      return analyzedModule;
+    }
     // Run ast visits
     auto globalScope = std::make_shared<objects::DictType>();
     // create module object. Analysis result will be the __dict__ of this object
-    auto mod =
-        StrictModuleObject::makeStrictModule(ModuleType(), name, globalScope);
-
-    // set __name__ and __path__
-    mod->setAttr(
-        "__name__",
-        std::make_shared<objects::StrictString>(objects::StrType(), mod, name));
-    const auto& subModuleLocs = moduleInfo.getSubmoduleSearchLocations();
-    if (!subModuleLocs.empty()) {
-      std::vector<std::shared_ptr<objects::BaseStrictObject>> pathVec;
-      pathVec.reserve(subModuleLocs.size());
-      for (const std::string& s : subModuleLocs) {
-        auto strObj =
-            std::make_shared<objects::StrictString>(objects::StrType(), mod, s);
-        pathVec.push_back(std::move(strObj));
-      }
-      mod->setAttr(
-          "__path__",
-          std::make_shared<objects::StrictList>(
-              objects::ListType(), mod, std::move(pathVec)));
-    }
-
+    auto mod = makeModuleObject(moduleInfo, globalScope);
     analyzedModule->setModuleValue(mod);
 
     // do analysis (unless opted out)
@@ -604,8 +641,18 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
         mod,
         moduleInfo.getFutureAnnotations());
 
+    std::optional<std::set<std::string>> dependencies;
+    int firstError = errorSinkBorrowed->getErrorCount();
     if (should_analyze == ShouldAnalyze::kYes) {
-      analyzer.analyze();
+      pendingAnalyses_.push_back({name, {}});
+      try {
+        analyzer.analyze();
+      } catch (...) {
+        pendingAnalyses_.pop_back();
+        throw;
+      }
+      dependencies = std::move(pendingAnalyses_.back().dependencies);
+      pendingAnalyses_.pop_back();
     } else {
       log("Skipping analysis for module module: %s (from %s)",
           name.c_str(),
@@ -613,6 +660,9 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
     }
 
     analyzedModule->setAstToResults(analyzer.passAstToResultsMap());
+    if (cacheable && dependencies) {
+      storeCachedAnalysis(*analyzedModule, *dependencies, firstError);
+    }
   }
 
   if (hasAllowListedParent(name)) {
@@ -727,6 +777,437 @@ void ModuleLoader::publishOnParent(const std::string& childName) {
   parentMod->setAttr(childAttrName, childMod);
 }
 
+void ModuleLoader::recordDependency(const std::string& modName) {
+  if (!pendingAnalyses_.empty() &&
+      pendingAnalyses_.back().modName != modName) {
+    pendingAnalyses_.back().dependencies.insert(modName);
+  }
+}
+
+bool ModuleLoader::setAnalysisCacheDir(const std::string& cacheDir) {
+  std::error_code ec;
+  std::filesystem::create_directories(cacheDir, ec);
+  if (ec) {
+    return false;
+  }
+  analysisCache_ = std::make_unique<AnalysisCache>(cacheDir);
+  return true;
+}
+
+/**
+ * Hash the settings that affect analysis results, other than the force
+ * strict function which can't be inspected
+ */
+uint64_t ModuleLoader::analysisCacheConfigHash() const {
+  uint64_t hash = AnalysisCache::kInitialHash;
+  auto add = [&hash](const std::string& value) {
+    hash = AnalysisCache::hashBytes(value, hash);
+    hash = AnalysisCache::hashBytes(std::string_view("", 1), hash);
+  };
+  for (const auto& paths : {importPath_, stubImportPath_}) {
+    for (const std::string& path : paths) {
+      add(path);
+    }
+    add(";");
+  }
+  for (const auto& allowed : allowList_) {
+    add(allowed.first);
+    add(allowed.second == AllowListKind::kPrefix ? "prefix" : "exact");
+  }
+  for (const std::string& regex : allowListRegexSources_) {
+    add(regex);
+  }
+  return hash;
+}
+
+/**
+ * Locate every file that loadSingleModule could read for `modName`, without
+ * reading more than what's needed to hash them
+ */
+SourceFingerprint ModuleLoader::fingerprintModule(
+    const std::string& modName) const {
+  std::filesystem::path modPath;
+  size_t start = 0;
+  size_t end;
+  while ((end = modName.find('.', start)) != std::string::npos) {
+    modPath /= modName.substr(start, end - start);
+    start = end + 1;
+  }
+  modPath /= modName.substr(start);
+
+  SourceFingerprint fingerprint;
+  uint64_t hash = AnalysisCache::kInitialHash;
+  auto probe = [&](const std::vector<std::string>& searchLocations,
+                   FileSuffixKind suffixKind) {
+    const char* suffix = getFileSuffixKindName(suffixKind);
+    std::error_code ec;
+    for (const std::string& importPath : searchLocations) {
+      std::filesystem::path base = std::filesystem::path(importPath) / modPath;
+      std::filesystem::path pyModPath = base;
+      pyModPath += suffix;
+      std::filesystem::path initModPath = base / "__init__";
+      initModPath += suffix;
+      for (const auto& path : {pyModPath, initModPath}) {
+        if (std::filesystem::is_regular_file(path, ec)) {
+          fingerprint.paths += path.string();
+          hash = AnalysisCache::hashFile(path, hash).value_or(hash);
+          return;
+        }
+      }
+      if (std::filesystem::is_directory(base, ec)) {
+        fingerprint.paths += base.string();
+        return;
+      }
+    }
+  };
+
+  probe(stubImportPath_, FileSuffixKind::kStrictStubFile);
+  fingerprint.paths += ';';
+  probe(importPath_, FileSuffixKind::kPythonFile);
+  fingerprint.paths += ';';
+  probe(importPath_, FileSuffixKind::kTypingStubFile);
+  fingerprint.paths += ';';
+  fingerprint.hash = AnalysisCache::hashBytes(fingerprint.paths, hash);
+  return fingerprint;
+}
+
+/**
+ * Collect the definitions and decorators in `body`, whose values may carry
+ * rewriter attributes, in source order. The order is stable for a given
+ * source, which lets cached attributes be matched with a freshly parsed AST
+ */
+static void collectDefinitionNodes(
+    const asdl_stmt_seq* body,
+    std::vector<void*>& nodes) {
+  auto addDefinition = [&nodes](
+                           stmt_ty stmt,
+                           const asdl_expr_seq* decorators,
+                           const asdl_stmt_seq* defBody) {
+    nodes.push_back(stmt);
+    int decoratorSize = asdl_seq_LEN(decorators);
+    for (int i = 0; i < decoratorSize; ++i) {
+      nodes.push_back(asdl_seq_GET(decorators, i));
+    }
+    collectDefinitionNodes(defBody, nodes);
+  };
+  int n = asdl_seq_LEN(body);
+  for (int i = 0; i < n; ++i) {
+    stmt_ty stmt = reinterpret_cast<stmt_ty>(asdl_seq_GET(body, i));
+    switch (stmt->kind) {
+      case FunctionDef_kind: {
+        auto& def = stmt->v.FunctionDef;
+        addDefinition(stmt, def.decorator_list, def.body);
+        break;
+      }
+      case AsyncFunctionDef_kind: {
+        auto& def = stmt->v.AsyncFunctionDef;
+        addDefinition(stmt, def.decorator_list, def.body);
+        break;
+      }
+      case ClassDef_kind: {
+        auto& def = stmt->v.ClassDef;
+        addDefinition(stmt, def.decorator_list, def.body);
+        break;
+      }
+      case For_kind:
+        collectDefinitionNodes(stmt->v.For.body, nodes);
+        collectDefinitionNodes(stmt->v.For.orelse, nodes);
+        break;
+      case AsyncFor_kind:
+        collectDefinitionNodes(stmt->v.AsyncFor.body, nodes);
+        collectDefinitionNodes(stmt->v.AsyncFor.orelse, nodes);
+        break;
+      case While_kind:
+        collectDefinitionNodes(stmt->v.While.body, nodes);
+        collectDefinitionNodes(stmt->v.While.orelse, nodes);
+        break;
+      case If_kind:
+        collectDefinitionNodes(stmt->v.If.body, nodes);
+        collectDefinitionNodes(stmt->v.If.orelse, nodes);
+        break;
+      case With_kind:
+        collectDefinitionNodes(stmt->v.With.body, nodes);
+        break;
+      case AsyncWith_kind:
+        collectDefinitionNodes(stmt->v.AsyncWith.body, nodes);
+        break;
+      case Try_kind: {
+        auto& tryStmt = stmt->v.Try;
+        collectDefinitionNodes(tryStmt.body, nodes);
+        int handlersSize = asdl_seq_LEN(tryStmt.handlers);
+        for (int j = 0; j < handlersSize; ++j) {
+          excepthandler_ty handler = reinterpret_cast<excepthandler_ty>(
+              asdl_seq_GET(tryStmt.handlers, j));
+          collectDefinitionNodes(handler->v.ExceptHandler.body, nodes);
+        }
+        collectDefinitionNodes(tryStmt.orelse, nodes);
+        collectDefinitionNodes(tryStmt.finalbody, nodes);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * Record a global of an analyzed module. Constants and imports can be
+ * restored without analyzing the module, anything else is opaque
+ */
+static CachedExport exportValue(
+    const std::string& name,
+    const std::shared_ptr<BaseStrictObject>& value) {
+  CachedExport exp{name, CachedValueKind::kOpaque, "", ""};
+  if (value == nullptr) {
+    return exp;
+  }
+  if (value->isLazy()) {
+    auto lazy = std::static_pointer_cast<objects::StrictLazyObject>(value);
+    exp.value = lazy->getModName();
+    if (lazy->getAttrName()) {
+      exp.kind = CachedValueKind::kImport;
+      exp.attrName = *lazy->getAttrName();
+    } else {
+      exp.kind = CachedValueKind::kModule;
+    }
+    return exp;
+  }
+  auto type = value->getType();
+  if (value == objects::NoneObject()) {
+    exp.kind = CachedValueKind::kNone;
+  } else if (type == objects::BoolType()) {
+    exp.kind = CachedValueKind::kBool;
+    bool boolValue =
+        std::static_pointer_cast<objects::StrictBool>(value)->getValue();
+    exp.value = boolValue ? "1" : "0";
+  } else if (type == objects::IntType()) {
+    // ints that don't fit in int_type stay opaque
+    auto intValue =
+        std::static_pointer_cast<objects::StrictInt>(value)->getValue();
+    if (intValue) {
+      exp.kind = CachedValueKind::kInt;
+      exp.value = std::to_string(*intValue);
+    }
+  } else if (type == objects::FloatType()) {
+    exp.kind = CachedValueKind::kFloat;
+    // hex keeps the exact value
+    double floatValue =
+        std::static_pointer_cast<objects::StrictFloat>(value)->getValue();
+    exp.value = fmt::format("{:a}", floatValue);
+  } else if (type == objects::StrType()) {
+    exp.kind = CachedValueKind::kStr;
+    exp.value =
+        std::static_pointer_cast<objects::StrictString>(value)->getValue();
+  } else if (
+      auto modValue = std::dynamic_pointer_cast<StrictModuleObject>(value)) {
+    exp.kind = CachedValueKind::kModule;
+    exp.value = modValue->getModuleName();
+  }
+  return exp;
+}
+
+/**
+ * Recreate a global of a module restored from the cache. Opaque values
+ * become lazy objects that analyze the module when they are used
+ */
+std::shared_ptr<BaseStrictObject> ModuleLoader::restoreExport(
+    const CachedExport& exp,
+    const CallerContext& context) {
+  auto mod = context.caller.lock();
+  switch (exp.kind) {
+    case CachedValueKind::kNone:
+      return objects::NoneObject();
+    case CachedValueKind::kBool:
+      return exp.value == "1" ? objects::StrictTrue() : objects::StrictFalse();
+    case CachedValueKind::kInt:
+      return std::make_shared<objects::StrictInt>(
+          objects::IntType(),
+          mod,
+          std::strtoll(exp.value.c_str(), nullptr, 10));
+    case CachedValueKind::kFloat:
+      return std::make_shared<objects::StrictFloat>(
+          objects::FloatType(), mod, std::strtod(exp.value.c_str(), nullptr));
+    case CachedValueKind::kStr:
+      return std::make_shared<objects::StrictString>(
+          objects::StrType(), mod, exp.value);
+    case CachedValueKind::kModule:
+      return std::make_shared<objects::StrictLazyObject>(
+          objects::LazyObjectType(),
+          mod,
+          this,
+          exp.value,
+          fmt::format("<imported module {}>", exp.value),
+          context);
+    case CachedValueKind::kImport:
+      return std::make_shared<objects::StrictLazyObject>(
+          objects::LazyObjectType(),
+          mod,
+          this,
+          exp.value,
+          fmt::format("<{} imported from {}>", exp.attrName, exp.value),
+          context,
+          exp.attrName);
+    case CachedValueKind::kOpaque:
+      return std::make_shared<objects::StrictLazyObject>(
+          objects::LazyObjectType(),
+          mod,
+          this,
+          mod->getModuleName(),
+          fmt::format("<{} from {}>", exp.name, mod->getModuleName()),
+          context,
+          exp.name,
+          true);
+  }
+  Py_UNREACHABLE();
+}
+
+bool ModuleLoader::loadCachedAnalysis(AnalyzedModule& mod) {
+  if (!analysisCache_) {
+    return false;
+  }
+  const std::string& name = mod.getModuleInfo().getModName();
+  auto entry = analysisCache_->load(name, analysisCacheConfigHash());
+  if (!entry || entry->moduleKind != mod.getModKindAsInt() ||
+      entry->stubKind != mod.getStubKindAsInt() ||
+      entry->source != fingerprintModule(name)) {
+    return false;
+  }
+  std::set<std::string> dependencies;
+  for (const CachedDependency& dep : entry->dependencies) {
+    if (dep.fingerprint != fingerprintModule(dep.modName)) {
+      log("Cached analysis of %s is stale because of %s",
+          name.c_str(),
+          dep.modName.c_str());
+      return false;
+    }
+    dependencies.insert(dep.modName);
+  }
+
+  const ModuleInfo& moduleInfo = mod.getModuleInfo();
+  std::vector<void*> nodes;
+  collectDefinitionNodes(moduleInfo.getAst()->v.Module.body, nodes);
+  std::unordered_map<void*, RewriterAttrs> rewriterAttrs;
+  for (const CachedRewriterAttrs& cached : entry->rewriterAttrs) {
+    if (cached.node < 0 || static_cast<size_t>(cached.node) >= nodes.size()) {
+      return false;
+    }
+    RewriterAttrs& attrs = rewriterAttrs[nodes[cached.node]];
+    attrs.setSlotsEnabled(!cached.slotsDisabled);
+    attrs.setLooseSlots(cached.looseSlots);
+    attrs.setExtraSlots(cached.extraSlots);
+    attrs.setMutable(cached.isMutable);
+    attrs.setHasCachedProp(cached.hasCachedProperty);
+    attrs.setCachedPropKind(
+        static_cast<CachedPropertyKind>(cached.cachedPropKind));
+  }
+
+  for (const CachedError& error : entry->errors) {
+    mod.getErrorSink().error<CachedStrictModuleException>(
+        error.lineno,
+        error.col,
+        error.filename,
+        error.scopeName,
+        error.message);
+  }
+  auto value =
+      makeModuleObject(moduleInfo, std::make_shared<objects::DictType>());
+  CallerContext context(
+      value,
+      moduleInfo.getFilename(),
+      "<module>",
+      0,
+      0,
+      &mod.getErrorSink(),
+      this);
+  for (const CachedExport& exp : entry->exports) {
+    value->setAttr(exp.name, restoreExport(exp, context));
+  }
+  mod.setModuleValue(std::move(value));
+  mod.setCachedRewriterAttrs(std::move(rewriterAttrs));
+  mod.setFromCache();
+  cachedModules_.insert(name);
+  dependencyClosures_[name] = std::move(dependencies);
+  return true;
+}
+
+void ModuleLoader::storeCachedAnalysis(
+    AnalyzedModule& mod,
+    const std::set<std::string>& dependencies,
+    int firstError) {
+  if (!analysisCache_) {
+    return;
+  }
+  const std::string& name = mod.getModuleInfo().getModName();
+  // an entry is only valid if the analysis of every module whose value this
+  // analysis used is known to be complete, which isn't the case in a cycle
+  std::set<std::string> closure;
+  for (const std::string& dep : dependencies) {
+    for (const PendingAnalysis& pending : pendingAnalyses_) {
+      if (pending.modName == dep) {
+        dependencyClosures_[name] = std::nullopt;
+        return;
+      }
+    }
+    closure.insert(dep);
+    auto depClosure = dependencyClosures_.find(dep);
+    if (depClosure != dependencyClosures_.end()) {
+      if (!depClosure->second) {
+        dependencyClosures_[name] = std::nullopt;
+        return;
+      }
+      closure.insert(depClosure->second->begin(), depClosure->second->end());
+    }
+  }
+  closure.erase(name);
+
+  CachedAnalysis entry;
+  entry.moduleKind = mod.getModKindAsInt();
+  entry.stubKind = mod.getStubKindAsInt();
+  entry.source = fingerprintModule(name);
+  for (const std::string& dep : closure) {
+    entry.dependencies.push_back(CachedDependency{dep, fingerprintModule(dep)});
+  }
+  const auto& errors = mod.getErrorSink().getErrors();
+  for (size_t i = firstError; i < errors.size(); ++i) {
+    const StrictModuleException& error = *errors[i];
+    entry.errors.push_back(CachedError{
+        error.getLineno(),
+        error.getCol(),
+        error.getFilename(),
+        error.getScopeName(),
+        error.displayString(false)});
+  }
+  if (auto value = mod.getModuleValue()) {
+    for (auto& [key, item] : *value->getDict()) {
+      // restored from the module info
+      if (key == "__name__" || key == "__path__") {
+        continue;
+      }
+      entry.exports.push_back(exportValue(key, item.first));
+    }
+  }
+  std::vector<void*> nodes;
+  collectDefinitionNodes(mod.getModuleInfo().getAst()->v.Module.body, nodes);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const RewriterAttrs* attrs = mod.getRewriterAttrs(nodes[i]);
+    if (attrs == nullptr) {
+      continue;
+    }
+    entry.rewriterAttrs.push_back(CachedRewriterAttrs{
+        static_cast<int>(i),
+        attrs->isSlotDisabled(),
+        attrs->isLooseSlots(),
+        attrs->getExtraSlots(),
+        attrs->isMutable(),
+        attrs->hasCachedProperty(),
+        static_cast<int>(attrs->getCachedPropKind())});
+  }
+  dependencyClosures_[name] = std::move(closure);
+  if (!analysisCache_->store(name, analysisCacheConfigHash(), entry)) {
+    log("Failed to store cached analysis of %s", name.c_str());
+  }
+}
+
 bool ModuleLoader::hasAllowListedParent(const std::string& modName) {
   std::optional<std::string> parent = getParentModuleName(modName);
   if (!parent.has_value()) {
@@ -1,6 +1,7 @@
 // Copyright (c) Meta Platforms, Inc. and affiliates.
 #pragma once
 
+#include "cinderx/StrictModules/Compiler/analysis_cache.h"
 #include "cinderx/StrictModules/Compiler/analyzed_module.h"
 #include "cinderx/StrictModules/Compiler/module_info.h"
 #include "cinderx/StrictModules/analyzer.h"
@@ -9,6 +10,7 @@
 #include <functional>
 #include <memory>
 #include <regex>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -118,6 +120,13 @@ class ModuleLoader {
   std::shared_ptr<StrictModuleObject> loadModuleValue(const char* modName);
   std::shared_ptr<StrictModuleObject> loadModuleValue(
       const std::string& modName);
+  /**
+  Like loadModuleValue, but if the module was restored from the analysis
+  cache analyze it again, so that the value includes its functions and
+  classes
+  */
+  std::shared_ptr<StrictModuleObject> loadAnalyzedModuleValue(
+      const std::string& modName);
 
   // return module value if module is already loaded, nullptr otherwise
   std::shared_ptr<StrictModuleObject> tryGetModuleValue(
@@ -158,6 +167,11 @@ class ModuleLoader {
   bool setAllowListPrefix(std::vector<std::string> allowList);
   bool setAllowListExact(std::vector<std::string> allowList);
   bool setAllowListRegex(std::vector<std::string> allowList);
+  /** Reuse analysis results stored in `cacheDir` by earlier runs, and store
+   *  the results of modules analyzed from now on there.
+   *  Return false if the directory can't be created.
+   */
+  bool setAnalysisCacheDir(const std::string& cacheDir);
 
   int getAnalyzedModuleCount() const;
 
@@ -202,14 +216,50 @@ class ModuleLoader {
   ErrorSinkFactory errorSinkFactory_;
   std::unordered_set<std::unique_ptr<AnalyzedModule>> deletedModules_;
   std::vector<std::regex> allowListRegexes_;
+  // sources of allowListRegexes_, which are part of the cache configuration
+  std::vector<std::string> allowListRegexSources_;
   bool verbose_ = false;
   bool disableAnalysis_ = false;
 
-  AnalyzedModule* analyze(std::unique_ptr<ModuleInfo> modInfo);
+  struct PendingAnalysis {
+    std::string modName;
+    // modules whose values the analysis of modName has used so far
+    std::set<std::string> dependencies;
+  };
+
+  std::unique_ptr<AnalysisCache> analysisCache_;
+  // modules restored from the cache, whose values only hold the globals
+  // recorded in the cache
+  std::unordered_set<std::string> cachedModules_;
+  // modules currently being analyzed, innermost last
+  std::vector<PendingAnalysis> pendingAnalyses_;
+  // modules whose values the analysis of each module used, transitively.
+  // nullopt if that couldn't be determined because of an import cycle
+  std::unordered_map<std::string, std::optional<std::set<std::string>>>
+      dependencyClosures_;
+  // cached modules whose full value was needed, which are analyzed again
+  // rather than restored from the cache
+  std::unordered_set<std::string> valueNeeded_;
+
+  AnalyzedModule* analyze(
+      std::unique_ptr<ModuleInfo> modInfo,
+      bool cacheable = true);
   bool isAllowListed(const std::string& modName);
   bool isForcedStrict(const std::string& modName, const std::string& fileName);
   bool hasAllowListedParent(const std::string& modName);
   void publishOnParent(const std::string& childName);
+
+  void recordDependency(const std::string& modName);
+  uint64_t analysisCacheConfigHash() const;
+  SourceFingerprint fingerprintModule(const std::string& modName) const;
+  bool loadCachedAnalysis(AnalyzedModule& mod);
+  std::shared_ptr<BaseStrictObject> restoreExport(
+      const CachedExport& exp,
+      const CallerContext& context);
+  void storeCachedAnalysis(
+      AnalyzedModule& mod,
+      const std::set<std::string>& dependencies,
+      int firstError);
 };
 
 } // namespace strictmod::compiler
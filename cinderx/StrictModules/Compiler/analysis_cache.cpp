@@ -0,0 +1,245 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#include "cinderx/StrictModules/Compiler/analysis_cache.h"
+
+#include "cinderx/StrictModules/py_headers.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace strictmod::compiler {
+
+static const char* kCacheSuffix = ".strictcache";
+static constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+/* Entries are a header line followed by a sequence of fields. Integers are
+ * written in decimal and strings are prefixed with their length, each field
+ * terminated by a newline.
+ */
+static std::string cacheHeader(uint64_t configHash) {
+  std::ostringstream header;
+  header << "strictmod-analysis " << AnalysisCache::kVersion << " "
+         << PY_VERSION << " " << configHash;
+  return header.str();
+}
+
+static void writeInt(std::ostream& os, int64_t value) {
+  os << value << '\n';
+}
+
+static void writeUInt(std::ostream& os, uint64_t value) {
+  os << value << '\n';
+}
+
+static void writeString(std::ostream& os, const std::string& value) {
+  os << value.size() << '\n' << value << '\n';
+}
+
+static void writeFingerprint(std::ostream& os, const SourceFingerprint& fp) {
+  writeString(os, fp.paths);
+  writeUInt(os, fp.hash);
+}
+
+template <typename T>
+static bool readNumber(std::istream& is, T& value) {
+  is >> value;
+  return static_cast<bool>(is) && is.get() == '\n';
+}
+
+static bool readInt(std::istream& is, int& value) {
+  return readNumber(is, value);
+}
+
+static bool readString(std::istream& is, std::string& value) {
+  size_t size;
+  if (!readNumber(is, size)) {
+    return false;
+  }
+  value.resize(size);
+  is.read(value.data(), size);
+  return static_cast<bool>(is) && is.get() == '\n';
+}
+
+static bool readFingerprint(std::istream& is, SourceFingerprint& fp) {
+  return readString(is, fp.paths) && readNumber(is, fp.hash);
+}
+
+std::filesystem::path AnalysisCache::entryPath(
+    const std::string& modName) const {
+  return cacheDir_ / (modName + kCacheSuffix);
+}
+
+std::optional<CachedAnalysis> AnalysisCache::load(
+    const std::string& modName,
+    uint64_t configHash) const {
+  std::ifstream is(entryPath(modName), std::ios::binary);
+  if (!is) {
+    return std::nullopt;
+  }
+  std::string header;
+  if (!std::getline(is, header) || header != cacheHeader(configHash)) {
+    return std::nullopt;
+  }
+
+  CachedAnalysis analysis;
+  size_t numDeps, numErrors;
+  if (!readInt(is, analysis.moduleKind) || !readInt(is, analysis.stubKind) ||
+      !readFingerprint(is, analysis.source) || !readNumber(is, numDeps)) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < numDeps; ++i) {
+    CachedDependency dep;
+    if (!readString(is, dep.modName) || !readFingerprint(is, dep.fingerprint)) {
+      return std::nullopt;
+    }
+    analysis.dependencies.push_back(std::move(dep));
+  }
+  if (!readNumber(is, numErrors)) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < numErrors; ++i) {
+    CachedError error;
+    if (!readInt(is, error.lineno) || !readInt(is, error.col) ||
+        !readString(is, error.filename) || !readString(is, error.scopeName) ||
+        !readString(is, error.message)) {
+      return std::nullopt;
+    }
+    analysis.errors.push_back(std::move(error));
+  }
+  size_t numExports, numAttrs;
+  if (!readNumber(is, numExports)) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < numExports; ++i) {
+    CachedExport exp;
+    int kind;
+    if (!readString(is, exp.name) || !readInt(is, kind) ||
+        !readString(is, exp.value) || !readString(is, exp.attrName) ||
+        kind < 0 || kind > static_cast<int>(CachedValueKind::kOpaque)) {
+      return std::nullopt;
+    }
+    exp.kind = static_cast<CachedValueKind>(kind);
+    analysis.exports.push_back(std::move(exp));
+  }
+  if (!readNumber(is, numAttrs)) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < numAttrs; ++i) {
+    CachedRewriterAttrs attrs;
+    size_t numSlots;
+    if (!readInt(is, attrs.node) || !readNumber(is, attrs.slotsDisabled) ||
+        !readNumber(is, attrs.looseSlots) || !readNumber(is, numSlots)) {
+      return std::nullopt;
+    }
+    for (size_t j = 0; j < numSlots; ++j) {
+      std::string slot;
+      if (!readString(is, slot)) {
+        return std::nullopt;
+      }
+      attrs.extraSlots.push_back(std::move(slot));
+    }
+    if (!readNumber(is, attrs.isMutable) ||
+        !readNumber(is, attrs.hasCachedProperty) ||
+        !readInt(is, attrs.cachedPropKind)) {
+      return std::nullopt;
+    }
+    analysis.rewriterAttrs.push_back(std::move(attrs));
+  }
+  return analysis;
+}
+
+bool AnalysisCache::store(
+    const std::string& modName,
+    uint64_t configHash,
+    const CachedAnalysis& analysis) const {
+  std::filesystem::path path = entryPath(modName);
+  // write to a file private to this process and move it into place, so
+  // that concurrent readers never see a partially written entry
+  std::filesystem::path tmpPath = path;
+  tmpPath += ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!os) {
+      return false;
+    }
+    os << cacheHeader(configHash) << '\n';
+    writeInt(os, analysis.moduleKind);
+    writeInt(os, analysis.stubKind);
+    writeFingerprint(os, analysis.source);
+    writeUInt(os, analysis.dependencies.size());
+    for (const CachedDependency& dep : analysis.dependencies) {
+      writeString(os, dep.modName);
+      writeFingerprint(os, dep.fingerprint);
+    }
+    writeUInt(os, analysis.errors.size());
+    for (const CachedError& error : analysis.errors) {
+      writeInt(os, error.lineno);
+      writeInt(os, error.col);
+      writeString(os, error.filename);
+      writeString(os, error.scopeName);
+      writeString(os, error.message);
+    }
+    writeUInt(os, analysis.exports.size());
+    for (const CachedExport& exp : analysis.exports) {
+      writeString(os, exp.name);
+      writeInt(os, static_cast<int>(exp.kind));
+      writeString(os, exp.value);
+      writeString(os, exp.attrName);
+    }
+    writeUInt(os, analysis.rewriterAttrs.size());
+    for (const CachedRewriterAttrs& attrs : analysis.rewriterAttrs) {
+      writeInt(os, attrs.node);
+      writeInt(os, attrs.slotsDisabled);
+      writeInt(os, attrs.looseSlots);
+      writeUInt(os, attrs.extraSlots.size());
+      for (const std::string& slot : attrs.extraSlots) {
+        writeString(os, slot);
+      }
+      writeInt(os, attrs.isMutable);
+      writeInt(os, attrs.hasCachedProperty);
+      writeInt(os, attrs.cachedPropKind);
+    }
+    if (!os.flush()) {
+      os.close();
+      std::error_code ec;
+      std::filesystem::remove(tmpPath, ec);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+  return true;
+}
+
+uint64_t AnalysisCache::hashBytes(std::string_view data, uint64_t hash) {
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+std::optional<uint64_t> AnalysisCache::hashFile(
+    const std::filesystem::path& path,
+    uint64_t hash) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is) {
+    return std::nullopt;
+  }
+  char buffer[8192];
+  while (is.read(buffer, sizeof(buffer)) || is.gcount() > 0) {
+    hash = hashBytes(std::string_view(buffer, is.gcount()), hash);
+  }
+  if (is.bad()) {
+    return std::nullopt;
+  }
+  return hash;
+}
+
+} // namespace strictmod::compiler
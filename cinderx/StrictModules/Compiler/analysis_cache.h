@@ -0,0 +1,132 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace strictmod::compiler {
+
+/** Identifies the files a module name resolves to and their contents */
+struct SourceFingerprint {
+  /* the strict stub, source and typing stub a module name resolves to,
+   * each followed by ';' (so an empty entry means none was found)
+   */
+  std::string paths;
+  uint64_t hash{0};
+
+  bool operator==(const SourceFingerprint& other) const = default;
+};
+
+struct CachedDependency {
+  std::string modName;
+  SourceFingerprint fingerprint;
+};
+
+struct CachedError {
+  int lineno;
+  int col;
+  std::string filename;
+  std::string scopeName;
+  std::string message;
+};
+
+enum class CachedValueKind {
+  kNone,
+  kBool,
+  kInt,
+  kFloat,
+  kStr,
+  // another module, `value` is its name
+  kModule,
+  // `from value import attrName` that wasn't evaluated yet
+  kImport,
+  // anything else, which needs the module to be analyzed again
+  kOpaque,
+};
+
+/** A global of the analyzed module. Only constants and imports are
+ *  recorded, which is enough for dependents that don't use the module's
+ *  functions and classes.
+ */
+struct CachedExport {
+  std::string name;
+  CachedValueKind kind;
+  // the constant (floats in hex), or the module name for imports
+  std::string value;
+  std::string attrName;
+};
+
+struct CachedRewriterAttrs {
+  // position of the node among the definitions and decorators of the
+  // module, in the order collectDefinitionNodes visits them
+  int node;
+  bool slotsDisabled;
+  bool looseSlots;
+  std::vector<std::string> extraSlots;
+  bool isMutable;
+  bool hasCachedProperty;
+  int cachedPropKind;
+};
+
+/** The result of analyzing a module. The entry is only valid while the
+ *  module and every module its analysis (transitively) imported still have
+ *  the recorded fingerprints.
+ */
+struct CachedAnalysis {
+  int moduleKind;
+  int stubKind;
+  SourceFingerprint source;
+  std::vector<CachedDependency> dependencies;
+  std::vector<CachedError> errors;
+  std::vector<CachedExport> exports;
+  std::vector<CachedRewriterAttrs> rewriterAttrs;
+};
+
+/** On-disk cache of analysis results, with one file per module in a
+ *  directory that may be shared between processes.
+ */
+class AnalysisCache {
+ public:
+  /* Bump this whenever a change to the analyzer may change its results */
+  static constexpr int kVersion = 2;
+  static constexpr uint64_t kInitialHash = 0xcbf29ce484222325ULL;
+
+  explicit AnalysisCache(std::filesystem::path cacheDir)
+      : cacheDir_(std::move(cacheDir)) {}
+
+  /** Return the entry stored for `modName` by a checker with the same
+   *  configuration, or nullopt if there is none or it can't be read.
+   */
+  std::optional<CachedAnalysis> load(
+      const std::string& modName,
+      uint64_t configHash) const;
+
+  /** Store the entry for `modName`, replacing any existing one.
+   *  Return false if it couldn't be written.
+   */
+  bool store(
+      const std::string& modName,
+      uint64_t configHash,
+      const CachedAnalysis& analysis) const;
+
+  /* FNV-1a, continuing from `hash` */
+  static uint64_t hashBytes(
+      std::string_view data,
+      uint64_t hash = kInitialHash);
+  /* hash the contents of the file at `path`, or return nullopt if it
+   * can't be read
+   */
+  static std::optional<uint64_t> hashFile(
+      const std::filesystem::path& path,
+      uint64_t hash = kInitialHash);
+
+ private:
+  std::filesystem::path cacheDir_;
+
+  std::filesystem::path entryPath(const std::string& modName) const;
+};
+
+} // namespace strictmod::compiler
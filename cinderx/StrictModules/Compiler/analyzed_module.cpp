@@ -39,6 +39,21 @@ void AnalyzedModule::cleanModuleContent() {
   }
 }
 
+const RewriterAttrs* AnalyzedModule::getRewriterAttrs(void* node) const {
+  if (astToResults_) {
+    auto it = astToResults_->find(node);
+    if (it != astToResults_->end() && it->second &&
+        it->second->hasRewritterAttrs()) {
+      return &it->second->getRewriterAttrs();
+    }
+  }
+  auto cached = cachedRewriterAttrs_.find(node);
+  if (cached != cachedRewriterAttrs_.end()) {
+    return &cached->second;
+  }
+  return nullptr;
+}
+
 int AnalyzedModule::getModKindAsInt() const {
   switch (moduleKind_) {
     case ModuleKind::kStrict:
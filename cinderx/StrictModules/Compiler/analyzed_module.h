@@ -4,9 +4,11 @@
 #include "cinderx/StrictModules/Compiler/module_info.h"
 #include "cinderx/StrictModules/Objects/objects.h"
 #include "cinderx/StrictModules/error_sink.h"
+#include "cinderx/StrictModules/rewriter_attributes.h"
 #include "cinderx/StrictModules/symbol_table.h"
 
 #include <memory>
+#include <unordered_map>
 namespace strictmod::compiler {
 using strictmod::objects::StrictModuleObject;
 
@@ -72,6 +74,15 @@ class AnalyzedModule {
     return astToResults_.get();
   }
 
+  /* Rewriter attributes of what a definition or decorator node evaluated
+   * to, or nullptr if there are none
+   */
+  const RewriterAttrs* getRewriterAttrs(void* node) const;
+  void setCachedRewriterAttrs(
+      std::unordered_map<void*, RewriterAttrs> attrs) {
+    cachedRewriterAttrs_ = std::move(attrs);
+  }
+
   Ref<> getPyAst(PyArena* arena);
 
   const ModuleInfo& getModuleInfo() const {
@@ -83,6 +94,18 @@ class AnalyzedModule {
   }
   int getModKindAsInt() const;
 
+  /* Whether the results were restored from the analysis cache rather than
+   * produced by analyzing the module, in which case the module value only
+   * holds the recorded constants and imports, and lazy placeholders that
+   * analyze the module when any other global is used
+   */
+  bool isFromCache() const {
+    return fromCache_;
+  }
+  void setFromCache() {
+    fromCache_ = true;
+  }
+
  private:
   std::shared_ptr<StrictModuleObject> module_;
   ModuleKind moduleKind_;
@@ -90,5 +113,8 @@ class AnalyzedModule {
   std::unique_ptr<astToResultT> astToResults_;
   std::unique_ptr<ModuleInfo> modInfo_;
   PreprocessingRecord preprocessRecord_;
+  bool fromCache_ = false;
+  // rewriter attributes restored from the analysis cache
+  std::unordered_map<void*, RewriterAttrs> cachedRewriterAttrs_;
 };
 } // namespace strictmod::compiler
@@ -12,14 +12,16 @@ StrictLazyObject::StrictLazyObject(
     std::string modName,
     std::string unknownName,
     CallerContext context,
-    std::optional<std::string> attrName)
+    std::optional<std::string> attrName,
+    bool fromCache)
     : BaseStrictObject(std::move(type), std::move(creator)),
       loader_(loader),
       modName_(std::move(modName)),
       unknownName_(std::move(unknownName)),
       context_(context),
       attrName_(std::move(attrName)),
-      evaluated_(false) {}
+      evaluated_(false),
+      fromCache_(fromCache) {}
 
 void StrictLazyObject::forceEvaluate(const CallerContext& caller) {
   // Handle import cycles. If forceEvaluate ended up calling itself, then in
@@ -30,7 +32,8 @@ void StrictLazyObject::forceEvaluate(const CallerContext& caller) {
   }
   evaluated_ = true;
   std::shared_ptr<BaseStrictObject> result;
-  auto mod = loader_->loadModuleValue(modName_);
+  auto mod = fromCache_ ? loader_->loadAnalyzedModuleValue(modName_)
+                       : loader_->loadModuleValue(modName_);
   if (mod && attrName_) {
     result = iImportFrom(mod, *attrName_, context_, loader_);
   } else {
@@ -19,6 +19,9 @@ namespace strictmod::objects {
  *
  * Otherwise, the lazy object represents the member of the module.
  * The module (but not the member in the module) is lazily evaluated
+ *
+ * If fromCache is set, the object stands for a global of a module
+ * restored from the analysis cache, and evaluating it analyzes that module
  */
 class StrictLazyObject : public BaseStrictObject {
  public:
@@ -29,7 +32,8 @@ class StrictLazyObject : public BaseStrictObject {
       std::string modName,
       std::string unknownName,
       CallerContext context,
-      std::optional<std::string> attrName = std::nullopt);
+      std::optional<std::string> attrName = std::nullopt,
+      bool fromCache = false);
 
   std::shared_ptr<BaseStrictObject> evaluate() {
     if (obj_ == nullptr) {
@@ -42,6 +46,16 @@ class StrictLazyObject : public BaseStrictObject {
     return true;
   }
 
+  const std::string& getModName() const {
+    return modName_;
+  }
+  const std::optional<std::string>& getAttrName() const {
+    return attrName_;
+  }
+  bool isFromCache() const {
+    return fromCache_;
+  }
+
   virtual std::shared_ptr<BaseStrictObject> copy(
       const CallerContext& caller) override;
   virtual std::string getDisplayName() const override;
@@ -54,6 +68,7 @@ class StrictLazyObject : public BaseStrictObject {
   std::optional<std::string> attrName_;
   std::shared_ptr<BaseStrictObject> obj_;
   bool evaluated_;
+  bool fromCache_;
 
   void forceEvaluate(const CallerContext& caller);
 };
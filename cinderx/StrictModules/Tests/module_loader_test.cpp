@@ -1,5 +1,11 @@
 // Copyright (c) Meta Platforms, Inc. and affiliates.
 #include "cinderx/StrictModules/Tests/test.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+
 TEST_F(ModuleLoaderTest, GetLoader) {
   auto mod = getLoader(nullptr, nullptr);
   ASSERT_NE(mod.get(), nullptr);
@@ -44,3 +50,181 @@ TEST_F(ModuleLoaderTest, LoadModuleImport) {
   auto mod = loadFile("simple_import");
   ASSERT_NE(mod.get(), nullptr);
 }
+
+class AnalysisCacheTest : public ModuleLoaderTest {
+ public:
+  void SetUp() override {
+    ModuleLoaderTest::SetUp();
+    root_ = std::filesystem::temp_directory_path() /
+        ("strict_analysis_cache_" + std::to_string(getpid()) + "_" +
+         ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_ / "src");
+    std::filesystem::create_directories(root_ / "stubs");
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root_);
+    ModuleLoaderTest::TearDown();
+  }
+
+  void writeModule(const std::string& name, const char* source) {
+    std::ofstream(root_ / "src" / (name + ".py")) << source;
+  }
+
+  std::unique_ptr<strictmod::compiler::ModuleLoader> getCachingLoader() {
+    std::string importPath = (root_ / "src").string();
+    std::string stubPath = (root_ / "stubs").string();
+    auto loader = getLoader(importPath.c_str(), stubPath.c_str());
+    EXPECT_TRUE(loader->setAnalysisCacheDir((root_ / "cache").string()));
+    return loader;
+  }
+
+ private:
+  std::filesystem::path root_;
+};
+
+TEST_F(AnalysisCacheTest, ReusesUnchangedModule) {
+  writeModule("a", "import __strict__\nx = 1\n");
+  auto loader = getCachingLoader();
+  auto mod = loader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  EXPECT_FALSE(mod->isFromCache());
+  EXPECT_NE(mod->getModuleValue(), nullptr);
+
+  auto cachingLoader = getCachingLoader();
+  auto cachedMod = cachingLoader->loadModule("a");
+  ASSERT_NE(cachedMod, nullptr);
+  EXPECT_TRUE(cachedMod->isFromCache());
+  EXPECT_TRUE(cachedMod->isStrict());
+  EXPECT_EQ(cachedMod->getErrorSink().getErrorCount(), 0);
+}
+
+TEST_F(AnalysisCacheTest, PreservesErrors) {
+  writeModule("a", "import __strict__\nraise Exception('boom')\n");
+  auto loader = getCachingLoader();
+  auto mod = loader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  ASSERT_EQ(mod->getErrorSink().getErrorCount(), 1);
+
+  auto cachingLoader = getCachingLoader();
+  auto cachedMod = cachingLoader->loadModule("a");
+  ASSERT_NE(cachedMod, nullptr);
+  EXPECT_TRUE(cachedMod->isFromCache());
+  ASSERT_EQ(cachedMod->getErrorSink().getErrorCount(), 1);
+  const auto& error = mod->getErrorSink().getErrors()[0];
+  const auto& cachedError = cachedMod->getErrorSink().getErrors()[0];
+  EXPECT_EQ(cachedError->getLineno(), error->getLineno());
+  EXPECT_EQ(cachedError->getCol(), error->getCol());
+  EXPECT_EQ(cachedError->getFilename(), error->getFilename());
+  EXPECT_EQ(cachedError->displayString(false), error->displayString(false));
+}
+
+TEST_F(AnalysisCacheTest, ChangedDependencyInvalidates) {
+  writeModule("b", "import __strict__\ny = 1\n");
+  writeModule("a", "import __strict__\nfrom b import y\nx = y\n");
+  getCachingLoader()->loadModule("a");
+
+  auto cachingLoader = getCachingLoader();
+  auto cachedMod = cachingLoader->loadModule("a");
+  ASSERT_NE(cachedMod, nullptr);
+  EXPECT_TRUE(cachedMod->isFromCache());
+
+  writeModule("b", "import __strict__\ny = 2\n");
+  auto staleLoader = getCachingLoader();
+  auto mod = staleLoader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  EXPECT_FALSE(mod->isFromCache());
+}
+
+TEST_F(AnalysisCacheTest, RestoresConstants) {
+  writeModule(
+      "a",
+      "import __strict__\nx = 1\ny = 'y'\nz = 0.1\nw = None\nv = True\n");
+  getCachingLoader()->loadModule("a");
+
+  auto cachingLoader = getCachingLoader();
+  auto value = cachingLoader->loadModuleValue("a");
+  ASSERT_NE(value, nullptr);
+  ASSERT_TRUE(cachingLoader->loadModule("a")->isFromCache());
+
+  auto x = std::dynamic_pointer_cast<strictmod::objects::StrictInt>(
+      value->getAttr("x"));
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->getValue(), 1);
+  auto y = std::dynamic_pointer_cast<strictmod::objects::StrictString>(
+      value->getAttr("y"));
+  ASSERT_NE(y, nullptr);
+  EXPECT_EQ(y->getValue(), "y");
+  auto z = std::dynamic_pointer_cast<strictmod::objects::StrictFloat>(
+      value->getAttr("z"));
+  ASSERT_NE(z, nullptr);
+  EXPECT_EQ(z->getValue(), 0.1);
+  EXPECT_EQ(value->getAttr("w"), strictmod::objects::NoneObject());
+  EXPECT_EQ(value->getAttr("v"), strictmod::objects::StrictTrue());
+  EXPECT_TRUE(cachingLoader->loadModule("a")->isFromCache());
+}
+
+TEST_F(AnalysisCacheTest, UsingOpaqueGlobalReanalyzes) {
+  writeModule("a", "import __strict__\ndef f():\n    return 1\n");
+  getCachingLoader()->loadModule("a");
+
+  auto cachingLoader = getCachingLoader();
+  auto value = cachingLoader->loadModuleValue("a");
+  ASSERT_NE(value, nullptr);
+  ASSERT_TRUE(cachingLoader->loadModule("a")->isFromCache());
+  auto f = value->getAttr("f");
+  ASSERT_NE(f, nullptr);
+  EXPECT_FALSE(f->isLazy());
+  EXPECT_FALSE(f->isUnknown());
+  auto mod = cachingLoader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  EXPECT_FALSE(mod->isFromCache());
+}
+
+TEST_F(AnalysisCacheTest, ChangedModuleUsesCachedDependency) {
+  writeModule("b", "import __strict__\ny = 1\n");
+  writeModule("a", "import __strict__\nfrom b import y\nx = y + 1\n");
+  getCachingLoader()->loadModule("a");
+
+  writeModule("a", "import __strict__\nfrom b import y\nx = y + 2\n");
+  auto cachingLoader = getCachingLoader();
+  auto mod = cachingLoader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  EXPECT_FALSE(mod->isFromCache());
+  EXPECT_EQ(mod->getErrorSink().getErrorCount(), 0);
+  auto x = std::dynamic_pointer_cast<strictmod::objects::StrictInt>(
+      mod->getModuleValue()->getAttr("x"));
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->getValue(), 3);
+  EXPECT_TRUE(cachingLoader->loadModule("b")->isFromCache());
+}
+
+TEST_F(AnalysisCacheTest, RestoresRewriterAttrs) {
+  writeModule(
+      "a",
+      "import __strict__\n"
+      "from __strict__ import loose_slots\n"
+      "@loose_slots\n"
+      "class C:\n"
+      "    pass\n");
+  auto classNode = [](strictmod::compiler::AnalyzedModule* mod) {
+    return asdl_seq_GET(mod->getModuleInfo().getAst()->v.Module.body, 2);
+  };
+  auto loader = getCachingLoader();
+  auto mod = loader->loadModule("a");
+  ASSERT_NE(mod, nullptr);
+  const RewriterAttrs* attrs = mod->getRewriterAttrs(classNode(mod));
+  ASSERT_NE(attrs, nullptr);
+  EXPECT_TRUE(attrs->isLooseSlots());
+
+  auto cachingLoader = getCachingLoader();
+  auto cachedMod = cachingLoader->loadModule("a");
+  ASSERT_NE(cachedMod, nullptr);
+  ASSERT_TRUE(cachedMod->isFromCache());
+  const RewriterAttrs* cachedAttrs =
+      cachedMod->getRewriterAttrs(classNode(cachedMod));
+  ASSERT_NE(cachedAttrs, nullptr);
+  EXPECT_TRUE(cachedAttrs->isLooseSlots());
+  EXPECT_EQ(cachedAttrs->isSlotDisabled(), attrs->isSlotDisabled());
+}
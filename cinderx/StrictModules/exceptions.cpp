@@ -91,6 +91,38 @@ void StrictModuleTooManyIterationsException::raise() {
   throw *this;
 }
 
+// CachedStrictModuleException
+CachedStrictModuleException::CachedStrictModuleException(
+    int lineno,
+    int col,
+    std::string filename,
+    std::string scopeName,
+    std::string displayString)
+    : StrictModuleException(
+          lineno,
+          col,
+          std::move(filename),
+          std::move(scopeName),
+          std::move(displayString)) {}
+
+std::unique_ptr<StrictModuleException> CachedStrictModuleException::clone()
+    const {
+  return std::make_unique<CachedStrictModuleException>(
+      lineno_, col_, filename_, scopeName_, msg_);
+}
+
+std::string CachedStrictModuleException::testStringHelper() const {
+  return "CachedStrictModuleException";
+}
+
+std::string CachedStrictModuleException::displayStringHelper() const {
+  return msg_;
+}
+
+void CachedStrictModuleException::raise() {
+  throw *this;
+}
+
 // StrictModuleUnhandledException
 StrictModuleUnhandledException::StrictModuleUnhandledException(
     int lineno,
@@ -120,6 +120,26 @@ class StrictModuleTooManyIterationsException : public StrictModuleException {
   virtual std::string displayStringHelper() const override;
 };
 
+/** An error reported by an earlier analysis of the module, restored from the
+ *  analysis cache. Only its location and display string are kept.
+ */
+class CachedStrictModuleException : public StrictModuleException {
+ public:
+  CachedStrictModuleException(
+      int lineno,
+      int col,
+      std::string filename,
+      std::string scopeName,
+      std::string displayString);
+
+  [[noreturn]] virtual void raise() override;
+  virtual std::unique_ptr<StrictModuleException> clone() const override;
+
+ private:
+  virtual std::string testStringHelper() const override;
+  virtual std::string displayStringHelper() const override;
+};
+
 /** Use this for user space exceptions, i.e. exceptions
  *  that the analyzed Python program may raise
  */
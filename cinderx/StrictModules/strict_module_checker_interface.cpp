@@ -101,6 +101,14 @@ int StrictModuleChecker_DisableAnalysis(StrictModuleChecker* checker) {
   return success ? 0 : -1;
 }
 
+int StrictModuleChecker_SetAnalysisCacheDir(
+    StrictModuleChecker* checker,
+    const char* cache_dir) {
+  auto loader = reinterpret_cast<strictmod::compiler::ModuleLoader*>(checker);
+  bool success = loader->setAnalysisCacheDir(std::string(cache_dir));
+  return success ? 0 : -1;
+}
+
 void StrictModuleChecker_Free(StrictModuleChecker* checker) {
   delete reinterpret_cast<strictmod::compiler::ModuleLoader*>(checker);
 }
@@ -68,6 +68,13 @@ int StrictModuleChecker_EnableVerboseLogging(StrictModuleChecker* checker);
 
 int StrictModuleChecker_DisableAnalysis(StrictModuleChecker* checker);
 
+/** Reuse analysis results of unchanged modules stored in `cache_dir`,
+ *  and store new results there
+ */
+int StrictModuleChecker_SetAnalysisCacheDir(
+    StrictModuleChecker* checker,
+    const char* cache_dir);
+
 void StrictModuleChecker_Free(StrictModuleChecker* checker);
 
 /** Return the analyzed module
@@ -5,6 +5,8 @@
 #include "cinder/hooks.h"
 
 #include "cinderx/CachedProperties/cached_properties.h"
+#include "cinderx/Common/attr_lookup_cache.h"
+#include "cinderx/Common/frame_arena.h"
 #include "cinderx/Common/watchers.h"
 #include "cinderx/Interpreter/interpreter.h"
 #include "cinderx/Jit/dict_watch.h"
@@ -168,28 +170,114 @@ static PyObject *watch_sys_modules(PyObject *, PyObject *) {
   Py_RETURN_NONE;
 }
 
+// The gc.collect() replaced by install_gc_collect_wrapper(). This is kept
+// alive after the wrapper is uninstalled, since references to the wrapper
+// taken while it was installed still call through it.
+static PyObject *g_orig_gc_collect = nullptr;
+static bool g_gc_collect_wrapped = false;
+
+// Collections requested through gc.collect() are expected to free everything
+// unreachable, so let the parallel collector know not to stop at a slice.
+static PyObject *gc_collect_wrapper(PyObject *, PyObject *const *args,
+                                    Py_ssize_t nargs, PyObject *kwnames) {
+  Cinder_SetParallelGCCollectRequested(1);
+  PyObject *result =
+      PyObject_Vectorcall(g_orig_gc_collect, args, nargs, kwnames);
+  Cinder_SetParallelGCCollectRequested(0);
+  return result;
+}
+
+static PyMethodDef gc_collect_wrapper_def = {
+    "collect", (PyCFunction)gc_collect_wrapper, METH_FASTCALL | METH_KEYWORDS,
+    "collect(generation=2)\n"
+    "\n"
+    "Run the garbage collector.\n"
+    "\n"
+    "With no arguments, run a full collection. The optional argument may be\n"
+    "an integer specifying which generation to collect. The number of\n"
+    "unreachable objects found is returned."};
+
+static int install_gc_collect_wrapper() {
+  if (g_gc_collect_wrapped) {
+    return 0;
+  }
+  PyObject *gc = PyImport_ImportModule("gc");
+  if (gc == NULL) {
+    return -1;
+  }
+  if (g_orig_gc_collect == nullptr) {
+    g_orig_gc_collect = PyObject_GetAttrString(gc, "collect");
+    if (g_orig_gc_collect == nullptr) {
+      Py_DECREF(gc);
+      return -1;
+    }
+  }
+  PyObject *wrapper = PyCFunction_New(&gc_collect_wrapper_def, NULL);
+  if (wrapper == NULL) {
+    Py_DECREF(gc);
+    return -1;
+  }
+  int err = PyObject_SetAttrString(gc, "collect", wrapper);
+  Py_DECREF(wrapper);
+  Py_DECREF(gc);
+  if (err < 0) {
+    return -1;
+  }
+  g_gc_collect_wrapped = true;
+  return 0;
+}
+
+static int uninstall_gc_collect_wrapper() {
+  if (!g_gc_collect_wrapped) {
+    return 0;
+  }
+  PyObject *gc = PyImport_ImportModule("gc");
+  if (gc == NULL) {
+    return -1;
+  }
+  int err = PyObject_SetAttrString(gc, "collect", g_orig_gc_collect);
+  Py_DECREF(gc);
+  if (err < 0) {
+    return -1;
+  }
+  g_gc_collect_wrapped = false;
+  return 0;
+}
+
 PyDoc_STRVAR(cinder_enable_parallel_gc_doc,
-             "enable_parallel_gc(min_generation=2, num_threads=0)\n\
+             "enable_parallel_gc(min_generation=2, num_threads=0, incremental_slice=0)\n\
 \n\
 Enable parallel garbage collection for generations >= `min_generation`.\n\
 \n\
 Use `num_threads` threads to perform collection in parallel. When this value is\n\
 0 the number of threads is half the number of processors.\n\
 \n\
-Calling this more than once has no effect. Call `cinder.disable_parallel_gc()`\n\
-and then call this function to change the configuration.\n\
+When `incremental_slice` is non-zero, automatic collections of the two oldest\n\
+generations examine at most that many objects from the oldest generation, with\n\
+a full collection once all of it has been examined. This makes long pauses\n\
+rarer for large heaps, but doesn't bound them: every pass over the oldest\n\
+generation still ends in a full collection. Collections requested through\n\
+`gc.collect()` are never incremental; `gc.collect` is wrapped while the\n\
+parallel collector is enabled so that it can tell them apart.\n\
+\n\
+Calling this again only updates `incremental_slice`. Call\n\
+`cinder.disable_parallel_gc()` and then call this function to change the rest\n\
+of the configuration.\n\
 \n\
-A ValueError is raised if the generation or number of threads is invalid.");
+A ValueError is raised if the generation, number of threads or slice size is\n\
+invalid.");
 static PyObject *cinder_enable_parallel_gc(PyObject *, PyObject *args,
                                            PyObject *kwargs) {
   static char *argnames[] = {const_cast<char *>("min_generation"),
-                             const_cast<char *>("num_threads"), NULL};
+                             const_cast<char *>("num_threads"),
+                             const_cast<char *>("incremental_slice"), NULL};
 
   int min_gen = 2;
   int num_threads = 0;
+  Py_ssize_t incremental_slice = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ii", argnames, &min_gen,
-                                   &num_threads)) {
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iin", argnames, &min_gen,
+                                   &num_threads, &incremental_slice)) {
     return NULL;
   }
 
@@ -203,9 +291,20 @@ static PyObject *cinder_enable_parallel_gc(PyObject *, PyObject *args,
     return NULL;
   }
 
+  if (incremental_slice < 0) {
+    PyErr_SetString(PyExc_ValueError, "invalid incremental_slice");
+    return NULL;
+  }
+
   if (Cinder_EnableParallelGC(min_gen, num_threads) < 0) {
     return NULL;
   }
+  if (Cinder_SetParallelGCIncrementalSlice(incremental_slice) < 0) {
+    return NULL;
+  }
+  if (install_gc_collect_wrapper() < 0) {
+    return NULL;
+  }
   Py_RETURN_NONE;
 }
 
@@ -218,6 +317,9 @@ affect the current collection.");
 static PyObject *cinder_disable_parallel_gc(PyObject *,
                                             PyObject *) {
   Cinder_DisableParallelGC();
+  if (uninstall_gc_collect_wrapper() < 0) {
+    return NULL;
+  }
   Py_RETURN_NONE;
 }
 
@@ -230,12 +332,73 @@ Returns a dictionary with the following keys when the parallel\n\
 collector is enabled:\n\
 \n\
     num_threads: Number of threads used.\n\
-    min_generation: The minimum generation for which parallel gc is enabled.");
+    min_generation: The minimum generation for which parallel gc is enabled.\n\
+    incremental_slice: The maximum number of objects from the oldest\n\
+        generation examined by an incremental collection, or 0.");
 static PyObject *cinder_get_parallel_gc_settings(PyObject *,
                                                  PyObject *) {
   return Cinder_GetParallelGCSettings();
 }
 
+PyDoc_STRVAR(cinder_get_parallel_gc_pause_stats_doc, "get_parallel_gc_pause_stats()\n\
+\n\
+Return pause time statistics for collections made since the parallel\n\
+collector was enabled, or None if it is not enabled.\n\
+\n\
+Returns a dictionary keyed by the kind of collection (\"young\",\n\
+\"incremental\" or \"full\"). Each value is a dictionary with the keys:\n\
+\n\
+    count: Number of collections.\n\
+    total_us: Total pause time in microseconds.\n\
+    max_us: Longest pause in microseconds.\n\
+    histogram: Maps N to the number of pauses shorter than N microseconds\n\
+        but at least N / 2, for each power of two N with a non-zero count.");
+static PyObject *cinder_get_parallel_gc_pause_stats(PyObject *,
+                                                    PyObject *) {
+  return Cinder_GetParallelGCPauseStats();
+}
+
+PyDoc_STRVAR(set_frame_arena_enabled_doc, "set_frame_arena_enabled(enabled)\n\
+\n\
+Enable or disable reusing the frames of finished calls run by the\n\
+interpreter or JIT, rather than freeing them.");
+static PyObject *set_frame_arena_enabled(PyObject *, PyObject *arg) {
+  int enabled = PyObject_IsTrue(arg);
+  if (enabled < 0) {
+    return nullptr;
+  }
+  Ci_FrameArena_SetEnabled(enabled);
+  if (!enabled) {
+    Ci_FrameArena_Clear();
+  }
+  Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(get_frame_arena_stats_doc, "get_frame_arena_stats()\n\
+\n\
+Return statistics for the current thread's frame arena as a dictionary\n\
+with the keys:\n\
+\n\
+    allocs: Frames allocated through the arena.\n\
+    reuses: Allocations satisfied by reusing the frame of a finished call.\n\
+    escapes: Finished frames that couldn't be reused because they were\n\
+        still referenced elsewhere.\n\
+    retained: Frames currently kept for reuse.");
+static PyObject *get_frame_arena_stats(PyObject *, PyObject *) {
+  Ci_FrameArenaStats stats;
+  Ci_FrameArena_GetStats(&stats);
+  return Py_BuildValue(
+      "{sKsKsKsK}",
+      "allocs",
+      (unsigned long long)stats.allocs,
+      "reuses",
+      (unsigned long long)stats.reuses,
+      "escapes",
+      (unsigned long long)stats.escapes,
+      "retained",
+      (unsigned long long)stats.retained);
+}
+
 static PyObject*
 compile_perf_trampoline_pre_fork(PyObject *, PyObject *) {
     _PyPerfTrampoline_CompilePerfTrampolinePreFork();
@@ -527,6 +690,9 @@ static int cinder_fini() {
     return -1;
   }
 
+  Ci_AttrLookupCache_Clear();
+  Ci_FrameArena_Clear();
+
   Ci_hook_type_created = nullptr;
   Ci_hook_type_destroyed = nullptr;
   Ci_hook_type_name_modified = nullptr;
@@ -635,6 +801,12 @@ static PyMethodDef _cinderx_methods[] = {
      cinder_disable_parallel_gc_doc},
     {"get_parallel_gc_settings", cinder_get_parallel_gc_settings, METH_NOARGS,
      cinder_get_parallel_gc_settings_doc},
+    {"get_parallel_gc_pause_stats", cinder_get_parallel_gc_pause_stats,
+     METH_NOARGS, cinder_get_parallel_gc_pause_stats_doc},
+    {"set_frame_arena_enabled", set_frame_arena_enabled, METH_O,
+     set_frame_arena_enabled_doc},
+    {"get_frame_arena_stats", get_frame_arena_stats, METH_NOARGS,
+     get_frame_arena_stats_doc},
     {"_compile_perf_trampoline_pre_fork", compile_perf_trampoline_pre_fork,
      METH_NOARGS, "Compile perf-trampoline entries before forking"},
     {"_is_compile_perf_trampoline_pre_fork_enabled",
@@ -51,6 +51,8 @@ PRIM_OP_XOR_INT: int
 RAND_MAX: int
 SEQ_ARRAY_INT64: int
 SEQ_CHECKED_LIST: int
+SEQ_CHECKED_LIST_DOUBLE: int
+SEQ_CHECKED_LIST_INT64: int
 SEQ_LIST: int
 SEQ_LIST_INEXACT: int
 SEQ_REPEAT_INEXACT_NUM: int
@@ -106,6 +108,7 @@ def _sizeof_dlsym_cache(*args, **kwargs) -> Any: ...
 def init_subclass(*args, **kwargs) -> Any: ...
 def install_sp_audit_hook() -> None: ...
 def is_type_static(t) -> bool: ...
+def is_value_class(t) -> bool: ...
 def lookup_native_symbol(*args, **kwargs) -> Any: ...
 def make_context_decorator_wrapper(*args, **kwargs) -> Any: ...
 def make_recreate_cm(t: T) -> Callable[[], T]: ...
@@ -61,6 +61,7 @@ class StrictModuleLoader(IStrictModuleLoader):
     def get_analyzed_count(self) -> int: ...
     def set_force_strict(self, force: bool) -> bool: ...
     def set_force_strict_by_name(self, *args, **kwargs) -> Any: ...
+    def set_analysis_cache_dir(self, path: str) -> bool: ...
 
 StrictModuleLoaderFactory = Callable[
     [List[str], str, List[str], List[str], bool, List[str], bool, bool],
@@ -54,6 +54,7 @@
     AwaitableType,
     CACHED_PROPERTY_IMPL_PREFIX,
     CachedPropertyMethod,
+    CheckedPrimitiveList,
     CInstance,
     Class,
     CType,
@@ -997,6 +998,12 @@ def visitList(self, node: ast.List) -> None:
 
         self.set_lineno(node)
         list_descr = list_type.klass.type_descr
+        if isinstance(klass, CheckedPrimitiveList):
+            # The type binder only allows empty displays for these, and a
+            # newly allocated one is empty.
+            self.emit("TP_ALLOC", list_descr)
+            return
+
         extend_descr = list_descr + ("extend",)
         built_final_list = False
         elements = 0
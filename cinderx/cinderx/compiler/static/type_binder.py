@@ -76,6 +76,7 @@
     Callable,
     CheckedDictInstance,
     CheckedListInstance,
+    CheckedPrimitiveListInstance,
     CInstance,
     Class,
     ClassVar,
@@ -1128,6 +1129,7 @@ def set_dict_type(
             (key_type.klass, value_type.klass),
         )
 
+        self.check_list_display(node, type_ctx)
         self.set_type(node, type_ctx)
         # We can use the type context to have a type which is wider than the
         # inferred types.  But we need to make sure that the keys/values are compatible
@@ -1139,6 +1141,16 @@ def set_dict_type(
             self.check_can_assign_from(type_class, gen_type, node)
         return type_ctx
 
+    def check_list_display(self, node: ast.expr, typ: Value) -> None:
+        # Lists with unboxed elements can't be built from boxed values, so
+        # only an empty display can create one.
+        if isinstance(typ, CheckedPrimitiveListInstance) and not (
+            isinstance(node, ast.List) and not node.elts
+        ):
+            self.syntax_error(
+                f"{typ.name} can only be created from an empty list display", node
+            )
+
     def set_list_type(
         self,
         node: ast.expr,
@@ -1154,6 +1166,7 @@ def set_list_type(
             else:
                 typ = self.type_env.list.exact_type().instance
 
+            self.check_list_display(node, typ)
             self.set_type(node, typ)
             return typ
 
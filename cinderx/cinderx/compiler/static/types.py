@@ -107,6 +107,8 @@
     PRIM_OP_XOR_INT,
     SEQ_ARRAY_INT64,
     SEQ_CHECKED_LIST,
+    SEQ_CHECKED_LIST_DOUBLE,
+    SEQ_CHECKED_LIST_INT64,
     SEQ_LIST,
     SEQ_LIST_INEXACT,
     SEQ_REPEAT_INEXACT_NUM,
@@ -629,6 +631,7 @@ def get_generic_type(
                 # pyre-ignore[6]: We trust that the type name is generic here.
                 k: v.make_generic(concrete, concrete.type_name, self)
                 for k, v in generic_type.members.items()
+                if concrete.inherits_generic_member(k)
             }
         )
         return concrete
@@ -1633,6 +1636,11 @@ def make_generic_type(
         """Binds the generic type parameters to a generic type definition"""
         return None
 
+    def inherits_generic_member(self, name: str) -> bool:
+        """Returns True if the member `name` of the generic type definition
+        should be bound into this instantiation of it"""
+        return True
+
     def resolve_attr(
         self, node: ast.Attribute, visitor: GenericVisitor[object]
     ) -> Optional[Value]:
@@ -8704,6 +8712,24 @@ def __init__(
             ResolvedTypeRef(self),
         )
 
+    def make_generic_type(self, index: Tuple[Class, ...]) -> Class:
+        if len(index) == 1 and index[0] in (self.type_env.int64, self.type_env.double):
+            # Lists of these primitives store their elements unboxed, which
+            # the runtime instantiates as a different type.
+            type_name = GenericTypeName(
+                self.type_name.module, self.type_name.name, index
+            )
+            return CheckedPrimitiveList(
+                type_name,
+                self.type_env,
+                list(self.bases),
+                klass=self.klass,
+                members={},
+                type_def=self,
+                is_exact=self.is_exact,
+            )
+        return super().make_generic_type(index)
+
 
 class CheckedListInstance(Object[CheckedList]):
     @property
@@ -8803,6 +8829,92 @@ def emit_forloop(self, node: ast.For, code_gen: Static38CodeGenerator) -> None:
         return common_sequence_emit_forloop(node, code_gen, SEQ_CHECKED_LIST)
 
 
+class CheckedPrimitiveList(CheckedList):
+    """CheckedList[int64] and CheckedList[double], whose elements are stored
+    unboxed.  Indexing, len() and iteration operate on the unboxed values;
+    other methods are invoked dynamically and take boxed values."""
+
+    def __init__(
+        self,
+        type_name: GenericTypeName,
+        type_env: TypeEnvironment,
+        bases: Optional[List[Class]] = None,
+        instance: Optional[Object[Class]] = None,
+        klass: Optional[Class] = None,
+        members: Optional[Dict[str, Value]] = None,
+        type_def: Optional[GenericClass] = None,
+        is_exact: bool = False,
+        pytype: Optional[Type[object]] = None,
+        is_final: bool = True,
+    ) -> None:
+        if instance is None:
+            instance = CheckedPrimitiveListInstance(self)
+        super().__init__(
+            type_name,
+            type_env,
+            bases,
+            instance,
+            klass,
+            members,
+            type_def,
+            is_exact,
+            pytype,
+            is_final,
+        )
+
+    def inherits_generic_member(self, name: str) -> bool:
+        # The typed methods of CheckedList[T] box and unbox T, which doesn't
+        # apply to the unboxed storage.
+        return name == "__init__"
+
+
+class CheckedPrimitiveListInstance(CheckedListInstance):
+    def _seq_type(self) -> int:
+        if self.klass.type_args[0] is self.klass.type_env.double:
+            return SEQ_CHECKED_LIST_DOUBLE
+        return SEQ_CHECKED_LIST_INT64
+
+    def _maybe_unbox_index(
+        self, node: ast.Subscript, code_gen: Static38CodeGenerator
+    ) -> None:
+        index_type = code_gen.get_type(node.slice)
+        if not isinstance(index_type, CIntInstance):
+            code_gen.emit("REFINE_TYPE", index_type.klass.type_descr)
+            code_gen.emit("PRIMITIVE_UNBOX", TYPED_INT64)
+
+    def emit_load_subscr(
+        self, node: ast.Subscript, code_gen: Static38CodeGenerator
+    ) -> None:
+        if code_gen.get_type(node) == self:
+            # A slice, which is a new list of the same type.
+            return Object.emit_load_subscr(self, node, code_gen)
+
+        self._maybe_unbox_index(node, code_gen)
+        code_gen.emit("SEQUENCE_GET", self._seq_type())
+
+    def emit_store_subscr(
+        self, node: ast.Subscript, code_gen: Static38CodeGenerator
+    ) -> None:
+        if code_gen.get_type(node) == self:
+            return Object.emit_store_subscr(self, node, code_gen)
+
+        self._maybe_unbox_index(node, code_gen)
+        code_gen.emit("SEQUENCE_SET", self._seq_type())
+
+    def bind_forloop_target(self, target: ast.expr, visitor: TypeBinder) -> None:
+        if not isinstance(target, ast.Name):
+            visitor.syntax_error(
+                f"cannot unpack multiple values from {self.name} while iterating",
+                target,
+            )
+        visitor.visit(target)
+
+    def emit_forloop(self, node: ast.For, code_gen: Static38CodeGenerator) -> None:
+        # guaranteed by type-binder
+        assert isinstance(node.target, ast.Name)
+        return common_sequence_emit_forloop(node, code_gen, self._seq_type())
+
+
 class CastFunction(Object[Class]):
     def bind_call(
         self, node: ast.Call, visitor: TypeBinder, type_ctx: Optional[Class]
@@ -99,6 +99,13 @@ def __init__(
             self.verbose,  # _verbose_logging
             self.disable_analysis,  # _disable_analysis
         )
+        analysis_cache_dir = os.getenv("PYTHONSTRICTCACHEDIR") or sys._xoptions.get(
+            "strict-cache-dir"
+        )
+        if isinstance(analysis_cache_dir, str) and isinstance(
+            self.loader, StrictModuleLoader
+        ):
+            self.loader.set_analysis_cache_dir(analysis_cache_dir)
         self.raise_on_error = raise_on_error
         self.log_time_func = log_time_func
         self.enable_patching = enable_patching
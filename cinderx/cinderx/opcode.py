@@ -24,6 +24,16 @@ def shadow_op(name, op):
         def_op(name, op)
         shadowop.add(op)
 
+    def shadow_jrel_op(name, op):
+        shadow_op(name, op)
+        hasjrel.append(op)
+
+    shadow_op("BINARY_ADD_INT", 35)
+    shadow_op("BINARY_ADD_FLOAT", 36)
+    shadow_op("BINARY_ADD_UNICODE", 37)
+    shadow_op("STORE_SUBSCR_LIST", 38)
+    shadow_op("STORE_SUBSCR_DICT", 39)
+
     def_op("INVOKE_METHOD", 158)
     hasconst.append(158)
 
@@ -86,6 +96,11 @@ def shadow_op(name, op):
     def_op("TP_ALLOC", 200)
     hasconst.append(200)
 
+    shadow_op("COMPARE_OP_INT", 201)
+    shadow_jrel_op("FOR_ITER_LIST", 202)
+    shadow_jrel_op("FOR_ITER_RANGE", 203)
+    shadow_op("UNPACK_SEQUENCE_TUPLE", 204)
+
     shadow_op("LOAD_METHOD_UNSHADOWED_METHOD", 205)
     shadow_op("LOAD_METHOD_TYPE_METHODLIKE", 206)
     shadow_op("BUILD_CHECKED_LIST_CACHED", 207)
@@ -95,6 +110,7 @@ def shadow_op(name, op):
     shadow_op("INVOKE_FUNCTION_CACHED", 211)
     shadow_op("INVOKE_FUNCTION_INDIRECT_CACHED", 212)
     shadow_op("BUILD_CHECKED_MAP_CACHED", 213)
+    shadow_op("CALL_FUNCTION_PY", 214)
 
     shadow_op("PRIMITIVE_STORE_FAST", 215)
     shadow_op("CAST_CACHED_OPTIONAL", 216)
@@ -19,6 +19,7 @@
     init_subclass,
     install_sp_audit_hook,
     is_type_static,
+    is_value_class,
     lookup_native_symbol,
     make_context_decorator_wrapper,
     make_recreate_cm,
@@ -69,6 +70,8 @@
     resolve_primitive_descr,
     SEQ_ARRAY_INT64,
     SEQ_CHECKED_LIST,
+    SEQ_CHECKED_LIST_DOUBLE,
+    SEQ_CHECKED_LIST_INT64,
     SEQ_LIST,
     SEQ_LIST_INEXACT,
     SEQ_REPEAT_INEXACT_NUM,
@@ -38,6 +38,8 @@
 
 CINDERX_SRCS = [
     "_cinderx.cpp",
+    "Common/attr_lookup_cache.cpp",
+    "Common/frame_arena.cpp",
     "Common/log.cpp",
     "Common/util.cpp",
     "Common/watchers.cpp",
@@ -49,6 +51,8 @@
     "Jit/bitvector.cpp",
     "Jit/bytecode.cpp",
     "Jit/code_allocator.cpp",
+    "Jit/code_layout.cpp",
+    "Jit/compile_failure_cache.cpp",
     "Jit/compiler.cpp",
     "Jit/config.cpp",
     "Jit/debug_info.cpp",
@@ -58,11 +62,15 @@
     "Jit/disassembler.cpp",
     "Jit/elf.cpp",
     "Jit/frame.cpp",
+    "Jit/gen_data_allocator.cpp",
     "Jit/global_cache.cpp",
     "Jit/hir/hir.cpp",
     "Jit/hir/alias_class.cpp",
     "Jit/hir/analysis.cpp",
     "Jit/hir/builder.cpp",
+    "Jit/hir/float_unboxing.cpp",
+    "Jit/hir/gvn.cpp",
+    "Jit/hir/licm.cpp",
     "Jit/hir/memory_effects.cpp",
     "Jit/hir/optimization.cpp",
     "Jit/hir/parser.cpp",
@@ -70,6 +78,7 @@
     "Jit/hir/printer.cpp",
     "Jit/hir/refcount_insertion.cpp",
     "Jit/hir/register.cpp",
+    "Jit/hir/scalar_replacement.cpp",
     "Jit/hir/simplify.cpp",
     "Jit/hir/ssa.cpp",
     "Jit/hir/type.cpp",
@@ -187,6 +196,7 @@
 
 STRICTM_SRCS = [
     "StrictModules/Compiler/analyzed_module.cpp",
+    "StrictModules/Compiler/analysis_cache.cpp",
     "StrictModules/Compiler/abstract_module_loader.cpp",
     "StrictModules/Compiler/module_info.cpp",
     "StrictModules/Compiler/stub.cpp",
@@ -236,6 +246,7 @@
 STATICPYTHON_SRCS = [
     "StaticPython/checked_dict.c",
     "StaticPython/checked_list.c",
+    "StaticPython/checked_primitive_list.c",
     "StaticPython/classloader.c",
     "StaticPython/descrobject_vectorcall.c",
     "StaticPython/methodobject_vectorcall.c",
@@ -446,6 +446,26 @@ def trigger_load_method_with_stats():
             },
         )
 
+    @jit_suppress
+    @unittest.skipUnless(cinderjit, "Test meaningless without the JIT enabled")
+    def test_cache_states(self):
+        class C:
+            def __init__(self):
+                self.x = 1
+
+        @cinder_support.failUnlessJITCompiled
+        def load_x(c):
+            return c.x
+
+        load_x(C())
+        states = cinderjit.get_and_clear_inline_cache_stats()["cache_states"]
+        self.assertEqual(set(states), {"load_attr", "store_attr", "load_method"})
+        for counts in states.values():
+            self.assertEqual(
+                set(counts), {"empty", "monomorphic", "polymorphic", "megamorphic"}
+            )
+        self.assertGreater(states["load_attr"]["monomorphic"], 0)
+
 
 class InlinedFunctionLineNumberTests(unittest.TestCase):
     @jit_suppress
@@ -3869,6 +3889,47 @@ def test_c_call_error_raised(self):
             self._c_func_that_sets_pyerr()
 
 
+def _direct_call_target(x):
+    return x + 1
+
+
+async def _direct_call_async_target(x):
+    return x + 2
+
+
+class DirectFunctionCallTests(unittest.TestCase):
+    """
+    Calls to values known to be Python functions go straight to the function's
+    vectorcall entry, with the usual vectorcall arguments.
+    """
+
+    @cinder_support.failUnlessJITCompiled
+    def _call_target(self, x):
+        return _direct_call_target(x)
+
+    @cinder_support.failUnlessJITCompiled
+    async def _await_target(self, x):
+        return await _direct_call_async_target(x)
+
+    def test_call(self):
+        self.assertEqual(self._call_target(1), 2)
+
+    def test_callee_code_replaced(self):
+        def other(x):
+            return x * 10
+
+        orig_code = _direct_call_target.__code__
+        try:
+            _direct_call_target.__code__ = other.__code__
+            self.assertEqual(self._call_target(3), 30)
+        finally:
+            _direct_call_target.__code__ = orig_code
+        self.assertEqual(self._call_target(3), 4)
+
+    def test_awaited_call(self):
+        self.assertEqual(asyncio.run(self._await_target(1)), 3)
+
+
 class UnpackSequenceTests(unittest.TestCase):
     @failUnlessHasOpcodes("UNPACK_SEQUENCE")
     @cinder_support.failUnlessJITCompiled
@@ -5111,6 +5172,49 @@ def test_is_op(self):
         self.assertFalse(self.compare_is_not(obj, obj))
 
 
+class LongArithmeticTests(unittest.TestCase):
+    # len() gives the JIT exact ints to work with, so these exercise the
+    # inline paths for single-digit ints as well as the fallback to PyLong.
+    @cinder_support.failUnlessJITCompiled
+    def arith(self, a, b, c):
+        x = len(a) - len(b)
+        y = len(c)
+        return (x + y, x - y, x * y, x & y, x | y, x ^ y, x // 3)
+
+    @cinder_support.failUnlessJITCompiled
+    def compare(self, a, b, c):
+        x = len(a) - len(b)
+        y = len(c)
+        return (x < y, x <= y, x == y, x != y, x > y, x >= y)
+
+    def check(self, x, y):
+        args = (range(max(x, 0)), range(max(-x, 0)), range(y))
+        self.assertEqual(
+            self.arith(*args),
+            (x + y, x - y, x * y, x & y, x | y, x ^ y, x // 3),
+        )
+        self.assertEqual(
+            self.compare(*args), (x < y, x <= y, x == y, x != y, x > y, x >= y)
+        )
+
+    def test_small_ints(self):
+        for x in (0, 1, -1, 5, -300, 1000):
+            for y in (0, 1, 7, 257):
+                self.check(x, y)
+
+    def test_digit_boundaries(self):
+        digit = 1 << 30
+        for x in (digit - 1, -(digit - 1), digit, -digit):
+            for y in (0, 1, digit - 1, digit, digit + 1):
+                self.check(x, y)
+
+    def test_large_ints(self):
+        big = 1 << 62
+        for x in (big, -big):
+            for y in (0, 3, big):
+                self.check(x, y)
+
+
 class MatchTests(unittest.TestCase):
     @cinder_support.failUnlessJITCompiled
     @failUnlessHasOpcodes("MATCH_SEQUENCE", "ROT_N")
@@ -5407,6 +5511,360 @@ def test_batch_compile_nested_func(self):
         self.assertEqual(proc.returncode, 0, proc.stderr)
         self.assertEqual(b"42\n", proc.stdout, proc.stdout)
 
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_batch_compile_worker_stats(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            funcs = []
+            for i in range(20):
+                exec(f"def f{i}(x):\\n" + "    x += 1\\n" * i + "    return x")
+                funcs.append(globals()[f"f{i}"])
+
+            cinderjit.disable()
+            stats = cinderjit.get_batch_compile_worker_stats()
+            print(len(stats))
+            print(sum(s["compiled"] for s in stats) >= len(funcs))
+            print(all(0 <= s["utilization"] <= 1 for s in stats))
+            print(all(cinderjit.is_jit_compiled(f) for f in funcs))
+            """
+        )
+        proc = subprocess.run(
+            [sys.executable, "-X", "jit", "-X", "jit-batch-compile-workers=3"],
+            input=code,
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        self.assertEqual(proc.stdout, "3\nTrue\nTrue\nTrue\n")
+
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_batch_compile_code_layout(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            def f(x):
+                return x + 1
+
+            def g(x):
+                return f(x) * 2
+
+            cinderjit.disable()
+            layout = [
+                e for e in cinderjit.get_code_layout()
+                if e["name"].startswith("__main__:")
+            ]
+            print(sorted(e["name"] for e in layout))
+            print(all(e["code"] != 0 and e["code_size"] > 0 for e in layout))
+            print(cinderjit.is_jit_compiled(f), cinderjit.is_jit_compiled(g))
+            """
+        )
+        proc = subprocess.run(
+            [sys.executable, "-X", "jit", "-X", "jit-code-layout"],
+            input=code,
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        self.assertEqual(
+            proc.stdout, "['__main__:f', '__main__:g']\nTrue\nTrue True\n"
+        )
+
+
+class CompileFailureCacheTests(unittest.TestCase):
+    CODE = textwrap.dedent(
+        """
+        import cinderjit
+
+        def uses_locals():
+            return locals()
+
+        try:
+            cinderjit.force_compile(uses_locals)
+        except RuntimeError as e:
+            print(e.args[0])
+        """
+    )
+
+    def run_with_cache(self, cache, *args):
+        proc = subprocess.run(
+            [
+                sys.executable,
+                "-X",
+                "jit",
+                "-X",
+                f"jit-compile-failure-cache={cache}",
+                *args,
+            ],
+            input=self.CODE,
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        return proc.stdout
+
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_failed_compile_is_not_retried(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            cache = os.path.join(tmp, "cache")
+            self.assertEqual(
+                self.run_with_cache(cache), "PYJIT_RESULT_UNKNOWN_ERROR\n"
+            )
+            with open(cache) as f:
+                self.assertIn(":uses_locals:", f.read())
+            self.assertEqual(
+                self.run_with_cache(cache), "PYJIT_RESULT_NOT_ON_JITLIST\n"
+            )
+            # A different JIT config doesn't use the cached results.
+            self.assertEqual(
+                self.run_with_cache(cache, "-X", "jit-shadow-frame"),
+                "PYJIT_RESULT_UNKNOWN_ERROR\n",
+            )
+
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_cache_from_another_build_is_ignored(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            cache = os.path.join(tmp, "cache")
+            self.run_with_cache(cache)
+            with open(cache) as f:
+                header, entries = f.read().split("\n", 1)
+            self.assertRegex(header, r"; build \S+;")
+            header = re.sub(r"; build \S+;", "; build 0123456789abcdef;", header)
+            with open(cache, "w") as f:
+                f.write(f"{header}\n{entries}")
+            self.assertEqual(
+                self.run_with_cache(cache), "PYJIT_RESULT_UNKNOWN_ERROR\n"
+            )
+
+
+class ReoptimizationTests(unittest.TestCase):
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_recompile_after_repeated_guard_failures(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            A = 0
+
+            def get_a():
+                return A
+
+            def deopts():
+                stats = cinderjit.get_and_clear_runtime_stats()
+                count = sum(
+                    d["int"]["count"]
+                    for d in stats["deopt"]
+                    if d["normal"]["func_qualname"] == "get_a"
+                )
+                return count, stats["reoptimized"]
+
+            cinderjit.force_compile(get_a)
+            for value in range(1, 4):
+                A = value
+                for _ in range(10):
+                    assert get_a() == value
+                print(deopts(), cinderjit.is_jit_compiled(get_a))
+            """
+        )
+        proc = subprocess.run(
+            [sys.executable, "-X", "jit", "-X", "jit-reopt-threshold=3", "-c", code],
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        # The first rebinding recompiles against the new value, the second
+        # drops the guard on A, and later rebindings no longer deopt.
+        self.assertEqual(
+            proc.stdout,
+            "(3, 1) True\n(3, 1) True\n(0, 0) True\n",
+        )
+
+
+class CodeReclamationTests(unittest.TestCase):
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_code_of_dead_functions_is_reused(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            def run(i):
+                ns = {}
+                exec(f"def f(x):\\n    return x + {i}\\n", ns)
+                f = ns.pop("f")
+                cinderjit.force_compile(f)
+                assert cinderjit.is_jit_compiled(f)
+                assert f(1) == i + 1
+
+            for i in range(10):
+                run(i)
+            stats = cinderjit.get_allocator_stats()
+            print(stats["freed_bytes"] > 0, stats["reused_bytes"] > 0)
+            """
+        )
+        proc = subprocess.run(
+            [sys.executable, "-X", "jit", "-c", code],
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        self.assertEqual(proc.stdout, "True True\n")
+
+
+class OnStackReplacementTests(unittest.TestCase):
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_long_running_loops_continue_in_jit(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+            import traceback
+
+            def count_for(n):
+                total = 0
+                for i in range(n):
+                    total += i
+                return total
+
+            def count_while(n):
+                i = 0
+                total = 0
+                while i < n:
+                    total += i
+                    i += 1
+                return total
+
+            def count_nested(n):
+                total = 0
+                for i in range(n):
+                    for j in range(i):
+                        total += j
+                return total
+
+            def raise_in_loop(n):
+                for i in range(n):
+                    if i == n - 1:
+                        raise ValueError(i)
+
+            def osr_entries():
+                return cinderjit.get_and_clear_runtime_stats()["osr_entries"]
+
+            osr_entries()
+            print(count_for(10), osr_entries())
+            print(count_for(1000), count_while(1000), count_nested(100))
+            try:
+                raise_in_loop(1000)
+            except ValueError as e:
+                tb = traceback.extract_tb(e.__traceback__)
+                print(repr(e), [frame.name for frame in tb])
+            print(osr_entries(), cinderjit.is_jit_compiled(count_for))
+            """
+        )
+        proc = subprocess.run(
+            [
+                sys.executable,
+                "-X",
+                "jit-auto=1000",
+                "-X",
+                "jit-osr-threshold=50",
+                "-c",
+                code,
+            ],
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        # Each function is called once, so only OSR can move it out of the
+        # interpreter, and the short loop never reaches the threshold.
+        self.assertEqual(
+            proc.stdout,
+            "45 0\n"
+            "499500 499500 161700\n"
+            "ValueError(999) ['<module>', 'raise_in_loop']\n"
+            "4 False\n",
+        )
+
+
+class BackgroundCompileTests(unittest.TestCase):
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_hot_functions_compile_in_background(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            def hot(x):
+                return x + 1
+
+            def replaced(x):
+                return x + 2
+
+            for i in range(5):
+                hot(i)
+            for i in range(5):
+                replaced(i)
+            replaced.__code__ = hot.__code__
+            cinderjit.wait_for_background_compiles()
+            print(cinderjit.is_jit_compiled(hot), hot(1))
+            print(cinderjit.is_jit_compiled(replaced), replaced(1))
+            """
+        )
+        proc = subprocess.run(
+            [
+                sys.executable,
+                "-X",
+                "jit-auto=2",
+                "-X",
+                "jit-auto-async",
+                "-c",
+                code,
+            ],
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        # The compiled code for replaced's old body must not be installed after
+        # its code object has been swapped out.
+        self.assertEqual(proc.stdout, "True 2\nFalse 2\n")
+
+    @cinder_support.skipUnlessJITEnabled("Runs a subprocess with the JIT enabled")
+    def test_closures_share_background_compile(self):
+        code = textwrap.dedent(
+            """
+            import cinderjit
+
+            def make_adder(n):
+                def add(x):
+                    return x + n
+                return add
+
+            add1 = make_adder(1)
+            add2 = make_adder(2)
+            for i in range(5):
+                add1(i)
+                add2(i)
+            cinderjit.wait_for_background_compiles()
+            print(cinderjit.is_jit_compiled(add1), add1(1))
+            print(cinderjit.is_jit_compiled(add2), add2(1))
+            """
+        )
+        proc = subprocess.run(
+            [
+                sys.executable,
+                "-X",
+                "jit-auto=2",
+                "-X",
+                "jit-auto-async",
+                "-c",
+                code,
+            ],
+            capture_output=True,
+            encoding=sys.stdout.encoding,
+        )
+        self.assertEqual(proc.returncode, 0, proc.stderr)
+        # add2 either waits on the job queued for add1 or picks up its result,
+        # and both end up compiled.
+        self.assertEqual(proc.stdout, "True 2\nTrue 3\n")
+
 
 class PreloadTests(unittest.TestCase):
     SCRIPT_FILE = "cinder_preload_helper_main.py"
@@ -5520,5 +5978,97 @@ def func():
         self.assertGreaterEqual(ops.get("Decref"), 2)
 
 
+class HIROptimizationStatsTests(unittest.TestCase):
+    def test_gvn_eliminates_repeated_global_load(self):
+        def func():
+            return (len, len)
+
+        cinderjit.force_compile(func)
+        self.assertEqual(func(), (len, len))
+
+        stats = cinderjit.get_function_optimization_stats(func)
+        self.assertIsInstance(stats, dict)
+        self.assertGreaterEqual(stats["num_gvn_eliminated"], 1)
+
+    def test_scalar_replacement_removes_unpacked_tuple(self):
+        def func(a, b):
+            t = (a, b)
+            x, y = t
+            return x + y
+
+        cinderjit.force_compile(func)
+        self.assertEqual(func(1, 2), 3)
+
+        stats = cinderjit.get_function_optimization_stats(func)
+        self.assertGreaterEqual(stats["num_scalar_replaced"], 1)
+
+    def test_scalar_replaced_tuple_is_rebuilt_on_deopt(self):
+        def func(a, b):
+            t = (a, b)
+            x, y = t
+            a.missing
+            return x + y
+
+        cinderjit.force_compile(func)
+        stats = cinderjit.get_function_optimization_stats(func)
+        self.assertGreaterEqual(stats["num_scalar_replaced"], 1)
+
+        try:
+            func(1, 2)
+        except AttributeError as e:
+            frame = e.__traceback__.tb_next.tb_frame
+        else:
+            self.fail("expected AttributeError")
+        self.assertEqual(frame.f_locals["t"], (1, 2))
+        self.assertEqual(frame.f_locals["x"], 1)
+
+    def test_float_arithmetic_is_unboxed(self):
+        def func(n):
+            x = 0.5
+            for i in range(n):
+                x = x * 1.5 - 0.25
+                x /= 2
+            return -x
+
+        cinderjit.force_compile(func)
+        self.assertEqual(func(3), 0.078125)
+
+        stats = cinderjit.get_function_optimization_stats(func)
+        self.assertGreaterEqual(stats["num_float_ops_unboxed"], 3)
+
+    def test_unboxed_float_compare_with_nan(self):
+        def func():
+            inf = 1e308 * 10.0
+            nan = inf - inf
+            return (nan < 1.0, nan <= nan, nan > 1.0, nan >= nan, 1.0 < inf)
+
+        cinderjit.force_compile(func)
+        self.assertEqual(func(), (False, False, False, False, True))
+
+    def test_unboxed_float_is_boxed_on_deopt(self):
+        def func(a):
+            x = 1.5
+            t = x * 3.0
+            u = t - 0.5
+            a.missing
+            return u
+
+        cinderjit.force_compile(func)
+        try:
+            func(1)
+        except AttributeError as e:
+            frame = e.__traceback__.tb_next.tb_frame
+        else:
+            self.fail("expected AttributeError")
+        self.assertEqual(frame.f_locals["t"], 4.5)
+        self.assertEqual(frame.f_locals["u"], 4.0)
+
+    def test_not_compiled(self):
+        def func():
+            pass
+
+        self.assertIsNone(cinderjit.get_function_optimization_stats(func))
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -514,3 +514,26 @@ def f() -> int64:
             r"cannot unpack multiple values from Array\[int64] while iterating",
         ):
             self.compile(codestr, modname="foo.py")
+
+    def test_crange_loop_bounds(self):
+        codestr = """
+            from __static__ import Array, box, crange, int64
+
+            def f(a: Array[int64], m: int, n: int) -> int:
+                sum: int64 = 0
+                for i in crange(int64(m), int64(n)):
+                    sum += a[i]
+                return box(sum)
+        """
+        with self.in_module(codestr) as mod:
+            a = Array[int64](4)
+            for i in range(4):
+                a[i] = i + 1
+            self.assertEqual(mod.f(a, 0, 4), 10)
+            self.assertEqual(mod.f(a, 1, 3), 5)
+            self.assertEqual(mod.f(a, 3, 0), 0)
+            self.assertEqual(mod.f(a, -2, 0), 7)
+            with self.assertRaisesRegex(IndexError, "index out of range"):
+                mod.f(a, 2, 5)
+            with self.assertRaisesRegex(IndexError, "index out of range"):
+                mod.f(a, -5, 0)
@@ -1,8 +1,13 @@
-from __static__ import CheckedList
+from __static__ import CheckedList, double, int64
 
 from unittest import skip, skipIf
 
-from cinderx.static import SEQ_CHECKED_LIST, SEQ_SUBSCR_UNCHECKED
+from cinderx.static import (
+    SEQ_CHECKED_LIST,
+    SEQ_CHECKED_LIST_DOUBLE,
+    SEQ_CHECKED_LIST_INT64,
+    SEQ_SUBSCR_UNCHECKED,
+)
 
 from .common import bad_ret_type, StaticTestBase, type_mismatch
 
@@ -544,3 +549,147 @@ def f() -> int:
             for i in range(50):
                 mod.f()
             self.assertEqual(mod.f(), 6)
+
+    def test_checked_list_primitive(self):
+        x = CheckedList[int64]()
+        self.assertEqual(type(x).__name__, "chklist[int64]")
+        self.assertEqual(CheckedList[int64].__module__, "__static__")
+        x.append(1)
+        x.extend([2, 3])
+        x.extend(x)
+        self.assertEqual(repr(x), "[1, 2, 3, 1, 2, 3]")
+        self.assertEqual(len(x), 6)
+        self.assertEqual(x[-1], 3)
+        self.assertEqual(x[1:3], CheckedList[int64]([2, 3]))
+        self.assertEqual(list(x), [1, 2, 3, 1, 2, 3])
+        self.assertEqual(x.pop(), 3)
+        del x[0]
+        self.assertEqual(list(x), [2, 3, 1, 2])
+        with self.assertRaisesRegex(TypeError, "bad value 'str'"):
+            x.append("A")
+        with self.assertRaises(OverflowError):
+            x[0] = 1 << 64
+        with self.assertRaises(IndexError):
+            x[4]
+
+        y = CheckedList[double]([1.5])
+        y.append(2.5)
+        self.assertEqual(y[0] + y[1], 4.0)
+        with self.assertRaisesRegex(TypeError, "bad value 'int'"):
+            y.append(1)
+
+    def test_checked_list_primitive_subscr(self):
+        codestr = """
+            from __static__ import CheckedList, box, double, int64
+
+            def f(n: int64) -> double:
+                a: CheckedList[double] = []
+                i: int64 = 0
+                while i < n:
+                    a.append(box(double(0.0)))
+                    i += 1
+                i = 0
+                v: double = 0.0
+                while i < n:
+                    a[i] = v
+                    v += 0.5
+                    i += 1
+                total: double = 0.0
+                for x in a:
+                    total += x
+                return total
+
+            def g(a: CheckedList[int64], i: int) -> int:
+                a[i] = a[i] + 1
+                return box(a[i])
+        """
+        with self.in_module(codestr) as mod:
+            self.assertInBytecode(
+                mod.f, "SEQUENCE_SET", SEQ_CHECKED_LIST_DOUBLE
+            )
+            self.assertInBytecode(
+                mod.f,
+                "SEQUENCE_GET",
+                SEQ_CHECKED_LIST_DOUBLE | SEQ_SUBSCR_UNCHECKED,
+            )
+            self.assertInBytecode(mod.g, "SEQUENCE_GET", SEQ_CHECKED_LIST_INT64)
+            self.assertEqual(mod.f(4), 3.0)
+
+            a = CheckedList[int64]([1, 41])
+            self.assertEqual(mod.g(a, -1), 42)
+            self.assertEqual(list(a), [1, 42])
+            with self.assertRaises(IndexError):
+                mod.g(a, 2)
+
+    def test_checked_list_primitive_literal(self):
+        codestr = """
+            from __static__ import CheckedList, int64
+
+            def f() -> None:
+                a: CheckedList[int64] = [1, 2]
+        """
+        self.type_error(
+            codestr,
+            r"can only be created from an empty list display",
+            at="[1, 2]",
+        )
+
+    def test_checked_list_primitive_slice_assign(self):
+        x = CheckedList[int64]([1, 2, 3, 4, 5])
+        x[1:3] = [7, 8, 9]
+        self.assertEqual(list(x), [1, 7, 8, 9, 4, 5])
+        x[4:] = CheckedList[int64]()
+        self.assertEqual(list(x), [1, 7, 8, 9])
+        x[::2] = CheckedList[int64]([0, 0])
+        self.assertEqual(list(x), [0, 7, 0, 9])
+        x[::-1] = x
+        self.assertEqual(list(x), [9, 0, 7, 0])
+        x[:0] = x
+        self.assertEqual(list(x), [9, 0, 7, 0, 9, 0, 7, 0])
+        del x[::3]
+        self.assertEqual(list(x), [0, 7, 9, 0, 0])
+        del x[3:]
+        self.assertEqual(list(x), [0, 7, 9])
+        with self.assertRaisesRegex(TypeError, "bad value 'str'"):
+            x[:1] = [1, "A"]
+        self.assertEqual(list(x), [0, 7, 9])
+        with self.assertRaisesRegex(ValueError, "extended slice of size 2"):
+            x[::2] = [1]
+
+        y = CheckedList[double]([1.0, 2.0])
+        y[1:] = [2.5, 3.5]
+        self.assertEqual(list(y), [1.0, 2.5, 3.5])
+
+    def test_checked_list_boxed_elements(self):
+        # Only int64 and double elements are stored unboxed; other element
+        # types, including bool, still go through the boxed path.
+        codestr = """
+            from __static__ import CheckedList
+
+            def f(a: CheckedList[int]) -> int:
+                total: int = 0
+                for el in a:
+                    total += el
+                return total
+
+            def g(a: CheckedList[bool]) -> int:
+                n: int = 0
+                for el in a:
+                    if el:
+                        n += 1
+                return n
+
+            def h() -> CheckedList[bool]:
+                return [True, False]
+        """
+        with self.in_module(codestr) as mod:
+            self.assertInBytecode(
+                mod.f, "SEQUENCE_GET", SEQ_CHECKED_LIST | SEQ_SUBSCR_UNCHECKED
+            )
+            self.assertInBytecode(
+                mod.g, "SEQUENCE_GET", SEQ_CHECKED_LIST | SEQ_SUBSCR_UNCHECKED
+            )
+            self.assertEqual(mod.f(CheckedList[int]([1, 2, 3])), 6)
+            self.assertEqual(mod.g(CheckedList[bool]([True, False, True])), 2)
+            self.assertEqual(type(mod.h()), CheckedList[bool])
+            self.assertEqual(type(mod.h()).__name__, "chklist[bool]")
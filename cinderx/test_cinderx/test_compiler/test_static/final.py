@@ -1,9 +1,17 @@
+import gc
 from typing import ClassVar
+from unittest import skipIf
 
 from cinderx.compiler.errors import TypedSyntaxError
+from cinderx.static import is_value_class
 
 from .common import StaticTestBase
 
+try:
+    import cinderjit
+except ImportError:
+    cinderjit = None
+
 
 class FinalTests(StaticTestBase):
     def test_final_multiple_typeargs(self):
@@ -869,3 +877,72 @@ def foo(c: C) -> int:
             )
             self.assertEqual(mod.foo(mod.C()), 42)
             self.assertEqual(mod.foo(mod.D()), 63)
+
+    def test_final_primitive_class_is_value_class(self):
+        codestr = """
+        from __static__ import double, int64
+        from typing import final
+
+        @final
+        class Point:
+            def __init__(self, x: double, y: double) -> None:
+                self.x: double = x
+                self.y: double = y
+                self.n: int64 = 0
+
+        class Open:
+            def __init__(self, x: double) -> None:
+                self.x: double = x
+
+        @final
+        class Named:
+            def __init__(self, name: str) -> None:
+                self.name: str = name
+        """
+        with self.in_module(codestr) as mod:
+            self.assertTrue(is_value_class(mod.Point))
+            self.assertFalse(is_value_class(mod.Open))
+            self.assertFalse(is_value_class(mod.Named))
+
+            p = mod.Point(1.0, 2.0)
+            self.assertFalse(gc.is_tracked(p))
+            self.assertEqual((p.x, p.y, p.n), (1.0, 2.0, 0))
+            p.n = 5
+            del p
+            # Reused instances come back zeroed.
+            for i in range(1000):
+                p = mod.Point(float(i), 0.0)
+                self.assertEqual((p.x, p.y, p.n), (float(i), 0.0, 0))
+                p.n = i
+
+    @skipIf(cinderjit is None, "JIT disabled")
+    def test_value_class_scalar_replaced(self):
+        codestr = """
+        from __static__ import double
+        from typing import final
+
+        @final
+        class Point:
+            def __init__(self, x: double, y: double) -> None:
+                self.x: double = x
+                self.y: double = y
+
+        def norm2(x: double, y: double) -> double:
+            p = Point(x, y)
+            p.x = p.x * 2
+            return p.x * p.x + p.y * p.y
+
+        def deopt(x: double, y: double, z) -> double:
+            p = Point(x, y)
+            try:
+                z + 1
+            except TypeError:
+                return p.x + p.y
+            return 0.0
+        """
+        with self.in_module(codestr) as mod:
+            cinderjit.force_compile(mod.norm2)
+            cinderjit.force_compile(mod.deopt)
+            self.assertEqual(mod.norm2(1.0, 2.0), 8.0)
+            self.assertEqual(mod.deopt(1.0, 2.0, 1), 0.0)
+            self.assertEqual(mod.deopt(1.0, 2.0, None), 3.0)
@@ -532,6 +532,52 @@ def g():
             C.f = orig
             self.assertEqual(g(), None)
 
+    @skipIf(cinderjit is None, "JIT disabled")
+    def test_override_devirtualized_method(self):
+        codestr = """
+            class C:
+                def f(self) -> int:
+                    return 1
+
+            def g(c: C) -> int:
+                return c.f()
+        """
+        with self.in_module(codestr) as mod:
+            g, C = mod.g, mod.C
+            cinderjit.force_compile(g)
+            self.assertEqual(g(C()), 1)
+
+            class D(C):
+                def f(self) -> int:
+                    return 2
+
+            self.assertEqual(g(D()), 2)
+            self.assertEqual(g(C()), 1)
+
+    @skipIf(cinderjit is None, "JIT disabled")
+    def test_patch_devirtualized_method(self):
+        codestr = """
+            class C:
+                def f(self) -> int:
+                    return 1
+
+            def g(c: C) -> int:
+                return c.f()
+        """
+        with self.in_module(codestr) as mod:
+            g, C = mod.g, mod.C
+            cinderjit.force_compile(g)
+
+            class D(C):
+                pass
+
+            self.assertEqual(g(D()), 1)
+            D.f = lambda self: 2
+            self.assertEqual(g(D()), 2)
+            self.assertEqual(g(C()), 1)
+            C.f = lambda self: 3
+            self.assertEqual(g(C()), 3)
+
     def test_patch_property_with_instance_and_override_dict(self):
         codestr = """
             class C:
@@ -2,6 +2,7 @@
 
 import gc
 import unittest
+import weakref
 
 import test.test_gc
 
@@ -19,6 +20,7 @@ def _restore_parallel_gc(settings):
         cinder.enable_parallel_gc(
             settings["min_generation"],
             settings["num_threads"],
+            settings["incremental_slice"],
         )
 
 
@@ -39,9 +41,86 @@ def test_get_settings_when_enabled(self):
         expected = {
             "min_generation": 2,
             "num_threads": 8,
+            "incremental_slice": 0,
         }
         self.assertEqual(settings, expected)
 
+    def test_set_incremental_slice(self):
+        cinder.enable_parallel_gc(2, 8, incremental_slice=1000)
+        self.assertEqual(cinder.get_parallel_gc_settings()["incremental_slice"], 1000)
+        # Only the slice changes once parallel gc is enabled
+        cinder.enable_parallel_gc(1, 4, incremental_slice=10)
+        expected = {
+            "min_generation": 2,
+            "num_threads": 8,
+            "incremental_slice": 10,
+        }
+        self.assertEqual(cinder.get_parallel_gc_settings(), expected)
+
+    def test_set_invalid_incremental_slice(self):
+        with self.assertRaisesRegex(ValueError, "invalid incremental_slice"):
+            cinder.enable_parallel_gc(2, 8, incremental_slice=-1)
+
+    def test_get_pause_stats_when_disabled(self):
+        self.assertEqual(cinder.get_parallel_gc_pause_stats(), None)
+
+    def test_get_pause_stats(self):
+        cinder.enable_parallel_gc(0, 2)
+        gc.collect(0)
+        gc.collect()
+        stats = cinder.get_parallel_gc_pause_stats()
+        self.assertEqual(set(stats), {"young", "incremental", "full"})
+        for kind in ("young", "full"):
+            self.assertGreaterEqual(stats[kind]["count"], 1)
+            self.assertEqual(
+                sum(stats[kind]["histogram"].values()), stats[kind]["count"]
+            )
+            self.assertGreaterEqual(stats[kind]["total_us"], stats[kind]["max_us"])
+
+    def test_incremental_collections(self):
+        cinder.enable_parallel_gc(0, 2, incremental_slice=100)
+        gc.collect()
+
+        class Node:
+            pass
+
+        # Enough long-lived objects for an increment to cover only part of
+        # the oldest generation
+        live = [Node() for _ in range(1000)]
+        gc.collect()
+        for node in live:
+            node.self = node
+
+        # Only automatic collections are incremental
+        gc.collect(1)
+        stats = cinder.get_parallel_gc_pause_stats()
+        self.assertEqual(stats["incremental"]["count"], 0)
+
+        old_threshold = gc.get_threshold()
+        try:
+            gc.set_threshold(100, 1, old_threshold[2])
+            garbage = [[] for _ in range(1000)]
+            del garbage
+        finally:
+            gc.set_threshold(*old_threshold)
+        stats = cinder.get_parallel_gc_pause_stats()
+        self.assertGreaterEqual(stats["incremental"]["count"], 1)
+
+        # Explicit collections are always full ones, so they find garbage
+        # that no increment has reached yet
+        ref = weakref.ref(live[-1])
+        del live, node
+        gc.collect()
+        self.assertIsNone(ref())
+
+    def test_gc_collect_wrapped_while_enabled(self):
+        orig_collect = gc.collect
+        cinder.enable_parallel_gc(2, 2)
+        self.assertIsNot(gc.collect, orig_collect)
+        self.assertEqual(gc.collect.__name__, "collect")
+        cinder.disable_parallel_gc()
+        self.assertIs(gc.collect, orig_collect)
+
     def test_set_invalid_generation(self):
         with self.assertRaisesRegex(ValueError, "invalid generation"):
             cinder.enable_parallel_gc(4, 8)
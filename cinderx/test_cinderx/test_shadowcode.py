@@ -2640,6 +2640,200 @@ def f(c, k):
         for __ in range(REPETITION):
             self.assertEqual(f(l, 1), 2)
 
+    def test_binary_add_changing_types(self):
+        def f(a, b):
+            return a + b
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), 3)
+            self.assertEqual(f(-(2**40), 1), -(2**40) + 1)
+        for __ in range(REPETITION):
+            self.assertEqual(f(1.5, 2.0), 3.5)
+        for __ in range(REPETITION):
+            self.assertEqual(f("a", "b"), "ab")
+        for __ in range(REPETITION):
+            self.assertEqual(f([1], [2]), [1, 2])
+            self.assertEqual(f(True, 1), 2)
+
+    def test_binary_add_polymorphic(self):
+        def f(a, b):
+            return a + b
+
+        # The site stops being quickened once it has flipped between types
+        # enough times, and keeps working after that.
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), 3)
+            self.assertEqual(f(1.5, 2.0), 3.5)
+            self.assertEqual(f("a", "b"), "ab")
+
+    def test_binary_add_unicode_in_place(self):
+        def f(n):
+            s = ""
+            for __ in range(n):
+                s = s + "x"
+            return s
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(10), "x" * 10)
+
+    def test_compare_op_int(self):
+        def f(a, b):
+            return (a < b, a <= b, a == b, a != b, a > b, a >= b)
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), (True, True, False, True, False, False))
+            self.assertEqual(f(-3, -3), (False, True, True, False, False, True))
+            self.assertEqual(
+                f(2**40, 1), (False, False, False, True, True, True)
+            )
+        for __ in range(REPETITION):
+            self.assertEqual(f("a", "b"), (True, True, False, True, False, False))
+            self.assertEqual(f(1.0, 1), (False, True, True, False, False, True))
+
+    def test_for_iter_changing_iterables(self):
+        def f(it):
+            total = 0
+            for x in it:
+                total += x
+            return total
+
+        for __ in range(REPETITION):
+            self.assertEqual(f([1, 2, 3]), 6)
+        for __ in range(REPETITION):
+            self.assertEqual(f(range(4)), 6)
+            self.assertEqual(f(range(2**62, 2**62 + 2)), 2**63 + 1)
+        for __ in range(REPETITION):
+            self.assertEqual(f((1, 2)), 3)
+            self.assertEqual(f(x for x in [1, 2]), 3)
+
+    def test_store_subscr(self):
+        def f(c, k, v):
+            c[k] = v
+
+        l = [0, 0, 0]
+        for __ in range(REPETITION):
+            f(l, 1, 2)
+            f(l, -1, 3)
+        self.assertEqual(l, [0, 2, 3])
+        for __ in range(REPETITION):
+            with self.assertRaisesRegex(IndexError, "assignment index out of range"):
+                f(l, 3, 1)
+            with self.assertRaises(IndexError):
+                f(l, 2**100, 1)
+
+        d = {}
+        for __ in range(REPETITION):
+            f(d, "a", 1)
+            f(d, 2, 3)
+        self.assertEqual(d, {"a": 1, 2: 3})
+
+        for __ in range(REPETITION):
+            f(l, slice(0, 1), [4])
+            f(UserDict(), 1, 2)
+        self.assertEqual(l, [4, 2, 3])
+
+    def test_unpack_sequence(self):
+        def f(seq):
+            a, b = seq
+            return a - b
+
+        for __ in range(REPETITION):
+            self.assertEqual(f((3, 1)), 2)
+        for __ in range(REPETITION):
+            self.assertEqual(f([3, 1]), 2)
+            self.assertEqual(f(iter((3, 1))), 2)
+            with self.assertRaises(ValueError):
+                f((1, 2, 3))
+
+    def test_call_function_changing_callables(self):
+        def g(x):
+            return x + 1
+
+        def f(fn, x):
+            return fn(x)
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(g, 1), 2)
+        for __ in range(REPETITION):
+            self.assertEqual(f(abs, -1), 1)
+            self.assertEqual(f(lambda x: x * 2, 2), 4)
+            with self.assertRaises(TypeError):
+                f(None, 1)
+
+    def test_inlined_call_frames(self):
+        def g():
+            return sys._getframe()
+
+        def f():
+            return g(), sys._getframe()
+
+        for __ in range(REPETITION):
+            inner, outer = f()
+            self.assertIs(inner.f_back, outer)
+            self.assertEqual(inner.f_code, g.__code__)
+            self.assertEqual(outer.f_code, f.__code__)
+
+    def test_inlined_call_exception(self):
+        def g(x):
+            if x:
+                raise ValueError(x)
+            return x
+
+        def f(x):
+            try:
+                return g(x)
+            except ValueError as e:
+                return e
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(0), 0)
+            e = f(1)
+            self.assertIsInstance(e, ValueError)
+            tb = e.__traceback__
+            self.assertEqual(tb.tb_frame.f_code, f.__code__)
+            self.assertEqual(tb.tb_next.tb_frame.f_code, g.__code__)
+            with self.assertRaises(TypeError):
+                f()
+
+    def test_inlined_call_method(self):
+        class C:
+            def __init__(self, x):
+                self.x = x
+
+            def add(self, y):
+                return self.x + y
+
+        def f(c, y):
+            return c.add(y)
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(C(1), 2), 3)
+
+    def test_inlined_call_generator(self):
+        def gen(n):
+            yield from range(n)
+
+        def count(n):
+            return n
+
+        def f(n):
+            return [count(x) for x in gen(n)]
+
+        for __ in range(REPETITION):
+            self.assertEqual(f(3), [0, 1, 2])
+
+    def test_inlined_call_recursion(self):
+        def fib(n):
+            return n if n < 2 else fib(n - 1) + fib(n - 2)
+
+        def forever(n):
+            return forever(n + 1)
+
+        for __ in range(REPETITION):
+            self.assertEqual(fib(10), 55)
+        with self.assertRaises(RecursionError):
+            forever(0)
+
     def test_tuple_int_const_key_two_tuples(self):
         t = (1, 2, 3)
         t2 = (3, 4, 5)